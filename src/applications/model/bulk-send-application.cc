@@ -18,6 +18,7 @@
  * Author: George F. Riley <riley@ece.gatech.edu>
  */
 
+#include <algorithm>
 #include "ns3/log.h"
 #include "ns3/address.h"
 #include "ns3/node.h"
@@ -27,6 +28,8 @@
 #include "ns3/socket-factory.h"
 #include "ns3/packet.h"
 #include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/inet-socket-address.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/tcp-socket-factory.h"
 #include "bulk-send-application.h"
@@ -64,6 +67,33 @@ BulkSendApplication::GetTypeId (void)
                    TypeIdValue (TcpSocketFactory::GetTypeId ()),
                    MakeTypeIdAccessor (&BulkSendApplication::m_tid),
                    MakeTypeIdChecker ())
+    .AddAttribute ("Fluid",
+                   "If true, model the transfer as a flow-level TCP aggregate "
+                   "on the path to the remote IPv4 address, instead of sending data.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&BulkSendApplication::m_fluid),
+                   MakeBooleanChecker ())
+    .AddAttribute ("FluidFlows",
+                   "The number of TCP transfers of the fluid model.",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&BulkSendApplication::m_fluidFlows),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("FluidSegmentSize",
+                   "The TCP segment size of the fluid model.",
+                   UintegerValue (536),
+                   MakeUintegerAccessor (&BulkSendApplication::m_fluidSegmentSize),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("FluidMaxWindow",
+                   "The maximum window of each TCP transfer of the fluid model, "
+                   "in bytes, as set by the receive buffer of the receiver.",
+                   UintegerValue (131072),
+                   MakeUintegerAccessor (&BulkSendApplication::m_fluidMaxWindow),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("FluidStep",
+                   "The period at which the fluid model is updated.",
+                   TimeValue (MilliSeconds (10)),
+                   MakeTimeAccessor (&BulkSendApplication::m_fluidStep),
+                   MakeTimeChecker ())
     .AddTraceSource ("Tx", "A new packet is created and is sent",
                      MakeTraceSourceAccessor (&BulkSendApplication::m_txTrace),
                      "ns3::Packet::TracedCallback")
@@ -75,7 +105,12 @@ BulkSendApplication::GetTypeId (void)
 BulkSendApplication::BulkSendApplication ()
   : m_socket (0),
     m_connected (false),
-    m_totBytes (0)
+    m_totBytes (0),
+    m_fluid (false),
+    m_fluidWindow (1),
+    m_fluidSlowStart (true),
+    m_fluidRate (0),
+    m_fluidBytes (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -105,6 +140,7 @@ BulkSendApplication::DoDispose (void)
   NS_LOG_FUNCTION (this);
 
   m_socket = 0;
+  m_fluidEvent.Cancel ();
   // chain up
   Application::DoDispose ();
 }
@@ -114,6 +150,32 @@ void BulkSendApplication::StartApplication (void) // Called at time specified by
 {
   NS_LOG_FUNCTION (this);
 
+  if (m_fluid)
+    {
+      if (!InetSocketAddress::IsMatchingType (m_peer))
+        {
+          NS_FATAL_ERROR ("BulkSend fluid mode requires an IPv4 remote address");
+        }
+      Ipv4Address destination = InetSocketAddress::ConvertFrom (m_peer).GetIpv4 ();
+      if (!m_fluidPath.Compute (GetNode (), destination))
+        {
+          NS_LOG_WARN ("BulkSendApplication found no complete path to " << destination);
+        }
+      if (m_fluidPath.GetNServedHops () > 0)
+        {
+          m_fluidWindow = 1;
+          m_fluidSlowStart = true;
+          m_fluidUpdate = Simulator::Now ();
+          m_fluidEvent.Cancel ();
+          FluidStep ();
+          return;
+        }
+      // Without loss nor queueing delay, the fluid would stay in slow
+      // start forever.
+      NS_LOG_WARN ("BulkSendApplication found no hop modeling fluid traffic to "
+                   << destination << ", sending packets");
+    }
+
   // Create the socket if not already
   if (!m_socket)
     {
@@ -155,6 +217,12 @@ void BulkSendApplication::StopApplication (void) // Called at time specified by
 {
   NS_LOG_FUNCTION (this);
 
+  if (m_fluid && m_fluidPath.GetNServedHops () > 0)
+    {
+      m_fluidEvent.Cancel ();
+      SetFluidRate (DataRate (0));
+      return;
+    }
   if (m_socket != 0)
     {
       m_socket->Close ();
@@ -219,6 +287,59 @@ void BulkSendApplication::ConnectionFailed (Ptr<Socket> socket)
   NS_LOG_LOGIC ("BulkSendApplication, Connection Failed");
 }
 
+void BulkSendApplication::FluidStep (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  // Count the bytes delivered at the rate of the last step.
+  Time now = Simulator::Now ();
+  double elapsed = (now - m_fluidUpdate).GetSeconds ();
+  m_fluidUpdate = now;
+  double loss = m_fluidPath.GetLossRatio ();
+  m_fluidBytes += elapsed * m_fluidRate.GetBitRate () / 8 * (1 - loss);
+  m_totBytes = static_cast<uint32_t> (std::min (m_fluidBytes, 4294967295.0));
+  if (m_maxBytes != 0 && m_totBytes >= m_maxBytes)
+    {
+      m_totBytes = m_maxBytes;
+      SetFluidRate (DataRate (0));
+      return;
+    }
+
+  // The acks are assumed to follow the path of the data backwards.
+  double rtt = (m_fluidPath.GetBaseDelay (m_fluidSegmentSize) * 2 + m_fluidPath.GetQueueDelay ()).GetSeconds ();
+  // The model needs a step shorter than the round trip.
+  rtt = std::max (rtt, m_fluidStep.GetSeconds ());
+  if (loss > 0)
+    {
+      m_fluidSlowStart = false;
+    }
+  double increase = (m_fluidSlowStart ? m_fluidWindow : 1) / rtt * elapsed;
+  // The window is at most halved once per round trip.
+  double decrease = m_fluidWindow * m_fluidWindow * loss / (2 * rtt) * elapsed;
+  decrease = std::min (decrease, m_fluidWindow / 2 * std::min (elapsed / rtt, 1.0));
+  m_fluidWindow = std::max (m_fluidWindow + increase - decrease, 1.0);
+  m_fluidWindow = std::min (m_fluidWindow, std::max (static_cast<double> (m_fluidMaxWindow) / m_fluidSegmentSize, 1.0));
+
+  // The source cannot send faster than its link.
+  double rate = m_fluidFlows * m_fluidWindow * m_fluidSegmentSize * 8 / rtt;
+  uint64_t linkRate = m_fluidPath.GetFirstHopRate ().GetBitRate ();
+  if (linkRate > 0)
+    {
+      rate = std::min (rate, static_cast<double> (linkRate));
+    }
+  NS_LOG_LOGIC ("window " << m_fluidWindow << " rtt " << rtt << " loss " << loss << " rate " << rate);
+  SetFluidRate (DataRate (static_cast<uint64_t> (rate)));
+  m_fluidEvent = Simulator::Schedule (m_fluidStep, &BulkSendApplication::FluidStep, this);
+}
+
+void BulkSendApplication::SetFluidRate (DataRate rate)
+{
+  NS_LOG_FUNCTION (this << rate);
+  m_fluidPath.RemoveRate (m_fluidRate);
+  m_fluidRate = rate;
+  m_fluidPath.AddRate (m_fluidRate);
+}
+
 void BulkSendApplication::DataSend (Ptr<Socket>, uint32_t)
 {
   NS_LOG_FUNCTION (this);
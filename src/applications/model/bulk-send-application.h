@@ -26,6 +26,9 @@
 #include "ns3/event-id.h"
 #include "ns3/ptr.h"
 #include "ns3/traced-callback.h"
+#include "ns3/nstime.h"
+#include "ns3/data-rate.h"
+#include "fluid-path.h"
 
 namespace ns3 {
 
@@ -64,6 +67,26 @@ class Socket;
  * For example, TCP sockets can be used, but
  * UDP sockets can not be used.
  *
+ * With the "Fluid" attribute, the application opens no socket and stands
+ * for an aggregate of "FluidFlows" TCP transfers at the flow level: the
+ * congestion window of each transfer follows the fluid model of Misra,
+ * Gong and Towsley, dW/dt = 1/R - W^2 p / (2 R), with a slow start
+ * until the first loss, and is updated every "FluidStep".  The round
+ * trip time R is twice the base delay of a segment along the IPv4 path
+ * to the remote address, plus the queueing delay on this path, and p is
+ * the loss ratio of the path (see FluidPath), in which only the
+ * point-to-point links delay and drop the fluid.  The aggregate rate
+ * N W S / R is added to the transmit queues of the path, so that it
+ * consumes the capacity of the links and delays and drops the packets
+ * which share them, in a few events per step instead of several per
+ * packet.  The window is bounded by "FluidMaxWindow", and the aggregate
+ * rate by the rate of the first hop.  The MaxBytes bound counts the
+ * bytes delivered by the model, and is checked at each step.  The Tx
+ * trace source is not fired in this mode.
+ *
+ * Without a point-to-point link on the path, nothing would slow the
+ * fluid down: the application then warns and sends packets through a
+ * socket, as without the "Fluid" attribute.
  */
 class BulkSendApplication : public Application
 {
@@ -137,6 +160,28 @@ private:
    * \brief Send more data as soon as some has been transmitted.
    */
   void DataSend (Ptr<Socket>, uint32_t); // for socket's SetSendCallback
+  /**
+   * \brief Update the window and the rate of the fluid model.
+   */
+  void FluidStep (void);
+  /**
+   * \brief Set the rate of the fluid model on the queues of the path.
+   * \param rate the new rate
+   */
+  void SetFluidRate (DataRate rate);
+
+  bool            m_fluid;            //!< True to model the transfers as fluid
+  uint32_t        m_fluidFlows;       //!< Number of transfers of the fluid model
+  uint32_t        m_fluidSegmentSize; //!< Segment size of the fluid model
+  uint32_t        m_fluidMaxWindow;   //!< Maximum window of each transfer, in bytes
+  Time            m_fluidStep;        //!< Update period of the fluid model
+  FluidPath       m_fluidPath;        //!< Queues crossed by the fluid
+  double          m_fluidWindow;      //!< Window of each transfer, in segments
+  bool            m_fluidSlowStart;   //!< True until the first loss
+  DataRate        m_fluidRate;        //!< Rate added to the path
+  double          m_fluidBytes;       //!< Bytes delivered by the fluid model
+  Time            m_fluidUpdate;      //!< Time of the last update
+  EventId         m_fluidEvent;       //!< Next update of the fluid model
 };
 
 } // namespace ns3
@@ -0,0 +1,244 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/channel.h"
+#include "ns3/net-device.h"
+#include "ns3/pointer.h"
+#include "ns3/ipv4.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/ipv4-routing-protocol.h"
+#include "fluid-path.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("FluidPath");
+
+namespace {
+
+/// The maximum number of hops of a path, to stop on routing loops.
+const uint32_t MAX_HOPS = 255;
+
+/**
+ * \param device an output device.
+ * \param address an address of a node attached to the channel of the device.
+ * \returns the node, or zero if it is not found.
+ */
+Ptr<Node>
+FindNeighbor (Ptr<NetDevice> device, Ipv4Address address)
+{
+  Ptr<Channel> channel = device->GetChannel ();
+  if (channel == 0)
+    {
+      return 0;
+    }
+  for (uint32_t i = 0; i < channel->GetNDevices (); i++)
+    {
+      Ptr<NetDevice> other = channel->GetDevice (i);
+      if (other == device)
+        {
+          continue;
+        }
+      Ptr<Ipv4> ipv4 = other->GetNode ()->GetObject<Ipv4> ();
+      if (ipv4 != 0 && ipv4->GetInterfaceForAddress (address) >= 0)
+        {
+          return other->GetNode ();
+        }
+    }
+  return 0;
+}
+
+} // anonymous namespace
+
+FluidPath::FluidPath ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+bool
+FluidPath::Compute (Ptr<Node> source, Ipv4Address destination)
+{
+  NS_LOG_FUNCTION (this << source << destination);
+  m_hops.clear ();
+  Ptr<Node> node = source;
+  while (m_hops.size () < MAX_HOPS)
+    {
+      Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+      if (ipv4 == 0)
+        {
+          NS_LOG_LOGIC ("No IPv4 on node " << node->GetId ());
+          return false;
+        }
+      if (ipv4->GetInterfaceForAddress (destination) >= 0)
+        {
+          return true;
+        }
+      Ipv4Header header;
+      header.SetDestination (destination);
+      Socket::SocketErrno error;
+      Ptr<Ipv4Route> route = ipv4->GetRoutingProtocol ()->RouteOutput (0, header, 0, error);
+      if (route == 0)
+        {
+          NS_LOG_LOGIC ("No route to " << destination << " on node " << node->GetId ());
+          return false;
+        }
+      Ptr<NetDevice> device = route->GetOutputDevice ();
+      Hop hop;
+      PointerValue queue;
+      if (device->GetAttributeFailSafe ("TxQueue", queue))
+        {
+          hop.queue = queue.Get<Queue> ();
+        }
+      if (hop.queue == 0 || hop.queue->GetFluidLinkRate ().GetBitRate () == 0)
+        {
+          // Only the devices which set the link rate of their queue serve
+          // the fluid: the other hops neither delay nor drop it.
+          NS_LOG_WARN ("Device " << device->GetInstanceTypeId ().GetName () << " of node "
+                       << node->GetId () << " does not model fluid traffic");
+          hop.queue = 0;
+        }
+      DataRateValue rate;
+      if (device->GetAttributeFailSafe ("DataRate", rate))
+        {
+          hop.rate = rate.Get ();
+        }
+      TimeValue delay;
+      if (device->GetChannel () != 0 && device->GetChannel ()->GetAttributeFailSafe ("Delay", delay))
+        {
+          hop.delay = delay.Get ();
+        }
+      m_hops.push_back (hop);
+
+      Ipv4Address gateway = route->GetGateway ();
+      node = FindNeighbor (device, gateway == Ipv4Address::GetZero () ? destination : gateway);
+      if (node == 0)
+        {
+          NS_LOG_LOGIC ("Next hop to " << destination << " not found");
+          return false;
+        }
+    }
+  NS_LOG_LOGIC ("Too many hops to " << destination);
+  return false;
+}
+
+uint32_t
+FluidPath::GetNHops (void) const
+{
+  return m_hops.size ();
+}
+
+uint32_t
+FluidPath::GetNServedHops (void) const
+{
+  uint32_t n = 0;
+  for (std::vector<Hop>::const_iterator i = m_hops.begin (); i != m_hops.end (); ++i)
+    {
+      if (i->queue != 0)
+        {
+          n++;
+        }
+    }
+  return n;
+}
+
+DataRate
+FluidPath::GetFirstHopRate (void) const
+{
+  for (std::vector<Hop>::const_iterator i = m_hops.begin (); i != m_hops.end (); ++i)
+    {
+      if (i->rate.GetBitRate () > 0)
+        {
+          return i->rate;
+        }
+    }
+  return DataRate (0);
+}
+
+void
+FluidPath::AddRate (DataRate rate)
+{
+  NS_LOG_FUNCTION (this << rate);
+  for (std::vector<Hop>::const_iterator i = m_hops.begin (); i != m_hops.end (); ++i)
+    {
+      if (i->queue != 0)
+        {
+          i->queue->AddFluidRate (rate);
+        }
+    }
+}
+
+void
+FluidPath::RemoveRate (DataRate rate)
+{
+  NS_LOG_FUNCTION (this << rate);
+  for (std::vector<Hop>::const_iterator i = m_hops.begin (); i != m_hops.end (); ++i)
+    {
+      if (i->queue != 0)
+        {
+          i->queue->RemoveFluidRate (rate);
+        }
+    }
+}
+
+Time
+FluidPath::GetBaseDelay (uint32_t size) const
+{
+  NS_LOG_FUNCTION (this << size);
+  Time delay = Seconds (0);
+  for (std::vector<Hop>::const_iterator i = m_hops.begin (); i != m_hops.end (); ++i)
+    {
+      delay += i->delay;
+      if (i->rate.GetBitRate () > 0)
+        {
+          delay += i->rate.CalculateBytesTxTime (size);
+        }
+    }
+  return delay;
+}
+
+Time
+FluidPath::GetQueueDelay (void) const
+{
+  NS_LOG_FUNCTION (this);
+  Time delay = Seconds (0);
+  for (std::vector<Hop>::const_iterator i = m_hops.begin (); i != m_hops.end (); ++i)
+    {
+      if (i->queue != 0)
+        {
+          delay += i->queue->GetFluidDelay ();
+        }
+    }
+  return delay;
+}
+
+double
+FluidPath::GetLossRatio (void) const
+{
+  NS_LOG_FUNCTION (this);
+  double delivered = 1;
+  for (std::vector<Hop>::const_iterator i = m_hops.begin (); i != m_hops.end (); ++i)
+    {
+      if (i->queue != 0)
+        {
+          delivered *= 1 - i->queue->GetFluidLossRatio ();
+        }
+    }
+  return 1 - delivered;
+}
+
+} // namespace ns3
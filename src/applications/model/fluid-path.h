@@ -0,0 +1,115 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef FLUID_PATH_H
+#define FLUID_PATH_H
+
+#include <vector>
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/data-rate.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/queue.h"
+
+namespace ns3 {
+
+class Node;
+
+/**
+ * \ingroup applications
+ *
+ * \brief The transmit queues crossed by a flow-level (fluid) source.
+ *
+ * The path follows the IPv4 routes of the nodes, from the source to the
+ * node which owns the destination address, and keeps the transmit queue
+ * of each output device, as given by its "TxQueue" attribute.  A fluid
+ * source adds its rate to these queues, and reads back the delay and the
+ * loss that the traffic of all the sources induces on its path.
+ *
+ * Only the devices which give the link rate of their transmit queue
+ * (Queue::SetFluidLinkRate), that is PointToPointNetDevice for now,
+ * serve the fluid.  The hops through other devices, such as CSMA or
+ * Wi-Fi, carry the fluid without delay nor loss, and Compute logs a
+ * warning for each of them.
+ */
+class FluidPath
+{
+public:
+  FluidPath ();
+
+  /**
+   * \brief Follow the routes from a node to a destination.
+   *
+   * The rate previously added to the queues of the path is not removed.
+   *
+   * \param source the source node
+   * \param destination the destination address
+   * \returns true if the destination was reached
+   */
+  bool Compute (Ptr<Node> source, Ipv4Address destination);
+  /**
+   * \returns the number of hops of the path
+   */
+  uint32_t GetNHops (void) const;
+  /**
+   * \returns the number of hops of the path which serve the fluid, that
+   * is, which delay and drop it
+   */
+  uint32_t GetNServedHops (void) const;
+  /**
+   * \returns the rate of the first output device of the path which gives
+   * its rate, which bounds the rate of a source, or zero if there is none
+   */
+  DataRate GetFirstHopRate (void) const;
+  /**
+   * \brief Add the rate of a source to the queues of the path.
+   * \param rate the rate of the source
+   */
+  void AddRate (DataRate rate);
+  /**
+   * \brief Remove the rate of a source from the queues of the path.
+   * \param rate the rate of the source, as given to AddRate
+   */
+  void RemoveRate (DataRate rate);
+  /**
+   * \param size the size of a packet
+   * \returns the propagation and transmission delays of the packet along
+   * the path, without queueing
+   */
+  Time GetBaseDelay (uint32_t size) const;
+  /**
+   * \returns the queueing delay along the path
+   */
+  Time GetQueueDelay (void) const;
+  /**
+   * \returns the fraction of the fluid which is lost along the path
+   */
+  double GetLossRatio (void) const;
+
+private:
+  /// A hop of the path.
+  struct Hop
+  {
+    Ptr<Queue> queue;   //!< The transmit queue, or zero.
+    DataRate rate;      //!< The rate of the output device.
+    Time delay;         //!< The delay of the channel.
+  };
+
+  std::vector<Hop> m_hops; //!< The hops, from the source.
+};
+
+} // namespace ns3
+
+#endif /* FLUID_PATH_H */
@@ -22,6 +22,7 @@
 // George F. Riley, Georgia Tech, Spring 2007
 // Adapted from ApplicationOnOff in GTNetS.
 
+#include <algorithm>
 #include "ns3/log.h"
 #include "ns3/address.h"
 #include "ns3/inet-socket-address.h"
@@ -36,6 +37,7 @@
 #include "ns3/socket-factory.h"
 #include "ns3/packet.h"
 #include "ns3/uinteger.h"
+#include "ns3/boolean.h"
 #include "ns3/trace-source-accessor.h"
 #include "onoff-application.h"
 #include "ns3/udp-socket-factory.h"
@@ -86,6 +88,12 @@ OnOffApplication::GetTypeId (void)
                    TypeIdValue (UdpSocketFactory::GetTypeId ()),
                    MakeTypeIdAccessor (&OnOffApplication::m_tid),
                    MakeTypeIdChecker ())
+    .AddAttribute ("Fluid",
+                   "If true, add the data rate to the queues of the path to "
+                   "the remote IPv4 address in on state, instead of sending packets.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&OnOffApplication::m_fluid),
+                   MakeBooleanChecker ())
     .AddTraceSource ("Tx", "A new packet is created and is sent",
                      MakeTraceSourceAccessor (&OnOffApplication::m_txTrace),
                      "ns3::Packet::TracedCallback")
@@ -99,7 +107,9 @@ OnOffApplication::OnOffApplication ()
     m_connected (false),
     m_residualBits (0),
     m_lastStartTime (Seconds (0)),
-    m_totBytes (0)
+    m_totBytes (0),
+    m_fluid (false),
+    m_fluidOn (false)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -148,7 +158,7 @@ void OnOffApplication::StartApplication () // Called at time specified by Start
   NS_LOG_FUNCTION (this);
 
   // Create the socket if not already
-  if (!m_socket)
+  if (!m_socket && !m_fluid)
     {
       m_socket = Socket::CreateSocket (GetNode (), m_tid);
       if (Inet6SocketAddress::IsMatchingType (m_peer))
@@ -183,11 +193,15 @@ void OnOffApplication::StopApplication () // Called at time specified by Stop
   NS_LOG_FUNCTION (this);
 
   CancelEvents ();
+  if (m_fluidOn)
+    {
+      StopFluid ();
+    }
   if(m_socket != 0)
     {
       m_socket->Close ();
     }
-  else
+  else if (!m_fluid)
     {
       NS_LOG_WARN ("OnOffApplication found null socket to close in StopApplication");
     }
@@ -214,6 +228,11 @@ void OnOffApplication::StartSending ()
 {
   NS_LOG_FUNCTION (this);
   m_lastStartTime = Simulator::Now ();
+  if (m_fluid)
+    {
+      StartFluid ();
+      return;
+    }
   ScheduleNextTx ();  // Schedule the send packet event
   ScheduleStopEvent ();
 }
@@ -222,10 +241,57 @@ void OnOffApplication::StopSending ()
 {
   NS_LOG_FUNCTION (this);
   CancelEvents ();
+  if (m_fluidOn)
+    {
+      StopFluid ();
+      if (m_maxBytes != 0 && m_totBytes >= m_maxBytes)
+        {
+          StopApplication ();
+          return;
+        }
+    }
 
   ScheduleStartEvent ();
 }
 
+void OnOffApplication::StartFluid ()
+{
+  NS_LOG_FUNCTION (this);
+  if (m_maxBytes != 0 && m_totBytes >= m_maxBytes)
+    {
+      StopApplication ();
+      return;
+    }
+  if (!InetSocketAddress::IsMatchingType (m_peer))
+    {
+      NS_FATAL_ERROR ("OnOffApplication fluid mode requires an IPv4 remote address");
+    }
+  Ipv4Address destination = InetSocketAddress::ConvertFrom (m_peer).GetIpv4 ();
+  if (!m_fluidPath.Compute (GetNode (), destination))
+    {
+      NS_LOG_WARN ("OnOffApplication found no complete path to " << destination);
+    }
+  m_fluidRate = m_cbrRate;
+  m_fluidPath.AddRate (m_fluidRate);
+  m_fluidOn = true;
+  ScheduleStopEvent ();
+}
+
+void OnOffApplication::StopFluid ()
+{
+  NS_LOG_FUNCTION (this);
+  m_fluidPath.RemoveRate (m_fluidRate);
+  m_fluidOn = false;
+  double bytes = (Simulator::Now () - m_lastStartTime).GetSeconds () * m_fluidRate.GetBitRate () / 8;
+  m_totBytes += static_cast<uint64_t> (bytes + 0.5);
+  if (m_maxBytes != 0)
+    {
+      m_totBytes = std::min (m_totBytes, m_maxBytes);
+    }
+  NS_LOG_INFO ("At time " << Simulator::Now ().GetSeconds ()
+               << "s on-off application stopped fluid, total Tx " << m_totBytes << " bytes");
+}
+
 // Private helpers
 void OnOffApplication::ScheduleNextTx ()
 {
@@ -261,6 +327,12 @@ void OnOffApplication::ScheduleStopEvent ()
   NS_LOG_FUNCTION (this);
 
   Time onInterval = Seconds (m_onTime->GetValue ());
+  if (m_fluidOn && m_maxBytes != 0 && m_fluidRate.GetBitRate () > 0)
+    {
+      // Stop at the last byte, which ends the application.
+      Time last = Seconds ((m_maxBytes - m_totBytes) * 8.0 / m_fluidRate.GetBitRate ()) + TimeStep (1);
+      onInterval = std::min (onInterval, last);
+    }
   NS_LOG_LOGIC ("stop at " << onInterval);
   m_startStopEvent = Simulator::Schedule (onInterval, &OnOffApplication::StopSending, this);
 }
@@ -31,6 +31,7 @@
 #include "ns3/ptr.h"
 #include "ns3/data-rate.h"
 #include "ns3/traced-callback.h"
+#include "fluid-path.h"
 
 namespace ns3 {
 
@@ -82,6 +83,16 @@ class Socket;
 *
 * If the underlying socket type supports broadcast, this application
 * will automatically enable the SetAllowBroadcast(true) socket option.
+*
+* With the "Fluid" attribute, the application sends no packets: during
+* the "On" state, it adds its data rate to the transmit queues on the
+* IPv4 path to the remote address, which is computed at the start of
+* each "On" state, so that the traffic consumes the capacity of the
+* links and delays the packets which share them (see FluidPath).  This
+* flow-level mode stands for background traffic at a small fraction of
+* the cost of its packets; the Tx trace source is not fired in it.  Only
+* point-to-point links model the fluid: the other hops let it through
+* without delay nor loss.
 */
 class OnOffApplication : public Application 
 {
@@ -147,6 +158,14 @@ private:
    * \brief Send a packet
    */
   void SendPacket ();
+  /**
+   * \brief Add the data rate to the queues of the path, in fluid mode
+   */
+  void StartFluid ();
+  /**
+   * \brief Remove the data rate from the queues of the path, in fluid mode
+   */
+  void StopFluid ();
 
   Ptr<Socket>     m_socket;       //!< Associated socket
   Address         m_peer;         //!< Peer address
@@ -163,6 +182,10 @@ private:
   EventId         m_startStopEvent;     //!< Event id for next start or stop event
   EventId         m_sendEvent;    //!< Event id of pending "send packet" event
   TypeId          m_tid;          //!< Type of the socket used
+  bool            m_fluid;        //!< True to send fluid instead of packets
+  bool            m_fluidOn;      //!< True if the fluid rate is on the path
+  DataRate        m_fluidRate;    //!< Rate added to the path
+  FluidPath       m_fluidPath;    //!< Queues crossed by the fluid
 
   /// Traced Callback: transmitted packets.
   TracedCallback<Ptr<const Packet> > m_txTrace;
@@ -20,6 +20,7 @@
 
 #include "callback.h"
 #include "log.h"
+#include <cstring>
 
 /**
  * \file
@@ -62,7 +63,16 @@ CallbackValue::SerializeToString (Ptr<const AttributeChecker> checker) const
 {
   NS_LOG_FUNCTION (this << checker);
   std::ostringstream oss;
-  oss << PeekPointer (m_value.GetImpl ());
+  // The impl of an inline Callback is a temporary, built on each call:
+  // its address would be meaningless.
+  if (m_value.IsInline ())
+    {
+      oss << "inline";
+    }
+  else
+    {
+      oss << PeekPointer (m_value.GetImpl ());
+    }
   return oss.str ();
 }
 bool
@@ -74,6 +84,19 @@ CallbackValue::DeserializeFromString (std::string value, Ptr<const AttributeChec
 
 ATTRIBUTE_CHECKER_IMPLEMENT (Callback);
 
+bool
+CallbackBase::DoIsEqual (const CallbackBase &other) const
+{
+  if (m_makeImpl != 0 && other.m_makeImpl != 0)
+    {
+      // both inline: same type and same stored pointers
+      return m_makeImpl == other.m_makeImpl
+             && std::memcmp (m_storage.m_bytes, other.m_storage.m_bytes,
+                             sizeof (m_storage.m_bytes)) == 0;
+    }
+  return GetImpl ()->IsEqual (other.GetImpl ());
+}
+
 } // namespace ns3
 
 #if (__GNUC__ >= 3)
@@ -81,6 +104,7 @@ ATTRIBUTE_CHECKER_IMPLEMENT (Callback);
 #include <cstdlib>
 #include <cxxabi.h>
 #include "log.h"
+#include <cstring>
 
 namespace ns3 {
 
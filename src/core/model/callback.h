@@ -25,10 +25,12 @@
 #include "fatal-error.h"
 #include "empty.h"
 #include "type-traits.h"
+#include "int-to-type.h"
 #include "attribute.h"
 #include "attribute-helper.h"
 #include "simple-ref-count.h"
 #include <typeinfo>
+#include <new>
 
 /**
  * \file
@@ -898,23 +900,466 @@ private:
   typename TypeTraits<TX3>::ReferencedType m_a3;  //!< third bound argument
 };
 
+/**
+ * \ingroup callbackimpl
+ * Inline storage for the Callbacks which need no CallbackImpl:
+ * a function pointer, or an object pointer and a member function
+ * pointer.  It is copied bitwise, without any reference counting.
+ */
+union CallbackStorage
+{
+  /** The stored pointers */
+  char m_bytes[sizeof (void *) + sizeof (void (CallbackImplBase::*)(void))];
+  void *m_pointer;                      //!< Enforce pointer alignment
+  void (*m_function)(void);             //!< Enforce function pointer alignment
+};
+
+/**
+ * \ingroup callbackimpl
+ * The type of the function which invokes an inline Callback
+ * with the arguments of the Callback.
+ */
+template <typename R, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7, typename T8, typename T9>
+struct CallbackInvokerType
+{
+  /** The invoker type */
+  typedef R (*Type)(const CallbackStorage &, T1, T2, T3, T4, T5, T6, T7, T8, T9);
+};
+
+/**
+ * \ingroup callbackimpl
+ * CallbackInvokerType classes with varying numbers of argument types
+ *
+ * @{
+ */
+/** CallbackInvokerType class with no arguments. */
+template <typename R>
+struct CallbackInvokerType<R,empty,empty,empty,empty,empty,empty,empty,empty,empty>
+{
+  typedef R (*Type)(const CallbackStorage &);  //!< The invoker type
+};
+/** CallbackInvokerType class with one argument. */
+template <typename R, typename T1>
+struct CallbackInvokerType<R,T1,empty,empty,empty,empty,empty,empty,empty,empty>
+{
+  typedef R (*Type)(const CallbackStorage &, T1);  //!< The invoker type
+};
+/** CallbackInvokerType class with two arguments. */
+template <typename R, typename T1, typename T2>
+struct CallbackInvokerType<R,T1,T2,empty,empty,empty,empty,empty,empty,empty>
+{
+  typedef R (*Type)(const CallbackStorage &, T1, T2);  //!< The invoker type
+};
+/** CallbackInvokerType class with three arguments. */
+template <typename R, typename T1, typename T2, typename T3>
+struct CallbackInvokerType<R,T1,T2,T3,empty,empty,empty,empty,empty,empty>
+{
+  typedef R (*Type)(const CallbackStorage &, T1, T2, T3);  //!< The invoker type
+};
+/** CallbackInvokerType class with four arguments. */
+template <typename R, typename T1, typename T2, typename T3, typename T4>
+struct CallbackInvokerType<R,T1,T2,T3,T4,empty,empty,empty,empty,empty>
+{
+  typedef R (*Type)(const CallbackStorage &, T1, T2, T3, T4);  //!< The invoker type
+};
+/** CallbackInvokerType class with five arguments. */
+template <typename R, typename T1, typename T2, typename T3, typename T4, typename T5>
+struct CallbackInvokerType<R,T1,T2,T3,T4,T5,empty,empty,empty,empty>
+{
+  typedef R (*Type)(const CallbackStorage &, T1, T2, T3, T4, T5);  //!< The invoker type
+};
+/** CallbackInvokerType class with six arguments. */
+template <typename R, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6>
+struct CallbackInvokerType<R,T1,T2,T3,T4,T5,T6,empty,empty,empty>
+{
+  typedef R (*Type)(const CallbackStorage &, T1, T2, T3, T4, T5, T6);  //!< The invoker type
+};
+/** CallbackInvokerType class with seven arguments. */
+template <typename R, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7>
+struct CallbackInvokerType<R,T1,T2,T3,T4,T5,T6,T7,empty,empty>
+{
+  typedef R (*Type)(const CallbackStorage &, T1, T2, T3, T4, T5, T6, T7);  //!< The invoker type
+};
+/** CallbackInvokerType class with eight arguments. */
+template <typename R, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7, typename T8>
+struct CallbackInvokerType<R,T1,T2,T3,T4,T5,T6,T7,T8,empty>
+{
+  typedef R (*Type)(const CallbackStorage &, T1, T2, T3, T4, T5, T6, T7, T8);  //!< The invoker type
+};
+/**@}*/
+
+/**
+ * \ingroup makecallbackmemptr
+ * Inline representation of a Callback to a member function of an
+ * object held by a raw pointer.  It needs neither a heap allocation
+ * nor a virtual call.
+ */
+template <typename OBJ, typename MEM_PTR, typename R, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7, typename T8, typename T9>
+class MemPtrCallbackInvoker
+{
+public:
+  /**
+   * Store an object pointer and a member function pointer.
+   *
+   * \param [out] storage the Callback storage
+   * \param objPtr the object pointer
+   * \param memPtr the object class member function
+   */
+  static void Store (CallbackStorage &storage, OBJ *objPtr, MEM_PTR memPtr) {
+    Stored *stored = new (storage.m_bytes) Stored;
+    stored->m_objPtr = objPtr;
+    stored->m_memPtr = memPtr;
+  }
+  /**
+   * \param storage the Callback storage
+   * \return a CallbackImpl equivalent to the stored Callback
+   */
+  static Ptr<CallbackImplBase> MakeImpl (const CallbackStorage &storage) {
+    const Stored *stored = Get (storage);
+    return Create<MemPtrCallbackImpl<OBJ *,MEM_PTR,R,T1,T2,T3,T4,T5,T6,T7,T8,T9> > (stored->m_objPtr, stored->m_memPtr);
+  }
+  /**
+   * Invoke the stored Callback with varying numbers of arguments
+   * @{
+   */
+  /**
+   * \param storage the Callback storage
+   * \return Callback value
+   */
+  static R Invoke (const CallbackStorage &storage) {
+    return (Get (storage)->m_objPtr->*Get (storage)->m_memPtr) ();
+  }
+  /**
+   * \param storage the Callback storage
+   * \param a1 first argument
+   * \return Callback value
+   */
+  static R Invoke (const CallbackStorage &storage, T1 a1) {
+    return (Get (storage)->m_objPtr->*Get (storage)->m_memPtr) (a1);
+  }
+  /**
+   * \param storage the Callback storage
+   * \param a1 first argument
+   * \param a2 second argument
+   * \return Callback value
+   */
+  static R Invoke (const CallbackStorage &storage, T1 a1, T2 a2) {
+    return (Get (storage)->m_objPtr->*Get (storage)->m_memPtr) (a1, a2);
+  }
+  /**
+   * \param storage the Callback storage
+   * \param a1 first argument
+   * \param a2 second argument
+   * \param a3 third argument
+   * \return Callback value
+   */
+  static R Invoke (const CallbackStorage &storage, T1 a1, T2 a2, T3 a3) {
+    return (Get (storage)->m_objPtr->*Get (storage)->m_memPtr) (a1, a2, a3);
+  }
+  /**
+   * \param storage the Callback storage
+   * \param a1 first argument
+   * \param a2 second argument
+   * \param a3 third argument
+   * \param a4 fourth argument
+   * \return Callback value
+   */
+  static R Invoke (const CallbackStorage &storage, T1 a1, T2 a2, T3 a3, T4 a4) {
+    return (Get (storage)->m_objPtr->*Get (storage)->m_memPtr) (a1, a2, a3, a4);
+  }
+  /**
+   * \param storage the Callback storage
+   * \param a1 first argument
+   * \param a2 second argument
+   * \param a3 third argument
+   * \param a4 fourth argument
+   * \param a5 fifth argument
+   * \return Callback value
+   */
+  static R Invoke (const CallbackStorage &storage, T1 a1, T2 a2, T3 a3, T4 a4, T5 a5) {
+    return (Get (storage)->m_objPtr->*Get (storage)->m_memPtr) (a1, a2, a3, a4, a5);
+  }
+  /**
+   * \param storage the Callback storage
+   * \param a1 first argument
+   * \param a2 second argument
+   * \param a3 third argument
+   * \param a4 fourth argument
+   * \param a5 fifth argument
+   * \param a6 sixth argument
+   * \return Callback value
+   */
+  static R Invoke (const CallbackStorage &storage, T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6) {
+    return (Get (storage)->m_objPtr->*Get (storage)->m_memPtr) (a1, a2, a3, a4, a5, a6);
+  }
+  /**
+   * \param storage the Callback storage
+   * \param a1 first argument
+   * \param a2 second argument
+   * \param a3 third argument
+   * \param a4 fourth argument
+   * \param a5 fifth argument
+   * \param a6 sixth argument
+   * \param a7 seventh argument
+   * \return Callback value
+   */
+  static R Invoke (const CallbackStorage &storage, T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6, T7 a7) {
+    return (Get (storage)->m_objPtr->*Get (storage)->m_memPtr) (a1, a2, a3, a4, a5, a6, a7);
+  }
+  /**
+   * \param storage the Callback storage
+   * \param a1 first argument
+   * \param a2 second argument
+   * \param a3 third argument
+   * \param a4 fourth argument
+   * \param a5 fifth argument
+   * \param a6 sixth argument
+   * \param a7 seventh argument
+   * \param a8 eighth argument
+   * \return Callback value
+   */
+  static R Invoke (const CallbackStorage &storage, T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6, T7 a7, T8 a8) {
+    return (Get (storage)->m_objPtr->*Get (storage)->m_memPtr) (a1, a2, a3, a4, a5, a6, a7, a8);
+  }
+  /**
+   * \param storage the Callback storage
+   * \param a1 first argument
+   * \param a2 second argument
+   * \param a3 third argument
+   * \param a4 fourth argument
+   * \param a5 fifth argument
+   * \param a6 sixth argument
+   * \param a7 seventh argument
+   * \param a8 eighth argument
+   * \param a9 ninth argument
+   * \return Callback value
+   */
+  static R Invoke (const CallbackStorage &storage, T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6, T7 a7, T8 a8, T9 a9) {
+    return (Get (storage)->m_objPtr->*Get (storage)->m_memPtr) (a1, a2, a3, a4, a5, a6, a7, a8, a9);
+  }
+  /**@}*/
+private:
+  /** The object and member function pointers */
+  struct Stored
+  {
+    OBJ *m_objPtr;                      //!< the object pointer
+    MEM_PTR m_memPtr;                   //!< the member function pointer
+  };
+  /**
+   * \param storage the Callback storage
+   * \return the stored pointers
+   */
+  static const Stored * Get (const CallbackStorage &storage) {
+    return reinterpret_cast<const Stored *> (storage.m_bytes);
+  }
+};
+
+/**
+ * \ingroup makecallbackfnptr
+ * Inline representation of a Callback to a function pointer.
+ */
+template <typename FUNCTION, typename R, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7, typename T8, typename T9>
+class FunctionCallbackInvoker
+{
+public:
+  /**
+   * Store a function pointer.
+   *
+   * \param [out] storage the Callback storage
+   * \param function the function pointer
+   */
+  static void Store (CallbackStorage &storage, FUNCTION function) {
+    new (storage.m_bytes) FUNCTION (function);
+  }
+  /**
+   * \param storage the Callback storage
+   * \return a CallbackImpl equivalent to the stored Callback
+   */
+  static Ptr<CallbackImplBase> MakeImpl (const CallbackStorage &storage) {
+    return Create<FunctorCallbackImpl<FUNCTION,R,T1,T2,T3,T4,T5,T6,T7,T8,T9> > (Get (storage));
+  }
+  /**
+   * Invoke the stored Callback with varying numbers of arguments
+   * @{
+   */
+  /**
+   * \param storage the Callback storage
+   * \return Callback value
+   */
+  static R Invoke (const CallbackStorage &storage) {
+    return (Get (storage)) ();
+  }
+  /**
+   * \param storage the Callback storage
+   * \param a1 first argument
+   * \return Callback value
+   */
+  static R Invoke (const CallbackStorage &storage, T1 a1) {
+    return (Get (storage)) (a1);
+  }
+  /**
+   * \param storage the Callback storage
+   * \param a1 first argument
+   * \param a2 second argument
+   * \return Callback value
+   */
+  static R Invoke (const CallbackStorage &storage, T1 a1, T2 a2) {
+    return (Get (storage)) (a1, a2);
+  }
+  /**
+   * \param storage the Callback storage
+   * \param a1 first argument
+   * \param a2 second argument
+   * \param a3 third argument
+   * \return Callback value
+   */
+  static R Invoke (const CallbackStorage &storage, T1 a1, T2 a2, T3 a3) {
+    return (Get (storage)) (a1, a2, a3);
+  }
+  /**
+   * \param storage the Callback storage
+   * \param a1 first argument
+   * \param a2 second argument
+   * \param a3 third argument
+   * \param a4 fourth argument
+   * \return Callback value
+   */
+  static R Invoke (const CallbackStorage &storage, T1 a1, T2 a2, T3 a3, T4 a4) {
+    return (Get (storage)) (a1, a2, a3, a4);
+  }
+  /**
+   * \param storage the Callback storage
+   * \param a1 first argument
+   * \param a2 second argument
+   * \param a3 third argument
+   * \param a4 fourth argument
+   * \param a5 fifth argument
+   * \return Callback value
+   */
+  static R Invoke (const CallbackStorage &storage, T1 a1, T2 a2, T3 a3, T4 a4, T5 a5) {
+    return (Get (storage)) (a1, a2, a3, a4, a5);
+  }
+  /**
+   * \param storage the Callback storage
+   * \param a1 first argument
+   * \param a2 second argument
+   * \param a3 third argument
+   * \param a4 fourth argument
+   * \param a5 fifth argument
+   * \param a6 sixth argument
+   * \return Callback value
+   */
+  static R Invoke (const CallbackStorage &storage, T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6) {
+    return (Get (storage)) (a1, a2, a3, a4, a5, a6);
+  }
+  /**
+   * \param storage the Callback storage
+   * \param a1 first argument
+   * \param a2 second argument
+   * \param a3 third argument
+   * \param a4 fourth argument
+   * \param a5 fifth argument
+   * \param a6 sixth argument
+   * \param a7 seventh argument
+   * \return Callback value
+   */
+  static R Invoke (const CallbackStorage &storage, T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6, T7 a7) {
+    return (Get (storage)) (a1, a2, a3, a4, a5, a6, a7);
+  }
+  /**
+   * \param storage the Callback storage
+   * \param a1 first argument
+   * \param a2 second argument
+   * \param a3 third argument
+   * \param a4 fourth argument
+   * \param a5 fifth argument
+   * \param a6 sixth argument
+   * \param a7 seventh argument
+   * \param a8 eighth argument
+   * \return Callback value
+   */
+  static R Invoke (const CallbackStorage &storage, T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6, T7 a7, T8 a8) {
+    return (Get (storage)) (a1, a2, a3, a4, a5, a6, a7, a8);
+  }
+  /**
+   * \param storage the Callback storage
+   * \param a1 first argument
+   * \param a2 second argument
+   * \param a3 third argument
+   * \param a4 fourth argument
+   * \param a5 fifth argument
+   * \param a6 sixth argument
+   * \param a7 seventh argument
+   * \param a8 eighth argument
+   * \param a9 ninth argument
+   * \return Callback value
+   */
+  static R Invoke (const CallbackStorage &storage, T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6, T7 a7, T8 a8, T9 a9) {
+    return (Get (storage)) (a1, a2, a3, a4, a5, a6, a7, a8, a9);
+  }
+  /**@}*/
+private:
+  /**
+   * \param storage the Callback storage
+   * \return the stored function pointer
+   */
+  static FUNCTION Get (const CallbackStorage &storage) {
+    return *reinterpret_cast<const FUNCTION *> (storage.m_bytes);
+  }
+};
+
 /**
  * \ingroup callbackimpl
  * Base class for Callback class.
  * Provides pimpl abstraction.
+ *
+ * Callbacks to a function pointer, or to a member function of an
+ * object held by a raw pointer, are stored inline in m_storage and
+ * invoked through m_invoke; all the other Callbacks use the pimpl.
  */
 class CallbackBase {
 public:
-  CallbackBase () : m_impl () {}
-  /** \return the impl pointer */
-  Ptr<CallbackImplBase> GetImpl (void) const { return m_impl; }
+  CallbackBase () : m_impl (), m_invoke (0), m_makeImpl (0), m_storage () {}
+  /**
+   * \return the impl pointer.  For a Callback stored inline, a new
+   * equivalent CallbackImpl is built on each call.
+   */
+  Ptr<CallbackImplBase> GetImpl (void) const {
+    if (m_makeImpl != 0)
+      {
+        return m_makeImpl (m_storage);
+      }
+    return m_impl;
+  }
+  /**
+   * \return true if the Callback is stored inline, without a pimpl.
+   */
+  bool IsInline (void) const {
+    return m_makeImpl != 0;
+  }
 protected:
   /**
    * Construct from a pimpl
    * \param impl the CallbackImplBase Ptr
    */
-  CallbackBase (Ptr<CallbackImplBase> impl) : m_impl (impl) {}
+  CallbackBase (Ptr<CallbackImplBase> impl) : m_impl (impl), m_invoke (0), m_makeImpl (0), m_storage () {}
+  /**
+   * Equality test.
+   *
+   * \param other Callback
+   * \return true if we are equal
+   */
+  bool DoIsEqual (const CallbackBase &other) const;
+
+  /** Type-erased pointer to a CallbackInvokerType function */
+  typedef void (*Invoker)(void);
+  /** Function which builds a CallbackImpl equivalent to an inline Callback */
+  typedef Ptr<CallbackImplBase> (*ImplMaker)(const CallbackStorage &);
+
   Ptr<CallbackImplBase> m_impl;         //!< the pimpl
+  Invoker m_invoke;                     //!< the invoker of an inline Callback, or zero
+  ImplMaker m_makeImpl;                 //!< the pimpl maker of an inline Callback, or zero
+  CallbackStorage m_storage;            //!< the inline Callback
 
   /**
    * \param mangled the mangled string
@@ -996,8 +1441,9 @@ public:
    */
   template <typename FUNCTOR>
   Callback (FUNCTOR const &functor, bool, bool) 
-    : CallbackBase (Create<FunctorCallbackImpl<FUNCTOR,R,T1,T2,T3,T4,T5,T6,T7,T8,T9> > (functor))
-  {}
+  {
+    DoInitFunctor (IntToType<TypeTraits<FUNCTOR>::IsFunctionPointer> (), functor);
+  }
 
   /**
    * Construct a member function pointer call back.
@@ -1007,8 +1453,9 @@ public:
    */
   template <typename OBJ_PTR, typename MEM_PTR>
   Callback (OBJ_PTR const &objPtr, MEM_PTR memPtr)
-    : CallbackBase (Create<MemPtrCallbackImpl<OBJ_PTR,MEM_PTR,R,T1,T2,T3,T4,T5,T6,T7,T8,T9> > (objPtr, memPtr))
-  {}
+  {
+    DoInitMemPtr (objPtr, memPtr);
+  }
 
   /**
    * Construct from a CallbackImpl pointer
@@ -1076,11 +1523,13 @@ public:
    * \return true if I don't have an implementation
    */
   bool IsNull (void) const {
-    return (DoPeekImpl () == 0) ? true : false;
+    return (DoPeekImpl () == 0 && m_invoke == 0) ? true : false;
   }
   /** Discard the implementation, set it to null */
   void Nullify (void) {
     m_impl = 0;
+    m_invoke = 0;
+    m_makeImpl = 0;
   }
 
   /**
@@ -1089,6 +1538,10 @@ public:
    */
   /** \return Callback value */
   R operator() (void) const {
+    if (m_invoke != 0)
+      {
+        return (reinterpret_cast<TypedInvoker> (m_invoke)) (m_storage);
+      }
     return (*(DoPeekImpl ()))();
   }
   /**
@@ -1096,6 +1549,10 @@ public:
    * \return Callback value
    */
   R operator() (T1 a1) const {
+    if (m_invoke != 0)
+      {
+        return (reinterpret_cast<TypedInvoker> (m_invoke)) (m_storage, a1);
+      }
     return (*(DoPeekImpl ()))(a1);
   }
   /**
@@ -1104,6 +1561,10 @@ public:
    * \return Callback value
    */
   R operator() (T1 a1, T2 a2) const {
+    if (m_invoke != 0)
+      {
+        return (reinterpret_cast<TypedInvoker> (m_invoke)) (m_storage, a1, a2);
+      }
     return (*(DoPeekImpl ()))(a1,a2);
   }
   /**
@@ -1113,6 +1574,10 @@ public:
    * \return Callback value
    */
   R operator() (T1 a1, T2 a2, T3 a3) const {
+    if (m_invoke != 0)
+      {
+        return (reinterpret_cast<TypedInvoker> (m_invoke)) (m_storage, a1, a2, a3);
+      }
     return (*(DoPeekImpl ()))(a1,a2,a3);
   }
   /**
@@ -1123,6 +1588,10 @@ public:
    * \return Callback value
    */
   R operator() (T1 a1, T2 a2, T3 a3, T4 a4) const {
+    if (m_invoke != 0)
+      {
+        return (reinterpret_cast<TypedInvoker> (m_invoke)) (m_storage, a1, a2, a3, a4);
+      }
     return (*(DoPeekImpl ()))(a1,a2,a3,a4);
   }
   /**
@@ -1134,6 +1603,10 @@ public:
    * \return Callback value
    */
   R operator() (T1 a1, T2 a2, T3 a3, T4 a4,T5 a5) const {
+    if (m_invoke != 0)
+      {
+        return (reinterpret_cast<TypedInvoker> (m_invoke)) (m_storage, a1, a2, a3, a4, a5);
+      }
     return (*(DoPeekImpl ()))(a1,a2,a3,a4,a5);
   }
   /**
@@ -1146,6 +1619,10 @@ public:
    * \return Callback value
    */
   R operator() (T1 a1, T2 a2, T3 a3, T4 a4,T5 a5,T6 a6) const {
+    if (m_invoke != 0)
+      {
+        return (reinterpret_cast<TypedInvoker> (m_invoke)) (m_storage, a1, a2, a3, a4, a5, a6);
+      }
     return (*(DoPeekImpl ()))(a1,a2,a3,a4,a5,a6);
   }
   /**
@@ -1159,6 +1636,10 @@ public:
    * \return Callback value
    */
   R operator() (T1 a1, T2 a2, T3 a3, T4 a4,T5 a5,T6 a6,T7 a7) const {
+    if (m_invoke != 0)
+      {
+        return (reinterpret_cast<TypedInvoker> (m_invoke)) (m_storage, a1, a2, a3, a4, a5, a6, a7);
+      }
     return (*(DoPeekImpl ()))(a1,a2,a3,a4,a5,a6,a7);
   }
   /**
@@ -1173,6 +1654,10 @@ public:
    * \return Callback value
    */
   R operator() (T1 a1, T2 a2, T3 a3, T4 a4,T5 a5,T6 a6,T7 a7,T8 a8) const {
+    if (m_invoke != 0)
+      {
+        return (reinterpret_cast<TypedInvoker> (m_invoke)) (m_storage, a1, a2, a3, a4, a5, a6, a7, a8);
+      }
     return (*(DoPeekImpl ()))(a1,a2,a3,a4,a5,a6,a7,a8);
   }
   /**
@@ -1188,6 +1673,10 @@ public:
    * \return Callback value
    */
   R operator() (T1 a1, T2 a2, T3 a3, T4 a4,T5 a5,T6 a6,T7 a7,T8 a8, T9 a9) const {
+    if (m_invoke != 0)
+      {
+        return (reinterpret_cast<TypedInvoker> (m_invoke)) (m_storage, a1, a2, a3, a4, a5, a6, a7, a8, a9);
+      }
     return (*(DoPeekImpl ()))(a1,a2,a3,a4,a5,a6,a7,a8,a9);
   }
   /**@}*/
@@ -1199,7 +1688,7 @@ public:
    * \return true if we are equal
    */
   bool IsEqual (const CallbackBase &other) const {
-    return m_impl->IsEqual (other.GetImpl ());
+    return DoIsEqual (other);
   }
 
   /**
@@ -1217,9 +1706,79 @@ public:
    * \param other Callback
    */
   void Assign (const CallbackBase &other) {
-    DoAssign (other.GetImpl ());
+    DoAssign (other);
   }
 private:
+  /** The type of the invoker of an inline Callback of this type */
+  typedef typename CallbackInvokerType<R,T1,T2,T3,T4,T5,T6,T7,T8,T9>::Type TypedInvoker;
+
+  /**
+   * Store a function pointer inline.
+   *
+   * \param function the function pointer
+   */
+  template <typename FUNCTOR>
+  void DoInitFunctor (IntToType<1>, FUNCTOR const &function) {
+    typedef FunctionCallbackInvoker<FUNCTOR,R,T1,T2,T3,T4,T5,T6,T7,T8,T9> Inline;
+    Inline::Store (m_storage, function);
+    m_invoke = reinterpret_cast<Invoker> (static_cast<TypedInvoker> (&Inline::Invoke));
+    m_makeImpl = &Inline::MakeImpl;
+  }
+  /**
+   * Wrap any other functor in a FunctorCallbackImpl.
+   *
+   * \param functor the functor
+   */
+  template <typename FUNCTOR>
+  void DoInitFunctor (IntToType<0>, FUNCTOR const &functor) {
+    m_impl = Create<FunctorCallbackImpl<FUNCTOR,R,T1,T2,T3,T4,T5,T6,T7,T8,T9> > (functor);
+  }
+  /**
+   * Store a raw object pointer and a member function pointer inline,
+   * if they fit in the storage.
+   *
+   * \param objPtr the object pointer
+   * \param memPtr the object class member function
+   */
+  template <typename OBJ, typename MEM_PTR>
+  void DoInitMemPtr (OBJ *objPtr, MEM_PTR memPtr) {
+    DoInitMemPtr (IntToType<(sizeof (OBJ *) + sizeof (MEM_PTR) <= sizeof (CallbackStorage))> (),
+                  objPtr, memPtr);
+  }
+  /**
+   * Store a raw object pointer and a member function pointer inline.
+   *
+   * \param objPtr the object pointer
+   * \param memPtr the object class member function
+   */
+  template <typename OBJ, typename MEM_PTR>
+  void DoInitMemPtr (IntToType<1>, OBJ *objPtr, MEM_PTR memPtr) {
+    typedef MemPtrCallbackInvoker<OBJ,MEM_PTR,R,T1,T2,T3,T4,T5,T6,T7,T8,T9> Inline;
+    Inline::Store (m_storage, objPtr, memPtr);
+    m_invoke = reinterpret_cast<Invoker> (static_cast<TypedInvoker> (&Inline::Invoke));
+    m_makeImpl = &Inline::MakeImpl;
+  }
+  /**
+   * Wrap an object pointer which does not fit in the inline storage
+   * in a MemPtrCallbackImpl.
+   *
+   * \param objPtr the object pointer
+   * \param memPtr the object class member function
+   */
+  template <typename OBJ, typename MEM_PTR>
+  void DoInitMemPtr (IntToType<0>, OBJ *objPtr, MEM_PTR memPtr) {
+    m_impl = Create<MemPtrCallbackImpl<OBJ *,MEM_PTR,R,T1,T2,T3,T4,T5,T6,T7,T8,T9> > (objPtr, memPtr);
+  }
+  /**
+   * Wrap a smart object pointer in a MemPtrCallbackImpl.
+   *
+   * \param objPtr the object pointer
+   * \param memPtr the object class member function
+   */
+  template <typename OBJ_PTR, typename MEM_PTR>
+  void DoInitMemPtr (OBJ_PTR const &objPtr, MEM_PTR memPtr) {
+    m_impl = Create<MemPtrCallbackImpl<OBJ_PTR,MEM_PTR,R,T1,T2,T3,T4,T5,T6,T7,T8,T9> > (objPtr, memPtr);
+  }
   /** \return the pimpl pointer */
   CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,T8,T9> *DoPeekImpl (void) const {
     return static_cast<CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,T8,T9> *> (PeekPointer (m_impl));
@@ -1247,17 +1806,18 @@ private:
   /**
    * Adopt the other's implementation, if type compatible
    *
-   * \param other Callback Ptr to adopt from
+   * \param other Callback to adopt from
    */
-  void DoAssign (Ptr<const CallbackImplBase> other) {
-    if (!DoCheckType (other))
+  void DoAssign (const CallbackBase &other) {
+    Ptr<const CallbackImplBase> impl = other.GetImpl ();
+    if (!DoCheckType (impl))
       {
         Ptr<CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,T8,T9> > expected;
         NS_FATAL_ERROR ("Incompatible types. (feed to \"c++filt -t\" if needed)" << std::endl <<
-                        "got=" << Demangle ( typeid (*other).name () ) << std::endl <<
+                        "got=" << Demangle ( typeid (*impl).name () ) << std::endl <<
                         "expected=" << Demangle ( typeid (*expected).name () ));
       }
-    m_impl = const_cast<CallbackImplBase *> (PeekPointer (other));
+    CallbackBase::operator = (other);
   }
 };
 
@@ -153,6 +153,7 @@ class ArrayMatcher
 public:
   ArrayMatcher (std::string element);
   bool Matches (uint32_t i) const;
+  bool GetIndex (uint32_t *index) const;
 private:
   bool StringToUint32 (std::string str, uint32_t *value) const;
   std::string m_element;
@@ -228,6 +229,20 @@ ArrayMatcher::Matches (uint32_t i) const
   return false;
 }
 
+bool
+ArrayMatcher::GetIndex (uint32_t *index) const
+{
+  NS_LOG_FUNCTION (this << index);
+  // Only a plain decimal number matches a single index: "*", "a|b" and
+  // "[a-b]" may match several ones.
+  if (m_element.empty () ||
+      m_element.find_first_not_of ("0123456789") != std::string::npos)
+    {
+      return false;
+    }
+  return StringToUint32 (m_element, index);
+}
+
 bool
 ArrayMatcher::StringToUint32 (std::string str, uint32_t *value) const
 {
@@ -250,6 +265,8 @@ private:
   void Canonicalize (void);
   void DoResolve (std::string path, Ptr<Object> root);
   void DoArrayResolve (std::string path, const ObjectPtrContainerValue &vector);
+  bool DoIndexResolve (std::string path, Ptr<Object> root,
+                       const ObjectPtrContainerAccessor *accessor);
   void DoResolveOne (Ptr<Object> object);
   std::string GetResolvedPath (void) const;
   virtual void DoOne (Ptr<Object> object, std::string path) = 0;
@@ -452,10 +469,15 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
                 {
                   NS_LOG_DEBUG ("GetAttribute(vector)="<<info.name<<" on path="<<GetResolvedPath () << pathLeft);
                   foundMatch = true;
-                  ObjectPtrContainerValue vector;
-                  root->GetAttribute (info.name, vector);
                   m_workStack.push_back (info.name);
-                  DoArrayResolve (pathLeft, vector);
+                  const ObjectPtrContainerAccessor *accessor =
+                    dynamic_cast<const ObjectPtrContainerAccessor *> (PeekPointer (info.accessor));
+                  if (accessor == 0 || !DoIndexResolve (pathLeft, root, accessor))
+                    {
+                      ObjectPtrContainerValue vector;
+                      root->GetAttribute (info.name, vector);
+                      DoArrayResolve (pathLeft, vector);
+                    }
                   m_workStack.pop_back ();
                 }
               // this could be anything else and we don't know what to do with it.
@@ -502,6 +524,42 @@ Resolver::DoArrayResolve (std::string path, const ObjectPtrContainerValue &conta
     }
 }
 
+bool
+Resolver::DoIndexResolve (std::string path, Ptr<Object> root,
+                          const ObjectPtrContainerAccessor *accessor)
+{
+  NS_LOG_FUNCTION (this << path << root << accessor);
+  NS_ASSERT (path != "");
+  NS_ASSERT ((path.find ("/")) == 0);
+  std::string::size_type next = path.find ("/", 1);
+  if (next == std::string::npos)
+    {
+      return true;
+    }
+  std::string item = path.substr (1, next-1);
+  std::string pathLeft = path.substr (next, path.size ()-next);
+
+  //
+  // A path such as "/NodeList/12/..." names a single element of the
+  // container: get it directly rather than the whole container, which
+  // is a copy of every element for containers such as the NodeList.
+  //
+  uint32_t index;
+  if (!ArrayMatcher (item).GetIndex (&index))
+    {
+      return false;
+    }
+  Ptr<Object> object = accessor->GetByIndex (PeekPointer (root), index);
+  if (object != 0)
+    {
+      std::ostringstream oss;
+      oss << index;
+      m_workStack.push_back (oss.str ());
+      DoResolve (pathLeft, object);
+      m_workStack.pop_back ();
+    }
+  return true;
+}
 
 class ConfigImpl 
 {
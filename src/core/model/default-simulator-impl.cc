@@ -22,6 +22,7 @@
 #include "default-simulator-impl.h"
 #include "scheduler.h"
 #include "event-impl.h"
+#include "event-batch.h"
 
 #include "ptr.h"
 #include "pointer.h"
@@ -29,6 +30,7 @@
 #include "log.h"
 
 #include <cmath>
+#include <algorithm>
 
 
 /**
@@ -71,7 +73,7 @@ DefaultSimulatorImpl::DefaultSimulatorImpl ()
   m_currentTs = 0;
   m_currentContext = 0xffffffff;
   m_unscheduledEvents = 0;
-  m_eventsWithContextEmpty = true;
+  m_eventsWithContext = 0;
   m_main = SystemThread::Self();
 }
 
@@ -90,6 +92,14 @@ DefaultSimulatorImpl::DoDispose (void)
       next.impl->Unref ();
     }
   m_events = 0;
+  EventWithContext *pending = __sync_lock_test_and_set (&m_eventsWithContext, (EventWithContext *)0);
+  while (pending != 0)
+    {
+      EventWithContext *next = pending->next;
+      pending->event->Unref ();
+      delete pending;
+      pending = next;
+    }
   SimulatorImpl::DoDispose ();
 }
 void
@@ -159,31 +169,47 @@ DefaultSimulatorImpl::IsFinished (void) const
 void
 DefaultSimulatorImpl::ProcessEventsWithContext (void)
 {
-  if (m_eventsWithContextEmpty)
+  if (m_eventsWithContext == 0)
     {
       return;
     }
 
-  // swap queues
-  EventsWithContext eventsWithContext;
-  {
-    CriticalSection cs (m_eventsWithContextMutex);
-    m_eventsWithContext.swap(eventsWithContext);
-    m_eventsWithContextEmpty = true;
-  }
-  while (!eventsWithContext.empty ())
+  // take the whole stack and reverse it to recover the push order
+  EventWithContext *stack = __sync_lock_test_and_set (&m_eventsWithContext, (EventWithContext *)0);
+  EventWithContext *queue = 0;
+  while (stack != 0)
+    {
+      EventWithContext *next = stack->next;
+      stack->next = queue;
+      queue = stack;
+      stack = next;
+    }
+  while (queue != 0)
     {
-       EventWithContext event = eventsWithContext.front ();
-       eventsWithContext.pop_front ();
+       EventWithContext *event = queue;
+       queue = queue->next;
        Scheduler::Event ev;
-       ev.impl = event.event;
-       ev.key.m_ts = m_currentTs + event.timestamp;
-       ev.key.m_context = event.context;
+       ev.impl = event->event;
+       ev.key.m_ts = m_currentTs + event->timestamp;
+       ev.key.m_context = event->context;
        ev.key.m_uid = m_uid;
        m_uid++;
        m_unscheduledEvents++;
        m_events->Insert (ev);
+       delete event;
+    }
+}
+
+void
+DefaultSimulatorImpl::PushEventsWithContext (EventWithContext *first, EventWithContext *last)
+{
+  EventWithContext *head;
+  do
+    {
+      head = m_eventsWithContext;
+      last->next = head;
     }
+  while (!__sync_bool_compare_and_swap (&m_eventsWithContext, head, first));
 }
 
 void
@@ -262,15 +288,66 @@ DefaultSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &time, E
     }
   else
     {
-      EventWithContext ev;
-      ev.context = context;
-      ev.timestamp = time.GetTimeStep ();
-      ev.event = event;
-      {
-        CriticalSection cs (m_eventsWithContextMutex);
-        m_eventsWithContext.push_back(ev);
-        m_eventsWithContextEmpty = false;
-      }
+      EventWithContext *ev = new EventWithContext;
+      ev->context = context;
+      ev->timestamp = time.GetTimeStep ();
+      ev->event = event;
+      PushEventsWithContext (ev, ev);
+    }
+}
+
+void
+DefaultSimulatorImpl::ScheduleBatch (const EventBatch &batch)
+{
+  NS_LOG_FUNCTION (this << batch.GetN ());
+
+  if (SystemThread::Equals (m_main))
+    {
+      // uids are allocated in batch order, so the events run in the
+      // same order as if they were scheduled one by one.
+      bool sorted = true;
+      m_batch.resize (batch.GetN ());
+      for (uint32_t i = 0; i < batch.GetN (); ++i)
+        {
+          const EventBatch::Entry &entry = batch.Get (i);
+          Scheduler::Event &ev = m_batch[i];
+          ev.impl = entry.event;
+          ev.key.m_ts = m_currentTs + entry.delay.GetTimeStep ();
+          ev.key.m_context = entry.context;
+          ev.key.m_uid = m_uid;
+          m_uid++;
+          sorted = sorted && (i == 0 || m_batch[i - 1].key.m_ts <= ev.key.m_ts);
+        }
+      if (!sorted)
+        {
+          std::sort (m_batch.begin (), m_batch.end ());
+        }
+      m_unscheduledEvents += m_batch.size ();
+      m_events->InsertBatch (m_batch);
+    }
+  else
+    {
+      // chain the events most recent first and push them together
+      EventWithContext *first = 0;
+      EventWithContext *last = 0;
+      for (uint32_t i = 0; i < batch.GetN (); ++i)
+        {
+          const EventBatch::Entry &entry = batch.Get (i);
+          EventWithContext *ev = new EventWithContext;
+          ev->context = entry.context;
+          ev->timestamp = entry.delay.GetTimeStep ();
+          ev->event = entry.event;
+          ev->next = first;
+          first = ev;
+          if (last == 0)
+            {
+              last = ev;
+            }
+        }
+      if (first != 0)
+        {
+          PushEventsWithContext (first, last);
+        }
     }
 }
 
@@ -25,11 +25,11 @@
 #include "scheduler.h"
 #include "event-impl.h"
 #include "system-thread.h"
-#include "ns3/system-mutex.h"
 
 #include "ptr.h"
 
 #include <list>
+#include <vector>
 
 /**
  * \file
@@ -58,6 +58,7 @@ public:
   virtual void Stop (Time const &time);
   virtual EventId Schedule (Time const &time, EventImpl *event);
   virtual void ScheduleWithContext (uint32_t context, Time const &time, EventImpl *event);
+  virtual void ScheduleBatch (const EventBatch &batch);
   virtual EventId ScheduleNow (EventImpl *event);
   virtual EventId ScheduleDestroy (EventImpl *event);
   virtual void Remove (const EventId &id);
@@ -76,15 +77,30 @@ private:
   void ProcessOneEvent (void);
   void ProcessEventsWithContext (void);
  
+  /** An event scheduled from a thread other than the main thread. */
   struct EventWithContext {
-    uint32_t context;
-    uint64_t timestamp;
-    EventImpl *event;
+    uint32_t context;          //!< The event context.
+    uint64_t timestamp;        //!< The event delay, relative to the current time.
+    EventImpl *event;          //!< The event.
+    EventWithContext *next;    //!< The event pushed before this one.
   };
-  typedef std::list<struct EventWithContext> EventsWithContext;
-  EventsWithContext m_eventsWithContext;
-  bool m_eventsWithContextEmpty;
-  SystemMutex m_eventsWithContextMutex;
+  /**
+   * Push a chain of events on the lock-free stack of events
+   * scheduled from other threads.
+   *
+   * \param first the most recent event of the chain.
+   * \param last the oldest event of the chain.
+   */
+  void PushEventsWithContext (EventWithContext *first, EventWithContext *last);
+  /**
+   * The events scheduled from other threads and not yet inserted
+   * in m_events, most recent first.  Other threads push with a
+   * compare-and-swap, the main thread takes the whole stack at once
+   * with an atomic exchange, so neither side ever blocks.
+   */
+  EventWithContext * volatile m_eventsWithContext;
+  /** Scratch storage for ScheduleBatch, kept to avoid reallocation. */
+  std::vector<Scheduler::Event> m_batch;
 
   typedef std::list<EventId> DestroyEvents;
   DestroyEvents m_destroyEvents;
@@ -0,0 +1,103 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EVENT_BATCH_H
+#define EVENT_BATCH_H
+
+#include <stdint.h>
+#include <vector>
+#include "nstime.h"
+
+/**
+ * \file
+ * \ingroup events
+ * ns3::EventBatch declaration.
+ */
+
+namespace ns3 {
+
+class EventImpl;
+
+/**
+ * \ingroup events
+ * \brief A group of events to schedule with a single call.
+ *
+ * Each event has its own context and delay, as if it was scheduled
+ * with Simulator::ScheduleWithContext. Broadcast channels typically
+ * build one batch per transmission, holding one reception event per
+ * receiver, and hand it to Simulator::ScheduleBatch so that the
+ * scheduler can insert the whole group at once.
+ *
+ * The events are owned by the batch until it is scheduled:
+ * the destructor and Clear release the events still held.
+ */
+class EventBatch
+{
+public:
+  /** An event with its context and delay. */
+  struct Entry
+  {
+    uint32_t context;   //!< The event context.
+    Time delay;         //!< The delay until the event expires.
+    EventImpl *event;   //!< The event.
+  };
+
+  EventBatch ();
+  ~EventBatch ();
+
+  /**
+   * Add an event to the batch.
+   *
+   * \param context the event context.
+   * \param delay the delay until the event expires.
+   * \param event the event, typically created with MakeEvent. The batch
+   *        takes ownership of it.
+   */
+  void Add (uint32_t context, Time const &delay, EventImpl *event);
+  /** \returns the number of events in the batch. */
+  uint32_t GetN (void) const;
+  /**
+   * \param i the index of an event.
+   * \returns the i-th event added to the batch.
+   */
+  const Entry & Get (uint32_t i) const;
+  /** \returns true if the batch holds no event. */
+  bool IsEmpty (void) const;
+  /** Release all the events of the batch. */
+  void Clear (void);
+  /**
+   * Forget all the events of the batch without releasing them,
+   * once their ownership has been handed over to the simulator.
+   * The storage of the batch is kept for reuse.
+   */
+  void Release (void);
+
+private:
+  /** Copying would duplicate the ownership of the events. */
+  EventBatch (const EventBatch &o);
+  /**
+   * Copying would duplicate the ownership of the events.
+   * \param o the batch to copy.
+   * \returns this batch.
+   */
+  EventBatch & operator = (const EventBatch &o);
+
+  std::vector<Entry> m_entries;   //!< The events.
+};
+
+} // namespace ns3
+
+#endif /* EVENT_BATCH_H */
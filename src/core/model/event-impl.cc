@@ -20,6 +20,11 @@
 
 #include "event-impl.h"
 #include "log.h"
+#include "ns3/core-config.h"
+#include <new>
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
 
 /**
  * \file
@@ -31,6 +36,162 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("EventImpl");
 
+/**
+ * \ingroup events
+ * Free lists of released event storage, one per size class.
+ *
+ * Each thread owns its own pool so that no locking is needed: events
+ * scheduled from a foreign thread (with the realtime simulator) are
+ * simply released into the pool of the thread which destroys them.
+ */
+struct EventImplPool
+{
+  /** Size classes are multiples of this many bytes. */
+  static const std::size_t GRANULARITY = 16;
+  /** Number of size classes. Larger events use the global allocator. */
+  static const uint32_t N_CLASSES = 16;
+  /** Maximum number of blocks kept in each free list. */
+  static const uint32_t MAX_FREE = 4096;
+
+  /** A released block, linked through its own storage. */
+  struct Block
+  {
+    Block *next;  //!< Next free block of the same size class.
+  };
+
+  Block *head[N_CLASSES];      //!< Free list of each size class.
+  uint32_t count[N_CLASSES];   //!< Length of each free list.
+};
+
+#if !defined (HAVE_PTHREAD_H)
+
+/** The pool of the only thread there is. */
+static EventImplPool g_eventImplPool;
+
+/**
+ * \ingroup events
+ * \returns the event storage pool of the calling thread.
+ */
+static EventImplPool *
+GetEventImplPool (void)
+{
+  return &g_eventImplPool;
+}
+
+#elif defined (HAVE_TLS)
+
+/** The pool of the calling thread, created on first use. */
+static __thread EventImplPool *g_eventImplPool = 0;
+/** Key used to release the pool of a thread when it exits. */
+static pthread_key_t g_eventImplPoolKey;
+/** Make sure g_eventImplPoolKey is created once. */
+static pthread_once_t g_eventImplPoolOnce = PTHREAD_ONCE_INIT;
+
+/**
+ * \ingroup events
+ * Release all the storage held by the pool of an exiting thread.
+ * \param pool the pool.
+ */
+static void
+DestroyEventImplPool (void *pool)
+{
+  EventImplPool *p = static_cast<EventImplPool *> (pool);
+  for (uint32_t i = 0; i < EventImplPool::N_CLASSES; i++)
+    {
+      while (p->head[i] != 0)
+        {
+          EventImplPool::Block *block = p->head[i];
+          p->head[i] = block->next;
+          ::operator delete (block);
+        }
+    }
+  delete p;
+  g_eventImplPool = 0;
+}
+
+/** \ingroup events Create g_eventImplPoolKey. */
+static void
+CreateEventImplPoolKey (void)
+{
+  pthread_key_create (&g_eventImplPoolKey, &DestroyEventImplPool);
+}
+
+/**
+ * \ingroup events
+ * \returns the event storage pool of the calling thread.
+ */
+static EventImplPool *
+GetEventImplPool (void)
+{
+  if (g_eventImplPool == 0)
+    {
+      pthread_once (&g_eventImplPoolOnce, &CreateEventImplPoolKey);
+      g_eventImplPool = new EventImplPool ();
+      pthread_setspecific (g_eventImplPoolKey, g_eventImplPool);
+    }
+  return g_eventImplPool;
+}
+
+#else
+
+/**
+ * \ingroup events
+ * Threads are available but thread-local storage is not: do not
+ * recycle event storage at all.
+ * \returns 0
+ */
+static EventImplPool *
+GetEventImplPool (void)
+{
+  return 0;
+}
+
+#endif
+
+void *
+EventImpl::operator new (std::size_t size)
+{
+  uint32_t sizeClass = (size - 1) / EventImplPool::GRANULARITY;
+  if (sizeClass >= EventImplPool::N_CLASSES)
+    {
+      return ::operator new (size);
+    }
+  EventImplPool *pool = GetEventImplPool ();
+  if (pool != 0 && pool->head[sizeClass] != 0)
+    {
+      EventImplPool::Block *block = pool->head[sizeClass];
+      pool->head[sizeClass] = block->next;
+      pool->count[sizeClass]--;
+      return block;
+    }
+  // always allocate the full size class so that the block
+  // can later be reused by any event of the same class.
+  return ::operator new ((sizeClass + 1) * EventImplPool::GRANULARITY);
+}
+
+void
+EventImpl::operator delete (void *ptr, std::size_t size)
+{
+  if (ptr == 0)
+    {
+      return;
+    }
+  uint32_t sizeClass = (size - 1) / EventImplPool::GRANULARITY;
+  if (sizeClass < EventImplPool::N_CLASSES)
+    {
+      EventImplPool *pool = GetEventImplPool ();
+      if (pool != 0 && pool->count[sizeClass] < EventImplPool::MAX_FREE)
+        {
+          EventImplPool::Block *block = static_cast<EventImplPool::Block *> (ptr);
+          block->next = pool->head[sizeClass];
+          pool->head[sizeClass] = block;
+          pool->count[sizeClass]++;
+          return;
+        }
+    }
+  ::operator delete (ptr);
+}
+
 EventImpl::~EventImpl ()
 {
   NS_LOG_FUNCTION (this);
@@ -21,6 +21,7 @@
 #define EVENT_IMPL_H
 
 #include <stdint.h>
+#include <cstddef>
 #include "simple-ref-count.h"
 
 /**
@@ -66,6 +67,26 @@ public:
    */
   bool IsCancelled (void);
 
+  /**
+   * Allocate storage for an event.
+   *
+   * Events are allocated and released at a very high rate, so their
+   * storage is recycled through per-thread, size-classed free lists
+   * rather than going through the global allocator every time.
+   *
+   * \param size the size of the concrete event class.
+   * \returns storage for the event.
+   */
+  static void * operator new (std::size_t size);
+  /**
+   * Release the storage of an event into the free list of the
+   * calling thread.
+   *
+   * \param ptr the storage returned by operator new.
+   * \param size the size of the concrete event class.
+   */
+  static void operator delete (void *ptr, std::size_t size);
+
 protected:
   /**
    * Implementation for Invoke().
@@ -0,0 +1,338 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ladder-scheduler.h"
+#include "event-impl.h"
+#include "assert.h"
+#include "log.h"
+#include <algorithm>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Implementation of ns3::LadderScheduler class.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LadderScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (LadderScheduler);
+
+/**
+ * Ordering used to keep Bottom sorted by decreasing key, so that
+ * the next event can be popped from the back of the vector.
+ *
+ * \param a the first event.
+ * \param b the second event.
+ * \returns true if \p a must be dequeued after \p b.
+ */
+static bool
+IsLater (const Scheduler::Event &a, const Scheduler::Event &b)
+{
+  return b.key < a.key;
+}
+
+TypeId
+LadderScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LadderScheduler")
+    .SetParent<Scheduler> ()
+    .SetGroupName ("Core")
+    .AddConstructor<LadderScheduler> ()
+  ;
+  return tid;
+}
+
+LadderScheduler::LadderScheduler ()
+  : m_topMin (~(uint64_t)0),
+    m_topMax (0),
+    m_topStart (0),
+    m_rungs (MAX_RUNGS),
+    m_nRungs (0),
+    m_qSize (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+LadderScheduler::~LadderScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint64_t
+LadderScheduler::CurrentStart (const Rung &rung) const
+{
+  return rung.start + rung.current * rung.width;
+}
+
+void
+LadderScheduler::Insert (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.key.m_ts << ev.key.m_uid);
+  uint64_t ts = ev.key.m_ts;
+  m_qSize++;
+  if (ts >= m_topStart)
+    {
+      m_top.push_back (ev);
+      m_topMin = std::min (m_topMin, ts);
+      m_topMax = std::max (m_topMax, ts);
+      return;
+    }
+  for (uint32_t i = 0; i < m_nRungs; i++)
+    {
+      Rung &rung = m_rungs[i];
+      if (ts >= CurrentStart (rung))
+        {
+          uint32_t bucket = (ts - rung.start) / rung.width;
+          NS_ASSERT (bucket < rung.nBuckets);
+          NS_LOG_LOGIC ("insert in rung=" << i << ", bucket=" << bucket);
+          rung.buckets[bucket].push_back (ev);
+          rung.count++;
+          return;
+        }
+    }
+  InsertBottom (ev);
+  if (m_bottom.size () > THRESHOLD)
+    {
+      SpawnFromBottom ();
+    }
+}
+
+bool
+LadderScheduler::IsEmpty (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_qSize == 0;
+}
+
+Scheduler::Event
+LadderScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  if (m_bottom.empty ())
+    {
+      // Moving events down the ladder does not change the content
+      // of the event set, only where it is stored.
+      const_cast<LadderScheduler *> (this)->RefillBottom ();
+    }
+  return m_bottom.back ();
+}
+
+Scheduler::Event
+LadderScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  if (m_bottom.empty ())
+    {
+      RefillBottom ();
+    }
+  Scheduler::Event ev = m_bottom.back ();
+  m_bottom.pop_back ();
+  m_qSize--;
+  NS_LOG_LOGIC ("remove ts=" << ev.key.m_ts << ", key=" << ev.key.m_uid);
+  return ev;
+}
+
+void
+LadderScheduler::Remove (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << &ev);
+  NS_ASSERT (!IsEmpty ());
+  uint64_t ts = ev.key.m_ts;
+  Bucket *bucket = &m_bottom;
+  Rung *rung = 0;
+  if (ts >= m_topStart)
+    {
+      bucket = &m_top;
+    }
+  else
+    {
+      for (uint32_t i = 0; i < m_nRungs; i++)
+        {
+          if (ts >= CurrentStart (m_rungs[i]))
+            {
+              rung = &m_rungs[i];
+              bucket = &rung->buckets[(ts - rung->start) / rung->width];
+              break;
+            }
+        }
+    }
+
+  if (bucket == &m_bottom)
+    {
+      Bucket::iterator i = std::lower_bound (m_bottom.begin (), m_bottom.end (),
+                                             ev, &IsLater);
+      NS_ASSERT (i != m_bottom.end () && i->key.m_uid == ev.key.m_uid);
+      NS_ASSERT (ev.impl == i->impl);
+      m_bottom.erase (i);
+      m_qSize--;
+      return;
+    }
+
+  for (Bucket::iterator i = bucket->begin (); i != bucket->end (); ++i)
+    {
+      if (i->key.m_uid == ev.key.m_uid)
+        {
+          NS_ASSERT (ev.impl == i->impl);
+          // buckets are unsorted: fill the hole with the last event.
+          *i = bucket->back ();
+          bucket->pop_back ();
+          if (rung != 0)
+            {
+              rung->count--;
+            }
+          m_qSize--;
+          return;
+        }
+    }
+  NS_ASSERT (false);
+}
+
+void
+LadderScheduler::InsertBottom (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.key.m_ts << ev.key.m_uid);
+  Bucket::iterator i = std::lower_bound (m_bottom.begin (), m_bottom.end (),
+                                         ev, &IsLater);
+  m_bottom.insert (i, ev);
+}
+
+LadderScheduler::Rung &
+LadderScheduler::PushRung (uint64_t min, uint64_t max, uint32_t n)
+{
+  NS_LOG_FUNCTION (this << min << max << n);
+  NS_ASSERT (m_nRungs < MAX_RUNGS);
+  NS_ASSERT (min <= max && n > 0);
+  Rung &rung = m_rungs[m_nRungs];
+  m_nRungs++;
+  rung.width = (max - min) / n + 1;
+  rung.nBuckets = (max - min) / rung.width + 1;
+  rung.start = min;
+  rung.current = 0;
+  rung.count = 0;
+  if (rung.buckets.size () < rung.nBuckets)
+    {
+      rung.buckets.resize (rung.nBuckets);
+    }
+  NS_LOG_LOGIC ("new rung=" << m_nRungs - 1 << ", nBuckets=" << rung.nBuckets <<
+                ", width=" << rung.width);
+  return rung;
+}
+
+void
+LadderScheduler::FillRung (Bucket &bucket)
+{
+  NS_LOG_FUNCTION (this << bucket.size ());
+  Rung &rung = m_rungs[m_nRungs - 1];
+  for (Bucket::const_iterator i = bucket.begin (); i != bucket.end (); ++i)
+    {
+      uint32_t index = (i->key.m_ts - rung.start) / rung.width;
+      NS_ASSERT (index < rung.nBuckets);
+      rung.buckets[index].push_back (*i);
+    }
+  rung.count += bucket.size ();
+  bucket.clear ();
+}
+
+void
+LadderScheduler::TransferTop (void)
+{
+  NS_LOG_FUNCTION (this << m_top.size ());
+  NS_ASSERT (m_nRungs == 0 && m_bottom.empty () && !m_top.empty ());
+  if (m_top.size () <= THRESHOLD || m_topMin == m_topMax)
+    {
+      std::sort (m_top.begin (), m_top.end (), &IsLater);
+      m_bottom.swap (m_top);
+      m_topStart = m_topMax + 1;
+    }
+  else
+    {
+      Rung &rung = PushRung (m_topMin, m_topMax, m_top.size ());
+      FillRung (m_top);
+      m_topStart = rung.start + rung.nBuckets * rung.width;
+    }
+  m_topMin = ~(uint64_t)0;
+  m_topMax = 0;
+}
+
+void
+LadderScheduler::SpawnFromBottom (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint64_t min = m_bottom.back ().key.m_ts;
+  if (m_nRungs == MAX_RUNGS || m_bottom.front ().key.m_ts == min)
+    {
+      return;
+    }
+  // The new rung must be able to hold any event which is later inserted
+  // below the current bucket of the deepest rung (or below Top).
+  uint64_t max = m_nRungs > 0 ? CurrentStart (m_rungs[m_nRungs - 1]) : m_topStart;
+  PushRung (min, max - 1, m_bottom.size ());
+  FillRung (m_bottom);
+}
+
+void
+LadderScheduler::RefillBottom (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_bottom.empty () && !IsEmpty ());
+  while (m_bottom.empty ())
+    {
+      if (m_nRungs == 0)
+        {
+          TransferTop ();
+          continue;
+        }
+      Rung &rung = m_rungs[m_nRungs - 1];
+      if (rung.count == 0)
+        {
+          m_nRungs--;
+          continue;
+        }
+      while (rung.buckets[rung.current].empty ())
+        {
+          rung.current++;
+        }
+      Bucket &bucket = rung.buckets[rung.current];
+      uint64_t bucketStart = CurrentStart (rung);
+      rung.current++;
+      rung.count -= bucket.size ();
+
+      if (bucket.size () > THRESHOLD && rung.width > 1 && m_nRungs < MAX_RUNGS)
+        {
+          uint64_t min = bucket.front ().key.m_ts;
+          uint64_t max = min;
+          for (Bucket::const_iterator i = bucket.begin (); i != bucket.end (); ++i)
+            {
+              min = std::min (min, i->key.m_ts);
+              max = std::max (max, i->key.m_ts);
+            }
+          if (min != max)
+            {
+              PushRung (min, bucketStart + rung.width - 1, bucket.size ());
+              FillRung (bucket);
+              continue;
+            }
+        }
+      std::sort (bucket.begin (), bucket.end (), &IsLater);
+      // Bottom is empty: swapping recycles its storage for the bucket.
+      m_bottom.swap (bucket);
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,144 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LADDER_SCHEDULER_H
+#define LADDER_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Declaration of ns3::LadderScheduler class.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ * \brief a ladder queue event scheduler
+ *
+ * This event scheduler implements the Ladder Queue described in
+ * "Ladder Queue: An O(1) Priority Queue Structure for Large-Scale
+ * Discrete Event Simulation" by Wai Teng Tang, Rick Siow Mong Goh
+ * and Ian Li-Jin Thng (ACM TOMACS, 2005).
+ *
+ * Events are kept in three tiers:
+ *  - Top: an unsorted vector holding all events far in the future,
+ *    i.e., with a timestamp larger than or equal to m_topStart.
+ *  - Ladder: a stack of rungs, each an array of unsorted buckets.
+ *    Rung 0 is built from the content of Top, and deeper rungs are
+ *    spawned from a single bucket of the rung above it whenever that
+ *    bucket holds too many events to be sorted cheaply.
+ *  - Bottom: a small sorted vector of the most imminent events, from
+ *    which events are actually dequeued.
+ *
+ * Unlike the CalendarScheduler, this scheduler never rehashes the
+ * full event set: events are only moved down one tier at a time, and
+ * each event is moved a bounded number of times, which keeps both
+ * Insert and RemoveNext amortized O(1). Buckets and rungs are recycled
+ * to avoid reallocation once the queue has reached its steady-state size.
+ */
+class LadderScheduler : public Scheduler
+{
+public:
+  static TypeId GetTypeId (void);
+
+  LadderScheduler ();
+  virtual ~LadderScheduler ();
+
+  virtual void Insert (const Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Event PeekNext (void) const;
+  virtual Event RemoveNext (void);
+  virtual void Remove (const Event &ev);
+
+private:
+  /** An unsorted list of events. */
+  typedef std::vector<Scheduler::Event> Bucket;
+
+  /** A single rung of the ladder. */
+  struct Rung
+  {
+    std::vector<Bucket> buckets; //!< Bucket storage, may be larger than m_nBuckets.
+    uint32_t nBuckets;           //!< Number of buckets in use.
+    uint64_t start;              //!< Timestamp of the start of the first bucket.
+    uint64_t width;              //!< Duration covered by a single bucket.
+    uint32_t current;            //!< Index of the first bucket not yet dequeued.
+    uint32_t count;              //!< Number of events stored in this rung.
+  };
+
+  /**
+   * Maximum number of events a bucket may hold to be transferred
+   * directly into Bottom rather than being spawned into a new rung.
+   */
+  static const uint32_t THRESHOLD = 50;
+  /** Maximum number of rungs in the ladder. */
+  static const uint32_t MAX_RUNGS = 8;
+
+  /**
+   * \param rung the rung.
+   * \returns the timestamp at the start of the current bucket of the rung.
+   */
+  inline uint64_t CurrentStart (const Rung &rung) const;
+  /**
+   * Insert an event into Bottom, keeping it sorted.
+   * \param ev the event to insert.
+   */
+  void InsertBottom (const Event &ev);
+  /**
+   * Initialize a new rung at the bottom of the ladder.
+   * \param min smallest timestamp the rung must hold.
+   * \param max largest timestamp the rung must hold.
+   * \param n number of events about to be stored in the rung.
+   * \returns the new rung.
+   */
+  Rung & PushRung (uint64_t min, uint64_t max, uint32_t n);
+  /**
+   * Move the events of a bucket into the deepest rung.
+   * \param bucket the events to move, cleared on return.
+   */
+  void FillRung (Bucket &bucket);
+  /** Transfer the content of Top into rung 0, or straight into Bottom. */
+  void TransferTop (void);
+  /** Spawn a new rung from Bottom when it has grown too large. */
+  void SpawnFromBottom (void);
+  /** Make sure Bottom holds at least one event. */
+  void RefillBottom (void);
+
+  /** Events in Top. */
+  Bucket m_top;
+  /** Smallest timestamp in Top. */
+  uint64_t m_topMin;
+  /** Largest timestamp in Top. */
+  uint64_t m_topMax;
+  /** Events with a timestamp larger than or equal to this go to Top. */
+  uint64_t m_topStart;
+  /** Rung storage; only the first m_nRungs entries are in use. */
+  std::vector<Rung> m_rungs;
+  /** Number of active rungs. */
+  uint32_t m_nRungs;
+  /** Events in Bottom, sorted by decreasing key. */
+  Bucket m_bottom;
+  /** Total number of events in the scheduler. */
+  uint32_t m_qSize;
+};
+
+} // namespace ns3
+
+#endif /* LADDER_SCHEDULER_H */
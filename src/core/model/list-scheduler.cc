@@ -70,6 +70,21 @@ ListScheduler::Insert (const Event &ev)
     }
   m_events.push_back (ev);
 }
+void
+ListScheduler::InsertBatch (const std::vector<Event> &events)
+{
+  NS_LOG_FUNCTION (this << events.size ());
+  // The events are sorted: merge them with the list in a single pass.
+  EventsI i = m_events.begin ();
+  for (std::vector<Event>::const_iterator j = events.begin (); j != events.end (); ++j)
+    {
+      while (i != m_events.end () && !(j->key < i->key))
+        {
+          i++;
+        }
+      m_events.insert (i, *j);
+    }
+}
 bool
 ListScheduler::IsEmpty (void) const
 {
@@ -24,6 +24,7 @@
 #include "scheduler.h"
 #include <list>
 #include <utility>
+#include <vector>
 #include <stdint.h>
 
 /**
@@ -52,6 +53,7 @@ public:
   virtual ~ListScheduler ();
 
   virtual void Insert (const Event &ev);
+  virtual void InsertBatch (const std::vector<Event> &events);
   virtual bool IsEmpty (void) const;
   virtual Event PeekNext (void) const;
   virtual Event RemoveNext (void);
@@ -165,6 +165,33 @@ void LogComponentDisableAll (enum LogLevel level);
 } // namespace ns3
 
 
+#ifndef NS3_LOG_COMPILE_LEVEL
+/**
+ * The log levels compiled in the current module, as a LogLevel mask.
+ *
+ * It is set for each module by the \c --log-level configure option.
+ * The statements of the other levels are removed by the compiler
+ * and these levels cannot be enabled at run time.  By default, all
+ * the levels are compiled in.
+ */
+#define NS3_LOG_COMPILE_LEVEL 0x0fffffff
+#endif
+
+/**
+ * Check at compile time if a log level is compiled in.
+ *
+ * \param level The log level.
+ */
+#define NS_LOG_IS_COMPILED(level)                               \
+  (((level) & (NS3_LOG_COMPILE_LEVEL)) != 0)
+
+/**
+ * The log levels which are not compiled in, used as the default
+ * mask of the log components.
+ */
+#define NS_LOG_COMPILED_OUT_MASK                                \
+  ((ns3::LogLevel)(ns3::LOG_LEVEL_ALL & ~(NS3_LOG_COMPILE_LEVEL)))
+
 /**
  * Define a Log component with a specific name.
  *
@@ -199,7 +226,8 @@ void LogComponentDisableAll (enum LogLevel level);
  * \param name The log component name.
  */
 #define NS_LOG_COMPONENT_DEFINE(name)                           \
-  static ns3::LogComponent g_log = ns3::LogComponent (name, __FILE__)
+  static ns3::LogComponent g_log =                              \
+    ns3::LogComponent (name, __FILE__, NS_LOG_COMPILED_OUT_MASK)
 
 /**
  * Define a logging component with a mask.
@@ -210,7 +238,9 @@ void LogComponentDisableAll (enum LogLevel level);
  * \param mask The default mask.
  */
 #define NS_LOG_COMPONENT_DEFINE_MASK(name, mask)                \
-  static ns3::LogComponent g_log = ns3::LogComponent (name, __FILE__, mask)
+  static ns3::LogComponent g_log =                              \
+    ns3::LogComponent (name, __FILE__,                          \
+                       (ns3::LogLevel)((mask) | NS_LOG_COMPILED_OUT_MASK))
 
 /**
  * Use \ref NS_LOG to output a message of level LOG_ERROR.
@@ -409,6 +439,16 @@ private:
 
 };  // class LogComponent
 
+/*
+ * IsEnabled is called by every logging statement, so it is inlined:
+ * a disabled statement costs a single load and branch.
+ */
+inline bool
+LogComponent::IsEnabled (const enum LogLevel level) const
+{
+  return (level & m_levels) ? 1 : 0;
+}
+
   
 /**
  * Insert `, ` when streaming function arguments.
@@ -66,6 +66,26 @@ MapScheduler::Insert (const Event &ev)
   NS_ASSERT (result.second);
 }
 
+void
+MapScheduler::InsertBatch (const std::vector<Event> &events)
+{
+  NS_LOG_FUNCTION (this << events.size ());
+  if (events.empty ())
+    {
+      return;
+    }
+  // The events are sorted: each one is inserted right after the
+  // previous one, which the hinted insertion does in amortized
+  // constant time rather than with a lookup from the root.
+  std::vector<Event>::const_iterator i = events.begin ();
+  EventMapI hint = m_list.insert (std::make_pair (i->key, i->impl)).first;
+  for (++i; i != events.end (); ++i)
+    {
+      NS_ASSERT (hint->first < i->key);
+      hint = m_list.insert (hint, std::make_pair (i->key, i->impl));
+    }
+}
+
 bool
 MapScheduler::IsEmpty (void) const
 {
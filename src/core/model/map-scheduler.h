@@ -25,6 +25,7 @@
 #include <stdint.h>
 #include <map>
 #include <utility>
+#include <vector>
 
 /**
  * \file
@@ -50,6 +51,7 @@ public:
   virtual ~MapScheduler ();
 
   virtual void Insert (const Event &ev);
+  virtual void InsertBatch (const std::vector<Event> &events);
   virtual bool IsEmpty (void) const;
   virtual Event PeekNext (void) const;
   virtual Event RemoveNext (void);
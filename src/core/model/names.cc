@@ -17,10 +17,12 @@
  */
 
 #include <map>
+#include <vector>
 #include "object.h"
 #include "log.h"
 #include "assert.h"
 #include "abort.h"
+#include "hash.h"
 #include "names.h"
 
 /**
@@ -49,10 +51,16 @@ public:
   Ptr<Object> m_object;
 
   std::map<std::string, NameNode *> m_nameMap;
+
+  std::string m_path;      //!< The fully qualified path, "/Names/client/eth0".
+  uint32_t m_pathHash;     //!< The hash of m_path.
+  NameNode *m_nextPath;    //!< The next node in the same bucket of the path table.
+  NameNode *m_nextObject;  //!< The next node in the same bucket of the object table.
 };
 
 NameNode::NameNode ()
-  : m_parent (0), m_name (""), m_object (0)
+  : m_parent (0), m_name (""), m_object (0),
+    m_path (""), m_pathHash (0), m_nextPath (0), m_nextObject (0)
 {
 }
 
@@ -62,6 +70,10 @@ NameNode::NameNode (const NameNode &nameNode)
   m_name = nameNode.m_name;
   m_object = nameNode.m_object;
   m_nameMap = nameNode.m_nameMap;
+  m_path = nameNode.m_path;
+  m_pathHash = nameNode.m_pathHash;
+  m_nextPath = 0;
+  m_nextObject = 0;
 }
 
 NameNode &
@@ -71,11 +83,17 @@ NameNode::operator = (const NameNode &rhs)
   m_name = rhs.m_name;
   m_object = rhs.m_object;
   m_nameMap = rhs.m_nameMap;
+  m_path = rhs.m_path;
+  m_pathHash = rhs.m_pathHash;
+  m_nextPath = 0;
+  m_nextObject = 0;
   return *this;
 }
 
 NameNode::NameNode (NameNode *parent, std::string name, Ptr<Object> object)
-  : m_parent (parent), m_name (name), m_object (object)
+  : m_parent (parent), m_name (name), m_object (object),
+    m_path (parent->m_path + "/" + name), m_pathHash (Hash32 (m_path)),
+    m_nextPath (0), m_nextObject (0)
 {
   NS_LOG_FUNCTION (this << parent << name << object);
 }
@@ -115,10 +133,50 @@ private:
   NameNode *IsNamed (Ptr<Object>);
   bool IsDuplicateName (NameNode *node, std::string name);
 
+  /**
+   * \param path a fully qualified path, starting with "/Names/".
+   * \returns the node of this path, or 0.
+   */
+  NameNode *LookupPath (std::string const &path) const;
+  /**
+   * \param node a new node, to add to both tables.
+   */
+  void Insert (NameNode *node);
+  /**
+   * \param node a node of the path table, to add back under its new
+   *        path after a rename, together with its descendants.
+   */
+  void Rehash (NameNode *node);
+  /**
+   * \param node a node of the path table, to remove from it.
+   */
+  void RemovePath (NameNode *node);
+  /**
+   * \param object an object.
+   * \returns the index of the bucket of the object table for this object.
+   */
+  uint32_t GetObjectBucket (Object const *object) const;
+  /**
+   * Double the number of buckets of both tables.
+   */
+  void Grow (void);
+
   NameNode m_root;
-  std::map<Ptr<Object>, NameNode *> m_objectMap;
+  /**
+   * Both tables are arrays of singly-linked buckets, chained through the
+   * nodes themselves, whose size is a power of two.  The path table holds
+   * every named node by its fully qualified path, so that a path is found
+   * with a single lookup rather than a walk down the tree; the object table
+   * holds the same nodes by object, for the reverse lookups.
+   */
+  std::vector<NameNode *> m_pathTable;
+  std::vector<NameNode *> m_objectTable;  //!< The nodes, by object.
+  uint32_t m_nNodes;                      //!< The number of named nodes.
 };
 
+/// The initial number of buckets of the name tables.
+static const uint32_t NAMES_INITIAL_BUCKETS = 64;
+
 NamesPriv *
 NamesPriv::Get (void)
 {
@@ -128,12 +186,16 @@ NamesPriv::Get (void)
 }
 
 NamesPriv::NamesPriv ()
+  : m_pathTable (NAMES_INITIAL_BUCKETS, 0),
+    m_objectTable (NAMES_INITIAL_BUCKETS, 0),
+    m_nNodes (0)
 {
   NS_LOG_FUNCTION (this);
 
   m_root.m_parent = 0;
   m_root.m_name = "Names";
   m_root.m_object = 0;
+  m_root.m_path = "/Names";
 }
 
 NamesPriv::~NamesPriv ()
@@ -148,21 +210,29 @@ NamesPriv::Clear (void)
 {
   NS_LOG_FUNCTION (this);
   //
-  // Every name is associated with an object in the object map, so freeing the
-  // NameNodes in this map will free all of the memory allocated for the NameNodes
+  // Every name is associated with an object in the object table, so freeing the
+  // NameNodes in this table will free all of the memory allocated for the NameNodes
   //
-  for (std::map<Ptr<Object>, NameNode *>::iterator i = m_objectMap.begin (); i != m_objectMap.end (); ++i)
+  for (std::vector<NameNode *>::iterator i = m_objectTable.begin (); i != m_objectTable.end (); ++i)
     {
-      delete i->second;
-      i->second = 0;
+      NameNode *node = *i;
+      while (node != 0)
+        {
+          NameNode *next = node->m_nextObject;
+          delete node;
+          node = next;
+        }
     }
 
-  m_objectMap.clear ();
+  m_pathTable.assign (NAMES_INITIAL_BUCKETS, 0);
+  m_objectTable.assign (NAMES_INITIAL_BUCKETS, 0);
+  m_nNodes = 0;
 
   m_root.m_parent = 0;
   m_root.m_name = "Names";
   m_root.m_object = 0;
   m_root.m_nameMap.clear ();
+  m_root.m_path = "/Names";
 }
 
 bool
@@ -268,7 +338,7 @@ NamesPriv::Add (Ptr<Object> context, std::string name, Ptr<Object> object)
 
   NameNode *newNode = new NameNode (node, name, object);
   node->m_nameMap[name] = newNode;
-  m_objectMap[object] = newNode;
+  Insert (newNode);
 
   return true;
 }
@@ -385,12 +455,14 @@ NamesPriv::Rename (Ptr<Object> context, std::string oldname, std::string newname
       // 1.  Geting the pointer to the name node from the map and remembering it;
       // 2.  Removing the map entry corresponding to oldname from the map;
       // 3.  Changing the name string in the name node;
-      // 4.  Adding the name node back in the map under the newname.
+      // 4.  Adding the name node back in the map under the newname;
+      // 5.  Moving the name node and its descendants to their new paths.
       //
       NameNode *changeNode = i->second;
       node->m_nameMap.erase (i);
       changeNode->m_name = newname;
       node->m_nameMap[newname] = changeNode;
+      Rehash (changeNode);
       return true;
     }
 }
@@ -400,8 +472,8 @@ NamesPriv::FindName (Ptr<Object> object)
 {
   NS_LOG_FUNCTION (this << object);
 
-  std::map<Ptr<Object>, NameNode *>::iterator i = m_objectMap.find (object);
-  if (i == m_objectMap.end ())
+  NameNode *node = IsNamed (object);
+  if (node == 0)
     {
       NS_LOG_LOGIC ("Object does not exist in object map");
       return "";
@@ -409,7 +481,7 @@ NamesPriv::FindName (Ptr<Object> object)
   else
     {
       NS_LOG_LOGIC ("Object exists in object map");
-      return i->second->m_name;
+      return node->m_name;
     }
 }
 
@@ -418,26 +490,15 @@ NamesPriv::FindPath (Ptr<Object> object)
 {
   NS_LOG_FUNCTION (this << object);
 
-  std::map<Ptr<Object>, NameNode *>::iterator i = m_objectMap.find (object);
-  if (i == m_objectMap.end ())
+  NameNode *node = IsNamed (object);
+  if (node == 0)
     {
       NS_LOG_LOGIC ("Object does not exist in object map");
       return "";
     }
 
-  NameNode *p = i->second;
-  NS_ASSERT_MSG (p, "NamesPriv::FindFullName(): Internal error: Invalid NameNode pointer from map");
-
-  std::string path;
-
-  do
-    {
-      path = "/" + p->m_name + path;
-      NS_LOG_LOGIC ("path is " << path);
-    }
-  while ((p = p->m_parent) != 0);
-
-  return path;
+  NS_LOG_LOGIC ("path is " << node->m_path);
+  return node->m_path;
 }
 
 
@@ -455,84 +516,35 @@ NamesPriv::Find (std::string path)
   // Find ("/Names/Client/eth0");
   //
   // So, if we are given a name that begins with "/Names/" the upshot is that we
-  // just remove that prefix and treat the rest of the string as starting with a 
-  // name in the root namespace.
+  // just look up that fully qualified path, and otherwise we look up the path
+  // made of the "/Names/" prefix and of the relative name.  Every named object
+  // is in the path table under its fully qualified path, so there is no need
+  // to walk down the name space segment by segment.
   //
 
   NS_LOG_FUNCTION (this << path);
   std::string namespaceName = "/Names/";
-  std::string remaining;
 
+  NameNode *node = 0;
   std::string::size_type offset = path.find (namespaceName);
   if (offset == 0)
     {
       NS_LOG_LOGIC (path << " is a fully qualified name");
-      remaining = path.substr (namespaceName.size ());
+      node = LookupPath (path);
     }
   else
     {
       NS_LOG_LOGIC (path << " begins with a relative name");
-      remaining = path;
+      node = LookupPath (namespaceName + path);
     }
 
-  NameNode *node = &m_root;
-
-  //
-  // The string <remaining> is now composed entirely of path segments in
-  // the /Names name space and we have eaten the leading slash. e.g., 
-  // remaining = "ClientNode/eth0"
-  //
-  // The start of the search is always at the root of the name space.
-  //
-  for (;;)
+  if (node == 0)
     {
-      NS_LOG_LOGIC ("Looking for the object of name " << remaining);
-      offset = remaining.find ("/");
-      if (offset == std::string::npos)
-        {
-          //
-          // There are no remaining slashes so this is the last segment of the 
-          // specified name.  We're done when we find it
-          //
-          std::map<std::string, NameNode *>::iterator i = node->m_nameMap.find (remaining);
-          if (i == node->m_nameMap.end ())
-            {
-              NS_LOG_LOGIC ("Name does not exist in name map");
-              return 0;
-            }
-          else
-            {
-              NS_LOG_LOGIC ("Name parsed, found object");
-              return i->second->m_object;
-            }
-        }
-      else
-        {
-          //
-          // There are more slashes so this is an intermediate segment of the 
-          // specified name.  We need to "recurse" when we find this segment.
-          //
-          offset = remaining.find ("/");
-          std::string segment = remaining.substr (0, offset);
-
-          std::map<std::string, NameNode *>::iterator i = node->m_nameMap.find (segment);
-          if (i == node->m_nameMap.end ())
-            {
-              NS_LOG_LOGIC ("Name does not exist in name map");
-              return 0;
-            }
-          else
-            {
-              node = i->second;
-              remaining = remaining.substr (offset + 1);
-              NS_LOG_LOGIC ("Intermediate segment parsed");
-              continue;
-            }
-        }
+      NS_LOG_LOGIC ("Name does not exist in name map");
+      return 0;
     }
-
-  NS_ASSERT_MSG (node, "NamesPriv::Find(): Internal error:  this can't happen");
-  return 0;
+  NS_LOG_LOGIC ("Name parsed, found object");
+  return node->m_object;
 }
 
 Ptr<Object>
@@ -569,8 +581,8 @@ NamesPriv::Find (Ptr<Object> context, std::string name)
         }
     }
 
-  std::map<std::string, NameNode *>::iterator i = node->m_nameMap.find (name);
-  if (i == node->m_nameMap.end ())
+  NameNode *child = LookupPath (node->m_path + "/" + name);
+  if (child == 0)
     {
       NS_LOG_LOGIC ("Name does not exist in name map");
       return 0;
@@ -578,7 +590,7 @@ NamesPriv::Find (Ptr<Object> context, std::string name)
   else
     {
       NS_LOG_LOGIC ("Name exists in name map");
-      return i->second->m_object;
+      return child->m_object;
     }
 }
 
@@ -587,17 +599,17 @@ NamesPriv::IsNamed (Ptr<Object> object)
 {
   NS_LOG_FUNCTION (this << object);
 
-  std::map<Ptr<Object>, NameNode *>::iterator i = m_objectMap.find (object);
-  if (i == m_objectMap.end ())
+  Object const *p = PeekPointer (object);
+  for (NameNode *node = m_objectTable[GetObjectBucket (p)]; node != 0; node = node->m_nextObject)
     {
-      NS_LOG_LOGIC ("Object does not exist in object map, returning NameNode 0");
-      return 0;
-    }
-  else
-    {
-      NS_LOG_LOGIC ("Object exists in object map, returning NameNode " << &i->second);
-      return i->second;
+      if (PeekPointer (node->m_object) == p)
+        {
+          NS_LOG_LOGIC ("Object exists in object map, returning NameNode " << node);
+          return node;
+        }
     }
+  NS_LOG_LOGIC ("Object does not exist in object map, returning NameNode 0");
+  return 0;
 }
 
 bool
@@ -618,6 +630,119 @@ NamesPriv::IsDuplicateName (NameNode *node, std::string name)
     }
 }
 
+NameNode *
+NamesPriv::LookupPath (std::string const &path) const
+{
+  NS_LOG_FUNCTION (this << path);
+
+  uint32_t hash = Hash32 (path);
+  for (NameNode *node = m_pathTable[hash & (m_pathTable.size () - 1)]; node != 0; node = node->m_nextPath)
+    {
+      if (node->m_pathHash == hash && node->m_path == path)
+        {
+          return node;
+        }
+    }
+  return 0;
+}
+
+void
+NamesPriv::Insert (NameNode *node)
+{
+  NS_LOG_FUNCTION (this << node);
+
+  if (m_nNodes >= m_pathTable.size ())
+    {
+      Grow ();
+    }
+  NameNode *&pathBucket = m_pathTable[node->m_pathHash & (m_pathTable.size () - 1)];
+  node->m_nextPath = pathBucket;
+  pathBucket = node;
+  NameNode *&objectBucket = m_objectTable[GetObjectBucket (PeekPointer (node->m_object))];
+  node->m_nextObject = objectBucket;
+  objectBucket = node;
+  m_nNodes++;
+}
+
+void
+NamesPriv::Rehash (NameNode *node)
+{
+  NS_LOG_FUNCTION (this << node);
+
+  RemovePath (node);
+  node->m_path = node->m_parent->m_path + "/" + node->m_name;
+  node->m_pathHash = Hash32 (node->m_path);
+  NameNode *&bucket = m_pathTable[node->m_pathHash & (m_pathTable.size () - 1)];
+  node->m_nextPath = bucket;
+  bucket = node;
+
+  for (std::map<std::string, NameNode *>::iterator i = node->m_nameMap.begin (); i != node->m_nameMap.end (); ++i)
+    {
+      Rehash (i->second);
+    }
+}
+
+void
+NamesPriv::RemovePath (NameNode *node)
+{
+  NS_LOG_FUNCTION (this << node);
+
+  NameNode **p = &m_pathTable[node->m_pathHash & (m_pathTable.size () - 1)];
+  while (*p != node)
+    {
+      NS_ASSERT_MSG (*p != 0, "NamesPriv::RemovePath(): Internal error: node not in the path table");
+      p = &(*p)->m_nextPath;
+    }
+  *p = node->m_nextPath;
+  node->m_nextPath = 0;
+}
+
+uint32_t
+NamesPriv::GetObjectBucket (Object const *object) const
+{
+  // Objects are aligned, so the low bits of their address carry no information.
+  uint64_t key = reinterpret_cast<uintptr_t> (object) >> 4;
+  key *= 0x9e3779b97f4a7c15ULL;
+  return static_cast<uint32_t> (key >> 32) & (m_objectTable.size () - 1);
+}
+
+void
+NamesPriv::Grow (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  std::vector<NameNode *> pathTable (m_pathTable.size () * 2, 0);
+  for (std::vector<NameNode *>::iterator i = m_pathTable.begin (); i != m_pathTable.end (); ++i)
+    {
+      NameNode *node = *i;
+      while (node != 0)
+        {
+          NameNode *next = node->m_nextPath;
+          NameNode *&bucket = pathTable[node->m_pathHash & (pathTable.size () - 1)];
+          node->m_nextPath = bucket;
+          bucket = node;
+          node = next;
+        }
+    }
+  m_pathTable.swap (pathTable);
+
+  std::vector<NameNode *> objectTable;
+  objectTable.swap (m_objectTable);
+  m_objectTable.assign (objectTable.size () * 2, 0);
+  for (std::vector<NameNode *>::iterator i = objectTable.begin (); i != objectTable.end (); ++i)
+    {
+      NameNode *node = *i;
+      while (node != 0)
+        {
+          NameNode *next = node->m_nextObject;
+          NameNode *&bucket = m_objectTable[GetObjectBucket (PeekPointer (node->m_object))];
+          node->m_nextObject = bucket;
+          bucket = node;
+          node = next;
+        }
+    }
+}
+
 void
 Names::Add (std::string name, Ptr<Object> object)
 {
@@ -220,6 +220,15 @@ public:
   virtual bool Get (const ObjectBase * object, AttributeValue &value) const;
   virtual bool HasGetter (void) const;
   virtual bool HasSetter (void) const;
+  /**
+   * Get a single instance from the container, identified by its index,
+   * without copying the whole container in an ObjectPtrContainerValue.
+   *
+   * \param [in] object The container object.
+   * \param [in] index The index of the desired instance.
+   * \returns The instance, or 0 if there is none with this index.
+   */
+  Ptr<Object> GetByIndex (const ObjectBase *object, uint32_t index) const;
 private:
   /**
    * Get the number of instances in the container.
@@ -33,6 +33,7 @@
 #include "log.h"
 #include "rng-stream.h"
 #include "rng-seed-manager.h"
+#include "system-mutex.h"
 #include <cmath>
 #include <iostream>
 
@@ -71,17 +72,76 @@ RandomVariableStream::GetTypeId (void)
   return tid;
 }
 
+/** The list of the existing random variables, for ResetStreams. */
+static RandomVariableStream *g_streams = 0;
+
+/**
+ * \internal
+ * Get the mutex of g_streams, since the threads of a parallel simulation
+ * create and destroy random variables concurrently.
+ *
+ * The mutex is never deleted: the random variables held by static
+ * objects are destroyed after the function local statics.
+ *
+ * \returns The static mutex to control access to g_streams.
+ */
+static SystemMutex &
+GetStreamsMutex (void)
+{
+  static SystemMutex *g_streamsMutex = new SystemMutex ();
+  return *g_streamsMutex;
+}
+
 RandomVariableStream::RandomVariableStream()
-  : m_rng (0)
+  : m_rng (0),
+    m_index (0),
+    m_prev (0)
 {
   NS_LOG_FUNCTION (this);
+  CriticalSection critical (GetStreamsMutex ());
+  m_next = g_streams;
+  if (m_next != 0)
+    {
+      m_next->m_prev = this;
+    }
+  g_streams = this;
 }
 RandomVariableStream::~RandomVariableStream()
 {
   NS_LOG_FUNCTION (this);
+  CriticalSection critical (GetStreamsMutex ());
+  if (m_prev != 0)
+    {
+      m_prev->m_next = m_next;
+    }
+  else
+    {
+      g_streams = m_next;
+    }
+  if (m_next != 0)
+    {
+      m_next->m_prev = m_prev;
+    }
   delete m_rng;
 }
 
+void
+RandomVariableStream::ResetStreams (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  uint32_t seed = RngSeedManager::GetSeed ();
+  uint64_t run = RngSeedManager::GetRun ();
+  CriticalSection critical (GetStreamsMutex ());
+  for (RandomVariableStream *i = g_streams; i != 0; i = i->m_next)
+    {
+      if (i->m_rng != 0)
+        {
+          delete i->m_rng;
+          i->m_rng = new RngStream (seed, i->m_index, run);
+        }
+    }
+}
+
 void
 RandomVariableStream::SetAntithetic(bool isAntithetic)
 {
@@ -110,6 +170,7 @@ RandomVariableStream::SetStream (int64_t stream)
       m_rng = new RngStream (RngSeedManager::GetSeed (),
                              nextStream,
                              RngSeedManager::GetRun ());
+      m_index = nextStream;
     }
   else
     {
@@ -120,6 +181,7 @@ RandomVariableStream::SetStream (int64_t stream)
       m_rng = new RngStream (RngSeedManager::GetSeed (),
                              target,
                              RngSeedManager::GetRun ());
+      m_index = target;
     }
   m_stream = stream;
 }
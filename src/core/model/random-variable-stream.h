@@ -133,6 +133,18 @@ public:
    */
   virtual uint32_t GetInteger (void) = 0;
 
+  /**
+   * \brief Restart all the existing RNG streams.
+   *
+   * Each stream keeps its stream number but is recreated from the
+   * current values of \ref GlobalValueRngSeed "RngSeed" and
+   * \ref GlobalValueRngRun "RngRun", as if the random variable had
+   * just been created.  This makes a change of run take effect on the
+   * random variables created before it, for instance in the processes
+   * forked by a SweepRunner.
+   */
+  static void ResetStreams (void);
+
 protected:
   /**
    * \brief Returns a pointer to the underlying RNG stream.
@@ -154,6 +166,14 @@ private:
 
   /// The stream number for this RNG stream.
   int64_t m_stream;
+
+  /// The index of the underlying RNG stream, automatic or not.
+  uint64_t m_index;
+
+  /// The previous random variable in the list of existing ones.
+  RandomVariableStream *m_prev;
+  /// The next random variable in the list of existing ones.
+  RandomVariableStream *m_next;
 };
 
 /**
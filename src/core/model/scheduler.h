@@ -22,6 +22,7 @@
 #define SCHEDULER_H
 
 #include <stdint.h>
+#include <vector>
 #include "object.h"
 
 /**
@@ -97,6 +98,17 @@ public:
    * \param ev event to store in the event list
    */
   virtual void Insert (const Event &ev) = 0;
+  /**
+   * Insert a group of events at once.
+   *
+   * The default implementation inserts the events one by one:
+   * subclasses override it when they can take advantage of the
+   * events being sorted and close to each other.
+   *
+   * \param events the events to store in the event list, sorted
+   *        by increasing key.
+   */
+  virtual void InsertBatch (const std::vector<Event> &events);
   /**
    * \returns true if the event list is empty and false otherwise.
    */
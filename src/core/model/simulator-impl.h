@@ -37,6 +37,7 @@
 namespace ns3 {
 
 class Scheduler;
+class EventBatch;
 
 /**
  * \ingroup simulator
@@ -111,6 +112,21 @@ public:
    * \returns A unique identifier for the newly-scheduled event.
    */
   virtual void ScheduleWithContext (uint32_t context, Time const &time, EventImpl *event) = 0;
+  /**
+   * Schedule a group of events, each in its own context.
+   *
+   * The events are scheduled in the order in which they were added
+   * to the batch, which gives the same execution order as one call to
+   * ScheduleWithContext per event. The ownership of the events is
+   * transferred to the simulator, but the batch itself is not modified:
+   * the caller must Release it.
+   *
+   * The default implementation calls ScheduleWithContext for each
+   * event: subclasses override it to insert the events at once.
+   *
+   * \param batch The events to schedule.
+   */
+  virtual void ScheduleBatch (const EventBatch &batch);
   /**
    * Schedule an event to run at the current virtual time.
    *
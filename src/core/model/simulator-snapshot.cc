@@ -0,0 +1,267 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "simulator-snapshot.h"
+#include "simulator.h"
+#include "assert.h"
+#include "fatal-error.h"
+#include "log.h"
+
+#include <unistd.h>
+#include <sys/wait.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::SimulatorSnapshot implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SimulatorSnapshot");
+
+namespace {
+
+/// The request to fork a restored process.
+const char RESTORE = 'r';
+/// The request to wait for a restored process, followed by its pid.
+const char WAIT = 'w';
+
+/**
+ * Read a value from a pipe, retrying on interruption.
+ * \param fd the file descriptor.
+ * \param buffer the value.
+ * \param size the size of the value.
+ * \returns true if the whole value was read.
+ */
+bool
+ReadFully (int fd, void *buffer, size_t size)
+{
+  ssize_t n;
+  while ((n = read (fd, buffer, size)) < 0 && errno == EINTR)
+    {
+    }
+  return n == static_cast<ssize_t> (size);
+}
+
+} // anonymous namespace
+
+SimulatorSnapshot::SimulatorSnapshot ()
+  : m_keeper (-1),
+    m_request (-1),
+    m_reply (-1)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+SimulatorSnapshot::~SimulatorSnapshot ()
+{
+  NS_LOG_FUNCTION (this);
+  Discard ();
+}
+
+uint32_t
+SimulatorSnapshot::Save (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT_MSG (m_keeper == -1, "A snapshot is already saved");
+  int request[2];
+  int reply[2];
+  if (pipe (request) != 0)
+    {
+      NS_FATAL_ERROR ("SimulatorSnapshot::Save(): pipe() failed: " << std::strerror (errno));
+    }
+  if (pipe (reply) != 0)
+    {
+      NS_FATAL_ERROR ("SimulatorSnapshot::Save(): pipe() failed: " << std::strerror (errno));
+    }
+  m_time = Simulator::Now ();
+  // The output buffered so far would otherwise be written again
+  // by every restored process.
+  std::cout.flush ();
+  std::cerr.flush ();
+  std::clog.flush ();
+  std::fflush (0);
+  pid_t pid = fork ();
+  if (pid < 0)
+    {
+      NS_FATAL_ERROR ("SimulatorSnapshot::Save(): fork() failed: " << std::strerror (errno));
+    }
+  if (pid == 0)
+    {
+      close (request[1]);
+      close (reply[0]);
+      uint32_t restored = Keep (request[0], reply[1]);
+      if (restored == 0)
+        {
+          // The snapshot was discarded: leave without running the
+          // destructors of the objects shared with the saving process.
+          _exit (0);
+        }
+      close (request[0]);
+      close (reply[1]);
+      // A restored process does not own the snapshot.
+      m_keeper = -1;
+      m_request = -1;
+      m_reply = -1;
+      NS_LOG_LOGIC ("restored process " << restored << " at " << m_time);
+      return restored;
+    }
+  close (request[0]);
+  close (reply[1]);
+  m_keeper = pid;
+  m_request = request[1];
+  m_reply = reply[0];
+  NS_LOG_LOGIC ("saved snapshot " << pid << " at " << m_time);
+  return 0;
+}
+
+uint32_t
+SimulatorSnapshot::Keep (int request, int reply)
+{
+  uint32_t restored = 0;
+  char command;
+  while (ReadFully (request, &command, 1))
+    {
+      if (command == RESTORE)
+        {
+          restored++;
+          std::fflush (0);
+          pid_t pid = fork ();
+          if (pid == 0)
+            {
+              return restored;
+            }
+          if (write (reply, &pid, sizeof (pid)) != sizeof (pid))
+            {
+              break;
+            }
+        }
+      else if (command == WAIT)
+        {
+          pid_t pid;
+          if (!ReadFully (request, &pid, sizeof (pid)))
+            {
+              break;
+            }
+          int status = -1;
+          int wstatus;
+          pid_t waited;
+          while ((waited = waitpid (pid, &wstatus, 0)) < 0 && errno == EINTR)
+            {
+            }
+          if (waited == pid && WIFEXITED (wstatus))
+            {
+              status = WEXITSTATUS (wstatus);
+            }
+          if (write (reply, &status, sizeof (status)) != sizeof (status))
+            {
+              break;
+            }
+        }
+    }
+  // Reap the restored processes which were not waited for.
+  while (waitpid (-1, 0, 0) > 0 || errno == EINTR)
+    {
+    }
+  return 0;
+}
+
+int
+SimulatorSnapshot::Restore (void)
+{
+  NS_LOG_FUNCTION (this);
+  return Wait (Spawn ());
+}
+
+pid_t
+SimulatorSnapshot::Spawn (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT_MSG (m_keeper != -1, "No snapshot to restore");
+  if (write (m_request, &RESTORE, 1) != 1)
+    {
+      NS_FATAL_ERROR ("SimulatorSnapshot::Spawn(): the snapshot is lost: " << std::strerror (errno));
+    }
+  pid_t pid;
+  if (!ReadFully (m_reply, &pid, sizeof (pid)))
+    {
+      NS_FATAL_ERROR ("SimulatorSnapshot::Spawn(): the snapshot is lost");
+    }
+  if (pid < 0)
+    {
+      NS_FATAL_ERROR ("SimulatorSnapshot::Spawn(): fork() failed in the snapshot");
+    }
+  NS_LOG_LOGIC ("restored process " << pid);
+  return pid;
+}
+
+int
+SimulatorSnapshot::Wait (pid_t pid)
+{
+  NS_LOG_FUNCTION (this << pid);
+  NS_ASSERT_MSG (m_keeper != -1, "No snapshot to wait for");
+  char command[1 + sizeof (pid)];
+  command[0] = WAIT;
+  std::memcpy (command + 1, &pid, sizeof (pid));
+  if (write (m_request, command, sizeof (command)) != sizeof (command))
+    {
+      NS_FATAL_ERROR ("SimulatorSnapshot::Wait(): the snapshot is lost: " << std::strerror (errno));
+    }
+  int status;
+  if (!ReadFully (m_reply, &status, sizeof (status)))
+    {
+      NS_FATAL_ERROR ("SimulatorSnapshot::Wait(): the snapshot is lost");
+    }
+  NS_LOG_LOGIC ("restored process " << pid << " exited with " << status);
+  return status;
+}
+
+void
+SimulatorSnapshot::Discard (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_keeper == -1)
+    {
+      return;
+    }
+  close (m_request);
+  close (m_reply);
+  while (waitpid (m_keeper, 0, 0) < 0 && errno == EINTR)
+    {
+    }
+  m_keeper = -1;
+  m_request = -1;
+  m_reply = -1;
+}
+
+bool
+SimulatorSnapshot::IsSaved (void) const
+{
+  return m_keeper != -1;
+}
+
+Time
+SimulatorSnapshot::GetTime (void) const
+{
+  return m_time;
+}
+
+} // namespace ns3
@@ -0,0 +1,157 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SIMULATOR_SNAPSHOT_H
+#define SIMULATOR_SNAPSHOT_H
+
+#include <stdint.h>
+#include <sys/types.h>
+#include "nstime.h"
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::SimulatorSnapshot declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ * \brief A snapshot of a running simulation, which can be restored
+ * any number of times.
+ *
+ * The snapshot is a suspended copy of the simulation process, created
+ * with fork() and shared copy-on-write with the process which saved it.
+ * It thus holds the exact simulation state: the pending events, the
+ * simulation time, the state of the random number streams and all
+ * the objects, whether or not they could be serialized.
+ *
+ * Each call to Restore starts a new process from the snapshot, which
+ * returns from Save with a non-zero value and resumes the simulation
+ * from there, for instance with different attribute values:
+ * \code
+ *   Simulator::Stop (warmup);
+ *   Simulator::Run ();
+ *   SimulatorSnapshot snapshot;
+ *   uint32_t restored = snapshot.Save ();
+ *   if (restored != 0)
+ *     {
+ *       // a restored process: apply the settings of this branch
+ *       Config::Set (path, values[restored - 1]);
+ *       Simulator::Run ();
+ *       exit (0);
+ *     }
+ *   std::vector<pid_t> runs;
+ *   for (uint32_t i = 0; i < values.size (); ++i)
+ *     {
+ *       runs.push_back (snapshot.Spawn ());
+ *     }
+ *   for (uint32_t i = 0; i < runs.size (); ++i)
+ *     {
+ *       snapshot.Wait (runs[i]);
+ *     }
+ * \endcode
+ *
+ * The processes started with Spawn run concurrently, while Restore
+ * waits for its process to exit before returning.  The number of
+ * concurrent processes is up to the caller: SweepRunner bounds it
+ * by a number of workers.
+ *
+ * The changes made by the saving process after Save are not seen by
+ * the restored processes.  Only the thread which calls Save is part
+ * of the snapshot, so it must not be used with the simulator
+ * implementations which run threads, nor while other threads are
+ * running.
+ */
+class SimulatorSnapshot
+{
+public:
+  SimulatorSnapshot ();
+  /** Discard the snapshot, if any. */
+  ~SimulatorSnapshot ();
+
+  /**
+   * Save the state of the simulation.
+   *
+   * \returns zero in the calling process, and the number of the
+   *          restoration, starting from one, in the processes
+   *          restored from this snapshot.
+   */
+  uint32_t Save (void);
+  /**
+   * Start a process from the snapshot and wait for it to exit.
+   *
+   * \returns the exit status of the restored process, or -1 if it
+   *          was terminated by a signal.
+   */
+  int Restore (void);
+  /**
+   * Start a process from the snapshot, without waiting for it.
+   *
+   * \returns the process id of the restored process, to give to Wait.
+   */
+  pid_t Spawn (void);
+  /**
+   * Wait for a process started with Spawn to exit.
+   *
+   * \param pid the process id returned by Spawn.
+   * \returns the exit status of the restored process, or -1 if it
+   *          was terminated by a signal or is not a process of this
+   *          snapshot.
+   */
+  int Wait (pid_t pid);
+  /**
+   * Discard the snapshot and release its resources, once the restored
+   * processes not waited for have exited.
+   */
+  void Discard (void);
+  /** \returns true if a snapshot has been saved and not discarded. */
+  bool IsSaved (void) const;
+  /** \returns the simulation time when the snapshot was saved. */
+  Time GetTime (void) const;
+
+private:
+  /**
+   * Wait for the requests, in the suspended copy of the process: fork
+   * a new process for each restoration, and reap the restored processes
+   * which are waited for.
+   *
+   * \param request the file descriptor of the requests.
+   * \param reply the file descriptor of the process ids and exit statuses.
+   * \returns the number of the restoration in the restored processes,
+   *          and zero in the suspended copy once the snapshot is discarded.
+   */
+  static uint32_t Keep (int request, int reply);
+
+  /** Copying would discard the snapshot twice. */
+  SimulatorSnapshot (const SimulatorSnapshot &o);
+  /**
+   * Copying would discard the snapshot twice.
+   * \param o the snapshot to copy.
+   * \returns this snapshot.
+   */
+  SimulatorSnapshot & operator = (const SimulatorSnapshot &o);
+
+  pid_t m_keeper;   //!< The suspended copy of the process, or -1.
+  int m_request;    //!< The pipe to send restoration requests.
+  int m_reply;      //!< The pipe to receive process ids and exit statuses.
+  Time m_time;      //!< The simulation time of the snapshot.
+};
+
+} // namespace ns3
+
+#endif /* SIMULATOR_SNAPSHOT_H */
@@ -251,6 +251,17 @@ Simulator::ScheduleWithContext (uint32_t context, const Time &time, EventImpl *i
 {
   return GetImpl ()->ScheduleWithContext (context, time, impl);
 }
+void
+Simulator::ScheduleBatch (EventBatch &batch)
+{
+  NS_LOG_FUNCTION (batch.GetN ());
+  if (batch.IsEmpty ())
+    {
+      return;
+    }
+  GetImpl ()->ScheduleBatch (batch);
+  batch.Release ();
+}
 EventId
 Simulator::ScheduleDestroy (const Ptr<EventImpl> &ev)
 {
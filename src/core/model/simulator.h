@@ -23,6 +23,7 @@
 
 #include "event-id.h"
 #include "event-impl.h"
+#include "event-batch.h"
 #include "make-event.h"
 #include "nstime.h"
 
@@ -445,6 +446,20 @@ public:
             typename T1, typename T2, typename T3, typename T4, typename T5>
   static void ScheduleWithContext (uint32_t context, Time const &time, void (*f)(U1,U2,U3,U4,U5), T1 a1, T2 a2, T3 a3, T4 a4, T5 a5);
 
+  /**
+   * Schedule a group of events, each with its own context and delay.
+   *
+   * This is equivalent to one call to ScheduleWithContext per event,
+   * in the order in which they were added to the batch, but lets the
+   * scheduler insert the whole group at once. On return, the batch is
+   * empty and can be reused.
+   *
+   * This method is thread-safe: it can be called from any thread.
+   *
+   * @param batch the events to schedule.
+   */
+  static void ScheduleBatch (EventBatch &batch);
+
   /** @} */
   
   /**
@@ -557,6 +557,99 @@ NullifyCallbackTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (target1.IsNull (), true, "Nullified Callback reports not IsNull()");
 }
 
+// ===========================================================================
+// Test equality and assignment of Callbacks stored inline and in a pimpl
+// ===========================================================================
+class EqualityCallbackTestCase : public TestCase
+{
+public:
+  EqualityCallbackTestCase ();
+  virtual ~EqualityCallbackTestCase () {}
+
+  void Target1 (int a) { m_test1 += a; }
+  void Target2 (int a) { m_test2 += a; }
+
+private:
+  virtual void DoRun (void);
+  virtual void DoSetup (void);
+
+  int m_test1;
+  int m_test2;
+};
+
+static int gEqualityCallbackTest;
+
+void EqualityCallbackTarget1 (int a) { gEqualityCallbackTest += a; }
+void EqualityCallbackTarget2 (int a) { gEqualityCallbackTest -= a; }
+void EqualityCallbackTarget3 (int a, int b) { gEqualityCallbackTest += a * b; }
+
+EqualityCallbackTestCase::EqualityCallbackTestCase ()
+  : TestCase ("Check IsEqual(), CheckType() and Assign()")
+{
+}
+
+void
+EqualityCallbackTestCase::DoSetup (void)
+{
+  m_test1 = 0;
+  m_test2 = 0;
+  gEqualityCallbackTest = 0;
+}
+
+void
+EqualityCallbackTestCase::DoRun (void)
+{
+  Callback<void, int> a = MakeCallback (&EqualityCallbackTestCase::Target1, this);
+  Callback<void, int> b = MakeCallback (&EqualityCallbackTestCase::Target1, this);
+  Callback<void, int> c = MakeCallback (&EqualityCallbackTestCase::Target2, this);
+  NS_TEST_ASSERT_MSG_EQ (a.IsEqual (b), true, "Identical member Callbacks differ");
+  NS_TEST_ASSERT_MSG_EQ (a.IsEqual (c), false, "Different member Callbacks are equal");
+  NS_TEST_ASSERT_MSG_EQ (a.GetImpl ()->IsEqual (b.GetImpl ()), true, "Identical member Callback pimpls differ");
+
+  Callback<void, int> f = MakeCallback (&EqualityCallbackTarget1);
+  Callback<void, int> g = MakeCallback (&EqualityCallbackTarget1);
+  Callback<void, int> h = MakeCallback (&EqualityCallbackTarget2);
+  NS_TEST_ASSERT_MSG_EQ (f.IsEqual (g), true, "Identical function Callbacks differ");
+  NS_TEST_ASSERT_MSG_EQ (f.IsEqual (h), false, "Different function Callbacks are equal");
+  NS_TEST_ASSERT_MSG_EQ (f.IsEqual (a), false, "Function and member Callbacks are equal");
+
+  Callback<void, int> bound = MakeBoundCallback (&EqualityCallbackTarget3, 2);
+  NS_TEST_ASSERT_MSG_EQ (bound.IsEqual (f), false, "Bound and function Callbacks are equal");
+  NS_TEST_ASSERT_MSG_EQ (f.IsEqual (bound), false, "Function and bound Callbacks are equal");
+
+  // the serialized form of a Callback does not change between calls
+  CallbackValue inlineValue (f);
+  NS_TEST_ASSERT_MSG_EQ (inlineValue.SerializeToString (0), "inline", "Wrong inline Callback string");
+  CallbackValue boundValue (bound);
+  NS_TEST_ASSERT_MSG_EQ (boundValue.SerializeToString (0), boundValue.SerializeToString (0),
+                         "Pimpl Callback string changes between calls");
+
+  // assign through the untyped base, as TracedCallback and CallbackValue do
+  CallbackBase base = a;
+  Callback<void, int> assigned;
+  NS_TEST_ASSERT_MSG_EQ (assigned.CheckType (base), true, "Compatible Callback rejected");
+  Callback<void, double> other;
+  NS_TEST_ASSERT_MSG_EQ (other.CheckType (base), false, "Incompatible Callback accepted");
+  assigned.Assign (base);
+  NS_TEST_ASSERT_MSG_EQ (assigned.IsEqual (a), true, "Assigned Callback differs");
+  assigned (3);
+  NS_TEST_ASSERT_MSG_EQ (m_test1, 3, "Assigned Callback did not fire");
+
+  base = bound;
+  assigned.Assign (base);
+  assigned (4);
+  NS_TEST_ASSERT_MSG_EQ (gEqualityCallbackTest, 8, "Assigned bound Callback did not fire");
+  base = f;
+  assigned.Assign (base);
+  assigned (5);
+  NS_TEST_ASSERT_MSG_EQ (gEqualityCallbackTest, 13, "Assigned function Callback did not fire");
+
+  c (7);
+  NS_TEST_ASSERT_MSG_EQ (m_test2, 7, "Member Callback did not fire");
+  c.Nullify ();
+  NS_TEST_ASSERT_MSG_EQ (c.IsNull (), true, "Nullified Callback reports not IsNull()");
+}
+
 // ===========================================================================
 // Make sure that various MakeCallback template functions compile and execute.
 // Doesn't check an results of the execution.
@@ -704,6 +797,7 @@ CallbackTestSuite::CallbackTestSuite ()
   AddTestCase (new MakeCallbackTestCase, TestCase::QUICK);
   AddTestCase (new MakeBoundCallbackTestCase, TestCase::QUICK);
   AddTestCase (new NullifyCallbackTestCase, TestCase::QUICK);
+  AddTestCase (new EqualityCallbackTestCase, TestCase::QUICK);
   AddTestCase (new MakeCallbackTemplatesTestCase, TestCase::QUICK);
 }
 
@@ -520,6 +520,18 @@ ObjectVectorConfigTestCase::DoRun (void)
 
   obj3->GetAttribute ("A", iv);
   NS_TEST_ASSERT_MSG_EQ (iv.Get (), -16, "Object Attribute \"A\" not set as expected");
+
+  //
+  // A single index is looked up directly in the vector: make sure that it
+  // is found with its path, and that an index past the end matches nothing.
+  //
+  Config::MatchContainer matches = Config::LookupMatches ("/NodeA/NodeB/NodesB/3");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 1U, "Object not found by its index");
+  NS_TEST_ASSERT_MSG_EQ (matches.Get (0), obj3, "Wrong object found by its index");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetMatchedPath (0), "/NodeA/NodeB/NodesB/3/", "Wrong path of the object found by its index");
+
+  matches = Config::LookupMatches ("/NodeA/NodeB/NodesB/4");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 0U, "Unexpectedly found an object past the end of the vector");
 }
 
 // ===========================================================================
@@ -0,0 +1,161 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/log.h"
+#include "ns3/test.h"
+#include <iostream>
+#include <sstream>
+
+/*
+ * Compile this file as a module configured with '--log-level=info':
+ * the function and logic statements are compiled out, whatever the
+ * level selected for the core module.
+ */
+#undef NS3_LOG_COMPILE_LEVEL
+#define NS3_LOG_COMPILE_LEVEL 0x0000000f
+
+NS_LOG_COMPONENT_DEFINE ("LogTestSuite");
+
+using namespace ns3;
+
+namespace {
+
+const enum LogLevel g_levels[] = {
+  LOG_ERROR, LOG_WARN, LOG_DEBUG, LOG_INFO, LOG_FUNCTION, LOG_LOGIC
+};
+const enum LogLevel g_levelMasks[] = {
+  LOG_LEVEL_ERROR, LOG_LEVEL_WARN, LOG_LEVEL_DEBUG, LOG_LEVEL_INFO,
+  LOG_LEVEL_FUNCTION, LOG_LEVEL_LOGIC
+};
+const uint32_t g_nLevels = sizeof (g_levels) / sizeof (g_levels[0]);
+// Index in g_levels of the first level which is compiled out.
+const uint32_t g_firstCompiledOut = 4;
+
+} // anonymous namespace
+
+class LogIsEnabledTestCase : public TestCase
+{
+public:
+  LogIsEnabledTestCase ();
+  virtual void DoRun (void);
+};
+
+LogIsEnabledTestCase::LogIsEnabledTestCase ()
+  : TestCase ("Check that IsEnabled follows the enabled and the compiled log levels")
+{
+}
+
+void
+LogIsEnabledTestCase::DoRun (void)
+{
+  for (uint32_t i = 0; i < g_nLevels; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (NS_LOG_IS_COMPILED (g_levels[i]), (i < g_firstCompiledOut),
+                             "Wrong compiled level " << LogComponent::GetLevelLabel (g_levels[i]));
+    }
+
+  g_log.Disable (LOG_LEVEL_ALL);
+  for (uint32_t i = 0; i < g_nLevels; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (g_log.IsEnabled (g_levels[i]), false,
+                             "Level " << LogComponent::GetLevelLabel (g_levels[i])
+                                      << " enabled after disabling all the levels");
+    }
+
+  for (uint32_t enabled = 0; enabled < g_nLevels; enabled++)
+    {
+      g_log.Disable (LOG_LEVEL_ALL);
+      g_log.Enable (g_levelMasks[enabled]);
+      for (uint32_t i = 0; i < g_nLevels; i++)
+        {
+          bool expected = (i <= enabled) && (i < g_firstCompiledOut);
+          NS_TEST_ASSERT_MSG_EQ (g_log.IsEnabled (g_levels[i]), expected,
+                                 "Wrong state of level " << LogComponent::GetLevelLabel (g_levels[i])
+                                                         << " with mask " << enabled);
+        }
+    }
+
+  // Neither the component nor the global helpers enable a compiled out level.
+  g_log.Disable (LOG_LEVEL_ALL);
+  LogComponentEnable ("LogTestSuite", LOG_LEVEL_ALL);
+  for (uint32_t i = 0; i < g_nLevels; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (g_log.IsEnabled (g_levels[i]), (i < g_firstCompiledOut),
+                             "Wrong state of level " << LogComponent::GetLevelLabel (g_levels[i])
+                                                     << " after enabling all the levels");
+    }
+  g_log.Disable (LOG_LEVEL_ALL);
+}
+
+class LogCompiledOutTestCase : public TestCase
+{
+public:
+  LogCompiledOutTestCase ();
+  virtual void DoRun (void);
+  uint32_t Count (void);
+  uint32_t m_count;
+};
+
+LogCompiledOutTestCase::LogCompiledOutTestCase ()
+  : TestCase ("Check that the statements of a compiled out level are not evaluated")
+{
+}
+
+uint32_t
+LogCompiledOutTestCase::Count (void)
+{
+  return ++m_count;
+}
+
+void
+LogCompiledOutTestCase::DoRun (void)
+{
+#ifdef NS3_LOG_ENABLE
+  std::ostringstream output;
+  std::streambuf *saved = std::clog.rdbuf (output.rdbuf ());
+
+  m_count = 0;
+  g_log.Disable (LOG_LEVEL_ALL);
+  NS_LOG_INFO ("disabled " << Count ());
+  NS_LOG_LOGIC ("disabled " << Count ());
+  uint32_t disabledCount = m_count;
+
+  g_log.Enable (LOG_LEVEL_ALL);
+  NS_LOG_INFO ("enabled " << Count ());
+  NS_LOG_LOGIC ("compiled out " << Count ());
+  uint32_t enabledCount = m_count;
+  g_log.Disable (LOG_LEVEL_ALL);
+
+  std::clog.rdbuf (saved);
+
+  NS_TEST_ASSERT_MSG_EQ (disabledCount, 0U, "A disabled statement was evaluated");
+  NS_TEST_ASSERT_MSG_EQ (enabledCount, 1U, "Wrong number of evaluated statements");
+  NS_TEST_ASSERT_MSG_EQ ((output.str ().find ("enabled 1") != std::string::npos), true,
+                         "The enabled statement was not printed");
+  NS_TEST_ASSERT_MSG_EQ ((output.str ().find ("compiled out") == std::string::npos), true,
+                         "The compiled out statement was printed");
+#endif /* NS3_LOG_ENABLE */
+}
+
+static class LogTestSuite : public TestSuite
+{
+public:
+  LogTestSuite ()
+    : TestSuite ("log", UNIT)
+  {
+    AddTestCase (new LogIsEnabledTestCase (), TestCase::QUICK);
+    AddTestCase (new LogCompiledOutTestCase (), TestCase::QUICK);
+  }
+} g_logTestSuite;
@@ -16,6 +16,8 @@
 
 #include "ns3/test.h"
 #include "ns3/names.h"
+#include <sstream>
+#include <vector>
 
 using namespace ns3;
 
@@ -919,6 +921,79 @@ AlternateFindTestCase::DoRun (void)
                          "Unexpectedly able to GetObject<TestObject> on an AlternateTestObject");
 }
 
+// ===========================================================================
+// Test case to make sure that the fully qualified paths of the descendants
+// of a renamed Object follow its new name, and that many names can be added
+// and found by path and by Object.
+// ===========================================================================
+class RenamedPathFindTestCase : public TestCase
+{
+public:
+  RenamedPathFindTestCase ();
+  virtual ~RenamedPathFindTestCase ();
+
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+};
+
+RenamedPathFindTestCase::RenamedPathFindTestCase ()
+  : TestCase ("Check Names::Find and Names::FindPath after renaming a parent")
+{
+}
+
+RenamedPathFindTestCase::~RenamedPathFindTestCase ()
+{
+}
+
+void
+RenamedPathFindTestCase::DoTeardown (void)
+{
+  Names::Clear ();
+}
+
+void
+RenamedPathFindTestCase::DoRun (void)
+{
+  Ptr<TestObject> parent = CreateObject<TestObject> ();
+  Names::Add ("Parent", parent);
+
+  Ptr<TestObject> child = CreateObject<TestObject> ();
+  Names::Add ("Parent/Child", child);
+
+  Ptr<TestObject> grandChild = CreateObject<TestObject> ();
+  Names::Add ("Parent/Child/Grand Child", grandChild);
+
+  Names::Rename ("Parent", "New Parent");
+
+  NS_TEST_ASSERT_MSG_EQ (Names::Find<TestObject> ("/Names/New Parent/Child/Grand Child"), grandChild,
+                         "Could not Names::Find a descendant of a renamed Object");
+  NS_TEST_ASSERT_MSG_EQ (Names::Find<TestObject> ("Parent/Child/Grand Child"), 0,
+                         "Unexpectedly found a descendant under the old name");
+  NS_TEST_ASSERT_MSG_EQ (Names::Find<TestObject> (parent, "Child"), child,
+                         "Could not Names::Find a child of a renamed Object");
+  NS_TEST_ASSERT_MSG_EQ (Names::FindPath (grandChild), "/Names/New Parent/Child/Grand Child",
+                         "Wrong path of a descendant of a renamed Object");
+
+  std::vector<Ptr<TestObject> > objects;
+  for (uint32_t i = 0; i < 1000; ++i)
+    {
+      std::ostringstream oss;
+      oss << "Object" << i;
+      objects.push_back (CreateObject<TestObject> ());
+      Names::Add ("New Parent/Child", oss.str (), objects.back ());
+    }
+  for (uint32_t i = 0; i < objects.size (); ++i)
+    {
+      std::ostringstream oss;
+      oss << "/Names/New Parent/Child/Object" << i;
+      NS_TEST_ASSERT_MSG_EQ (Names::Find<TestObject> (oss.str ()), objects[i], "Could not Names::Find " << oss.str ());
+      NS_TEST_ASSERT_MSG_EQ (Names::FindPath (objects[i]), oss.str (), "Wrong path of " << oss.str ());
+    }
+  NS_TEST_ASSERT_MSG_EQ (Names::FindPath (grandChild), "/Names/New Parent/Child/Grand Child",
+                         "Lost the path of an Object while adding others");
+}
+
 class NamesTestSuite : public TestSuite
 {
 public:
@@ -942,6 +1017,7 @@ NamesTestSuite::NamesTestSuite ()
   AddTestCase (new FullyQualifiedFindTestCase, TestCase::QUICK);
   AddTestCase (new RelativeFindTestCase, TestCase::QUICK);
   AddTestCase (new AlternateFindTestCase, TestCase::QUICK);
+  AddTestCase (new RenamedPathFindTestCase, TestCase::QUICK);
 }
 
 static NamesTestSuite namesTestSuite;
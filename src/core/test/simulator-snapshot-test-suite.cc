@@ -0,0 +1,119 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/simulator-snapshot.h"
+#include "ns3/random-variable-stream.h"
+
+#include <unistd.h>
+
+using namespace ns3;
+
+class SimulatorSnapshotTestCase : public TestCase
+{
+public:
+  SimulatorSnapshotTestCase ();
+private:
+  virtual void DoRun (void);
+  void Count (void);
+  uint32_t m_count;
+};
+
+SimulatorSnapshotTestCase::SimulatorSnapshotTestCase ()
+  : TestCase ("Restore the pending events and random streams of a snapshot")
+{
+}
+
+void
+SimulatorSnapshotTestCase::Count (void)
+{
+  m_count++;
+}
+
+void
+SimulatorSnapshotTestCase::DoRun (void)
+{
+  m_count = 0;
+  for (uint32_t i = 1; i <= 10; ++i)
+    {
+      Simulator::Schedule (Seconds (i), &SimulatorSnapshotTestCase::Count, this);
+    }
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  Simulator::Stop (Seconds (5.5));
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (m_count, 5, "Events before the snapshot were not run");
+
+  // The third restored process waits for the fourth one, which it
+  // can only hear from if both run at the same time.
+  int handshake[2];
+  NS_TEST_ASSERT_MSG_EQ (pipe (handshake), 0, "pipe() failed");
+
+  SimulatorSnapshot snapshot;
+  uint32_t restored = snapshot.Save ();
+  if (restored != 0)
+    {
+      // A restored process: report the next random value as exit status
+      // if the remaining events are run.
+      Simulator::Run ();
+      bool ok = m_count == 10 && Simulator::Now () == Seconds (10);
+      char byte = 0;
+      if (restored == 3)
+        {
+          alarm (10);
+          ok = ok && read (handshake[0], &byte, 1) == 1;
+        }
+      else if (restored == 4)
+        {
+          ok = ok && write (handshake[1], &byte, 1) == 1;
+        }
+      uint32_t value = rng->GetInteger (0, 199);
+      Simulator::Destroy ();
+      _exit (ok ? value : 255);
+    }
+  NS_TEST_ASSERT_MSG_EQ (snapshot.IsSaved (), true, "Snapshot was not saved");
+  NS_TEST_ASSERT_MSG_EQ (snapshot.GetTime (), Seconds (5.5), "Wrong snapshot time");
+
+  // The changes made after the snapshot are not seen by the restored processes.
+  m_count = 1000;
+  int first = snapshot.Restore ();
+  int second = snapshot.Restore ();
+  int value = rng->GetInteger (0, 199);
+  NS_TEST_EXPECT_MSG_EQ (first, value, "First restored process diverged");
+  NS_TEST_EXPECT_MSG_EQ (second, value, "Second restored process diverged");
+  pid_t third = snapshot.Spawn ();
+  pid_t fourth = snapshot.Spawn ();
+  NS_TEST_EXPECT_MSG_EQ (snapshot.Wait (fourth), value, "Fourth restored process diverged");
+  NS_TEST_EXPECT_MSG_EQ (snapshot.Wait (third), value, "Restored processes did not run concurrently");
+  close (handshake[0]);
+  close (handshake[1]);
+  snapshot.Discard ();
+  NS_TEST_EXPECT_MSG_EQ (snapshot.IsSaved (), false, "Snapshot was not discarded");
+
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_count, 1005, "Events after the snapshot were not run");
+  Simulator::Destroy ();
+}
+
+class SimulatorSnapshotTestSuite : public TestSuite
+{
+public:
+  SimulatorSnapshotTestSuite ()
+    : TestSuite ("simulator-snapshot")
+  {
+    AddTestCase (new SimulatorSnapshotTestCase (), TestCase::QUICK);
+  }
+} g_simulatorSnapshotTestSuite;
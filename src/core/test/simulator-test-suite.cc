@@ -23,6 +23,9 @@
 #include "ns3/heap-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
+#include "ns3/ladder-scheduler.h"
+#include "ns3/random-variable-stream.h"
+#include <vector>
 
 using namespace ns3;
 
@@ -168,6 +171,149 @@ SimulatorEventsTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (m_destroy, true, "Event should have run");
 }
 
+class SchedulerOrderTestCase : public TestCase
+{
+public:
+  SchedulerOrderTestCase (ObjectFactory schedulerFactory);
+  virtual void DoRun (void);
+  Ptr<UniformRandomVariable> m_random;
+  ObjectFactory m_schedulerFactory;
+};
+
+SchedulerOrderTestCase::SchedulerOrderTestCase (ObjectFactory schedulerFactory)
+  : TestCase ("Check that a large event set is ordered correctly with " +
+              schedulerFactory.GetTypeId ().GetName ()),
+    m_schedulerFactory (schedulerFactory)
+{
+}
+void
+SchedulerOrderTestCase::DoRun (void)
+{
+  m_random = CreateObject<UniformRandomVariable> ();
+  m_random->SetStream (1);
+  Ptr<Scheduler> scheduler = m_schedulerFactory.Create<Scheduler> ();
+  std::vector<Scheduler::Event> removable;
+  uint32_t uid = 0;
+  uint32_t n = 0;
+  Scheduler::Event ev;
+  ev.impl = 0;
+  ev.key.m_context = 0;
+  // a wide spread of timestamps, with many duplicates.
+  for (uint32_t i = 0; i < 4000; i++)
+    {
+      ev.key.m_ts = m_random->GetInteger (0, 0x7fff) * (i % 3);
+      ev.key.m_uid = uid++;
+      scheduler->Insert (ev);
+      n++;
+      if (i % 7 == 0)
+        {
+          removable.push_back (ev);
+        }
+    }
+  for (std::vector<Scheduler::Event>::const_iterator i = removable.begin ();
+       i != removable.end (); ++i)
+    {
+      scheduler->Remove (*i);
+      n--;
+    }
+  Scheduler::EventKey last = { 0, 0, 0 };
+  while (!scheduler->IsEmpty ())
+    {
+      Scheduler::Event peek = scheduler->PeekNext ();
+      Scheduler::Event next = scheduler->RemoveNext ();
+      n--;
+      NS_TEST_ASSERT_MSG_EQ (peek.key.m_uid, next.key.m_uid, "PeekNext and RemoveNext disagree");
+      NS_TEST_ASSERT_MSG_EQ ((next.key < last), false, "Events removed out of order");
+      last = next.key;
+      // keep scheduling events in the near and far future of the
+      // current event, as a simulation would.
+      if (last.m_uid % 2 == 0 && uid < 12000)
+        {
+          ev.key.m_ts = last.m_ts + m_random->GetInteger (0, 3);
+          ev.key.m_uid = uid++;
+          scheduler->Insert (ev);
+          ev.key.m_ts = last.m_ts + m_random->GetInteger (0, 0x7fff) * 10;
+          ev.key.m_uid = uid++;
+          scheduler->Insert (ev);
+          n += 2;
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (n, 0, "Events were lost");
+}
+
+class EventBatchTestCase : public TestCase
+{
+public:
+  EventBatchTestCase (ObjectFactory schedulerFactory);
+  virtual void DoRun (void);
+  void Record (uint32_t id, uint32_t context, uint64_t ts);
+  void ScheduleNested (void);
+  std::vector<uint32_t> m_order;
+  uint32_t m_errors;
+  ObjectFactory m_schedulerFactory;
+};
+
+EventBatchTestCase::EventBatchTestCase (ObjectFactory schedulerFactory)
+  : TestCase ("Check that event batches run in order with " +
+              schedulerFactory.GetTypeId ().GetName ()),
+    m_errors (0),
+    m_schedulerFactory (schedulerFactory)
+{
+}
+void
+EventBatchTestCase::Record (uint32_t id, uint32_t context, uint64_t ts)
+{
+  if (Simulator::GetContext () != context
+      || Simulator::Now ().GetNanoSeconds () != (int64_t)ts)
+    {
+      m_errors++;
+    }
+  m_order.push_back (id);
+}
+void
+EventBatchTestCase::ScheduleNested (void)
+{
+  EventBatch batch;
+  batch.Add (200, NanoSeconds (1), MakeEvent (&EventBatchTestCase::Record, this, 8, 200, 21));
+  batch.Add (201, NanoSeconds (0), MakeEvent (&EventBatchTestCase::Record, this, 9, 201, 20));
+  Simulator::ScheduleBatch (batch);
+}
+void
+EventBatchTestCase::DoRun (void)
+{
+  Simulator::SetScheduler (m_schedulerFactory);
+
+  Simulator::ScheduleWithContext (100, NanoSeconds (10), &EventBatchTestCase::Record, this, 0, 100, 10);
+  EventBatch batch;
+  uint64_t delays[] = { 10, 10, 5, 20, 10, 5 };
+  for (uint32_t i = 0; i < 6; i++)
+    {
+      batch.Add (101 + i, NanoSeconds (delays[i]),
+                 MakeEvent (&EventBatchTestCase::Record, this, i + 1, 101 + i, delays[i]));
+    }
+  NS_TEST_EXPECT_MSG_EQ (batch.GetN (), 6, "Events were not added to the batch");
+  Simulator::ScheduleBatch (batch);
+  NS_TEST_EXPECT_MSG_EQ (batch.IsEmpty (), true, "Batch not released once scheduled");
+  Simulator::ScheduleWithContext (107, NanoSeconds (10), &EventBatchTestCase::Record, this, 7, 107, 10);
+  Simulator::Schedule (NanoSeconds (20), &EventBatchTestCase::ScheduleNested, this);
+
+  // events which are never scheduled are released by the batch.
+  EventBatch unused;
+  unused.Add (0, Seconds (1), MakeEvent (&EventBatchTestCase::ScheduleNested, this));
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  // events with the same timestamp run in the order they were scheduled.
+  uint32_t expected[] = { 3, 6, 0, 1, 2, 5, 7, 4, 9, 8 };
+  NS_TEST_ASSERT_MSG_EQ (m_order.size (), 10, "Events were lost");
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_order[i], expected[i], "Events run out of order");
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_errors, 0, "Events run with the wrong context or time");
+}
+
 class SimulatorTemplateTestCase : public TestCase
 {
 public:
@@ -475,5 +621,21 @@ public:
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (CalendarScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+
+    std::string schedulerTypes[] = {
+      "ns3::ListScheduler",
+      "ns3::MapScheduler",
+      "ns3::HeapScheduler",
+      "ns3::CalendarScheduler",
+      "ns3::LadderScheduler"
+    };
+    for (unsigned int i = 0; i < (sizeof(schedulerTypes) / sizeof(schedulerTypes[0])); ++i)
+      {
+        factory.SetTypeId (schedulerTypes[i]);
+        AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+        AddTestCase (new EventBatchTestCase (factory), TestCase::QUICK);
+      }
   }
 } g_simulatorTestSuite;
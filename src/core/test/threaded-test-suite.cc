@@ -26,10 +26,15 @@
 #include "ns3/config.h"
 #include "ns3/string.h"
 #include "ns3/system-thread.h"
+#include "ns3/system-mutex.h"
+#include "ns3/event-batch.h"
+#include "ns3/make-event.h"
 
+#include <algorithm>
 #include <ctime>
 #include <list>
 #include <utility>
+#include <vector>
 
 using namespace ns3;
 
@@ -225,6 +230,262 @@ ThreadedSimulatorEventsTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (m_a, m_d, "Bad scheduling");
 }
 
+class ThreadedSimulatorOrderTestCase : public TestCase
+{
+public:
+  ThreadedSimulatorOrderTestCase ();
+  void Record (uint32_t i);
+  void StartThread (void);
+  void SchedulingThread (void);
+  std::vector<uint32_t> m_order;
+
+private:
+  virtual void DoRun (void);
+};
+
+ThreadedSimulatorOrderTestCase::ThreadedSimulatorOrderTestCase ()
+  : TestCase ("Check that events scheduled from another thread run in the order they were scheduled")
+{
+}
+
+void
+ThreadedSimulatorOrderTestCase::Record (uint32_t i)
+{
+  m_order.push_back (i);
+}
+
+void
+ThreadedSimulatorOrderTestCase::SchedulingThread (void)
+{
+  for (uint32_t i = 0; i < 100; ++i)
+    {
+      Simulator::ScheduleWithContext (i, Seconds (0),
+                                      &ThreadedSimulatorOrderTestCase::Record, this, i);
+    }
+  EventBatch batch;
+  for (uint32_t i = 100; i < 110; ++i)
+    {
+      batch.Add (i, Seconds (0), MakeEvent (&ThreadedSimulatorOrderTestCase::Record, this, i));
+    }
+  Simulator::ScheduleBatch (batch);
+  for (uint32_t i = 110; i < 120; ++i)
+    {
+      Simulator::ScheduleWithContext (i, Seconds (0),
+                                      &ThreadedSimulatorOrderTestCase::Record, this, i);
+    }
+}
+
+void
+ThreadedSimulatorOrderTestCase::StartThread (void)
+{
+  Ptr<SystemThread> thread = Create<SystemThread> (MakeCallback (&ThreadedSimulatorOrderTestCase::SchedulingThread, this));
+  thread->Start ();
+  thread->Join ();
+}
+
+void
+ThreadedSimulatorOrderTestCase::DoRun (void)
+{
+  Simulator::Schedule (MicroSeconds (1), &ThreadedSimulatorOrderTestCase::StartThread, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_order.size (), 120, "Missing events");
+  for (uint32_t i = 0; i < m_order.size (); ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_order[i], i, "Events run out of order");
+    }
+}
+
+// Arguments of several sizes, whose events fall in different size
+// classes of the EventImpl storage pool, and beyond the largest class.
+template <int N>
+struct EventPoolPayload
+{
+  uint32_t words[N];
+};
+
+class ThreadedEventPoolTestCase : public TestCase
+{
+public:
+  ThreadedEventPoolTestCase ();
+  template <int N>
+  void Record (EventPoolPayload<N> payload);
+  EventImpl *MakeSizedEvent (uint32_t id);
+  void StartThreads (void);
+  static void SchedulingThread (std::pair<ThreadedEventPoolTestCase *, uint32_t> context);
+  SystemMutex m_mutex;
+  std::vector<uint32_t> m_ran;
+  uint32_t m_errors;
+
+private:
+  virtual void DoRun (void);
+};
+
+ThreadedEventPoolTestCase::ThreadedEventPoolTestCase ()
+  : TestCase ("Check that recycled event storage runs the right events"),
+    m_errors (0)
+{
+}
+
+template <int N>
+void
+ThreadedEventPoolTestCase::Record (EventPoolPayload<N> payload)
+{
+  CriticalSection cs (m_mutex);
+  for (int i = 1; i < N; ++i)
+    {
+      if (payload.words[i] != payload.words[0] + i)
+        {
+          m_errors++;
+        }
+    }
+  m_ran.push_back (payload.words[0]);
+}
+
+EventImpl *
+ThreadedEventPoolTestCase::MakeSizedEvent (uint32_t id)
+{
+  switch (id % 4)
+    {
+    case 0:
+      {
+        EventPoolPayload<1> payload = { { id } };
+        return MakeEvent (&ThreadedEventPoolTestCase::Record<1>, this, payload);
+      }
+    case 1:
+      {
+        EventPoolPayload<8> payload;
+        for (int i = 0; i < 8; ++i)
+          {
+            payload.words[i] = id + i;
+          }
+        return MakeEvent (&ThreadedEventPoolTestCase::Record<8>, this, payload);
+      }
+    case 2:
+      {
+        EventPoolPayload<30> payload;
+        for (int i = 0; i < 30; ++i)
+          {
+            payload.words[i] = id + i;
+          }
+        return MakeEvent (&ThreadedEventPoolTestCase::Record<30>, this, payload);
+      }
+    default:
+      {
+        EventPoolPayload<100> payload;
+        for (int i = 0; i < 100; ++i)
+          {
+            payload.words[i] = id + i;
+          }
+        return MakeEvent (&ThreadedEventPoolTestCase::Record<100>, this, payload);
+      }
+    }
+}
+
+void
+ThreadedEventPoolTestCase::SchedulingThread (std::pair<ThreadedEventPoolTestCase *, uint32_t> context)
+{
+  ThreadedEventPoolTestCase *me = context.first;
+  uint32_t threadno = context.second;
+
+  // Each thread runs, drops and schedules events of all sizes: the
+  // storage of the dropped events is reused by the next ones in the pool
+  // of the thread, and that of the scheduled ones is released by the
+  // main thread.
+  for (uint32_t k = 0; k < 600; ++k)
+    {
+      uint32_t id = 1000000 * (threadno + 1) + 1000 * k;
+      EventImpl *event = me->MakeSizedEvent (id + k % 4);
+      switch (k % 3)
+        {
+        case 0:
+          event->Invoke ();
+          event->Unref ();
+          break;
+        case 1:
+          event->Unref ();
+          break;
+        default:
+          Simulator::ScheduleWithContext (threadno, MicroSeconds (k % 7), event);
+          break;
+        }
+    }
+}
+
+void
+ThreadedEventPoolTestCase::StartThreads (void)
+{
+  std::vector<Ptr<SystemThread> > threads;
+  for (uint32_t i = 0; i < 4; ++i)
+    {
+      threads.push_back (Create<SystemThread> (MakeBoundCallback (&ThreadedEventPoolTestCase::SchedulingThread,
+                                                                  std::make_pair (this, i))));
+      threads.back ()->Start ();
+    }
+  for (uint32_t i = 0; i < threads.size (); ++i)
+    {
+      threads[i]->Join ();
+    }
+}
+
+void
+ThreadedEventPoolTestCase::DoRun (void)
+{
+  std::vector<uint32_t> expected;
+
+  // Cancel and remove some of the events of the main thread, so that the
+  // storage of the removed ones is reused by the events scheduled next.
+  std::vector<EventId> ids;
+  for (uint32_t id = 0; id < 2000; ++id)
+    {
+      ids.push_back (Simulator::Schedule (MicroSeconds (id % 50), Ptr<EventImpl> (MakeSizedEvent (id), false)));
+    }
+  for (uint32_t id = 0; id < 2000; ++id)
+    {
+      if (id % 5 == 1)
+        {
+          Simulator::Cancel (ids[id]);
+        }
+      else if (id % 5 == 2)
+        {
+          Simulator::Remove (ids[id]);
+        }
+      else
+        {
+          expected.push_back (id);
+        }
+    }
+  for (uint32_t id = 2000; id < 4000; ++id)
+    {
+      Simulator::Schedule (MicroSeconds (id % 50), Ptr<EventImpl> (MakeSizedEvent (id), false));
+      expected.push_back (id);
+    }
+
+  Simulator::Schedule (MicroSeconds (1), &ThreadedEventPoolTestCase::StartThreads, this);
+  for (uint32_t threadno = 0; threadno < 4; ++threadno)
+    {
+      for (uint32_t k = 0; k < 600; ++k)
+        {
+          if (k % 3 != 1)
+            {
+              expected.push_back (1000000 * (threadno + 1) + 1000 * k + k % 4);
+            }
+        }
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_errors, 0, "Events ran with corrupted arguments");
+  std::sort (m_ran.begin (), m_ran.end ());
+  std::sort (expected.begin (), expected.end ());
+  NS_TEST_ASSERT_MSG_EQ (m_ran.size (), expected.size (), "Wrong number of events run");
+  for (uint32_t i = 0; i < m_ran.size (); ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_ran[i], expected[i], "Wrong event run");
+    }
+}
+
 class ThreadedSimulatorTestSuite : public TestSuite
 {
 public:
@@ -241,7 +502,8 @@ public:
       "ns3::ListScheduler",
       "ns3::HeapScheduler",
       "ns3::MapScheduler",
-      "ns3::CalendarScheduler"
+      "ns3::CalendarScheduler",
+      "ns3::LadderScheduler"
     };
     unsigned int threadcounts[] = {
       0,
@@ -262,5 +524,7 @@ public:
               }
           }
       }
+    AddTestCase (new ThreadedSimulatorOrderTestCase (), TestCase::QUICK);
+    AddTestCase (new ThreadedEventPoolTestCase (), TestCase::QUICK);
   }
 } g_threadedSimulatorTestSuite;
@@ -222,6 +222,7 @@ CsmaChannel::TransmitEnd ()
 
   NS_LOG_LOGIC ("Receive");
 
+  EventBatch receptions;
   std::vector<CsmaDeviceRec>::iterator it;
   uint32_t devId = 0;
   for (it = m_deviceList.begin (); it < m_deviceList.end (); it++)
@@ -229,13 +230,14 @@ CsmaChannel::TransmitEnd ()
       if (it->IsActive ())
         {
           // schedule reception events
-          Simulator::ScheduleWithContext (it->devicePtr->GetNode ()->GetId (),
-                                          m_delay,
-                                          &CsmaNetDevice::Receive, it->devicePtr,
-                                          m_currentPkt->Copy (), m_deviceList[m_currentSrc].devicePtr);
+          receptions.Add (it->devicePtr->GetNode ()->GetId (),
+                          m_delay,
+                          MakeEvent (&CsmaNetDevice::Receive, it->devicePtr,
+                                     m_currentPkt->Copy (), m_deviceList[m_currentSrc].devicePtr));
         }
       devId++;
     }
+  Simulator::ScheduleBatch (receptions);
 
   // also schedule for the tx side to go back to IDLE
   Simulator::Schedule (m_delay, &CsmaChannel::PropagationCompleteEvent,
@@ -30,6 +30,7 @@
 #include "ns3/uinteger.h"
 #include "ns3/pointer.h"
 #include "ns3/trace-source-accessor.h"
+#include "ns3/packet-burst.h"
 #include "csma-net-device.h"
 #include "csma-channel.h"
 
@@ -993,6 +994,48 @@ CsmaNetDevice::SendFrom (Ptr<Packet> packet, const Address& src, const Address&
   return true;
 }
 
+bool
+CsmaNetDevice::SendBurst (Ptr<PacketBurst> burst, const Address& dest, uint16_t protocolNumber)
+{
+  NS_LOG_FUNCTION (burst << dest << protocolNumber);
+
+  NS_ASSERT (IsLinkUp ());
+
+  Mac48Address destination = Mac48Address::ConvertFrom (dest);
+  bool ok = true;
+  for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin (); i != burst->End (); ++i)
+    {
+      Ptr<Packet> packet = *i;
+      if (IsSendEnabled () == false)
+        {
+          m_macTxDropTrace (packet);
+          ok = false;
+          continue;
+        }
+      AddHeader (packet, m_address, destination, protocolNumber);
+      m_macTxTrace (packet);
+      if (m_queue->Enqueue (packet) == false)
+        {
+          m_macTxDropTrace (packet);
+          ok = false;
+        }
+    }
+
+  //
+  // Start a single transmission for the whole burst; the next packets are
+  // sent from TransmitCompleteEvent.
+  //
+  if (m_txMachineState == READY && m_queue->IsEmpty () == false)
+    {
+      m_currentPkt = m_queue->Dequeue ();
+      NS_ASSERT_MSG (m_currentPkt != 0, "CsmaNetDevice::SendBurst(): IsEmpty false but no Packet on queue?");
+      m_promiscSnifferTrace (m_currentPkt);
+      m_snifferTrace (m_currentPkt);
+      TransmitStart ();
+    }
+  return ok;
+}
+
 Ptr<Node>
 CsmaNetDevice::GetNode (void) const
 {
@@ -278,6 +278,16 @@ public:
   virtual bool SendFrom (Ptr<Packet> packet, const Address& source, const Address& dest, 
                          uint16_t protocolNumber);
 
+  /**
+   * Start sending several packets down the channel.  The packets are
+   * all queued before a transmission is started.
+   * \param burst packets to send
+   * \param dest layer 2 destination address
+   * \param protocolNumber protocol number
+   * \return true if all the packets were queued, false otherwise (drop, ...)
+   */
+  virtual bool SendBurst (Ptr<PacketBurst> burst, const Address& dest, uint16_t protocolNumber);
+
   /**
    * Get the node to which this device is attached.
    *
@@ -80,6 +80,9 @@ public:
    * Users must first call PopulateRoutingTables() and then may subsequently
    * call RecomputeRoutingTables() at any later time in the simulation.
    *
+   * If the "GlobalRoutingIncremental" global value is true, only the
+   * routing tables affected by the changes of the topology are updated.
+   *
    */
   static void RecomputeRoutingTables (void);
 private:
@@ -27,6 +27,9 @@
 #include <queue>
 #include <algorithm>
 #include <iostream>
+#include <functional>
+#include <iterator>
+#include <set>
 #include "ns3/assert.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
@@ -35,15 +38,44 @@
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/ipv4-list-routing.h"
 #include "ns3/mpi-interface.h"
+#include "ns3/global-value.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
 #include "global-router-interface.h"
 #include "global-route-manager-impl.h"
 #include "candidate-queue.h"
 #include "ipv4-global-routing.h"
+#include "ipv4-routing-table-entry.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#include "ns3/system-mutex.h"
+#endif /* HAVE_PTHREAD_H */
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("GlobalRouteManagerImpl");
 
+/// The number of threads which run the SPF calculations of the routers.
+static GlobalValue g_globalRoutingThreads = GlobalValue ("GlobalRoutingThreads",
+                                                         "The number of threads computing the global routes; 1 computes them in the main thread",
+                                                         UintegerValue (1),
+                                                         MakeUintegerChecker<uint32_t> (1));
+
+/// Whether GlobalRouteManager::RecomputeRoutes updates the routes incrementally.
+static GlobalValue g_globalRoutingIncremental = GlobalValue ("GlobalRoutingIncremental",
+                                                             "Only compute again the global routes affected by a topology change",
+                                                             BooleanValue (false),
+                                                             MakeBooleanChecker ());
+
+#ifdef HAVE_PTHREAD_H
+struct GlobalRouteManagerImpl::SPFWork
+{
+  std::vector<SPFRouter> const *routers; //!< the routers to compute
+  uint32_t next; //!< the index of the next router to compute
+  SystemMutex mutex; //!< protects next
+};
+#endif /* HAVE_PTHREAD_H */
+
 /**
  * \brief Stream insertion operator.
  *
@@ -446,6 +478,8 @@ GlobalRouteManagerLSDB::~GlobalRouteManagerLSDB ()
     }
   NS_LOG_LOGIC ("clear map");
   m_database.clear ();
+  m_lsas.clear ();
+  m_linkDataIndex.clear ();
 }
 
 void
@@ -468,9 +502,27 @@ GlobalRouteManagerLSDB::Insert (Ipv4Address addr, GlobalRoutingLSA* lsa)
     {
       m_extdatabase.push_back (lsa);
     } 
-  else
+  else if (m_database.insert (LSDBPair_t (addr, lsa)).second)
     {
-      m_database.insert (LSDBPair_t (addr, lsa));
+      m_lsas.push_back (lsa);
+//
+// Index the LinkData of the TransitNetwork records.  When several LSAs have
+// the same LinkData, GetLSAByLinkData returns the one with the lowest address.
+//
+      for (uint32_t j = 0; j < lsa->GetNLinkRecords (); j++)
+        {
+          GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
+          if (lr->GetLinkType () != GlobalRoutingLinkRecord::TransitNetwork)
+            {
+              continue;
+            }
+          std::pair<LSDBMap_t::iterator, bool> ret =
+            m_linkDataIndex.insert (LSDBPair_t (lr->GetLinkData (), lsa));
+          if (!ret.second && addr < ret.first->second->GetLinkStateId ())
+            {
+              ret.first->second = lsa;
+            }
+        }
     }
 }
 
@@ -495,13 +547,10 @@ GlobalRouteManagerLSDB::GetLSA (Ipv4Address addr) const
 //
 // Look up an LSA by its address.
 //
-  LSDBMap_t::const_iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  LSDBMap_t::const_iterator i = m_database.find (addr);
+  if (i != m_database.end ())
     {
-      if (i->first == addr)
-        {
-          return i->second;
-        }
+      return i->second;
     }
   return 0;
 }
@@ -511,26 +560,30 @@ GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
 {
   NS_LOG_FUNCTION (this << addr);
 //
-// Look up an LSA by its address.
+// Look up an LSA by the LinkData of one of its TransitNetwork records.
 //
-  LSDBMap_t::const_iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  LSDBMap_t::const_iterator i = m_linkDataIndex.find (addr);
+  if (i != m_linkDataIndex.end ())
     {
-      GlobalRoutingLSA* temp = i->second;
-// Iterate among temp's Link Records
-      for (uint32_t j = 0; j < temp->GetNLinkRecords (); j++)
-        {
-          GlobalRoutingLinkRecord *lr = temp->GetLinkRecord (j);
-          if ( lr->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork &&
-               lr->GetLinkData () == addr)
-            {
-              return temp;
-            }
-        }
+      return i->second;
     }
   return 0;
 }
 
+uint32_t
+GlobalRouteManagerLSDB::GetNumLSAs () const
+{
+  NS_LOG_FUNCTION (this);
+  return m_lsas.size ();
+}
+
+GlobalRoutingLSA*
+GlobalRouteManagerLSDB::GetLSAByIndex (uint32_t index) const
+{
+  NS_LOG_FUNCTION (this << index);
+  return m_lsas.at (index);
+}
+
 // ---------------------------------------------------------------------------
 //
 // GlobalRouteManagerImpl Implementation
@@ -539,16 +592,27 @@ GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
 
 GlobalRouteManagerImpl::GlobalRouteManagerImpl () 
   :
-    m_spfroot (0)
+    m_spfroot (0),
+    m_work (0)
 {
   NS_LOG_FUNCTION (this);
   m_lsdb = new GlobalRouteManagerLSDB ();
 }
 
+GlobalRouteManagerImpl::GlobalRouteManagerImpl (GlobalRouteManagerLSDB *lsdb, SPFWork *work)
+  :
+    m_spfroot (0),
+    m_lsdb (lsdb),
+    m_work (work)
+{
+  NS_LOG_FUNCTION (this << lsdb << work);
+}
+
 GlobalRouteManagerImpl::~GlobalRouteManagerImpl ()
 {
   NS_LOG_FUNCTION (this);
-  if (m_lsdb)
+  // A worker does not own the database.
+  if (m_lsdb && m_work == 0)
     {
       delete m_lsdb;
     }
@@ -567,6 +631,19 @@ GlobalRouteManagerImpl::DebugUseLsdb (GlobalRouteManagerLSDB* lsdb)
 
 void
 GlobalRouteManagerImpl::DeleteGlobalRoutes ()
+{
+  NS_LOG_FUNCTION (this);
+  DeleteRoutes ();
+  if (m_lsdb)
+    {
+      NS_LOG_LOGIC ("Deleting LSDB, creating new one");
+      delete m_lsdb;
+      m_lsdb = new GlobalRouteManagerLSDB ();
+    }
+}
+
+void
+GlobalRouteManagerImpl::DeleteRoutes ()
 {
   NS_LOG_FUNCTION (this);
   NodeList::Iterator listEnd = NodeList::End ();
@@ -592,12 +669,6 @@ GlobalRouteManagerImpl::DeleteGlobalRoutes ()
         }
       NS_LOG_LOGIC ("Deleted " << j << " global routes from node "<< node->GetId ());
     }
-  if (m_lsdb)
-    {
-      NS_LOG_LOGIC ("Deleting LSDB, creating new one");
-      delete m_lsdb;
-      m_lsdb = new GlobalRouteManagerLSDB ();
-    }
 }
 
 //
@@ -700,6 +771,21 @@ GlobalRouteManagerImpl::InitializeRoutes ()
 // Walk the list of nodes in the system.
 //
   NS_LOG_INFO ("About to start SPF calculation");
+  std::vector<SPFRouter> routers;
+  GetSPFRouters (routers);
+  SPFCalculate (routers);
+  NS_LOG_INFO ("Finished SPF calculation");
+}
+
+void
+GlobalRouteManagerImpl::GetSPFRouters (std::vector<SPFRouter> &routers) const
+{
+  NS_LOG_FUNCTION (this);
+//
+// Walk the list of nodes in the system.  The SPF calculations do not use the
+// node list, so that they can run in worker threads: the objects they need
+// are looked up here.
+//
   NodeList::Iterator listEnd = NodeList::End ();
   for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
     {
@@ -711,9 +797,11 @@ GlobalRouteManagerImpl::InitializeRoutes ()
       Ptr<GlobalRouter> rtr = 
         node->GetObject<GlobalRouter> ();
 
-      uint32_t systemId = MpiInterface::GetSystemId ();
-      // Ignore nodes that are not assigned to our systemId (distributed sim)
-      if (node->GetSystemId () != systemId) 
+      // Ignore nodes that are not assigned to our systemId (distributed sim).
+      // Nodes are only filtered when MPI is in use: a shared memory parallel
+      // simulation computes the routes of all nodes in the same process.
+      if (MpiInterface::IsEnabled ()
+          && node->GetSystemId () != MpiInterface::GetSystemId ())
         {
           continue;
         }
@@ -724,10 +812,615 @@ GlobalRouteManagerImpl::InitializeRoutes ()
 //
       if (rtr && rtr->GetNumLSAs () )
         {
-          SPFCalculate (rtr->GetRouterId ());
+          SPFRouter router;
+          router.routerId = rtr->GetRouterId ();
+          router.node = node;
+          router.ipv4 = node->GetObject<Ipv4> ();
+          router.routing = rtr->GetRoutingProtocol ();
+          NS_ASSERT_MSG (router.ipv4, "GlobalRouteManagerImpl::GetSPFRouters (): "
+                         "GetObject for <Ipv4> interface failed");
+          routers.push_back (router);
+        }
+    }
+}
+
+void
+GlobalRouteManagerImpl::SPFCalculate (std::vector<SPFRouter> const &routers)
+{
+  NS_LOG_FUNCTION (this);
+  UintegerValue threads;
+  g_globalRoutingThreads.GetValue (threads);
+  uint32_t nThreads = std::min<uint32_t> (threads.Get (), routers.size ());
+#ifdef HAVE_PTHREAD_H
+  if (nThreads > 1)
+    {
+//
+// The calculations of the routers are independent: each one only reads the
+// database and writes the routing table of its router.  Each worker has its
+// own SPF tree and LSA status, and takes the next router until none is left.
+//
+      NS_LOG_LOGIC ("Running " << routers.size () << " SPF calculations in " << nThreads << " threads");
+      SPFWork work;
+      work.routers = &routers;
+      work.next = 0;
+      std::vector<GlobalRouteManagerImpl *> workers;
+      std::vector<Ptr<SystemThread> > systemThreads;
+      for (uint32_t i = 0; i < nThreads; i++)
+        {
+          GlobalRouteManagerImpl *worker = new GlobalRouteManagerImpl (m_lsdb, &work);
+          workers.push_back (worker);
+          systemThreads.push_back (Create<SystemThread> (MakeCallback (&GlobalRouteManagerImpl::SPFWorkerRun, worker)));
+          systemThreads.back ()->Start ();
+        }
+      for (uint32_t i = 0; i < nThreads; i++)
+        {
+          systemThreads[i]->Join ();
+          delete workers[i];
+        }
+      return;
+    }
+#endif /* HAVE_PTHREAD_H */
+  for (uint32_t i = 0; i < routers.size (); i++)
+    {
+      SPFCalculate (routers[i]);
+    }
+}
+
+#ifdef HAVE_PTHREAD_H
+void
+GlobalRouteManagerImpl::SPFWorkerRun (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (;;)
+    {
+      uint32_t i;
+      {
+        CriticalSection cs (m_work->mutex);
+        i = m_work->next++;
+      }
+      if (i >= m_work->routers->size ())
+        {
+          break;
+        }
+      SPFCalculate ((*m_work->routers)[i]);
+    }
+}
+#endif /* HAVE_PTHREAD_H */
+
+void
+GlobalRouteManagerImpl::SPFCalculate (SPFRouter const &router)
+{
+  NS_LOG_FUNCTION (this << router.routerId);
+  m_spfrouter = router;
+  SPFCalculate (router.routerId);
+  m_spfrouter = SPFRouter ();
+}
+
+namespace {
+
+/// A link of a link state database, as SPFNext follows it.
+struct SPFLink
+{
+  uint32_t from;   //!< the index of the vertex with the link
+  uint32_t to;     //!< the index of the vertex at the other end
+  uint32_t data;   //!< the LinkData of the record, or the address of the router on a network
+  uint32_t metric; //!< the metric of the link, 0 from a network
+};
+
+/**
+ * \param a a link.
+ * \param b another link.
+ * \returns true if a is ordered before b.
+ */
+bool
+operator < (SPFLink const &a, SPFLink const &b)
+{
+  if (a.from != b.from)
+    {
+      return a.from < b.from;
+    }
+  if (a.to != b.to)
+    {
+      return a.to < b.to;
+    }
+  if (a.data != b.data)
+    {
+      return a.data < b.data;
+    }
+  return a.metric < b.metric;
+}
+
+/**
+ * \param a a link.
+ * \param b another link.
+ * \returns true if the links are the same.
+ */
+bool
+operator == (SPFLink const &a, SPFLink const &b)
+{
+  return a.from == b.from && a.to == b.to && a.data == b.data && a.metric == b.metric;
+}
+
+/// A destination to which the SPF calculation adds routes, through a vertex.
+struct SPFDestination
+{
+  uint32_t network; //!< the network, or host, address
+  uint32_t mask;    //!< the network mask
+  bool host;        //!< whether the routes are host routes
+};
+
+/**
+ * \param a a destination.
+ * \param b another destination.
+ * \returns true if a is ordered before b.
+ */
+bool
+operator < (SPFDestination const &a, SPFDestination const &b)
+{
+  if (a.network != b.network)
+    {
+      return a.network < b.network;
+    }
+  if (a.mask != b.mask)
+    {
+      return a.mask < b.mask;
+    }
+  return a.host < b.host;
+}
+
+/**
+ * \param a a destination.
+ * \param b another destination.
+ * \returns true if the destinations are the same.
+ */
+bool
+operator == (SPFDestination const &a, SPFDestination const &b)
+{
+  return a.network == b.network && a.mask == b.mask && a.host == b.host;
+}
+
+/// The distance to an unreachable vertex.
+const uint64_t SPF_INFINITY = ~(uint64_t)0;
+
+/**
+ * \brief The graph of a link state database, with the vertices numbered
+ * by an index shared with the other databases it is compared with.
+ */
+class SPFGraph
+{
+public:
+  /**
+   * \param lsdb the database.
+   * \param index the index of each router and network LSA of the database.
+   */
+  SPFGraph (GlobalRouteManagerLSDB const &lsdb, std::map<Ipv4Address, uint32_t> const &index);
+
+  /**
+   * \param to the index of a vertex.
+   * \returns the distance from each vertex to it, or SPF_INFINITY.
+   */
+  std::vector<uint64_t> const &GetDistancesTo (uint32_t to);
+
+  std::vector<std::vector<SPFLink> > links; //!< the sorted links of each vertex
+  std::vector<std::vector<SPFDestination> > destinations; //!< the sorted destinations of each vertex
+
+private:
+  std::vector<std::vector<SPFLink> > m_in; //!< the links to each vertex
+  std::map<uint32_t, std::vector<uint64_t> > m_distances; //!< the distances to the vertices computed so far
+};
+
+SPFGraph::SPFGraph (GlobalRouteManagerLSDB const &lsdb, std::map<Ipv4Address, uint32_t> const &index)
+  : links (index.size ()),
+    destinations (index.size ()),
+    m_in (index.size ())
+{
+  for (uint32_t i = 0; i < lsdb.GetNumLSAs (); i++)
+    {
+      GlobalRoutingLSA *lsa = lsdb.GetLSAByIndex (i);
+      SPFLink link;
+      link.from = index.find (lsa->GetLinkStateId ())->second;
+      SPFDestination destination;
+      destination.host = false;
+      if (lsa->GetLSType () == GlobalRoutingLSA::NetworkLSA)
+        {
+          destination.mask = lsa->GetNetworkLSANetworkMask ().Get ();
+          destination.network = lsa->GetLinkStateId ().Get () & destination.mask;
+          destinations[link.from].push_back (destination);
+          for (uint32_t j = 0; j < lsa->GetNAttachedRouters (); j++)
+            {
+              GlobalRoutingLSA *w = lsdb.GetLSAByLinkData (lsa->GetAttachedRouter (j));
+              if (w != 0)
+                {
+                  link.to = index.find (w->GetLinkStateId ())->second;
+                  link.data = lsa->GetAttachedRouter (j).Get ();
+                  link.metric = 0;
+                  links[link.from].push_back (link);
+                }
+            }
+        }
+      else
+        {
+          for (uint32_t j = 0; j < lsa->GetNLinkRecords (); j++)
+            {
+              GlobalRoutingLinkRecord *l = lsa->GetLinkRecord (j);
+              if (l->GetLinkType () == GlobalRoutingLinkRecord::StubNetwork)
+                {
+                  destination.mask = l->GetLinkData ().Get ();
+                  destination.network = l->GetLinkId ().Get () & destination.mask;
+                  destination.host = false;
+                  destinations[link.from].push_back (destination);
+                  continue;
+                }
+              std::map<Ipv4Address, uint32_t>::const_iterator to = index.find (l->GetLinkId ());
+              if (to == index.end ())
+                {
+                  continue;
+                }
+              link.to = to->second;
+              link.data = l->GetLinkData ().Get ();
+              link.metric = l->GetMetric ();
+              links[link.from].push_back (link);
+              if (l->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint)
+                {
+                  destination.network = l->GetLinkData ().Get ();
+                  destination.mask = 0xffffffff;
+                  destination.host = true;
+                  destinations[link.from].push_back (destination);
+                }
+            }
+        }
+    }
+  for (uint32_t v = 0; v < links.size (); v++)
+    {
+      std::sort (links[v].begin (), links[v].end ());
+      std::sort (destinations[v].begin (), destinations[v].end ());
+      for (uint32_t j = 0; j < links[v].size (); j++)
+        {
+          m_in[links[v][j].to].push_back (links[v][j]);
         }
     }
-  NS_LOG_INFO ("Finished SPF calculation");
+}
+
+std::vector<uint64_t> const &
+SPFGraph::GetDistancesTo (uint32_t to)
+{
+  std::map<uint32_t, std::vector<uint64_t> >::iterator i = m_distances.find (to);
+  if (i != m_distances.end ())
+    {
+      return i->second;
+    }
+//
+// Dijkstra on the reversed links, from the destination vertex.
+//
+  std::vector<uint64_t> &distances = m_distances[to];
+  distances.assign (links.size (), SPF_INFINITY);
+  typedef std::pair<uint64_t, uint32_t> Candidate;
+  std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate> > candidates;
+  distances[to] = 0;
+  candidates.push (Candidate (0, to));
+  while (!candidates.empty ())
+    {
+      Candidate c = candidates.top ();
+      candidates.pop ();
+      if (c.first != distances[c.second])
+        {
+          continue;
+        }
+      for (uint32_t j = 0; j < m_in[c.second].size (); j++)
+        {
+          SPFLink const &link = m_in[c.second][j];
+          uint64_t distance = c.first + link.metric;
+          if (distance < distances[link.from])
+            {
+              distances[link.from] = distance;
+              candidates.push (Candidate (distance, link.from));
+            }
+        }
+    }
+  return distances;
+}
+
+/**
+ * \brief Check whether a link added or removed may change the shortest
+ * path tree of a router, or its next hops.
+ *
+ * \param graph the graph with the link.
+ * \param link the link.
+ * \param root the index of the router.
+ * \returns true if the link leads to the router or to one of its networks,
+ * or is on one of its shortest paths.
+ */
+bool
+IsSPFLinkUsed (SPFGraph &graph, SPFLink const &link, uint32_t root)
+{
+  if (link.to == root)
+    {
+      return true;
+    }
+  std::vector<SPFLink> const &rootLinks = graph.links[root];
+  for (uint32_t j = 0; j < rootLinks.size (); j++)
+    {
+      if (rootLinks[j].to == link.to)
+        {
+          return true;
+        }
+    }
+  uint64_t from = graph.GetDistancesTo (link.from)[root];
+  return from != SPF_INFINITY && from + link.metric == graph.GetDistancesTo (link.to)[root];
+}
+
+/// The destinations added and removed on a vertex.
+struct SPFDestinationChange
+{
+  uint32_t vertex; //!< the index of the vertex
+  std::vector<SPFDestination> removed; //!< the destinations removed
+  std::vector<SPFDestination> added; //!< the destinations added
+  bool hasWitness; //!< whether witness is set
+  SPFDestination witness; //!< a destination only the vertex had, whose routes give the next hops to the vertex
+};
+
+} // anonymous namespace
+
+void
+GlobalRouteManagerImpl::RecomputeRoutes ()
+{
+  NS_LOG_FUNCTION (this);
+  BooleanValue incremental;
+  g_globalRoutingIncremental.GetValue (incremental);
+  if (!incremental.Get () || m_lsdb->GetNumLSAs () == 0)
+    {
+      DeleteGlobalRoutes ();
+      BuildGlobalRoutingDatabase ();
+      InitializeRoutes ();
+      return;
+    }
+//
+// Keep the database the routes were computed from, to compare it with the
+// new one.
+//
+  GlobalRouteManagerLSDB *oldLsdb = m_lsdb;
+  m_lsdb = new GlobalRouteManagerLSDB ();
+  BuildGlobalRoutingDatabase ();
+  std::vector<SPFRouter> routers;
+  GetSPFRouters (routers);
+  std::vector<SPFRouter> recompute;
+  if (UpdateRoutes (*oldLsdb, routers, recompute))
+    {
+      NS_LOG_INFO ("Recomputing the routes of " << recompute.size () << " of " << routers.size () << " routers");
+      for (uint32_t i = 0; i < recompute.size (); i++)
+        {
+          Ptr<Ipv4GlobalRouting> gr = recompute[i].routing;
+          uint32_t nRoutes = gr->GetNRoutes ();
+          for (uint32_t j = 0; j < nRoutes; j++)
+            {
+              gr->RemoveRoute (0);
+            }
+        }
+      SPFCalculate (recompute);
+    }
+  else
+    {
+      NS_LOG_INFO ("Recomputing all the routes");
+      DeleteRoutes ();
+      SPFCalculate (routers);
+    }
+  delete oldLsdb;
+}
+
+bool
+GlobalRouteManagerImpl::UpdateRoutes (GlobalRouteManagerLSDB const &oldLsdb,
+                                      std::vector<SPFRouter> const &routers,
+                                      std::vector<SPFRouter> &recompute)
+{
+  NS_LOG_FUNCTION (this << &oldLsdb);
+//
+// Only the links and the destinations of the LSAs may change: the LSAs,
+// the masks of the networks and the external routes must be the same.
+//
+  uint32_t n = oldLsdb.GetNumLSAs ();
+  if (m_lsdb->GetNumLSAs () != n || m_lsdb->GetNumExtLSAs () != oldLsdb.GetNumExtLSAs ())
+    {
+      NS_LOG_LOGIC ("Different number of LSAs");
+      return false;
+    }
+  std::map<Ipv4Address, uint32_t> index;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      index[oldLsdb.GetLSAByIndex (i)->GetLinkStateId ()] = i;
+    }
+  for (uint32_t i = 0; i < n; i++)
+    {
+      GlobalRoutingLSA *lsa = m_lsdb->GetLSAByIndex (i);
+      GlobalRoutingLSA *old = oldLsdb.GetLSA (lsa->GetLinkStateId ());
+      if (old == 0 || old->GetLSType () != lsa->GetLSType ()
+          || (lsa->GetLSType () == GlobalRoutingLSA::NetworkLSA
+              && old->GetNetworkLSANetworkMask () != lsa->GetNetworkLSANetworkMask ()))
+        {
+          NS_LOG_LOGIC ("LSA " << lsa->GetLinkStateId () << " added or changed");
+          return false;
+        }
+    }
+  for (uint32_t i = 0; i < oldLsdb.GetNumExtLSAs (); i++)
+    {
+      GlobalRoutingLSA *lsa = m_lsdb->GetExtLSA (i);
+      GlobalRoutingLSA *old = oldLsdb.GetExtLSA (i);
+      if (old->GetLinkStateId () != lsa->GetLinkStateId ()
+          || old->GetNetworkLSANetworkMask () != lsa->GetNetworkLSANetworkMask ()
+          || old->GetAdvertisingRouter () != lsa->GetAdvertisingRouter ())
+        {
+          NS_LOG_LOGIC ("External LSA " << lsa->GetLinkStateId () << " changed");
+          return false;
+        }
+    }
+
+  SPFGraph oldGraph (oldLsdb, index);
+  SPFGraph newGraph (*m_lsdb, index);
+//
+// Find the links removed from the old graph and added to the new one; a
+// link whose metric changed is both.  Each one needs the distances to its
+// ends: when there are more of them than routers, computing all the routes
+// again is cheaper.
+//
+  std::vector<SPFLink> removed;
+  std::vector<SPFLink> added;
+  for (uint32_t v = 0; v < n; v++)
+    {
+      std::set_difference (oldGraph.links[v].begin (), oldGraph.links[v].end (),
+                           newGraph.links[v].begin (), newGraph.links[v].end (),
+                           std::back_inserter (removed));
+      std::set_difference (newGraph.links[v].begin (), newGraph.links[v].end (),
+                           oldGraph.links[v].begin (), oldGraph.links[v].end (),
+                           std::back_inserter (added));
+    }
+  std::set<uint32_t> oldEnds;
+  std::set<uint32_t> newEnds;
+  for (uint32_t j = 0; j < removed.size (); j++)
+    {
+      oldEnds.insert (removed[j].from);
+      oldEnds.insert (removed[j].to);
+    }
+  for (uint32_t j = 0; j < added.size (); j++)
+    {
+      newEnds.insert (added[j].from);
+      newEnds.insert (added[j].to);
+    }
+  if (oldEnds.size () + newEnds.size () > routers.size ())
+    {
+      NS_LOG_LOGIC ((removed.size () + added.size ()) << " links changed");
+      return false;
+    }
+//
+// Find the destinations added and removed on each vertex.  The routes to a
+// destination which only one vertex had go through the next hops to that
+// vertex.
+//
+  std::map<std::pair<uint32_t, uint32_t>, uint32_t> announced;
+  for (uint32_t v = 0; v < n; v++)
+    {
+      for (uint32_t j = 0; j < oldGraph.destinations[v].size (); j++)
+        {
+          SPFDestination const &d = oldGraph.destinations[v][j];
+          announced[std::make_pair (d.network, d.mask)]++;
+        }
+    }
+  std::vector<SPFDestinationChange> changes;
+  for (uint32_t v = 0; v < n; v++)
+    {
+      std::vector<SPFDestination> const &oldDestinations = oldGraph.destinations[v];
+      std::vector<SPFDestination> const &newDestinations = newGraph.destinations[v];
+      if (oldDestinations == newDestinations)
+        {
+          continue;
+        }
+      SPFDestinationChange change;
+      change.vertex = v;
+      std::set_difference (oldDestinations.begin (), oldDestinations.end (),
+                           newDestinations.begin (), newDestinations.end (),
+                           std::back_inserter (change.removed));
+      std::set_difference (newDestinations.begin (), newDestinations.end (),
+                           oldDestinations.begin (), oldDestinations.end (),
+                           std::back_inserter (change.added));
+      change.hasWitness = false;
+      for (uint32_t j = 0; j < oldDestinations.size () && !change.hasWitness; j++)
+        {
+          SPFDestination const &d = oldDestinations[j];
+          if (announced[std::make_pair (d.network, d.mask)] == 1)
+            {
+              change.witness = d;
+              change.hasWitness = true;
+            }
+        }
+      changes.push_back (change);
+    }
+
+  for (uint32_t i = 0; i < routers.size (); i++)
+    {
+      SPFRouter const &router = routers[i];
+      uint32_t root = index[router.routerId];
+//
+// The shortest path tree of the router, and the next hops, may change when
+// its own LSA changes, or when a link changed on one of its shortest paths,
+// in the old or the new graph.
+//
+      bool affected = oldGraph.links[root] != newGraph.links[root]
+        || oldGraph.destinations[root] != newGraph.destinations[root];
+      for (uint32_t j = 0; j < removed.size () && !affected; j++)
+        {
+          affected = IsSPFLinkUsed (oldGraph, removed[j], root);
+        }
+      for (uint32_t j = 0; j < added.size () && !affected; j++)
+        {
+          affected = IsSPFLinkUsed (newGraph, added[j], root);
+        }
+//
+// Otherwise, the next hops to each vertex are the same: the routes to the
+// destinations removed from a vertex are deleted, and the routes to the
+// destinations added are added with the next hops to that vertex.
+//
+      Ptr<Ipv4GlobalRouting> gr = router.routing;
+      for (uint32_t j = 0; j < changes.size () && !affected; j++)
+        {
+          SPFDestinationChange const &change = changes[j];
+          if (!change.hasWitness)
+            {
+              affected = true;
+              break;
+            }
+          std::vector<Ipv4RoutingTableEntry *> routes;
+          gr->GetRoutesTo (Ipv4Address (change.witness.network), Ipv4Mask (change.witness.mask), routes);
+          std::vector<std::pair<Ipv4Address, uint32_t> > exits;
+          for (uint32_t k = 0; k < routes.size (); k++)
+            {
+              exits.push_back (std::make_pair (routes[k]->GetGateway (), routes[k]->GetInterface ()));
+            }
+          for (uint32_t k = 0; k < change.removed.size () && !affected; k++)
+            {
+              SPFDestination const &d = change.removed[k];
+              routes.clear ();
+              gr->GetRoutesTo (Ipv4Address (d.network), Ipv4Mask (d.mask), routes);
+              for (uint32_t e = 0; e < exits.size () && !affected; e++)
+                {
+                  std::vector<Ipv4RoutingTableEntry *>::iterator route = routes.begin ();
+                  while (route != routes.end ()
+                         && (*route == 0 || (*route)->GetGateway () != exits[e].first
+                             || (*route)->GetInterface () != exits[e].second))
+                    {
+                      ++route;
+                    }
+                  if (route == routes.end ())
+                    {
+                      NS_LOG_LOGIC ("No route to " << Ipv4Address (d.network) << " through " << exits[e].first);
+                      affected = true;
+                      break;
+                    }
+                  gr->DeleteRoute (*route);
+                  *route = 0;
+                }
+            }
+          for (uint32_t k = 0; k < change.added.size () && !affected; k++)
+            {
+              SPFDestination const &d = change.added[k];
+              for (uint32_t e = 0; e < exits.size (); e++)
+                {
+                  if (d.host)
+                    {
+                      gr->AddHostRouteTo (Ipv4Address (d.network), exits[e].first, exits[e].second);
+                    }
+                  else
+                    {
+                      gr->AddNetworkRouteTo (Ipv4Address (d.network), Ipv4Mask (d.mask),
+                                             exits[e].first, exits[e].second);
+                    }
+                }
+            }
+        }
+      if (affected)
+        {
+          NS_LOG_LOGIC ("Router " << router.routerId << " needs a new SPF calculation");
+          recompute.push_back (router);
+        }
+    }
+  return true;
 }
 
 //
@@ -836,7 +1529,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 // If the link is to a router that is already in the shortest path first tree
 // then we have it covered -- ignore it.
 //
-      if (w_lsa->GetStatus () == GlobalRoutingLSA::LSA_SPF_IN_SPFTREE) 
+      if (GetStatus (w_lsa) == GlobalRoutingLSA::LSA_SPF_IN_SPFTREE) 
         {
           NS_LOG_LOGIC ("Skipping ->  LSA "<< 
                         w_lsa->GetLinkStateId () << " already in SPF tree");
@@ -861,7 +1554,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
       NS_LOG_LOGIC ("Considering w_lsa " << w_lsa->GetLinkStateId ());
 
 // Is there already vertex w in candidate list?
-      if (w_lsa->GetStatus () == GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED)
+      if (GetStatus (w_lsa) == GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED)
         {
 // Calculate nexthop to w
 // We need to figure out how to actually get to the new router represented
@@ -873,7 +1566,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
           w = new SPFVertex (w_lsa);
           if (SPFNexthopCalculation (v, w, l, distance))
             {
-              w_lsa->SetStatus (GlobalRoutingLSA::LSA_SPF_CANDIDATE);
+              SetStatus (w_lsa, GlobalRoutingLSA::LSA_SPF_CANDIDATE);
 //
 // Push this new vertex onto the priority queue (ordered by distance from the
 // root node).
@@ -888,7 +1581,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
             NS_ASSERT_MSG (0, "SPFNexthopCalculation never " 
                            << "return false, but it does now!");
         }
-      else if (w_lsa->GetStatus () == GlobalRoutingLSA::LSA_SPF_CANDIDATE)
+      else if (GetStatus (w_lsa) == GlobalRoutingLSA::LSA_SPF_CANDIDATE)
         {
 //
 // We have already considered the link represented by <w>.  What wse have to
@@ -1247,7 +1940,38 @@ void
 GlobalRouteManagerImpl::DebugSPFCalculate (Ipv4Address root)
 {
   NS_LOG_FUNCTION (this << root);
-  SPFCalculate (root);
+  SPFRouter router;
+  router.routerId = root;
+  NodeList::Iterator listEnd = NodeList::End ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
+    {
+      Ptr<GlobalRouter> rtr = (*i)->GetObject<GlobalRouter> ();
+      if (rtr && rtr->GetRouterId () == root)
+        {
+          router.node = *i;
+          router.ipv4 = (*i)->GetObject<Ipv4> ();
+          router.routing = rtr->GetRoutingProtocol ();
+          break;
+        }
+    }
+  SPFCalculate (router);
+}
+
+GlobalRoutingLSA::SPFStatus
+GlobalRouteManagerImpl::GetStatus (GlobalRoutingLSA* lsa) const
+{
+  std::map<GlobalRoutingLSA*, GlobalRoutingLSA::SPFStatus>::const_iterator i = m_status.find (lsa);
+  if (i == m_status.end ())
+    {
+      return GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED;
+    }
+  return i->second;
+}
+
+void
+GlobalRouteManagerImpl::SetStatus (GlobalRoutingLSA* lsa, GlobalRoutingLSA::SPFStatus status)
+{
+  m_status[lsa] = status;
 }
 
 //
@@ -1320,9 +2044,7 @@ GlobalRouteManagerImpl::CheckForStubNode (Ipv4Address root)
               if (lr->GetLinkId () == myRouterId)
                 {
                   // Next hop is stored in the LinkID field of lr
-                  Ptr<GlobalRouter> router = rlsa->GetNode ()->GetObject<GlobalRouter> ();
-                  NS_ASSERT (router);
-                  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+                  Ptr<Ipv4GlobalRouting> gr = m_spfrouter.routing;
                   NS_ASSERT (gr);
                   gr->AddNetworkRouteTo (Ipv4Address ("0.0.0.0"), Ipv4Mask ("0.0.0.0"), lr->GetLinkData (), 
                                          FindOutgoingInterfaceId (transitLink->GetLinkData ()));
@@ -1345,9 +2067,9 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 
   SPFVertex *v;
 //
-// Initialize the Link State Database.
+// Initialize the status of the Link State Advertisements: none is explored.
 //
-  m_lsdb->Initialize ();
+  m_status.clear ();
 //
 // The candidate queue is a priority queue of SPFVertex objects, with the top
 // of the queue being the closest vertex in terms of distance from the root
@@ -1367,7 +2089,7 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 //
   m_spfroot= v;
   v->SetDistanceFromRoot (0);
-  v->GetLSA ()->SetStatus (GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
+  SetStatus (v->GetLSA (), GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
   NS_LOG_LOGIC ("Starting SPFCalculate for node " << root);
 
 //
@@ -1377,7 +2099,7 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // reached.  Instead, short-circuit this computation and just install
 // a default route in the CheckForStubNode() method.
 //
-  if (NodeList::GetNNodes () > 0 && CheckForStubNode (root))
+  if (m_spfrouter.routing != 0 && CheckForStubNode (root))
     {
       NS_LOG_LOGIC ("SPFCalculate truncated for stub node " << root);
       delete m_spfroot;
@@ -1428,7 +2150,7 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // Update the status field of the vertex to indicate that it is in the SPF
 // tree.
 //
-      v->GetLSA ()->SetStatus (GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
+      SetStatus (v->GetLSA (), GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
 //
 // The current vertex has a parent pointer.  By calling this rather oddly 
 // named method (blame quagga) we add the current vertex to the list of 
@@ -1559,59 +2281,33 @@ GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v
   Ipv4Address routerId = m_spfroot->GetVertexId ();
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
-//
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  Ptr<Node> node = m_spfrouter.node;
+  if (node == 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to QI for that interface.  If there's no GlobalRouter interface, the node
-// in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
+      NS_LOG_LOGIC ("No node for the root router " << routerId);
+      return;
+    }
+  NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
 //
-// Routing information is updated using the Ipv4 interface.  We need to QI
-// for that interface.  If the node is acting as an IP version 4 router, it
-// should absolutely have an Ipv4 interface.
+// Routing information is updated using the Ipv4 interface and the routing
+// protocol of the node, which were looked up before the SPF calculation.
 //
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "QI for <Ipv4> interface failed");
+  Ptr<Ipv4> ipv4 = m_spfrouter.ipv4;
+  NS_ASSERT_MSG (ipv4, 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "QI for <Ipv4> interface failed");
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          NS_ASSERT_MSG (v->GetLSA (), 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask ();
-          Ipv4Address tempip = extlsa->GetLinkStateId ();
-          tempip = tempip.CombineMask (tempmask);
+  NS_ASSERT_MSG (v->GetLSA (), 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask ();
+  Ipv4Address tempip = extlsa->GetLinkStateId ();
+  tempip = tempip.CombineMask (tempmask);
 
 //
 // Here's why we did all of that work.  We're going to add a host route to the
@@ -1626,39 +2322,31 @@ GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v
 // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
 // which the packets should be send for forwarding.
 //
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all next-hop-IPs and out-going-interfaces for reaching
-          // the stub network gateway 'v' from the root node
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-              if (outIf >= 0)
-                {
-                  gr->AddASExternalRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add external network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative");
-                }
-            }
-          return;
-        } // if
-    } // for
+  Ptr<Ipv4GlobalRouting> gr = m_spfrouter.routing;
+  NS_ASSERT (gr);
+  // walk through all next-hop-IPs and out-going-interfaces for reaching
+  // the stub network gateway 'v' from the root node
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
+      if (outIf >= 0)
+        {
+          gr->AddASExternalRouteTo (tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                        " add external network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
+        }
+      else
+        {
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative");
+        }
+    }
 }
 
 
@@ -1728,61 +2416,33 @@ GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex*
   Ipv4Address routerId = m_spfroot->GetVertexId ();
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
-//
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  Ptr<Node> node = m_spfrouter.node;
+  if (node == 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to QI for that interface.  If there's no GlobalRouter interface, the node
-// in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
+      NS_LOG_LOGIC ("No node for the root router " << routerId);
+      return;
+    }
+  NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
 //
-// Routing information is updated using the Ipv4 interface.  We need to QI
-// for that interface.  If the node is acting as an IP version 4 router, it
-// should absolutely have an Ipv4 interface.
+// Routing information is updated using the Ipv4 interface and the routing
+// protocol of the node, which were looked up before the SPF calculation.
 //
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "QI for <Ipv4> interface failed");
+  Ptr<Ipv4> ipv4 = m_spfrouter.ipv4;
+  NS_ASSERT_MSG (ipv4, 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "QI for <Ipv4> interface failed");
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          NS_ASSERT_MSG (v->GetLSA (), 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask (l->GetLinkData ().Get ());
-          Ipv4Address tempip = l->GetLinkId ();
-          tempip = tempip.CombineMask (tempmask);
+  NS_ASSERT_MSG (v->GetLSA (), 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask (l->GetLinkData ().Get ());
+  Ipv4Address tempip = l->GetLinkId ();
+  tempip = tempip.CombineMask (tempmask);
 //
 // Here's why we did all of that work.  We're going to add a host route to the
 // host address found in the m_linkData field of the point-to-point link
@@ -1797,39 +2457,31 @@ GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex*
 // which the packets should be send for forwarding.
 //
 
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all next-hop-IPs and out-going-interfaces for reaching
-          // the stub network gateway 'v' from the root node
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-              if (outIf >= 0)
-                {
-                  gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative");
-                }
-            }
-          return;
-        } // if
-    } // for
+  Ptr<Ipv4GlobalRouting> gr = m_spfrouter.routing;
+  NS_ASSERT (gr);
+  // walk through all next-hop-IPs and out-going-interfaces for reaching
+  // the stub network gateway 'v' from the root node
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
+      if (outIf >= 0)
+        {
+          gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                        " add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
+        }
+      else
+        {
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative");
+        }
+    }
 }
 
 //
@@ -1852,62 +2504,35 @@ GlobalRouteManagerImpl::FindOutgoingInterfaceId (Ipv4Address a, Ipv4Mask amask)
 // the address in question.
 //
   Ipv4Address routerId = m_spfroot->GetVertexId ();
-//
-// Walk the list of nodes in the system looking for the one corresponding to
-// the node at the root of the SPF tree.  This is the node for which we are
-// building the routing table.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  Ptr<Node> node = m_spfrouter.node;
+  if (node == 0)
     {
-      Ptr<Node> node = *i;
-
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-//
-// If the node doesn't have a GlobalRouter interface it can't be the one
-// we're interested in.
-//
-      if (rtr == 0)
-        {
-          continue;
-        }
-
-      if (rtr->GetRouterId () == routerId)
-        {
+      NS_LOG_LOGIC ("No node for the root router " << routerId);
+      return -1;
+    }
 //
 // This is the node we're building the routing table for.  We're going to need
-// the Ipv4 interface to look for the ipv4 interface index.  Since this node
-// is participating in routing IP version 4 packets, it certainly must have 
-// an Ipv4 interface.
+// the Ipv4 interface to look for the ipv4 interface index.
 //
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::FindOutgoingInterfaceId (): "
-                         "GetObject for <Ipv4> interface failed");
+  Ptr<Ipv4> ipv4 = m_spfrouter.ipv4;
+  NS_ASSERT_MSG (ipv4, 
+                 "GlobalRouteManagerImpl::FindOutgoingInterfaceId (): "
+                 "GetObject for <Ipv4> interface failed");
 //
 // Look through the interfaces on this node for one that has the IP address
 // we're looking for.  If we find one, return the corresponding interface
 // index, or -1 if not found.
 //
-          int32_t interface = ipv4->GetInterfaceForPrefix (a, amask);
+  int32_t interface = ipv4->GetInterfaceForPrefix (a, amask);
 
 #if 0
-          if (interface < 0)
-            {
-              NS_FATAL_ERROR ("GlobalRouteManagerImpl::FindOutgoingInterfaceId(): "
-                              "Expected an interface associated with address a:" << a);
-            }
-#endif 
-          return interface;
-        }
+  if (interface < 0)
+    {
+      NS_FATAL_ERROR ("GlobalRouteManagerImpl::FindOutgoingInterfaceId(): "
+                      "Expected an interface associated with address a:" << a);
     }
-//
-// Couldn't find it.
-//
-  NS_LOG_LOGIC ("FindOutgoingInterfaceId():Can't find root node " << routerId);
-  return -1;
+#endif 
+  return interface;
 }
 
 //
@@ -1943,61 +2568,33 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
   Ipv4Address routerId = m_spfroot->GetVertexId ();
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
-//
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  Ptr<Node> node = m_spfrouter.node;
+  if (node == 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to GetObject for that interface.  If there's no GlobalRouter interface, 
-// the node in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
+      NS_LOG_LOGIC ("No node for the root router " << routerId);
+      return;
+    }
+  NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
 //
-// Routing information is updated using the Ipv4 interface.  We need to 
-// GetObject for that interface.  If the node is acting as an IP version 4 
-// router, it should absolutely have an Ipv4 interface.
+// Routing information is updated using the Ipv4 interface and the routing
+// protocol of the node, which were looked up before the SPF calculation.
 //
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "GetObject for <Ipv4> interface failed");
+  Ptr<Ipv4> ipv4 = m_spfrouter.ipv4;
+  NS_ASSERT_MSG (ipv4, 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "GetObject for <Ipv4> interface failed");
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          GlobalRoutingLSA *lsa = v->GetLSA ();
-          NS_ASSERT_MSG (lsa, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
+  GlobalRoutingLSA *lsa = v->GetLSA ();
+  NS_ASSERT_MSG (lsa, 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "Expected valid LSA in SPFVertex* v");
 
-          uint32_t nLinkRecords = lsa->GetNLinkRecords ();
+  uint32_t nLinkRecords = lsa->GetNLinkRecords ();
 //
 // Iterate through the link records on the vertex to which we're going to add
 // routes.  To make sure we're being clear, we're going to add routing table
@@ -2006,18 +2603,18 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 // the local side of the point-to-point links found on the node described by
 // the vertex <v>.
 //
-          NS_LOG_LOGIC (" Node " << node->GetId () <<
-                        " found " << nLinkRecords << " link records in LSA " << lsa << "with LinkStateId "<< lsa->GetLinkStateId ());
-          for (uint32_t j = 0; j < nLinkRecords; ++j)
-            {
+  NS_LOG_LOGIC (" Node " << node->GetId () <<
+                " found " << nLinkRecords << " link records in LSA " << lsa << "with LinkStateId "<< lsa->GetLinkStateId ());
+  for (uint32_t j = 0; j < nLinkRecords; ++j)
+    {
 //
 // We are only concerned about point-to-point links
 //
-              GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
-              if (lr->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
-                {
-                  continue;
-                }
+      GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
+      if (lr->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
+        {
+          continue;
+        }
 //
 // Here's why we did all of that work.  We're going to add a host route to the
 // host address found in the m_linkData field of the point-to-point link
@@ -2031,44 +2628,33 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
 // which the packets should be send for forwarding.
 //
-              Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-              if (router == 0)
-                {
-                  continue;
-                }
-              Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-              NS_ASSERT (gr);
-              // walk through all available exit directions due to ECMP,
-              // and add host route for each of the exit direction toward
-              // the vertex 'v'
-              for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-                {
-                  SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-                  Ipv4Address nextHop = exit.first;
-                  int32_t outIf = exit.second;
-                  if (outIf >= 0)
-                    {
-                      gr->AddHostRouteTo (lr->GetLinkData (), nextHop,
-                                          outIf);
-                      NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                    " adding host route to " << lr->GetLinkData () <<
-                                    " using next hop " << nextHop <<
-                                    " and outgoing interface " << outIf);
-                    }
-                  else
-                    {
-                      NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                    " NOT able to add host route to " << lr->GetLinkData () <<
-                                    " using next hop " << nextHop <<
-                                    " since outgoing interface id is negative " << outIf);
-                    }
-                } // for all routes from the root the vertex 'v'
+      Ptr<Ipv4GlobalRouting> gr = m_spfrouter.routing;
+      NS_ASSERT (gr);
+      // walk through all available exit directions due to ECMP,
+      // and add host route for each of the exit direction toward
+      // the vertex 'v'
+      for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+        {
+          SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+          Ipv4Address nextHop = exit.first;
+          int32_t outIf = exit.second;
+          if (outIf >= 0)
+            {
+              gr->AddHostRouteTo (lr->GetLinkData (), nextHop,
+                                  outIf);
+              NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                            " adding host route to " << lr->GetLinkData () <<
+                            " using next hop " << nextHop <<
+                            " and outgoing interface " << outIf);
             }
-//
-// Done adding the routes for the selected node.
-//
-          return;
-        }
+          else
+            {
+              NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                            " NOT able to add host route to " << lr->GetLinkData () <<
+                            " using next hop " << nextHop <<
+                            " since outgoing interface id is negative " << outIf);
+            }
+        } // for all routes from the root the vertex 'v'
     }
 }
 void
@@ -2088,96 +2674,61 @@ GlobalRouteManagerImpl::SPFIntraAddTransit (SPFVertex* v)
   Ipv4Address routerId = m_spfroot->GetVertexId ();
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
-//
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  Ptr<Node> node = m_spfrouter.node;
+  if (node == 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to GetObject for that interface.  If there's no GlobalRouter interface, 
-// the node in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("setting routes for node " << node->GetId ());
+      NS_LOG_LOGIC ("No node for the root router " << routerId);
+      return;
+    }
+  NS_LOG_LOGIC ("setting routes for node " << node->GetId ());
 //
-// Routing information is updated using the Ipv4 interface.  We need to 
-// GetObject for that interface.  If the node is acting as an IP version 4 
-// router, it should absolutely have an Ipv4 interface.
+// Routing information is updated using the Ipv4 interface and the routing
+// protocol of the node, which were looked up before the SPF calculation.
 //
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                         "GetObject for <Ipv4> interface failed");
+  Ptr<Ipv4> ipv4 = m_spfrouter.ipv4;
+  NS_ASSERT_MSG (ipv4, 
+                 "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
+                 "GetObject for <Ipv4> interface failed");
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          GlobalRoutingLSA *lsa = v->GetLSA ();
-          NS_ASSERT_MSG (lsa, 
-                         "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask ();
-          Ipv4Address tempip = lsa->GetLinkStateId ();
-          tempip = tempip.CombineMask (tempmask);
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all available exit directions due to ECMP,
-          // and add host route for each of the exit direction toward
-          // the vertex 'v'
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
+  GlobalRoutingLSA *lsa = v->GetLSA ();
+  NS_ASSERT_MSG (lsa, 
+                 "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask ();
+  Ipv4Address tempip = lsa->GetLinkStateId ();
+  tempip = tempip.CombineMask (tempmask);
+  Ptr<Ipv4GlobalRouting> gr = m_spfrouter.routing;
+  NS_ASSERT (gr);
+  // walk through all available exit directions due to ECMP,
+  // and add host route for each of the exit direction toward
+  // the vertex 'v'
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
 
-              if (outIf >= 0)
-                {
-                  gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative " << outIf);
-                }
-            }
+      if (outIf >= 0)
+        {
+          gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                        " add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
         }
-    } 
+      else
+        {
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative " << outIf);
+        }
+    }
 }
 
 // Derived from quagga ospf_vertex_add_parents ()
@@ -37,7 +37,9 @@ namespace ns3 {
 const uint32_t SPF_INFINITY = 0xffffffff; //!< "infinite" distance between nodes
 
 class CandidateQueue;
+class Ipv4;
 class Ipv4GlobalRouting;
+class Node;
 
 /**
  * @brief Vertex used in shortest path first (SPF) computations. See \RFC{2328},
@@ -639,6 +641,21 @@ public:
  */
   GlobalRoutingLSA* GetLSAByLinkData (Ipv4Address addr) const;
 
+/**
+ * @brief Get the number of router and network Link State Advertisements.
+ *
+ * @returns the number of Link State Advertisements, external ones excluded.
+ */
+  uint32_t GetNumLSAs () const;
+
+/**
+ * @brief Get a router or network Link State Advertisement by its index.
+ *
+ * @param index the index of the LSA, less than GetNumLSAs ().
+ * @returns A pointer to the Link State Advertisement.
+ */
+  GlobalRoutingLSA* GetLSAByIndex (uint32_t index) const;
+
 /**
  * @brief Set all LSA flags to an initialized state, for SPF computation
  *
@@ -678,6 +695,8 @@ private:
   typedef std::pair<Ipv4Address, GlobalRoutingLSA*> LSDBPair_t; //!< pair of IPv4 addresses / Link State Advertisements
 
   LSDBMap_t m_database; //!< database of IPv4 addresses / Link State Advertisements
+  std::vector<GlobalRoutingLSA*> m_lsas; //!< the Link State Advertisements of m_database, in insertion order
+  LSDBMap_t m_linkDataIndex; //!< Link State Advertisements by the LinkData of their TransitNetwork link records
   std::vector<GlobalRoutingLSA*> m_extdatabase; //!< database of External Link State Advertisements
 
 /**
@@ -733,6 +752,18 @@ public:
  */
   virtual void InitializeRoutes ();
 
+/**
+ * @brief Delete the global routes, rebuild the routing database and
+ * compute the routes again.
+ *
+ * If the "GlobalRoutingIncremental" global value is true and routes were
+ * computed before, the new database is compared with the previous one.
+ * The routers whose shortest path tree may have changed are computed
+ * again; the others only update the routes to the destinations which
+ * were added or removed.
+ */
+  virtual void RecomputeRoutes ();
+
 /**
  * @brief Debugging routine; allow client code to supply a pre-built LSDB
  */
@@ -745,6 +776,27 @@ public:
   void DebugSPFCalculate (Ipv4Address root);
 
 private:
+  /// The router at the root of an SPF calculation, which gets the routes.
+  struct SPFRouter
+  {
+    Ipv4Address routerId;             //!< the router ID
+    Ptr<Node> node;                   //!< the node
+    Ptr<Ipv4> ipv4;                   //!< the Ipv4 of the node
+    Ptr<Ipv4GlobalRouting> routing;   //!< the global routing protocol of the node
+  };
+
+  /// The SPF calculations shared by worker threads.
+  struct SPFWork;
+
+/**
+ * @brief Construct a worker, which runs the SPF calculations of an SPFWork
+ * with the database of another GlobalRouteManagerImpl.
+ *
+ * @param lsdb the database, which the worker does not own.
+ * @param work the SPF calculations.
+ */
+  GlobalRouteManagerImpl (GlobalRouteManagerLSDB *lsdb, SPFWork *work);
+
 /**
  * @brief GlobalRouteManagerImpl copy construction is disallowed.
  * There's no  need for it and a compiler provided shallow copy would be 
@@ -765,7 +817,70 @@ private:
   GlobalRouteManagerImpl& operator= (GlobalRouteManagerImpl& srmi);
 
   SPFVertex* m_spfroot; //!< the root node
+  SPFRouter m_spfrouter; //!< the router of the root node
   GlobalRouteManagerLSDB* m_lsdb; //!< the Link State DataBase (LSDB) of the Global Route Manager
+  SPFWork* m_work; //!< the calculations of a worker, or 0
+  std::map<GlobalRoutingLSA*, GlobalRoutingLSA::SPFStatus> m_status; //!< the status of the LSAs explored by the SPF calculation
+
+  /**
+   * \brief Find the routers whose routes are computed by this process.
+   *
+   * \param routers the routers, in node order.
+   */
+  void GetSPFRouters (std::vector<SPFRouter> &routers) const;
+
+  /**
+   * \brief Delete the routes of all the nodes with a GlobalRouter interface.
+   */
+  void DeleteRoutes ();
+
+  /**
+   * \brief Run the SPF calculations of several routers, with as many threads
+   * as the "GlobalRoutingThreads" global value allows.
+   *
+   * \param routers the routers.
+   */
+  void SPFCalculate (std::vector<SPFRouter> const &routers);
+
+  /**
+   * \brief Run the SPF calculations of a worker, until none is left.
+   */
+  void SPFWorkerRun (void);
+
+  /**
+   * \brief Calculate the shortest path first (SPF) tree of a router, and
+   * add the routes to it.
+   *
+   * \param router the router at the root.
+   */
+  void SPFCalculate (SPFRouter const &router);
+
+  /**
+   * \brief Compare the database with the one the routes were computed
+   * from, and update the routes which do not need a new SPF calculation.
+   *
+   * \param oldLsdb the previous database.
+   * \param routers the routers whose routes are computed by this process.
+   * \param recompute filled with the routers whose shortest path tree may
+   * have changed, which need a new SPF calculation.
+   * \returns false if the databases are too different, and all the routes
+   * must be computed again.
+   */
+  bool UpdateRoutes (GlobalRouteManagerLSDB const &oldLsdb,
+                     std::vector<SPFRouter> const &routers,
+                     std::vector<SPFRouter> &recompute);
+
+  /**
+   * \param lsa an LSA of the database.
+   * \returns the status of the LSA in the current SPF calculation.
+   */
+  GlobalRoutingLSA::SPFStatus GetStatus (GlobalRoutingLSA* lsa) const;
+
+  /**
+   * \param lsa an LSA of the database.
+   * \param status the status of the LSA in the current SPF calculation.
+   */
+  void SetStatus (GlobalRoutingLSA* lsa, GlobalRoutingLSA::SPFStatus status);
 
   /**
    * \brief Test if a node is a stub, from an OSPF sense.
@@ -62,6 +62,16 @@ public:
  */
   static void InitializeRoutes ();
 
+/**
+ * @brief Delete the global routes, rebuild the routing database and
+ * compute the routes again, after a change of the topology.
+ *
+ * If the "GlobalRoutingIncremental" global value is true, the new
+ * database is compared with the previous one, and only the nodes whose
+ * routes depend on the changes are updated.
+ */
+  static void RecomputeRoutes ();
+
 private:
 /**
  * @brief Global Route Manager copy construction is disallowed.  There's no 
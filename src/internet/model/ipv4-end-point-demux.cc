@@ -26,8 +26,34 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Ipv4EndPointDemux");
 
+Ipv4EndPointDemux::Key::Key (Ipv4Address localAddress, uint16_t localPort,
+                             Ipv4Address peerAddress, uint16_t peerPort)
+  : localAddress (localAddress),
+    localPort (localPort),
+    peerAddress (peerAddress),
+    peerPort (peerPort)
+{
+}
+
+bool
+Ipv4EndPointDemux::Key::operator == (Key const &o) const
+{
+  return localPort == o.localPort && peerPort == o.peerPort &&
+         localAddress == o.localAddress && peerAddress == o.peerAddress;
+}
+
+size_t
+Ipv4EndPointDemux::KeyHash::operator () (Key const &key) const
+{
+  uint32_t h = key.localAddress.Get ();
+  h = h * 31 + key.peerAddress.Get ();
+  h = h * 31 + ((static_cast<uint32_t> (key.localPort) << 16) | key.peerPort);
+  return h ^ (h >> 16);
+}
+
 Ipv4EndPointDemux::Ipv4EndPointDemux ()
-  : m_ephemeral (49152), m_portLast (65535), m_portFirst (49152)
+  : m_ephemeral (49152), m_portLast (65535), m_portFirst (49152),
+    m_nEndPoints (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -35,41 +61,67 @@ Ipv4EndPointDemux::Ipv4EndPointDemux ()
 Ipv4EndPointDemux::~Ipv4EndPointDemux ()
 {
   NS_LOG_FUNCTION (this);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  for (EndPointTable::iterator bucket = m_endPoints.begin (); bucket != m_endPoints.end (); bucket++)
     {
-      Ipv4EndPoint *endPoint = *i;
-      delete endPoint;
+      for (EndPointsI i = bucket->second.begin (); i != bucket->second.end (); i++) 
+        {
+          Ipv4EndPoint *endPoint = *i;
+          delete endPoint;
+        }
     }
   m_endPoints.clear ();
 }
 
+void
+Ipv4EndPointDemux::Index (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  endPoint->m_demux = this;
+  m_endPoints[Key (endPoint->m_localAddr, endPoint->m_localPort,
+                   endPoint->m_peerAddr, endPoint->m_peerPort)].push_back (endPoint);
+  m_nEndPoints++;
+  m_localEndPoints[Key (endPoint->m_localAddr, endPoint->m_localPort, Ipv4Address::GetAny (), 0)]++;
+  m_localPorts[endPoint->m_localPort]++;
+}
+
+void
+Ipv4EndPointDemux::Unindex (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  EndPointTable::iterator bucket = m_endPoints.find (Key (endPoint->m_localAddr, endPoint->m_localPort,
+                                                          endPoint->m_peerAddr, endPoint->m_peerPort));
+  NS_ASSERT_MSG (bucket != m_endPoints.end (), "End point not in the demux");
+  bucket->second.remove (endPoint);
+  if (bucket->second.empty ())
+    {
+      m_endPoints.erase (bucket);
+    }
+  m_nEndPoints--;
+  sgi::hash_map<Key, uint32_t, KeyHash>::iterator local =
+    m_localEndPoints.find (Key (endPoint->m_localAddr, endPoint->m_localPort, Ipv4Address::GetAny (), 0));
+  if (--local->second == 0)
+    {
+      m_localEndPoints.erase (local);
+    }
+  sgi::hash_map<uint16_t, uint32_t>::iterator port = m_localPorts.find (endPoint->m_localPort);
+  if (--port->second == 0)
+    {
+      m_localPorts.erase (port);
+    }
+}
+
 bool
 Ipv4EndPointDemux::LookupPortLocal (uint16_t port)
 {
   NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
-    {
-      if ((*i)->GetLocalPort  () == port) 
-        {
-          return true;
-        }
-    }
-  return false;
+  return m_localPorts.find (port) != m_localPorts.end ();
 }
 
 bool
 Ipv4EndPointDemux::LookupLocal (Ipv4Address addr, uint16_t port)
 {
   NS_LOG_FUNCTION (this << addr << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
-    {
-      if ((*i)->GetLocalPort () == port &&
-          (*i)->GetLocalAddress () == addr) 
-        {
-          return true;
-        }
-    }
-  return false;
+  return m_localEndPoints.find (Key (addr, port, Ipv4Address::GetAny (), 0)) != m_localEndPoints.end ();
 }
 
 Ipv4EndPoint *
@@ -83,8 +135,8 @@ Ipv4EndPointDemux::Allocate (void)
       return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (Ipv4Address::GetAny (), port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  Index (endPoint);
+  NS_LOG_DEBUG ("Now have >>" << m_nEndPoints << "<< endpoints.");
   return endPoint;
 }
 
@@ -99,8 +151,8 @@ Ipv4EndPointDemux::Allocate (Ipv4Address address)
       return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  Index (endPoint);
+  NS_LOG_DEBUG ("Now have >>" << m_nEndPoints << "<< endpoints.");
   return endPoint;
 }
 
@@ -122,8 +174,8 @@ Ipv4EndPointDemux::Allocate (Ipv4Address address, uint16_t port)
       return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  Index (endPoint);
+  NS_LOG_DEBUG ("Now have >>" << m_nEndPoints << "<< endpoints.");
   return endPoint;
 }
 
@@ -132,23 +184,17 @@ Ipv4EndPointDemux::Allocate (Ipv4Address localAddress, uint16_t localPort,
                              Ipv4Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << localAddress << localPort << peerAddress << peerPort);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  if (m_endPoints.find (Key (localAddress, localPort, peerAddress, peerPort)) != m_endPoints.end ())
     {
-      if ((*i)->GetLocalPort () == localPort &&
-          (*i)->GetLocalAddress () == localAddress &&
-          (*i)->GetPeerPort () == peerPort &&
-          (*i)->GetPeerAddress () == peerAddress) 
-        {
-          NS_LOG_WARN ("No way we can allocate this end-point.");
-          /* no way we can allocate this end-point. */
-          return 0;
-        }
+      NS_LOG_WARN ("No way we can allocate this end-point.");
+      /* no way we can allocate this end-point. */
+      return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (localAddress, localPort);
   endPoint->SetPeer (peerAddress, peerPort);
-  m_endPoints.push_back (endPoint);
+  Index (endPoint);
 
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  NS_LOG_DEBUG ("Now have >>" << m_nEndPoints << "<< endpoints.");
 
   return endPoint;
 }
@@ -157,15 +203,8 @@ void
 Ipv4EndPointDemux::DeAllocate (Ipv4EndPoint *endPoint)
 {
   NS_LOG_FUNCTION (this << endPoint);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
-    {
-      if (*i == endPoint)
-        {
-          delete endPoint;
-          m_endPoints.erase (i);
-          break;
-        }
-    }
+  Unindex (endPoint);
+  delete endPoint;
 }
 
 /*
@@ -177,10 +216,9 @@ Ipv4EndPointDemux::GetAllEndPoints (void)
   NS_LOG_FUNCTION (this);
   EndPoints ret;
 
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  for (EndPointTable::iterator bucket = m_endPoints.begin (); bucket != m_endPoints.end (); bucket++)
     {
-      Ipv4EndPoint* endP = *i;
-      ret.push_back (endP);
+      ret.insert (ret.end (), bucket->second.begin (), bucket->second.end ());
     }
   return ret;
 }
@@ -204,21 +242,63 @@ Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport,
   EndPoints retval4; // Exact match on all 4
 
   NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  bool subnetDirected = false;
+  Ipv4Address incomingInterfaceAddr = daddr;  // may be a broadcast
+  for (uint32_t i = 0; incomingInterface != 0 && i < incomingInterface->GetNAddresses (); i++)
+    {
+      Ipv4InterfaceAddress addr = incomingInterface->GetAddress (i);
+      if (addr.GetLocal ().CombineMask (addr.GetMask ()) == daddr.CombineMask (addr.GetMask ()) &&
+          daddr.IsSubnetDirectedBroadcast (addr.GetMask ()))
+        {
+          subnetDirected = true;
+          incomingInterfaceAddr = addr.GetLocal ();
+        }
+    }
+  bool isBroadcast = (daddr.IsBroadcast () || subnetDirected == true);
+  NS_LOG_DEBUG ("dest addr " << daddr << " broadcast? " << isBroadcast);
+
+  // Only the end points whose addresses and peer port are either those of
+  // the packet or wildcards can match it: look up these four-tuples only.
+  // A broadcast matches the end points bound to the incoming interface.
+  Ipv4Address localAddresses[2] = { isBroadcast ? incomingInterfaceAddr : daddr, Ipv4Address::GetAny () };
+  Ipv4Address peerAddresses[2] = { saddr, Ipv4Address::GetAny () };
+  uint16_t peerPorts[2] = { sport, 0 };
+  EndPoints candidates;
+  for (uint32_t la = 0; la < 2; la++)
+    {
+      if (la == 1 && localAddresses[1] == localAddresses[0])
+        {
+          break;
+        }
+      for (uint32_t pa = 0; pa < 2; pa++)
+        {
+          if (pa == 1 && peerAddresses[1] == peerAddresses[0])
+            {
+              break;
+            }
+          for (uint32_t pp = 0; pp < 2; pp++)
+            {
+              if (pp == 1 && peerPorts[1] == peerPorts[0])
+                {
+                  break;
+                }
+              EndPointTable::iterator bucket = m_endPoints.find (Key (localAddresses[la], dport,
+                                                                      peerAddresses[pa], peerPorts[pp]));
+              if (bucket != m_endPoints.end ())
+                {
+                  candidates.insert (candidates.end (), bucket->second.begin (), bucket->second.end ());
+                }
+            }
+        }
+    }
+
+  for (EndPointsI i = candidates.begin (); i != candidates.end (); i++) 
     {
       Ipv4EndPoint* endP = *i;
       NS_LOG_DEBUG ("Looking at endpoint dport=" << endP->GetLocalPort ()
                                                  << " daddr=" << endP->GetLocalAddress ()
                                                  << " sport=" << endP->GetPeerPort ()
                                                  << " saddr=" << endP->GetPeerAddress ());
-      if (endP->GetLocalPort () != dport) 
-        {
-          NS_LOG_LOGIC ("Skipping endpoint " << &endP
-                                             << " because endpoint dport "
-                                             << endP->GetLocalPort ()
-                                             << " does not match packet dport " << dport);
-          continue;
-        }
       if (endP->GetBoundNetDevice ())
         {
           if (endP->GetBoundNetDevice () != incomingInterface->GetDevice ())
@@ -230,20 +310,6 @@ Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport,
               continue;
             }
         }
-      bool subnetDirected = false;
-      Ipv4Address incomingInterfaceAddr = daddr;  // may be a broadcast
-      for (uint32_t i = 0; i < incomingInterface->GetNAddresses (); i++)
-        {
-          Ipv4InterfaceAddress addr = incomingInterface->GetAddress (i);
-          if (addr.GetLocal ().CombineMask (addr.GetMask ()) == daddr.CombineMask (addr.GetMask ()) &&
-              daddr.IsSubnetDirectedBroadcast (addr.GetMask ()))
-            {
-              subnetDirected = true;
-              incomingInterfaceAddr = addr.GetLocal ();
-            }
-        }
-      bool isBroadcast = (daddr.IsBroadcast () || subnetDirected == true);
-      NS_LOG_DEBUG ("dest addr " << daddr << " broadcast? " << isBroadcast);
       bool localAddressMatchesWildCard = 
         endP->GetLocalAddress () == Ipv4Address::GetAny ();
       bool localAddressMatchesExact = endP->GetLocalAddress () == daddr;
@@ -317,33 +383,38 @@ Ipv4EndPointDemux::SimpleLookup (Ipv4Address daddr,
 
   // this code is a copy/paste version of an old BSD ip stack lookup
   // function.
+  EndPointTable::iterator exact = m_endPoints.find (Key (daddr, dport, saddr, sport));
+  if (exact != m_endPoints.end ())
+    {
+      /* this is an exact match. */
+      return exact->second.front ();
+    }
+  if (!LookupPortLocal (dport))
+    {
+      return 0;
+    }
+  // The end points of a bucket have the same addresses, hence genericity.
   uint32_t genericity = 3;
   Ipv4EndPoint *generic = 0;
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  for (EndPointTable::iterator bucket = m_endPoints.begin (); bucket != m_endPoints.end (); bucket++)
     {
-      if ((*i)->GetLocalPort () != dport) 
+      Ipv4EndPoint *endP = bucket->second.front ();
+      if (endP->GetLocalPort () != dport) 
         {
           continue;
         }
-      if ((*i)->GetLocalAddress () == daddr &&
-          (*i)->GetPeerPort () == sport &&
-          (*i)->GetPeerAddress () == saddr) 
-        {
-          /* this is an exact match. */
-          return *i;
-        }
       uint32_t tmp = 0;
-      if ((*i)->GetLocalAddress () == Ipv4Address::GetAny ()) 
+      if (endP->GetLocalAddress () == Ipv4Address::GetAny ()) 
         {
           tmp++;
         }
-      if ((*i)->GetPeerAddress () == Ipv4Address::GetAny ()) 
+      if (endP->GetPeerAddress () == Ipv4Address::GetAny ()) 
         {
           tmp++;
         }
       if (tmp < genericity) 
         {
-          generic = (*i);
+          generic = endP;
           genericity = tmp;
         }
     }
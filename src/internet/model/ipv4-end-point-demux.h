@@ -24,6 +24,7 @@
 #include <stdint.h>
 #include <list>
 #include "ns3/ipv4-address.h"
+#include "ns3/sgi-hashmap.h"
 #include "ipv4-interface.h"
 
 namespace ns3 {
@@ -34,10 +35,16 @@ class Ipv4EndPoint;
  * \brief Demultiplexes packets to various transport layer endpoints
  *
  * This class serves as a lookup table to match partial or full information
- * about a four-tuple to an ns3::Ipv4EndPoint.  It internally contains a list
- * of endpoints, and has APIs to add and find endpoints in this demux.  This
- * code is shared in common to TCP and UDP protocols in ns3.  This demux
+ * about a four-tuple to an ns3::Ipv4EndPoint.  It internally contains a hash
+ * table of endpoints, and has APIs to add and find endpoints in this demux.
+ * This code is shared in common to TCP and UDP protocols in ns3.  This demux
  * sits between ns3's layer four and the socket layer
+ *
+ * The endpoints are hashed by their four-tuple, wildcards included, so
+ * that a lookup only probes the few tuples which can match a packet,
+ * whatever the number of connections.  The local addresses and ports in
+ * use are counted in hash tables as well.  The endpoints notify the demux
+ * when their addresses or ports change, to be hashed again.
  */
 
 class Ipv4EndPointDemux {
@@ -152,6 +159,62 @@ public:
   void DeAllocate (Ipv4EndPoint *endPoint);
 
 private:
+  friend class Ipv4EndPoint;
+
+  /**
+   * \brief The addresses and ports of an end point, wildcards included.
+   */
+  struct Key
+  {
+    Ipv4Address localAddress; //!< The local address.
+    uint16_t localPort;       //!< The local port.
+    Ipv4Address peerAddress;  //!< The peer address.
+    uint16_t peerPort;        //!< The peer port.
+
+    /**
+     * \brief Constructor.
+     * \param localAddress the local address
+     * \param localPort the local port
+     * \param peerAddress the peer address
+     * \param peerPort the peer port
+     */
+    Key (Ipv4Address localAddress, uint16_t localPort,
+         Ipv4Address peerAddress, uint16_t peerPort);
+    /**
+     * \param o the other key
+     * \returns true if the keys are equal
+     */
+    bool operator == (Key const &o) const;
+  };
+
+  /**
+   * \brief Hash function of the keys.
+   */
+  struct KeyHash : public std::unary_function<Key, size_t>
+  {
+    /**
+     * \param key the key
+     * \returns the hash of the key
+     */
+    size_t operator () (Key const &key) const;
+  };
+
+  /**
+   * \brief The end points, by four-tuple.
+   */
+  typedef sgi::hash_map<Key, EndPoints, KeyHash> EndPointTable;
+
+  /**
+   * \brief Add an end point to the tables.
+   * \param endPoint the end point
+   */
+  void Index (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Remove an end point from the tables.
+   * \param endPoint the end point
+   */
+  void Unindex (Ipv4EndPoint *endPoint);
 
   /**
    * \brief Allocate an ephemeral port.
@@ -175,9 +238,26 @@ private:
   uint16_t m_portFirst;
 
   /**
-   * \brief A list of IPv4 end points.
+   * \brief The IPv4 end points, by four-tuple.
+   */
+  EndPointTable m_endPoints;
+
+  /**
+   * \brief The number of IPv4 end points.
+   */
+  uint32_t m_nEndPoints;
+
+  /**
+   * \brief The number of end points by local address and port.
+   *
+   * The peer address and port of the keys are wildcards.
+   */
+  sgi::hash_map<Key, uint32_t, KeyHash> m_localEndPoints;
+
+  /**
+   * \brief The number of end points by local port.
    */
-  EndPoints m_endPoints;
+  sgi::hash_map<uint16_t, uint32_t> m_localPorts;
 };
 
 } // namespace ns3
@@ -32,6 +32,7 @@ namespace ns3 {
 
 class Header;
 class Packet;
+class Ipv4EndPointDemux;
 
 /**
  * \brief A representation of an internet endpoint/connection
@@ -169,6 +170,8 @@ public:
                     uint32_t icmpInfo);
 
 private:
+  friend class Ipv4EndPointDemux;
+
   /**
    * \brief ForwardUp wrapper.
    * \param p packet
@@ -190,6 +193,14 @@ private:
                       uint8_t icmpType, uint8_t icmpCode,
                       uint32_t icmpInfo);
 
+  /**
+   * \brief The demux which indexes this end point by its addresses and
+   * ports, if any.
+   *
+   * The demux is notified when they change, to index the end point again.
+   */
+  Ipv4EndPointDemux *m_demux;
+
   /**
    * \brief The local address.
    */
@@ -21,6 +21,7 @@
 #define IPV4_GLOBAL_ROUTING_H
 
 #include <list>
+#include <vector>
 #include <stdint.h>
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv4-header.h"
@@ -28,6 +29,7 @@
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/random-variable-stream.h"
+#include "ipv4-route-trie.h"
 
 namespace ns3 {
 
@@ -216,6 +218,30 @@ public:
    */
   void RemoveRoute (uint32_t i);
 
+  /**
+   * \brief Get the host and network routes to a destination.
+   *
+   * This is how the GlobalRouteManager updates the routes to a few
+   * destinations without recomputing the whole table.
+   *
+   * \param network the destination network, or host.
+   * \param networkMask the mask of the destination.
+   * \param routes filled with the host routes, then the network routes,
+   * whose destination is exactly this one, in table order.
+   */
+  void GetRoutesTo (Ipv4Address network, Ipv4Mask networkMask,
+                    std::vector<Ipv4RoutingTableEntry *> &routes) const;
+
+  /**
+   * \brief Remove a host or network route from the global unicast routing
+   * table.
+   *
+   * \param route a route returned by GetRoutesTo.
+   *
+   * \see Ipv4GlobalRouting::GetRoutesTo
+   */
+  void DeleteRoute (Ipv4RoutingTableEntry *route);
+
   /**
    * Assign a fixed random variable stream number to the random variables
    * used by this model.  Return the number of streams (possibly zero) that
@@ -260,10 +286,25 @@ private:
 
   Ptr<Ipv4Route> LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif = 0);
 
+  /**
+   * \brief Find the routes to the longest prefix matching an address.
+   * \param trie the routes to look up.
+   * \param dest the destination address.
+   * \param oif the output interface of the routes, if not 0.
+   * \param routes filled with the routes to the longest matching prefix
+   *        which has routes on the output interface.
+   */
+  void LookupTrie (Ipv4RouteTrie const &trie, Ipv4Address dest, Ptr<NetDevice> oif,
+                   std::vector<Ipv4RoutingTableEntry *> &routes) const;
+
   HostRoutes m_hostRoutes;             //!< Routes to hosts
   NetworkRoutes m_networkRoutes;       //!< Routes to networks
   ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
 
+  Ipv4RouteTrie m_hostTrie;            //!< Index of m_hostRoutes
+  Ipv4RouteTrie m_networkTrie;         //!< Index of m_networkRoutes
+  Ipv4RouteTrie m_ASexternalTrie;      //!< Index of m_ASexternalRoutes
+
   Ptr<Ipv4> m_ipv4; //!< associated IPv4 instance
 };
 
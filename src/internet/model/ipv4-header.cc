@@ -384,12 +384,9 @@ Ipv4Header::Serialize (Buffer::Iterator start) const
 {
   NS_LOG_FUNCTION (this << &start);
   Buffer::Iterator i = start;
+  uint8_t *buffer = i.WriteSpan (20);
 
-  uint8_t verIhl = (4 << 4) | (5);
-  i.WriteU8 (verIhl);
-  i.WriteU8 (m_tos);
-  i.WriteHtonU16 (m_payloadSize + 5*4);
-  i.WriteHtonU16 (m_identification);
+  uint16_t totalLength = m_payloadSize + 5*4;
   uint32_t fragmentOffset = m_fragmentOffset / 8;
   uint8_t flagsFrag = (fragmentOffset >> 8) & 0x1f;
   if (m_flags & DONT_FRAGMENT) 
@@ -400,23 +397,25 @@ Ipv4Header::Serialize (Buffer::Iterator start) const
     {
       flagsFrag |= (1<<5);
     }
-  i.WriteU8 (flagsFrag);
-  uint8_t frag = fragmentOffset & 0xff;
-  i.WriteU8 (frag);
-  i.WriteU8 (m_ttl);
-  i.WriteU8 (m_protocol);
-  i.WriteHtonU16 (0);
-  i.WriteHtonU32 (m_source.Get ());
-  i.WriteHtonU32 (m_destination.Get ());
+  buffer[0] = (4 << 4) | (5);
+  buffer[1] = m_tos;
+  Buffer::WriteMsb (buffer + 2, totalLength, 2);
+  Buffer::WriteMsb (buffer + 4, m_identification, 2);
+  buffer[6] = flagsFrag;
+  buffer[7] = fragmentOffset & 0xff;
+  buffer[8] = m_ttl;
+  buffer[9] = m_protocol;
+  buffer[10] = 0;
+  buffer[11] = 0;
+  m_source.Serialize (buffer + 12);
+  m_destination.Serialize (buffer + 16);
 
   if (m_calcChecksum) 
     {
       i = start;
       uint16_t checksum = i.CalculateIpChecksum (20);
       NS_LOG_LOGIC ("checksum=" <<checksum);
-      i = start;
-      i.Next (10);
-      i.WriteU16 (checksum);
+      Buffer::WriteLsb (buffer + 10, checksum, 2);
     }
 }
 uint32_t
@@ -424,15 +423,17 @@ Ipv4Header::Deserialize (Buffer::Iterator start)
 {
   NS_LOG_FUNCTION (this << &start);
   Buffer::Iterator i = start;
-  uint8_t verIhl = i.ReadU8 ();
+  uint8_t scratch[20];
+  uint8_t const *buffer = i.ReadSpan (scratch, 20);
+  uint8_t verIhl = buffer[0];
   uint8_t ihl = verIhl & 0x0f; 
   uint16_t headerSize = ihl * 4;
   NS_ASSERT ((verIhl >> 4) == 4);
-  m_tos = i.ReadU8 ();
-  uint16_t size = i.ReadNtohU16 ();
+  m_tos = buffer[1];
+  uint16_t size = Buffer::ReadMsb (buffer + 2, 2);
   m_payloadSize = size - headerSize;
-  m_identification = i.ReadNtohU16 ();
-  uint8_t flags = i.ReadU8 ();
+  m_identification = Buffer::ReadMsb (buffer + 4, 2);
+  uint8_t flags = buffer[6];
   m_flags = 0;
   if (flags & (1<<6)) 
     {
@@ -442,17 +443,15 @@ Ipv4Header::Deserialize (Buffer::Iterator start)
     {
       m_flags |= MORE_FRAGMENTS;
     }
-  i.Prev ();
-  m_fragmentOffset = i.ReadU8 () & 0x1f;
+  m_fragmentOffset = flags & 0x1f;
   m_fragmentOffset <<= 8;
-  m_fragmentOffset |= i.ReadU8 ();
+  m_fragmentOffset |= buffer[7];
   m_fragmentOffset <<= 3;
-  m_ttl = i.ReadU8 ();
-  m_protocol = i.ReadU8 ();
-  m_checksum = i.ReadU16 ();
-  /* i.Next (2); // checksum */
-  m_source.Set (i.ReadNtohU32 ());
-  m_destination.Set (i.ReadNtohU32 ());
+  m_ttl = buffer[8];
+  m_protocol = buffer[9];
+  m_checksum = Buffer::ReadLsb (buffer + 10, 2);
+  m_source = Ipv4Address::Deserialize (buffer + 12);
+  m_destination = Ipv4Address::Deserialize (buffer + 16);
   m_headerSize = headerSize;
 
   if (m_calcChecksum) 
@@ -19,6 +19,7 @@
 //
 
 #include "ns3/packet.h"
+#include "ns3/packet-burst.h"
 #include "ns3/log.h"
 #include "ns3/callback.h"
 #include "ns3/ipv4-address.h"
@@ -112,6 +113,10 @@ Ipv4L3Protocol::GetTypeId (void)
 }
 
 Ipv4L3Protocol::Ipv4L3Protocol()
+  : m_ucb (MakeCallback (&Ipv4L3Protocol::IpForward, this)),
+    m_mcb (MakeCallback (&Ipv4L3Protocol::IpMulticastForward, this)),
+    m_lcb (MakeCallback (&Ipv4L3Protocol::LocalDeliver, this)),
+    m_ecb (MakeCallback (&Ipv4L3Protocol::RouteInputError, this))
 {
   NS_LOG_FUNCTION (this);
 }
@@ -281,6 +286,7 @@ Ipv4L3Protocol::SetupLoopback (void)
   uint32_t index = AddIpv4Interface (interface);
   Ptr<Node> node = GetObject<Node> ();
   node->RegisterProtocolHandler (MakeCallback (&Ipv4L3Protocol::Receive, this), 
+                                 MakeCallback (&Ipv4L3Protocol::ReceiveBurst, this),
                                  Ipv4L3Protocol::PROT_NUMBER, device);
   interface->SetUp ();
   if (m_routingProtocol != 0)
@@ -303,6 +309,7 @@ Ipv4L3Protocol::AddInterface (Ptr<NetDevice> device)
 
   Ptr<Node> node = GetObject<Node> ();
   node->RegisterProtocolHandler (MakeCallback (&Ipv4L3Protocol::Receive, this), 
+                                 MakeCallback (&Ipv4L3Protocol::ReceiveBurst, this),
                                  Ipv4L3Protocol::PROT_NUMBER, device);
   node->RegisterProtocolHandler (MakeCallback (&ArpL3Protocol::Receive, PeekPointer (GetObject<ArpL3Protocol> ())),
                                  ArpL3Protocol::PROT_NUMBER, device);
@@ -504,6 +511,59 @@ Ipv4L3Protocol::Receive ( Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t p
         }
     }
 
+  ReceivePacket (packet, device, ipv4Interface, interface);
+}
+
+void
+Ipv4L3Protocol::ReceiveBurst (Ptr<NetDevice> device, Ptr<const PacketBurst> burst, uint16_t protocol,
+                              const Address &from, const Address &to, NetDevice::PacketType packetType)
+{
+  NS_LOG_FUNCTION (this << device << burst << protocol << from << to << packetType);
+
+  NS_LOG_LOGIC (burst->GetNPackets () << " packets from " << from << " received on node " <<
+                m_node->GetId ());
+
+  uint32_t interface = 0;
+  Ptr<Ipv4Interface> ipv4Interface;
+  bool found = false;
+  for (Ipv4InterfaceList::const_iterator i = m_interfaces.begin (); 
+       i != m_interfaces.end (); 
+       i++, interface++)
+    {
+      ipv4Interface = *i;
+      if (ipv4Interface->GetDevice () == device)
+        {
+          found = true;
+          break;
+        }
+    }
+
+  Ptr<Ipv4> ipv4 = m_node->GetObject<Ipv4> ();
+  for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin (); i != burst->End (); ++i)
+    {
+      Ptr<Packet> packet = (*i)->Copy ();
+      if (found)
+        {
+          if (!ipv4Interface->IsUp ())
+            {
+              NS_LOG_LOGIC ("Dropping received packet -- interface is down");
+              Ipv4Header ipHeader;
+              packet->RemoveHeader (ipHeader);
+              m_dropTrace (ipHeader, packet, DROP_INTERFACE_DOWN, ipv4, interface);
+              continue;
+            }
+          m_rxTrace (packet, ipv4, interface);
+        }
+      ReceivePacket (packet, device, ipv4Interface, interface);
+    }
+}
+
+void
+Ipv4L3Protocol::ReceivePacket (Ptr<Packet> packet, Ptr<NetDevice> device, Ptr<Ipv4Interface> ipv4Interface,
+                               uint32_t interface)
+{
+  NS_LOG_FUNCTION (this << packet << device << ipv4Interface << interface);
+
   Ipv4Header ipHeader;
   if (Node::ChecksumEnabled ())
     {
@@ -532,12 +592,7 @@ Ipv4L3Protocol::Receive ( Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t p
     }
 
   NS_ASSERT_MSG (m_routingProtocol != 0, "Need a routing protocol object to process packets");
-  if (!m_routingProtocol->RouteInput (packet, ipHeader, device,
-                                      MakeCallback (&Ipv4L3Protocol::IpForward, this),
-                                      MakeCallback (&Ipv4L3Protocol::IpMulticastForward, this),
-                                      MakeCallback (&Ipv4L3Protocol::LocalDeliver, this),
-                                      MakeCallback (&Ipv4L3Protocol::RouteInputError, this)
-                                      ))
+  if (!m_routingProtocol->RouteInput (packet, ipHeader, device, m_ucb, m_mcb, m_lcb, m_ecb))
     {
       NS_LOG_WARN ("No route found for forwarding packet.  Drop.");
       m_dropTrace (ipHeader, packet, DROP_NO_ROUTE, m_node->GetObject<Ipv4> (), interface);
@@ -40,6 +40,7 @@ class Ipv4L3ProtocolTestCase;
 namespace ns3 {
 
 class Packet;
+class PacketBurst;
 class NetDevice;
 class Ipv4Interface;
 class Ipv4Address;
@@ -169,6 +170,20 @@ public:
   void Receive ( Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from,
                  const Address &to, NetDevice::PacketType packetType);
 
+  /**
+   * Lower layer calls this method for the packets which a device
+   * receives in bursts.  The interface of the device is looked up
+   * once for the whole burst; the packets are then routed one by one.
+   * \param device network device
+   * \param burst the packets
+   * \param protocol protocol value
+   * \param from address of the correspondant
+   * \param to address of the destination
+   * \param packetType type of the packets
+   */
+  void ReceiveBurst (Ptr<NetDevice> device, Ptr<const PacketBurst> burst, uint16_t protocol, const Address &from,
+                     const Address &to, NetDevice::PacketType packetType);
+
   /**
    * \param packet packet to send
    * \param source source address of packet
@@ -374,6 +389,16 @@ private:
    */
   void RouteInputError (Ptr<const Packet> p, const Ipv4Header & ipHeader, Socket::SocketErrno sockErrno);
 
+  /**
+   * \brief Process a packet received on an interface, and route it.
+   * \param packet the packet, with its IPv4 header
+   * \param device the device which received the packet
+   * \param ipv4Interface the interface of the device
+   * \param interface the index of the interface
+   */
+  void ReceivePacket (Ptr<Packet> packet, Ptr<NetDevice> device, Ptr<Ipv4Interface> ipv4Interface,
+                      uint32_t interface);
+
   /**
    * \brief Add an IPv4 interface to the stack.
    * \param interface interface to add
@@ -465,6 +490,11 @@ private:
 
   Ptr<Ipv4RoutingProtocol> m_routingProtocol; //!< Routing protocol associated with the stack
 
+  Ipv4RoutingProtocol::UnicastForwardCallback m_ucb;   //!< Callback to forward unicast packets
+  Ipv4RoutingProtocol::MulticastForwardCallback m_mcb; //!< Callback to forward multicast packets
+  Ipv4RoutingProtocol::LocalDeliverCallback m_lcb;     //!< Callback to deliver packets locally
+  Ipv4RoutingProtocol::ErrorCallback m_ecb;            //!< Callback for packets without a route
+
   SocketList m_sockets; //!< List of IPv4 raw sockets.
 
   /**
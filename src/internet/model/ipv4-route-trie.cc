@@ -0,0 +1,218 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ipv4-route-trie.h"
+#include "ipv4-routing-table-entry.h"
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Ipv4RouteTrie");
+
+namespace {
+
+/**
+ * \param length the length of a prefix.
+ * \returns the mask of the prefix.
+ */
+inline uint32_t
+MaskOf (uint32_t length)
+{
+  return length == 0 ? 0 : 0xffffffffU << (32 - length);
+}
+
+/**
+ * \param bits an address.
+ * \param i the index of a bit, from the most significant one.
+ * \returns the value of the bit.
+ */
+inline uint32_t
+BitOf (uint32_t bits, uint32_t i)
+{
+  return (bits >> (31 - i)) & 1;
+}
+
+} // anonymous namespace
+
+const uint32_t Ipv4RouteTrie::MAX_MATCHES;
+
+Ipv4RouteTrie::Ipv4RouteTrie ()
+  : m_root (CreateNode (0, 0))
+{
+  NS_LOG_FUNCTION (this);
+}
+
+Ipv4RouteTrie::~Ipv4RouteTrie ()
+{
+  NS_LOG_FUNCTION (this);
+  DeleteNode (m_root);
+}
+
+Ipv4RouteTrie::Node *
+Ipv4RouteTrie::CreateNode (uint32_t prefix, uint32_t length)
+{
+  Node *node = new Node;
+  node->prefix = prefix;
+  node->length = length;
+  node->child[0] = 0;
+  node->child[1] = 0;
+  return node;
+}
+
+void
+Ipv4RouteTrie::DeleteNode (Node *node)
+{
+  if (node != 0)
+    {
+      DeleteNode (node->child[0]);
+      DeleteNode (node->child[1]);
+      delete node;
+    }
+}
+
+void
+Ipv4RouteTrie::GetPrefix (Ipv4RoutingTableEntry const *route, uint32_t *prefix, uint32_t *length)
+{
+  // Ipv4Mask::GetPrefixLength counts up to the last one bit of the mask,
+  // which is too long for a non-contiguous mask: count the leading ones.
+  uint32_t mask = route->GetDestNetworkMask ().Get ();
+  *length = 0;
+  while (*length < 32 && BitOf (mask, *length) == 1)
+    {
+      (*length)++;
+    }
+  *prefix = route->GetDestNetwork ().Get () & MaskOf (*length);
+}
+
+void
+Ipv4RouteTrie::Insert (Ipv4RoutingTableEntry *route, uint32_t metric)
+{
+  NS_LOG_FUNCTION (this << route << metric);
+  uint32_t prefix;
+  uint32_t length;
+  GetPrefix (route, &prefix, &length);
+
+  // Invariant: the prefix of node is a prefix of the route, and is not
+  // longer than it.
+  Node *node = m_root;
+  while (node->length < length)
+    {
+      Node *&child = node->child[BitOf (prefix, node->length)];
+      if (child == 0)
+        {
+          child = CreateNode (prefix, length);
+          node = child;
+          break;
+        }
+      uint32_t common = node->length + 1;
+      uint32_t max = std::min (length, child->length);
+      while (common < max && BitOf (prefix, common) == BitOf (child->prefix, common))
+        {
+          common++;
+        }
+      if (common < child->length)
+        {
+          // The route diverges from the child, or ends, in the middle of
+          // its compressed path: split the path at this bit.
+          Node *split = CreateNode (prefix & MaskOf (common), common);
+          split->child[BitOf (child->prefix, common)] = child;
+          child = split;
+        }
+      node = child;
+    }
+  NS_ASSERT (node->length == length && node->prefix == prefix);
+  node->routes.push_back (std::make_pair (route, metric));
+}
+
+void
+Ipv4RouteTrie::Remove (Ipv4RoutingTableEntry *route)
+{
+  NS_LOG_FUNCTION (this << route);
+  uint32_t prefix;
+  uint32_t length;
+  GetPrefix (route, &prefix, &length);
+
+  Node **parentLink = 0;
+  Node **link = &m_root;
+  while ((*link)->length < length)
+    {
+      parentLink = link;
+      link = &(*link)->child[BitOf (prefix, (*link)->length)];
+      NS_ASSERT_MSG (*link != 0 && (*link)->length <= length, "Route not in the trie");
+    }
+  Node *node = *link;
+  NS_ASSERT_MSG (node->prefix == prefix, "Route not in the trie");
+  Routes::iterator i = node->routes.begin ();
+  while (i != node->routes.end () && i->first != route)
+    {
+      ++i;
+    }
+  NS_ASSERT_MSG (i != node->routes.end (), "Route not in the trie");
+  node->routes.erase (i);
+
+  // Every node but the root has routes or two children: remove the node,
+  // then its parent, if they have neither anymore.
+  for (uint32_t level = 0; level < 2 && node != m_root && node->routes.empty (); ++level)
+    {
+      if (node->child[0] != 0 && node->child[1] != 0)
+        {
+          break;
+        }
+      *link = node->child[0] != 0 ? node->child[0] : node->child[1];
+      delete node;
+      if (parentLink == 0)
+        {
+          break;
+        }
+      link = parentLink;
+      parentLink = 0;
+      node = *link;
+    }
+}
+
+void
+Ipv4RouteTrie::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  DeleteNode (m_root);
+  m_root = CreateNode (0, 0);
+}
+
+uint32_t
+Ipv4RouteTrie::Lookup (Ipv4Address dest, Routes const *matches[]) const
+{
+  NS_LOG_FUNCTION (this << dest << matches);
+  uint32_t bits = dest.Get ();
+  uint32_t n = 0;
+  Node const *node = m_root;
+  while (node != 0 && (bits & MaskOf (node->length)) == node->prefix)
+    {
+      if (!node->routes.empty ())
+        {
+          matches[n++] = &node->routes;
+        }
+      if (node->length == 32)
+        {
+          break;
+        }
+      node = node->child[BitOf (bits, node->length)];
+    }
+  return n;
+}
+
+} // namespace ns3
@@ -0,0 +1,136 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef IPV4_ROUTE_TRIE_H
+#define IPV4_ROUTE_TRIE_H
+
+#include <vector>
+#include <utility>
+#include <stdint.h>
+#include "ns3/ipv4-address.h"
+
+namespace ns3 {
+
+class Ipv4RoutingTableEntry;
+
+/**
+ * \ingroup internet
+ *
+ * \brief Longest prefix match index of Ipv4RoutingTableEntry.
+ *
+ * The routes are stored in a path-compressed binary radix trie, indexed
+ * by their destination network and mask: a lookup visits at most one
+ * node per prefix length matching the destination, whatever the number
+ * of routes.  Each node holds the routes to one prefix, in the order in
+ * which they were inserted, so that routing protocols can apply their
+ * own policy (metrics, equal-cost multipath, output interface) among the
+ * routes to the longest prefix.
+ *
+ * The trie does not own the routes: the routing protocols keep them in
+ * their lists, which define the route indices, and insert and remove
+ * them in the trie as well.
+ *
+ * A route whose mask is not contiguous, such as 255.0.255.0, is stored
+ * under the prefix made of the leading one bits of its mask, /8 in this
+ * example.  Such a route is returned for addresses which it does not
+ * match, and its prefix is shorter than Ipv4Mask::GetPrefixLength: the
+ * callers must check the rest of the mask with Ipv4Mask::IsMatch, and
+ * compare the routes of all the matching prefixes if they rank them by
+ * Ipv4Mask::GetPrefixLength.
+ */
+class Ipv4RouteTrie
+{
+public:
+  /// A route, with a metric for the protocols which have one.
+  typedef std::pair<Ipv4RoutingTableEntry *, uint32_t> Route;
+  /// The routes to a prefix, in insertion order.
+  typedef std::vector<Route> Routes;
+
+  /// The maximum number of prefixes matching an address, /0 to /32.
+  static const uint32_t MAX_MATCHES = 33;
+
+  Ipv4RouteTrie ();
+  ~Ipv4RouteTrie ();
+
+  /**
+   * \brief Add a route after the other routes to the same prefix.
+   * \param route the route, indexed by its destination network and mask.
+   * \param metric the metric of the route.
+   */
+  void Insert (Ipv4RoutingTableEntry *route, uint32_t metric = 0);
+  /**
+   * \brief Remove a route.
+   * \param route a route previously inserted.
+   */
+  void Remove (Ipv4RoutingTableEntry *route);
+  /**
+   * \brief Remove all the routes.
+   */
+  void Clear (void);
+  /**
+   * \brief Find the prefixes which match an address.
+   * \param dest the address.
+   * \param matches an array of MAX_MATCHES elements, filled with the
+   *        routes of the matching prefixes, from the shortest to the longest.
+   * \returns the number of matching prefixes.
+   */
+  uint32_t Lookup (Ipv4Address dest, Routes const *matches[]) const;
+
+private:
+  /// A node of the trie.
+  struct Node
+  {
+    uint32_t prefix;        //!< The bits of the prefix, the others are zero.
+    uint32_t length;        //!< The length of the prefix.
+    Node *child[2];         //!< The children, by the bit after the prefix.
+    Routes routes;          //!< The routes to this prefix.
+  };
+
+  /**
+   * Disallow copy.
+   * \param o the trie to copy
+   */
+  Ipv4RouteTrie (Ipv4RouteTrie const &o);
+  /**
+   * Disallow assignment.
+   * \param o the trie to copy
+   * \returns this trie
+   */
+  Ipv4RouteTrie &operator = (Ipv4RouteTrie const &o);
+
+  /**
+   * \param prefix the bits of a prefix.
+   * \param length the length of the prefix.
+   * \returns a new node without routes nor children.
+   */
+  static Node *CreateNode (uint32_t prefix, uint32_t length);
+  /**
+   * \param node a node to delete, with its descendants.
+   */
+  static void DeleteNode (Node *node);
+  /**
+   * \param route a route.
+   * \param prefix the bits of the prefix of the route.
+   * \param length the length of the prefix of the route, which is the
+   *        number of leading one bits of its mask.
+   */
+  static void GetPrefix (Ipv4RoutingTableEntry const *route, uint32_t *prefix, uint32_t *length);
+
+  Node *m_root;            //!< The node of the /0 prefix.
+};
+
+} // namespace ns3
+
+#endif /* IPV4_ROUTE_TRIE_H */
@@ -26,10 +26,34 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Ipv6EndPointDemux");
 
+Ipv6EndPointDemux::Key::Key (Ipv6Address localAddress, uint16_t localPort,
+                             Ipv6Address peerAddress, uint16_t peerPort)
+  : localAddress (localAddress),
+    localPort (localPort),
+    peerAddress (peerAddress),
+    peerPort (peerPort)
+{
+}
+
+bool Ipv6EndPointDemux::Key::operator == (Key const &o) const
+{
+  return localPort == o.localPort && peerPort == o.peerPort
+         && localAddress == o.localAddress && peerAddress == o.peerAddress;
+}
+
+size_t Ipv6EndPointDemux::KeyHash::operator () (Key const &key) const
+{
+  Ipv6AddressHash hash;
+  size_t h = hash (key.localAddress);
+  h = h * 31 + hash (key.peerAddress);
+  return h * 31 + ((static_cast<uint32_t> (key.localPort) << 16) | key.peerPort);
+}
+
 Ipv6EndPointDemux::Ipv6EndPointDemux ()
   : m_ephemeral (49152),
     m_portFirst (49152),
-    m_portLast (65535)
+    m_portLast (65535),
+    m_nEndPoints (0)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -37,39 +61,63 @@ Ipv6EndPointDemux::Ipv6EndPointDemux ()
 Ipv6EndPointDemux::~Ipv6EndPointDemux ()
 {
   NS_LOG_FUNCTION_NOARGS ();
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  for (EndPointTable::iterator bucket = m_endPoints.begin (); bucket != m_endPoints.end (); bucket++)
     {
-      Ipv6EndPoint *endPoint = *i;
-      delete endPoint;
+      for (EndPointsI i = bucket->second.begin (); i != bucket->second.end (); i++)
+        {
+          Ipv6EndPoint *endPoint = *i;
+          delete endPoint;
+        }
     }
   m_endPoints.clear ();
 }
 
-bool Ipv6EndPointDemux::LookupPortLocal (uint16_t port)
+void Ipv6EndPointDemux::Index (Ipv6EndPoint *endPoint)
 {
-  NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  NS_LOG_FUNCTION (this << endPoint);
+  endPoint->m_demux = this;
+  m_endPoints[Key (endPoint->m_localAddr, endPoint->m_localPort,
+                   endPoint->m_peerAddr, endPoint->m_peerPort)].push_back (endPoint);
+  m_nEndPoints++;
+  m_localEndPoints[Key (endPoint->m_localAddr, endPoint->m_localPort, Ipv6Address::GetAny (), 0)]++;
+  m_localPorts[endPoint->m_localPort]++;
+}
+
+void Ipv6EndPointDemux::Unindex (Ipv6EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  EndPointTable::iterator bucket = m_endPoints.find (Key (endPoint->m_localAddr, endPoint->m_localPort,
+                                                          endPoint->m_peerAddr, endPoint->m_peerPort));
+  NS_ASSERT_MSG (bucket != m_endPoints.end (), "End point not in the demux");
+  bucket->second.remove (endPoint);
+  if (bucket->second.empty ())
     {
-      if ((*i)->GetLocalPort  () == port)
-        {
-          return true;
-        }
+      m_endPoints.erase (bucket);
+    }
+  m_nEndPoints--;
+  sgi::hash_map<Key, uint32_t, KeyHash>::iterator local =
+    m_localEndPoints.find (Key (endPoint->m_localAddr, endPoint->m_localPort, Ipv6Address::GetAny (), 0));
+  if (--local->second == 0)
+    {
+      m_localEndPoints.erase (local);
+    }
+  sgi::hash_map<uint16_t, uint32_t>::iterator port = m_localPorts.find (endPoint->m_localPort);
+  if (--port->second == 0)
+    {
+      m_localPorts.erase (port);
     }
-  return false;
+}
+
+bool Ipv6EndPointDemux::LookupPortLocal (uint16_t port)
+{
+  NS_LOG_FUNCTION (this << port);
+  return m_localPorts.find (port) != m_localPorts.end ();
 }
 
 bool Ipv6EndPointDemux::LookupLocal (Ipv6Address addr, uint16_t port)
 {
   NS_LOG_FUNCTION (this << addr << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
-    {
-      if ((*i)->GetLocalPort () == port
-          && (*i)->GetLocalAddress () == addr)
-        {
-          return true;
-        }
-    }
-  return false;
+  return m_localEndPoints.find (Key (addr, port, Ipv6Address::GetAny (), 0)) != m_localEndPoints.end ();
 }
 
 Ipv6EndPoint* Ipv6EndPointDemux::Allocate ()
@@ -82,8 +130,8 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate ()
       return 0;
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (Ipv6Address::GetAny (), port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  Index (endPoint);
+  NS_LOG_DEBUG ("Now have >>" << m_nEndPoints << "<< endpoints.");
   return endPoint;
 }
 
@@ -97,8 +145,8 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address address)
       return 0;
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  Index (endPoint);
+  NS_LOG_DEBUG ("Now have >>" << m_nEndPoints << "<< endpoints.");
   return endPoint;
 }
 
@@ -118,8 +166,8 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address address, uint16_t port)
       return 0;
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  Index (endPoint);
+  NS_LOG_DEBUG ("Now have >>" << m_nEndPoints << "<< endpoints.");
   return endPoint;
 }
 
@@ -127,23 +175,17 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address localAddress, uint16_t lo
                                            Ipv6Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << localAddress << localPort << peerAddress << peerPort);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  if (m_endPoints.find (Key (localAddress, localPort, peerAddress, peerPort)) != m_endPoints.end ())
     {
-      if ((*i)->GetLocalPort () == localPort
-          && (*i)->GetLocalAddress () == localAddress
-          && (*i)->GetPeerPort () == peerPort
-          && (*i)->GetPeerAddress () == peerAddress)
-        {
-          NS_LOG_WARN ("No way we can allocate this end-point.");
-          /* no way we can allocate this end-point. */
-          return 0;
-        }
+      NS_LOG_WARN ("No way we can allocate this end-point.");
+      /* no way we can allocate this end-point. */
+      return 0;
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (localAddress, localPort);
   endPoint->SetPeer (peerAddress, peerPort);
-  m_endPoints.push_back (endPoint);
+  Index (endPoint);
 
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  NS_LOG_DEBUG ("Now have >>" << m_nEndPoints << "<< endpoints.");
 
   return endPoint;
 }
@@ -151,15 +193,8 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address localAddress, uint16_t lo
 void Ipv6EndPointDemux::DeAllocate (Ipv6EndPoint *endPoint)
 {
   NS_LOG_FUNCTION_NOARGS ();
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
-    {
-      if (*i == endPoint)
-        {
-          delete endPoint;
-          m_endPoints.erase (i);
-          break;
-        }
-    }
+  Unindex (endPoint);
+  delete endPoint;
 }
 
 /*
@@ -179,21 +214,48 @@ Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::Lookup (Ipv6Address daddr, uint1
   EndPoints retval4; /* Exact match on all 4 */
 
   NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+
+  /* Only the end points whose addresses and peer port are either those of
+     the packet or wildcards can match it: look up these four-tuples only. */
+  Ipv6Address localAddresses[2] = { daddr, Ipv6Address::GetAny () };
+  Ipv6Address peerAddresses[2] = { saddr, Ipv6Address::GetAny () };
+  uint16_t peerPorts[2] = { sport, 0 };
+  EndPoints candidates;
+  for (uint32_t la = 0; la < 2; la++)
+    {
+      if (la == 1 && localAddresses[1] == localAddresses[0])
+        {
+          break;
+        }
+      for (uint32_t pa = 0; pa < 2; pa++)
+        {
+          if (pa == 1 && peerAddresses[1] == peerAddresses[0])
+            {
+              break;
+            }
+          for (uint32_t pp = 0; pp < 2; pp++)
+            {
+              if (pp == 1 && peerPorts[1] == peerPorts[0])
+                {
+                  break;
+                }
+              EndPointTable::iterator bucket = m_endPoints.find (Key (localAddresses[la], dport,
+                                                                      peerAddresses[pa], peerPorts[pp]));
+              if (bucket != m_endPoints.end ())
+                {
+                  candidates.insert (candidates.end (), bucket->second.begin (), bucket->second.end ());
+                }
+            }
+        }
+    }
+
+  for (EndPointsI i = candidates.begin (); i != candidates.end (); i++)
     {
       Ipv6EndPoint* endP = *i;
       NS_LOG_DEBUG ("Looking at endpoint dport=" << endP->GetLocalPort ()
                                                  << " daddr=" << endP->GetLocalAddress ()
                                                  << " sport=" << endP->GetPeerPort ()
                                                  << " saddr=" << endP->GetPeerAddress ());
-      if (endP->GetLocalPort () != dport)
-        {
-          NS_LOG_LOGIC ("Skipping endpoint " << &endP
-                                             << " because endpoint dport "
-                                             << endP->GetLocalPort ()
-                                             << " does not match packet dport " << dport);
-          continue;
-        }
 
       if (endP->GetBoundNetDevice ())
         {
@@ -284,38 +346,44 @@ Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::Lookup (Ipv6Address daddr, uint1
 
 Ipv6EndPoint* Ipv6EndPointDemux::SimpleLookup (Ipv6Address dst, uint16_t dport, Ipv6Address src, uint16_t sport)
 {
+  EndPointTable::iterator exact = m_endPoints.find (Key (dst, dport, src, sport));
+  if (exact != m_endPoints.end ())
+    {
+      /* this is an exact match. */
+      return exact->second.front ();
+    }
+  if (!LookupPortLocal (dport))
+    {
+      return 0;
+    }
+
+  /* The end points of a bucket have the same addresses, hence genericity. */
   uint32_t genericity = 3;
   Ipv6EndPoint *generic = 0;
 
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  for (EndPointTable::iterator bucket = m_endPoints.begin (); bucket != m_endPoints.end (); bucket++)
     {
+      Ipv6EndPoint *endP = bucket->second.front ();
       uint32_t tmp = 0;
 
-      if ((*i)->GetLocalPort () != dport)
+      if (endP->GetLocalPort () != dport)
         {
           continue;
         }
 
-      if ((*i)->GetLocalAddress () == dst && (*i)->GetPeerPort () == sport
-          && (*i)->GetPeerAddress () == src)
-        {
-          /* this is an exact match. */
-          return *i;
-        }
-
-      if ((*i)->GetLocalAddress () == Ipv6Address::GetAny ())
+      if (endP->GetLocalAddress () == Ipv6Address::GetAny ())
         {
           tmp++;
         }
 
-      if ((*i)->GetPeerAddress () == Ipv6Address::GetAny ())
+      if (endP->GetPeerAddress () == Ipv6Address::GetAny ())
         {
           tmp++;
         }
 
       if (tmp < genericity)
         {
-          generic = (*i);
+          generic = endP;
           genericity = tmp;
         }
     }
@@ -346,7 +414,12 @@ uint16_t Ipv6EndPointDemux::AllocateEphemeralPort ()
 
 Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::GetEndPoints () const
 {
-  return m_endPoints;
+  EndPoints ret;
+  for (EndPointTable::const_iterator bucket = m_endPoints.begin (); bucket != m_endPoints.end (); bucket++)
+    {
+      ret.insert (ret.end (), bucket->second.begin (), bucket->second.end ());
+    }
+  return ret;
 }
 
 } /* namespace ns3 */
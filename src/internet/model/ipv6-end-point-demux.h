@@ -24,6 +24,7 @@
 #include <stdint.h>
 #include <list>
 #include "ns3/ipv6-address.h"
+#include "ns3/sgi-hashmap.h"
 #include "ipv6-interface.h"
 
 namespace ns3 {
@@ -33,6 +34,10 @@ class Ipv6EndPoint;
 /**
  * \class Ipv6EndPointDemux
  * \brief Demultiplexor for end points.
+ *
+ * The end points are hashed by their four-tuple, wildcards included, so
+ * that a lookup only probes the few tuples which can match a packet.  The
+ * end points notify the demux when their addresses or ports change.
  */
 class Ipv6EndPointDemux
 {
@@ -137,6 +142,63 @@ public:
   EndPoints GetEndPoints () const;
 
 private:
+  friend class Ipv6EndPoint;
+
+  /**
+   * \brief The addresses and ports of an end point, wildcards included.
+   */
+  struct Key
+  {
+    Ipv6Address localAddress; //!< The local address.
+    uint16_t localPort;       //!< The local port.
+    Ipv6Address peerAddress;  //!< The peer address.
+    uint16_t peerPort;        //!< The peer port.
+
+    /**
+     * \brief Constructor.
+     * \param localAddress the local address
+     * \param localPort the local port
+     * \param peerAddress the peer address
+     * \param peerPort the peer port
+     */
+    Key (Ipv6Address localAddress, uint16_t localPort,
+         Ipv6Address peerAddress, uint16_t peerPort);
+    /**
+     * \param o the other key
+     * \returns true if the keys are equal
+     */
+    bool operator == (Key const &o) const;
+  };
+
+  /**
+   * \brief Hash function of the keys.
+   */
+  struct KeyHash : public std::unary_function<Key, size_t>
+  {
+    /**
+     * \param key the key
+     * \returns the hash of the key
+     */
+    size_t operator () (Key const &key) const;
+  };
+
+  /**
+   * \brief The end points, by four-tuple.
+   */
+  typedef sgi::hash_map<Key, EndPoints, KeyHash> EndPointTable;
+
+  /**
+   * \brief Add an end point to the tables.
+   * \param endPoint the end point
+   */
+  void Index (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Remove an end point from the tables.
+   * \param endPoint the end point
+   */
+  void Unindex (Ipv6EndPoint *endPoint);
+
   /**
    * \brief Allocate a ephemeral port.
    * \return a port
@@ -159,9 +221,26 @@ private:
   uint16_t m_portLast;
 
   /**
-   * \brief A list of IPv6 end points.
+   * \brief The IPv6 end points, by four-tuple.
+   */
+  EndPointTable m_endPoints;
+
+  /**
+   * \brief The number of IPv6 end points.
+   */
+  uint32_t m_nEndPoints;
+
+  /**
+   * \brief The number of end points by local address and port.
+   *
+   * The peer address and port of the keys are wildcards.
+   */
+  sgi::hash_map<Key, uint32_t, KeyHash> m_localEndPoints;
+
+  /**
+   * \brief The number of end points by local port.
    */
-  EndPoints m_endPoints;
+  sgi::hash_map<uint16_t, uint32_t> m_localPorts;
 };
 
 } /* namespace ns3 */
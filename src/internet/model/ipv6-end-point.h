@@ -34,6 +34,7 @@ namespace ns3
 
 class Header;
 class Packet;
+class Ipv6EndPointDemux;
 
 /**
  * \brief A representation of an internet IPv6 endpoint/connection
@@ -178,6 +179,8 @@ public:
                     uint8_t code, uint32_t info);
 
 private:
+  friend class Ipv6EndPointDemux;
+
   /**
    * \brief ForwardUp wrapper.
    * \param p packet
@@ -198,6 +201,14 @@ private:
   void DoForwardIcmp (Ipv6Address src, uint8_t ttl, uint8_t type,
                       uint8_t code, uint32_t info);
 
+  /**
+   * \brief The demux which indexes this end point by its addresses and
+   * ports, if any.
+   *
+   * The demux is notified when they change, to index the end point again.
+   */
+  Ipv6EndPointDemux *m_demux;
+
   /**
    * \brief The local address.
    */
@@ -303,14 +303,19 @@ void
 TcpHeader::Serialize (Buffer::Iterator start)  const
 {
   Buffer::Iterator i = start;
-  i.WriteHtonU16 (m_sourcePort);
-  i.WriteHtonU16 (m_destinationPort);
-  i.WriteHtonU32 (m_sequenceNumber.GetValue ());
-  i.WriteHtonU32 (m_ackNumber.GetValue ());
-  i.WriteHtonU16 (GetLength () << 12 | m_flags); //reserved bits are all zero
-  i.WriteHtonU16 (m_windowSize);
-  i.WriteHtonU16 (0);
-  i.WriteHtonU16 (m_urgentPointer);
+  uint8_t *buffer = i.WriteSpan (20);
+  uint32_t sequenceNumber = m_sequenceNumber.GetValue ();
+  uint32_t ackNumber = m_ackNumber.GetValue ();
+  uint16_t field = GetLength () << 12 | m_flags; //reserved bits are all zero
+  Buffer::WriteMsb (buffer, m_sourcePort, 2);
+  Buffer::WriteMsb (buffer + 2, m_destinationPort, 2);
+  Buffer::WriteMsb (buffer + 4, sequenceNumber, 4);
+  Buffer::WriteMsb (buffer + 8, ackNumber, 4);
+  Buffer::WriteMsb (buffer + 12, field, 2);
+  Buffer::WriteMsb (buffer + 14, m_windowSize, 2);
+  buffer[16] = 0;
+  buffer[17] = 0;
+  Buffer::WriteMsb (buffer + 18, m_urgentPointer, 2);
 
   // Serialize options if they exist
   // This implementation does not presently try to align options on word
@@ -337,10 +342,7 @@ TcpHeader::Serialize (Buffer::Iterator start)  const
       uint16_t headerChecksum = CalculateHeaderChecksum (start.GetSize ());
       i = start;
       uint16_t checksum = i.CalculateIpChecksum (start.GetSize (), headerChecksum);
-
-      i = start;
-      i.Next (16);
-      i.WriteU16 (checksum);
+      Buffer::WriteLsb (buffer + 16, checksum, 2);
     }
 }
 
@@ -348,16 +350,17 @@ uint32_t
 TcpHeader::Deserialize (Buffer::Iterator start)
 {
   Buffer::Iterator i = start;
-  m_sourcePort = i.ReadNtohU16 ();
-  m_destinationPort = i.ReadNtohU16 ();
-  m_sequenceNumber = i.ReadNtohU32 ();
-  m_ackNumber = i.ReadNtohU32 ();
-  uint16_t field = i.ReadNtohU16 ();
+  uint8_t scratch[20];
+  uint8_t const *buffer = i.ReadSpan (scratch, 20);
+  m_sourcePort = Buffer::ReadMsb (buffer, 2);
+  m_destinationPort = Buffer::ReadMsb (buffer + 2, 2);
+  m_sequenceNumber = Buffer::ReadMsb (buffer + 4, 4);
+  m_ackNumber = Buffer::ReadMsb (buffer + 8, 4);
+  uint16_t field = Buffer::ReadMsb (buffer + 12, 2);
   m_flags = field & 0x3F;
   m_length = field>>12;
-  m_windowSize = i.ReadNtohU16 ();
-  i.Next (2);
-  m_urgentPointer = i.ReadNtohU16 ();
+  m_windowSize = Buffer::ReadMsb (buffer + 14, 2);
+  m_urgentPointer = Buffer::ReadMsb (buffer + 18, 2);
 
   // Deserialize options if they exist
   m_options.clear ();
@@ -36,6 +36,12 @@ class Packet;
  *
  * \brief class for the reordering buffer that keeps the data from lower layer, i.e.
  *        TcpL4Protocol, sent to the application
+ *
+ * The packets are kept by sequence number, without overlap.  A new packet
+ * is only compared with the buffered packets around its sequence numbers,
+ * and only a packet filling the hole at the head of the out-of-order data
+ * makes the following packets available, so that the cost of adding a
+ * segment does not depend on the number of buffered segments.
  */
 class TcpRxBuffer : public Object
 {
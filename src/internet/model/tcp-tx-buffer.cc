@@ -57,7 +57,7 @@ TcpTxBuffer::GetTypeId (void)
  * initialized below is insignificant.
  */
 TcpTxBuffer::TcpTxBuffer (uint32_t n)
-  : m_firstByteSeq (n), m_size (0), m_maxBuffer (32768), m_data (0)
+  : m_firstByteSeq (n), m_size (0), m_maxBuffer (32768), m_headOffset (0), m_next (0)
 {
 }
 
@@ -111,7 +111,7 @@ TcpTxBuffer::Add (Ptr<Packet> p)
     {
       if (p->GetSize () > 0)
         {
-          m_data.push_back (p);
+          m_data.push_back (BufItem (m_headOffset + m_size, p));
           m_size += p->GetSize ();
           NS_LOG_LOGIC ("Updated size=" << m_size << ", lastSeq=" << m_firstByteSeq + SequenceNumber32 (m_size));
         }
@@ -133,6 +133,37 @@ TcpTxBuffer::SizeFromSequence (const SequenceNumber32& seq) const
   return lastSeq - seq;
 }
 
+uint32_t
+TcpTxBuffer::FindPacket (uint32_t offset) const
+{
+  NS_ASSERT (offset < m_size);
+  // Sending in sequence, the byte follows the previous copy
+  if (m_next < m_data.size ())
+    {
+      uint32_t start = m_data[m_next].first - m_headOffset;
+      if (start <= offset && offset - start < m_data[m_next].second->GetSize ())
+        {
+          return m_next;
+        }
+    }
+  // Otherwise, look for the last packet starting at or before the byte
+  uint32_t low = 0;
+  uint32_t high = m_data.size ();
+  while (high - low > 1)
+    {
+      uint32_t middle = low + (high - low) / 2;
+      if (m_data[middle].first - m_headOffset <= offset)
+        {
+          low = middle;
+        }
+      else
+        {
+          high = middle;
+        }
+    }
+  return low;
+}
+
 Ptr<Packet>
 TcpTxBuffer::CopyFromSequence (uint32_t numBytes, const SequenceNumber32& seq)
 {
@@ -149,54 +180,35 @@ TcpTxBuffer::CopyFromSequence (uint32_t numBytes, const SequenceNumber32& seq)
 
   // Extract data from the buffer and return
   uint32_t offset = seq - m_firstByteSeq.Get ();
-  uint32_t count = 0;      // Offset of the first byte of a packet in the buffer
-  uint32_t pktSize = 0;
-  bool beginFound = false;
-  int pktCount = 0;
-  Ptr<Packet> outPacket;
-  NS_LOG_LOGIC ("There are " << m_data.size () << " number of packets in buffer");
-  for (BufIterator i = m_data.begin (); i != m_data.end (); ++i)
+  uint32_t i = FindPacket (offset);
+  uint32_t packetOffset = offset - (m_data[i].first - m_headOffset);
+  uint32_t pktSize = m_data[i].second->GetSize ();
+  uint32_t fragmentLength = std::min (s, pktSize - packetOffset);
+  NS_LOG_LOGIC ("First byte found in packet #" << i << " at offset " << packetOffset
+                                               << ", packet len=" << pktSize);
+  Ptr<Packet> outPacket = m_data[i].second->CreateFragment (packetOffset, fragmentLength);
+  uint32_t copied = fragmentLength;
+  uint32_t end = packetOffset + fragmentLength; // Offset following the copy in packet #i
+  while (copied < s)
     {
-      pktCount++;
-      pktSize = (*i)->GetSize ();
-      if (!beginFound)
-        { // Look for first fragment
-          if (count + pktSize > offset)
-            {
-              NS_LOG_LOGIC ("First byte found in packet #" << pktCount << " at buffer offset " << count
-                                                           << ", packet len=" << pktSize);
-              beginFound = true;
-              uint32_t packetOffset = offset - count;
-              uint32_t fragmentLength = count + pktSize - offset;
-              if (fragmentLength >= s)
-                { // Data to be copied falls entirely in this packet
-                  return (*i)->CreateFragment (packetOffset, s);
-                }
-              else
-                { // This packet only fulfills part of the request
-                  outPacket = (*i)->CreateFragment (packetOffset, fragmentLength);
-                }
-              NS_LOG_LOGIC ("Output packet is now of size " << outPacket->GetSize ());
-            }
-        }
-      else if (count + pktSize >= offset + s)
-        { // Last packet fragment found
-          NS_LOG_LOGIC ("Last byte found in packet #" << pktCount << " at buffer offset " << count
-                                                      << ", packet len=" << pktSize);
-          uint32_t fragmentLength = offset + s - count;
-          Ptr<Packet> endFragment = (*i)->CreateFragment (0, fragmentLength);
-          outPacket->AddAtEnd (endFragment);
-          NS_LOG_LOGIC ("Output packet is now of size " << outPacket->GetSize ());
-          break;
+      ++i;
+      pktSize = m_data[i].second->GetSize ();
+      fragmentLength = std::min (s - copied, pktSize);
+      if (fragmentLength == pktSize)
+        {
+          NS_LOG_LOGIC ("Appending to output the packet #" << i << " len=" << pktSize);
+          outPacket->AddAtEnd (m_data[i].second);
         }
       else
-        {
-          NS_LOG_LOGIC ("Appending to output the packet #" << pktCount << " of offset " << count << " len=" << pktSize);
-          outPacket->AddAtEnd (*i);
-          NS_LOG_LOGIC ("Output packet is now of size " << outPacket->GetSize ());
+        { // Last packet fragment found
+          NS_LOG_LOGIC ("Last byte found in packet #" << i << ", packet len=" << pktSize);
+          outPacket->AddAtEnd (m_data[i].second->CreateFragment (0, fragmentLength));
         }
-      count += pktSize;
+      copied += fragmentLength;
+      end = fragmentLength;
     }
+  m_next = end == pktSize ? i + 1 : i;
+  NS_LOG_LOGIC ("Output packet is now of size " << outPacket->GetSize ());
   NS_ASSERT (outPacket->GetSize () == s);
   return outPacket;
 }
@@ -217,37 +229,37 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
   // Cases do not need to scan the buffer
   if (m_firstByteSeq >= seq) return;
 
-  // Scan the buffer and discard packets
+  // Discard the packets from the head of the buffer
   uint32_t offset = seq - m_firstByteSeq.Get ();  // Number of bytes to remove
   uint32_t pktSize;
+  uint32_t removed = 0;
   NS_LOG_LOGIC ("Offset=" << offset);
-  BufIterator i = m_data.begin ();
-  while (i != m_data.end ())
+  while (offset > 0 && !m_data.empty ())
     {
-      if (offset > (*i)->GetSize ())
+      pktSize = m_data.front ().second->GetSize ();
+      if (offset >= pktSize)
         { // This packet is behind the seqnum. Remove this packet from the buffer
-          pktSize = (*i)->GetSize ();
           m_size -= pktSize;
+          m_headOffset += pktSize;
           offset -= pktSize;
-          m_firstByteSeq += pktSize;
-          i = m_data.erase (i);
+          m_data.pop_front ();
+          removed++;
           NS_LOG_LOGIC ("Removed one packet of size " << pktSize << ", offset=" << offset);
         }
-      else if (offset > 0)
+      else
         { // Part of the packet is behind the seqnum. Fragment
-          pktSize = (*i)->GetSize () - offset;
-          *i = (*i)->CreateFragment (offset, pktSize);
+          pktSize -= offset;
+          m_data.front ().second = m_data.front ().second->CreateFragment (offset, pktSize);
+          m_data.front ().first += offset;
           m_size -= offset;
-          m_firstByteSeq += offset;
-          NS_LOG_LOGIC ("Fragmented one packet by size " << offset << ", new size=" << pktSize);
-          break;
+          m_headOffset += offset;
+          offset = 0;
+          NS_LOG_LOGIC ("Fragmented one packet, new size=" << pktSize);
         }
     }
-  // Catching the case of ACKing a FIN
-  if (m_size == 0)
-    {
-      m_firstByteSeq = seq;
-    }
+  m_next = m_next > removed ? m_next - removed : 0;
+  // The remaining offset, if any, is the ACK of a FIN
+  m_firstByteSeq = seq;
   NS_LOG_LOGIC ("size=" << m_size << " headSeq=" << m_firstByteSeq << " maxBuffer=" << m_maxBuffer
                         <<" numPkts="<< m_data.size ());
   NS_ASSERT (m_firstByteSeq == seq);
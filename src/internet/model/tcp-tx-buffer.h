@@ -21,7 +21,8 @@
 #ifndef TCP_TX_BUFFER_H
 #define TCP_TX_BUFFER_H
 
-#include <list>
+#include <deque>
+#include <utility>
 #include "ns3/traced-value.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/object.h"
@@ -36,6 +37,13 @@ class Packet;
  *
  * \brief class for keeping the data sent by the application to the TCP socket, i.e.
  *        the sending buffer.
+ *
+ * The packets written by the application are kept in a double-ended queue,
+ * each with its offset in the byte stream, so that the packet holding a
+ * sequence number is found by a binary search rather than by walking the
+ * buffer.  The position following the last copied segment is remembered,
+ * where the next segment usually starts, so that sending a window costs a
+ * constant time per segment whatever the size of the buffer.
  */
 class TcpTxBuffer : public Object
 {
@@ -128,13 +136,24 @@ public:
   void DiscardUpTo (const SequenceNumber32& seq);
 
 private:
+  /// a packet of the buffer, with the stream offset of its first byte
+  typedef std::pair<uint32_t, Ptr<Packet> > BufItem;
   /// container for data stored in the buffer
-  typedef std::list<Ptr<Packet> >::iterator BufIterator;
+  typedef std::deque<BufItem> BufData;
+
+  /**
+   * \brief Find the packet holding a byte of the buffer.
+   * \param offset the offset of the byte from the head of the buffer
+   * \returns the index of the packet in m_data
+   */
+  uint32_t FindPacket (uint32_t offset) const;
 
   TracedValue<SequenceNumber32> m_firstByteSeq; //!< Sequence number of the first byte in data (SND.UNA)
   uint32_t m_size;                              //!< Number of data bytes
   uint32_t m_maxBuffer;                         //!< Max number of data bytes in buffer (SND.WND)
-  std::list<Ptr<Packet> > m_data;               //!< Corresponding data (may be null)
+  uint32_t m_headOffset;                        //!< Stream offset of the first byte in data
+  uint32_t m_next;                              //!< Index of the packet holding the byte after the last copy
+  BufData m_data;                               //!< Corresponding data (may be null)
 };
 
 } // namepsace ns3
@@ -184,46 +184,38 @@ void
 UdpHeader::Serialize (Buffer::Iterator start) const
 {
   Buffer::Iterator i = start;
+  uint8_t *buffer = i.WriteSpan (8);
 
-  i.WriteHtonU16 (m_sourcePort);
-  i.WriteHtonU16 (m_destinationPort);
+  uint16_t length = m_payloadSize;
   if (m_payloadSize == 0)
     {
-      i.WriteHtonU16 (start.GetSize ());
+      length = start.GetSize ();
     }
-  else
+  Buffer::WriteMsb (buffer, m_sourcePort, 2);
+  Buffer::WriteMsb (buffer + 2, m_destinationPort, 2);
+  Buffer::WriteMsb (buffer + 4, length, 2);
+  buffer[6] = 0;
+  buffer[7] = 0;
+
+  uint16_t checksum = m_checksum;
+  if (m_checksum == 0 && m_calcChecksum)
     {
-      i.WriteHtonU16 (m_payloadSize);
-    }
-
-  if ( m_checksum == 0)
-    {
-      i.WriteU16 (0);
-
-      if (m_calcChecksum)
-        {
-          uint16_t headerChecksum = CalculateHeaderChecksum (start.GetSize ());
-          i = start;
-          uint16_t checksum = i.CalculateIpChecksum (start.GetSize (), headerChecksum);
-
-          i = start;
-          i.Next (6);
-          i.WriteU16 (checksum);
-        }
-    }
-  else
-    {
-      i.WriteU16 (m_checksum);
+      uint16_t headerChecksum = CalculateHeaderChecksum (start.GetSize ());
+      i = start;
+      checksum = i.CalculateIpChecksum (start.GetSize (), headerChecksum);
     }
+  Buffer::WriteLsb (buffer + 6, checksum, 2);
 }
 uint32_t
 UdpHeader::Deserialize (Buffer::Iterator start)
 {
   Buffer::Iterator i = start;
-  m_sourcePort = i.ReadNtohU16 ();
-  m_destinationPort = i.ReadNtohU16 ();
-  m_payloadSize = i.ReadNtohU16 () - GetSerializedSize ();
-  m_checksum = i.ReadU16 ();
+  uint8_t scratch[8];
+  uint8_t const *buffer = i.ReadSpan (scratch, 8);
+  m_sourcePort = Buffer::ReadMsb (buffer, 2);
+  m_destinationPort = Buffer::ReadMsb (buffer + 2, 2);
+  m_payloadSize = Buffer::ReadMsb (buffer + 4, 2) - GetSerializedSize ();
+  m_checksum = Buffer::ReadLsb (buffer + 6, 2);
 
   if (m_calcChecksum)
     {
@@ -0,0 +1,300 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <set>
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/object.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv4-interface-address.h"
+#include "ns3/ipv4-end-point.h"
+#include "ns3/ipv4-end-point-demux.h"
+#include "ns3/ipv6-end-point.h"
+#include "ns3/ipv6-end-point-demux.h"
+
+using namespace ns3;
+
+/**
+ * Compare the lookups of the IPv4 demux with a linear scan of its end
+ * points, while end points are allocated, moved and removed.
+ */
+class Ipv4EndPointDemuxRandomTestCase : public TestCase
+{
+public:
+  Ipv4EndPointDemuxRandomTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \returns a local address, a wildcard or a broadcast.
+   */
+  Ipv4Address NextLocalAddress (void);
+  /**
+   * \returns a peer address or a wildcard.
+   */
+  Ipv4Address NextPeerAddress (void);
+  /**
+   * \brief Check the lookups of a few packets against a linear scan.
+   * \param demux the demux.
+   * \param endPoints the end points in the demux.
+   * \param interface the incoming interface of the packets.
+   */
+  void Check (Ipv4EndPointDemux &demux, std::vector<Ipv4EndPoint *> const &endPoints,
+              Ptr<Ipv4Interface> interface);
+
+  Ptr<UniformRandomVariable> m_random; //!< The random numbers of the test.
+};
+
+Ipv4EndPointDemuxRandomTestCase::Ipv4EndPointDemuxRandomTestCase ()
+  : TestCase ("Check the IPv4 demux lookups against a linear scan")
+{
+}
+
+Ipv4Address
+Ipv4EndPointDemuxRandomTestCase::NextLocalAddress (void)
+{
+  static const char *addresses[] = { "0.0.0.0", "10.0.0.1", "10.0.0.2", "10.0.0.255", "255.255.255.255" };
+  return Ipv4Address (addresses[m_random->GetInteger (0, 4)]);
+}
+
+Ipv4Address
+Ipv4EndPointDemuxRandomTestCase::NextPeerAddress (void)
+{
+  static const char *addresses[] = { "0.0.0.0", "10.0.1.1", "10.0.1.2" };
+  return Ipv4Address (addresses[m_random->GetInteger (0, 2)]);
+}
+
+void
+Ipv4EndPointDemuxRandomTestCase::Check (Ipv4EndPointDemux &demux, std::vector<Ipv4EndPoint *> const &endPoints,
+                                        Ptr<Ipv4Interface> interface)
+{
+  for (uint32_t k = 0; k < 100; k++)
+    {
+      Ipv4Address daddr = NextLocalAddress ();
+      uint16_t dport = m_random->GetInteger (1, 3);
+      Ipv4Address saddr = NextPeerAddress ();
+      uint16_t sport = m_random->GetInteger (0, 2);
+
+      // The matching rules of the demux, applied to every end point.
+      bool isBroadcast = daddr.IsBroadcast () || daddr == Ipv4Address ("10.0.0.255");
+      Ipv4Address interfaceAddress = daddr == Ipv4Address ("10.0.0.255") ? Ipv4Address ("10.0.0.1") : daddr;
+      std::set<Ipv4EndPoint *> expected[4];
+      uint32_t genericity = 3;
+      bool exact = false;
+      for (uint32_t i = 0; i < endPoints.size (); i++)
+        {
+          Ipv4EndPoint *endP = endPoints[i];
+          if (endP->GetLocalPort () != dport)
+            {
+              continue;
+            }
+          bool localWildCard = endP->GetLocalAddress () == Ipv4Address::GetAny ();
+          bool localExact = endP->GetLocalAddress () == (isBroadcast && !localWildCard ? interfaceAddress : daddr);
+          bool peerExact = endP->GetPeerAddress () == saddr && endP->GetPeerPort () == sport;
+          bool peerWildCard = endP->GetPeerAddress () == Ipv4Address::GetAny () && endP->GetPeerPort () == 0;
+          if ((localExact || localWildCard)
+              && (endP->GetPeerAddress () == saddr || endP->GetPeerAddress () == Ipv4Address::GetAny ())
+              && (endP->GetPeerPort () == sport || endP->GetPeerPort () == 0))
+            {
+              if (localWildCard && peerWildCard)
+                {
+                  expected[0].insert (endP);
+                }
+              if ((localExact || (isBroadcast && localWildCard)) && peerWildCard)
+                {
+                  expected[1].insert (endP);
+                }
+              if (localWildCard && peerExact)
+                {
+                  expected[2].insert (endP);
+                }
+              if (localExact && peerExact)
+                {
+                  expected[3].insert (endP);
+                }
+            }
+          exact = exact || (endP->GetLocalAddress () == daddr && endP->GetPeerAddress () == saddr
+                            && endP->GetPeerPort () == sport);
+          genericity = std::min (genericity, uint32_t (localWildCard) + (endP->GetPeerAddress () == Ipv4Address::GetAny ()));
+        }
+      uint32_t best = 3;
+      while (best > 0 && expected[best].empty ())
+        {
+          best--;
+        }
+
+      Ipv4EndPointDemux::EndPoints found = demux.Lookup (daddr, dport, saddr, sport, interface);
+      NS_TEST_ASSERT_MSG_EQ (found.size (), expected[best].size (),
+                             "Wrong number of end points for " << daddr << ":" << dport << " from " << saddr << ":" << sport);
+      NS_TEST_ASSERT_MSG_EQ ((std::set<Ipv4EndPoint *> (found.begin (), found.end ()) == expected[best]), true,
+                             "Wrong end points for " << daddr << ":" << dport << " from " << saddr << ":" << sport);
+
+      Ipv4EndPoint *simple = demux.SimpleLookup (daddr, dport, saddr, sport);
+      if (genericity == 3)
+        {
+          NS_TEST_ASSERT_MSG_EQ (simple, 0, "Unexpected simple lookup match");
+          continue;
+        }
+      NS_TEST_ASSERT_MSG_NE (simple, 0, "No simple lookup match");
+      NS_TEST_ASSERT_MSG_EQ (simple->GetLocalPort (), dport, "Wrong port in simple lookup");
+      if (exact)
+        {
+          NS_TEST_ASSERT_MSG_EQ ((simple->GetLocalAddress () == daddr && simple->GetPeerAddress () == saddr
+                                  && simple->GetPeerPort () == sport), true, "Exact match not found");
+        }
+      else
+        {
+          NS_TEST_ASSERT_MSG_EQ (uint32_t (simple->GetLocalAddress () == Ipv4Address::GetAny ())
+                                 + (simple->GetPeerAddress () == Ipv4Address::GetAny ()), genericity,
+                                 "Simple lookup match not the most specific");
+        }
+    }
+
+  for (uint16_t port = 1; port <= 3; port++)
+    {
+      Ipv4Address address = NextLocalAddress ();
+      bool portUsed = false;
+      bool localUsed = false;
+      for (uint32_t i = 0; i < endPoints.size (); i++)
+        {
+          portUsed = portUsed || endPoints[i]->GetLocalPort () == port;
+          localUsed = localUsed || (endPoints[i]->GetLocalPort () == port && endPoints[i]->GetLocalAddress () == address);
+        }
+      NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (port), portUsed, "Wrong local port lookup");
+      NS_TEST_ASSERT_MSG_EQ (demux.LookupLocal (address, port), localUsed, "Wrong local address lookup");
+    }
+  NS_TEST_ASSERT_MSG_EQ (demux.GetAllEndPoints ().size (), endPoints.size (), "Wrong number of end points");
+}
+
+void
+Ipv4EndPointDemuxRandomTestCase::DoRun (void)
+{
+  m_random = CreateObject<UniformRandomVariable> ();
+  m_random->SetStream (1);
+  Ptr<Ipv4Interface> interface = CreateObject<Ipv4Interface> ();
+  interface->AddAddress (Ipv4InterfaceAddress (Ipv4Address ("10.0.0.1"), Ipv4Mask ("255.255.255.0")));
+
+  Ipv4EndPointDemux demux;
+  std::vector<Ipv4EndPoint *> endPoints;
+  for (uint32_t round = 0; round < 20; round++)
+    {
+      for (uint32_t i = 0; i < 20; i++)
+        {
+          Ipv4EndPoint *endPoint = demux.Allocate (NextLocalAddress (), m_random->GetInteger (1, 3),
+                                                   NextPeerAddress (), m_random->GetInteger (0, 2));
+          if (endPoint != 0)
+            {
+              endPoints.push_back (endPoint);
+            }
+        }
+      Check (demux, endPoints, interface);
+      // Move some end points, as the sockets do when they connect.
+      for (uint32_t i = 0; i < 5 && !endPoints.empty (); i++)
+        {
+          Ipv4EndPoint *endPoint = endPoints[m_random->GetInteger (0, endPoints.size () - 1)];
+          endPoint->SetPeer (NextPeerAddress (), m_random->GetInteger (0, 2));
+          endPoint->SetLocalAddress (NextLocalAddress ());
+        }
+      Check (demux, endPoints, interface);
+      for (uint32_t i = 0; i < 12 && !endPoints.empty (); i++)
+        {
+          uint32_t k = m_random->GetInteger (0, endPoints.size () - 1);
+          demux.DeAllocate (endPoints[k]);
+          endPoints.erase (endPoints.begin () + k);
+        }
+      Check (demux, endPoints, interface);
+    }
+}
+
+/**
+ * Check that the IPv6 demux finds the end points whose addresses and ports
+ * changed after their allocation.
+ */
+class Ipv6EndPointDemuxTestCase : public TestCase
+{
+public:
+  Ipv6EndPointDemuxTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+Ipv6EndPointDemuxTestCase::Ipv6EndPointDemuxTestCase ()
+  : TestCase ("Check the IPv6 demux lookups of moved end points")
+{
+}
+
+void
+Ipv6EndPointDemuxTestCase::DoRun (void)
+{
+  Ipv6Address local ("2001:1::1");
+  Ipv6Address peer ("2001:2::1");
+  Ipv6EndPointDemux demux;
+  Ipv6EndPoint *listener = demux.Allocate (80);
+  Ipv6EndPoint *bound = demux.Allocate (local, 80);
+  NS_TEST_ASSERT_MSG_EQ (demux.Allocate (local, 80), 0, "Duplicate end point allocated");
+
+  Ipv6EndPointDemux::EndPoints found = demux.Lookup (local, 80, peer, 1000, 0);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1U, "Wrong number of end points");
+  NS_TEST_ASSERT_MSG_EQ (found.front (), bound, "Bound end point not found");
+  found = demux.Lookup (Ipv6Address ("2001:1::2"), 80, peer, 1000, 0);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1U, "Wrong number of end points");
+  NS_TEST_ASSERT_MSG_EQ (found.front (), listener, "Listening end point not found");
+
+  // A connection moved to its final addresses and ports after allocation.
+  Ipv6EndPoint *connection = demux.Allocate (Ipv6Address ("2001:1::2"), 80, peer, 999);
+  NS_TEST_ASSERT_MSG_NE (connection, 0, "Connection not allocated");
+  connection->SetLocalAddress (local);
+  connection->SetPeer (peer, 1000);
+  NS_TEST_ASSERT_MSG_EQ (demux.Allocate (local, 80, peer, 1000), 0, "Duplicate connection allocated");
+  found = demux.Lookup (local, 80, peer, 1000, 0);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1U, "Wrong number of end points");
+  NS_TEST_ASSERT_MSG_EQ (found.front (), connection, "Connected end point not found");
+  NS_TEST_ASSERT_MSG_EQ (demux.SimpleLookup (local, 80, peer, 1000), connection, "Connected end point not found");
+  found = demux.Lookup (local, 80, peer, 1001, 0);
+  NS_TEST_ASSERT_MSG_EQ (found.front (), bound, "Bound end point not found");
+
+  connection->SetLocalPort (81);
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (81), true, "Moved end point port not found");
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupLocal (local, 81), true, "Moved end point not found");
+  found = demux.Lookup (local, 80, peer, 1000, 0);
+  NS_TEST_ASSERT_MSG_EQ (found.front (), bound, "Bound end point not found");
+
+  demux.DeAllocate (connection);
+  demux.DeAllocate (bound);
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (81), false, "Removed end point port found");
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupLocal (local, 80), false, "Removed end point found");
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (80), true, "Listening end point port not found");
+  NS_TEST_ASSERT_MSG_EQ (demux.GetEndPoints ().size (), 1U, "Wrong number of end points");
+  demux.DeAllocate (listener);
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (80), false, "Removed end point port found");
+}
+
+/**
+ * IPv4 and IPv6 end point demux TestSuite
+ */
+static class EndPointDemuxTestSuite : public TestSuite
+{
+public:
+  EndPointDemuxTestSuite ()
+    : TestSuite ("end-point-demux", UNIT)
+  {
+    AddTestCase (new Ipv4EndPointDemuxRandomTestCase, TestCase::QUICK);
+    AddTestCase (new Ipv6EndPointDemuxTestCase, TestCase::QUICK);
+  }
+} g_endPointDemuxTestSuite;
@@ -15,6 +15,9 @@
  */
 
 #include <vector>
+#include <string>
+#include <sstream>
+#include <algorithm>
 #include "ns3/boolean.h"
 #include "ns3/config.h"
 #include "ns3/inet-socket-address.h"
@@ -36,6 +39,9 @@
 #include "ns3/simple-channel.h"
 #include "ns3/socket-factory.h"
 #include "ns3/udp-socket-factory.h"
+#include "ns3/global-router-interface.h"
+#include "ns3/ipv4-global-routing.h"
+#include "ns3/ipv4-routing-table-entry.h"
 
 using namespace ns3;
 
@@ -419,6 +425,162 @@ Ipv4GlobalRoutingSlash32TestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * Check that the routes computed with several threads, or incrementally
+ * after interface changes, are the ones computed by the serial calculation.
+ */
+class Ipv4GlobalRoutingRecomputeTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingRecomputeTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \param nodes the nodes.
+   * \param sorted whether to sort the routes of each node.
+   * \returns the global routes of the nodes.
+   */
+  std::string GetRoutes (NodeContainer const &nodes, bool sorted);
+  /**
+   * \brief Recompute the routes incrementally, then from scratch, and
+   * compare them.
+   * \param nodes the nodes.
+   * \param change the change made before.
+   */
+  void CheckIncremental (NodeContainer const &nodes, std::string change);
+};
+
+Ipv4GlobalRoutingRecomputeTestCase::Ipv4GlobalRoutingRecomputeTestCase ()
+  : TestCase ("Recompute global routes with threads and incrementally")
+{
+}
+
+std::string
+Ipv4GlobalRoutingRecomputeTestCase::GetRoutes (NodeContainer const &nodes, bool sorted)
+{
+  std::ostringstream oss;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<Ipv4GlobalRouting> routing = nodes.Get (i)->GetObject<GlobalRouter> ()->GetRoutingProtocol ();
+      std::vector<std::string> routes;
+      for (uint32_t j = 0; j < routing->GetNRoutes (); j++)
+        {
+          std::ostringstream route;
+          route << *routing->GetRoute (j);
+          routes.push_back (route.str ());
+        }
+      if (sorted)
+        {
+          std::sort (routes.begin (), routes.end ());
+        }
+      oss << "node " << i << ":\n";
+      for (uint32_t j = 0; j < routes.size (); j++)
+        {
+          oss << routes[j] << "\n";
+        }
+    }
+  return oss.str ();
+}
+
+void
+Ipv4GlobalRoutingRecomputeTestCase::CheckIncremental (NodeContainer const &nodes, std::string change)
+{
+  Config::SetGlobal ("GlobalRoutingIncremental", BooleanValue (true));
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  std::string incremental = GetRoutes (nodes, true);
+  Config::SetGlobal ("GlobalRoutingIncremental", BooleanValue (false));
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  NS_TEST_EXPECT_MSG_EQ (incremental, GetRoutes (nodes, true), "Wrong incremental routes after " << change);
+}
+
+// Test program for a ring of routers with a chord, a LAN and a stub router,
+// with point-to-point links unless noted:
+//
+//                  10.9.0.0/24
+//                      |
+//                      0 ------- 1
+//                      |       / |
+//             metric 3 |     /   |
+//                      |   /     |
+//                      3 ------- 2 ------- 4 ==LAN== 5, 6 ------- 7
+//
+void
+Ipv4GlobalRoutingRecomputeTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (8);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper p2pHelper;
+  p2pHelper.SetNetDevicePointToPointMode (true);
+  SimpleNetDeviceHelper lanHelper;
+  Ipv4AddressHelper ipv4;
+  uint32_t links[][2] = { { 0, 1 }, { 1, 2 }, { 2, 3 }, { 3, 0 }, { 1, 3 }, { 2, 4 }, { 6, 7 } };
+  std::vector<NetDeviceContainer> devices;
+  for (uint32_t i = 0; i < sizeof (links) / sizeof (links[0]); i++)
+    {
+      devices.push_back (p2pHelper.Install (NodeContainer (nodes.Get (links[i][0]), nodes.Get (links[i][1]))));
+      std::ostringstream base;
+      base << "10.1." << i << ".0";
+      ipv4.SetBase (base.str ().c_str (), "255.255.255.252");
+      ipv4.Assign (devices.back ());
+    }
+  NodeContainer lan (nodes.Get (4), nodes.Get (5), nodes.Get (6));
+  NetDeviceContainer lanDevices = lanHelper.Install (lan);
+  ipv4.SetBase ("10.2.0.0", "255.255.255.0");
+  ipv4.Assign (lanDevices);
+  NetDeviceContainer stubDevice = lanHelper.Install (nodes.Get (0));
+  ipv4.SetBase ("10.9.0.0", "255.255.255.0");
+  ipv4.Assign (stubDevice);
+  // The calculation does not support equal-cost paths to a network that is
+  // not adjacent to the root: make the link between 0 and 3 longer.
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Ptr<NetDevice> device = devices[3].Get (i);
+      Ptr<Ipv4> ipv4Node = device->GetNode ()->GetObject<Ipv4> ();
+      ipv4Node->SetMetric (ipv4Node->GetInterfaceForDevice (device), 3);
+    }
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  std::string serial = GetRoutes (nodes, false);
+  std::string serialSorted = GetRoutes (nodes, true);
+
+  Config::SetGlobal ("GlobalRoutingThreads", UintegerValue (3));
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  NS_TEST_EXPECT_MSG_EQ (GetRoutes (nodes, false), serial, "Routes computed in threads differ");
+  Config::SetGlobal ("GlobalRoutingThreads", UintegerValue (1));
+
+  Ptr<Ipv4> ipv4Node0 = nodes.Get (0)->GetObject<Ipv4> ();
+  Ptr<Ipv4> ipv4Node1 = nodes.Get (1)->GetObject<Ipv4> ();
+  Ptr<Ipv4> ipv4Node2 = nodes.Get (2)->GetObject<Ipv4> ();
+  Ptr<Ipv4> ipv4Node5 = nodes.Get (5)->GetObject<Ipv4> ();
+  int32_t chord = ipv4Node1->GetInterfaceForDevice (devices[4].Get (0));
+  int32_t ring = ipv4Node2->GetInterfaceForDevice (devices[2].Get (0));
+  int32_t stub = ipv4Node0->GetInterfaceForDevice (stubDevice.Get (0));
+  int32_t lanInterface = ipv4Node5->GetInterfaceForDevice (lanDevices.Get (1));
+
+  ipv4Node1->SetMetric (chord, 5);
+  CheckIncremental (nodes, "metric change");
+  ipv4Node2->SetDown (ring);
+  CheckIncremental (nodes, "link down");
+  ipv4Node2->SetUp (ring);
+  CheckIncremental (nodes, "link up");
+  ipv4Node0->SetDown (stub);
+  CheckIncremental (nodes, "stub network down");
+  ipv4Node0->SetUp (stub);
+  CheckIncremental (nodes, "stub network up");
+  ipv4Node5->SetDown (lanInterface);
+  CheckIncremental (nodes, "LAN interface down");
+  ipv4Node5->SetUp (lanInterface);
+  CheckIncremental (nodes, "LAN interface up");
+  ipv4Node1->SetMetric (chord, 1);
+  CheckIncremental (nodes, "metric restored");
+  NS_TEST_EXPECT_MSG_EQ (GetRoutes (nodes, true), serialSorted, "Routes differ after restoring the topology");
+
+  Simulator::Destroy ();
+}
 
 class Ipv4GlobalRoutingTestSuite : public TestSuite
 {
@@ -431,6 +593,7 @@ Ipv4GlobalRoutingTestSuite::Ipv4GlobalRoutingTestSuite ()
 {
   AddTestCase (new Ipv4DynamicGlobalRoutingTestCase, TestCase::QUICK);
   AddTestCase (new Ipv4GlobalRoutingSlash32TestCase, TestCase::QUICK);
+  AddTestCase (new Ipv4GlobalRoutingRecomputeTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
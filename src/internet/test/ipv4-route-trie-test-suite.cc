@@ -0,0 +1,318 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/ipv4-route-trie.h"
+#include "ns3/ipv4-routing-table-entry.h"
+#include "ns3/ipv4-static-routing.h"
+#include "ns3/ipv4-global-routing.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/node.h"
+#include "ns3/simulator.h"
+#include "ns3/random-variable-stream.h"
+
+using namespace ns3;
+
+/**
+ * Check the prefixes found in the trie for a few hand-made routes,
+ * including equal-cost routes, a default route and removals.
+ */
+class Ipv4RouteTrieBasicTestCase : public TestCase
+{
+public:
+  Ipv4RouteTrieBasicTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+Ipv4RouteTrieBasicTestCase::Ipv4RouteTrieBasicTestCase ()
+  : TestCase ("Check longest prefix match on a few routes")
+{
+}
+
+void
+Ipv4RouteTrieBasicTestCase::DoRun (void)
+{
+  Ipv4RoutingTableEntry def = Ipv4RoutingTableEntry::CreateNetworkRouteTo (Ipv4Address ("0.0.0.0"), Ipv4Mask::GetZero (), 0);
+  Ipv4RoutingTableEntry net8 = Ipv4RoutingTableEntry::CreateNetworkRouteTo (Ipv4Address ("10.0.0.0"), Ipv4Mask ("255.0.0.0"), 1);
+  Ipv4RoutingTableEntry net24a = Ipv4RoutingTableEntry::CreateNetworkRouteTo (Ipv4Address ("10.1.2.0"), Ipv4Mask ("255.255.255.0"), 2);
+  Ipv4RoutingTableEntry net24b = Ipv4RoutingTableEntry::CreateNetworkRouteTo (Ipv4Address ("10.1.2.7"), Ipv4Mask ("255.255.255.0"), 3);
+  Ipv4RoutingTableEntry net16 = Ipv4RoutingTableEntry::CreateNetworkRouteTo (Ipv4Address ("10.1.0.0"), Ipv4Mask ("255.255.0.0"), 4);
+  Ipv4RoutingTableEntry host = Ipv4RoutingTableEntry::CreateHostRouteTo (Ipv4Address ("10.1.2.3"), 5);
+
+  Ipv4RouteTrie trie;
+  Ipv4RouteTrie::Routes const *matches[Ipv4RouteTrie::MAX_MATCHES];
+  NS_TEST_ASSERT_MSG_EQ (trie.Lookup (Ipv4Address ("10.1.2.3"), matches), 0U, "Empty trie has a match");
+
+  trie.Insert (&net24a, 7);
+  trie.Insert (&net8);
+  trie.Insert (&host);
+  trie.Insert (&def);
+  trie.Insert (&net24b, 3);
+  trie.Insert (&net16);
+
+  uint32_t n = trie.Lookup (Ipv4Address ("10.1.2.3"), matches);
+  NS_TEST_ASSERT_MSG_EQ (n, 5U, "Wrong number of matching prefixes");
+  NS_TEST_ASSERT_MSG_EQ (matches[0]->at (0).first, &def, "Default route not first");
+  NS_TEST_ASSERT_MSG_EQ (matches[1]->at (0).first, &net8, "/8 route not second");
+  NS_TEST_ASSERT_MSG_EQ (matches[2]->at (0).first, &net16, "/16 route not third");
+  NS_TEST_ASSERT_MSG_EQ (matches[3]->size (), 2U, "Equal-cost routes not together");
+  NS_TEST_ASSERT_MSG_EQ (matches[3]->at (0).first, &net24a, "Equal-cost routes not in insertion order");
+  NS_TEST_ASSERT_MSG_EQ (matches[3]->at (0).second, 7U, "Wrong metric");
+  NS_TEST_ASSERT_MSG_EQ (matches[3]->at (1).first, &net24b, "Equal-cost routes not in insertion order");
+  NS_TEST_ASSERT_MSG_EQ (matches[4]->at (0).first, &host, "Host route not last");
+
+  n = trie.Lookup (Ipv4Address ("10.2.0.1"), matches);
+  NS_TEST_ASSERT_MSG_EQ (n, 2U, "Wrong number of matching prefixes");
+  NS_TEST_ASSERT_MSG_EQ (matches[1]->at (0).first, &net8, "/8 route not found");
+
+  n = trie.Lookup (Ipv4Address ("192.168.0.1"), matches);
+  NS_TEST_ASSERT_MSG_EQ (n, 1U, "Wrong number of matching prefixes");
+  NS_TEST_ASSERT_MSG_EQ (matches[0]->at (0).first, &def, "Default route not found");
+
+  trie.Remove (&net24a);
+  trie.Remove (&host);
+  trie.Remove (&def);
+  n = trie.Lookup (Ipv4Address ("10.1.2.3"), matches);
+  NS_TEST_ASSERT_MSG_EQ (n, 3U, "Wrong number of matching prefixes after removal");
+  NS_TEST_ASSERT_MSG_EQ (matches[2]->size (), 1U, "Equal-cost route not removed");
+  NS_TEST_ASSERT_MSG_EQ (matches[2]->at (0).first, &net24b, "Wrong equal-cost route removed");
+
+  trie.Remove (&net24b);
+  trie.Remove (&net16);
+  trie.Remove (&net8);
+  NS_TEST_ASSERT_MSG_EQ (trie.Lookup (Ipv4Address ("10.1.2.3"), matches), 0U, "Match after removing all routes");
+
+  // A non-contiguous mask is stored under its leading ones, whatever the
+  // bits of the network under the hole of the mask.
+  Ipv4RoutingTableEntry holed = Ipv4RoutingTableEntry::CreateNetworkRouteTo (Ipv4Address ("10.5.3.0"), Ipv4Mask ("255.0.255.0"), 6);
+  trie.Insert (&holed);
+  trie.Insert (&net16);
+  n = trie.Lookup (Ipv4Address ("10.1.3.9"), matches);
+  NS_TEST_ASSERT_MSG_EQ (n, 2U, "Wrong number of matching prefixes with a non-contiguous mask");
+  NS_TEST_ASSERT_MSG_EQ (matches[0]->at (0).first, &holed, "Route with a non-contiguous mask not under its leading ones");
+  NS_TEST_ASSERT_MSG_EQ (matches[1]->at (0).first, &net16, "/16 route not found");
+  n = trie.Lookup (Ipv4Address ("11.5.3.0"), matches);
+  NS_TEST_ASSERT_MSG_EQ (n, 0U, "Route with a non-contiguous mask found outside its leading ones");
+  trie.Remove (&holed);
+  trie.Remove (&net16);
+  NS_TEST_ASSERT_MSG_EQ (trie.Lookup (Ipv4Address ("10.1.3.9"), matches), 0U, "Match after removing all routes");
+}
+
+/**
+ * Check that Ipv4StaticRouting and Ipv4GlobalRouting select the routes
+ * with non-contiguous masks as a linear scan with Ipv4Mask::IsMatch, and
+ * rank their masks by Ipv4Mask::GetPrefixLength.
+ */
+class Ipv4RouteTrieNonContiguousTestCase : public TestCase
+{
+public:
+  Ipv4RouteTrieNonContiguousTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \param routing the routing protocol.
+   * \param dest the destination.
+   * \returns the interface of the route to dest, or -1 without route.
+   */
+  int32_t Lookup (Ptr<Ipv4RoutingProtocol> routing, char const *dest);
+
+  Ptr<Ipv4> m_ipv4; //!< The IPv4 stack of the routing protocols.
+};
+
+Ipv4RouteTrieNonContiguousTestCase::Ipv4RouteTrieNonContiguousTestCase ()
+  : TestCase ("Check the routing protocols with non-contiguous masks")
+{
+}
+
+int32_t
+Ipv4RouteTrieNonContiguousTestCase::Lookup (Ptr<Ipv4RoutingProtocol> routing, char const *dest)
+{
+  Ipv4Header header;
+  header.SetDestination (Ipv4Address (dest));
+  Socket::SocketErrno error;
+  Ptr<Ipv4Route> route = routing->RouteOutput (Create<Packet> (), header, 0, error);
+  return route == 0 ? -1 : m_ipv4->GetInterfaceForDevice (route->GetOutputDevice ());
+}
+
+void
+Ipv4RouteTrieNonContiguousTestCase::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.Install (node);
+  m_ipv4 = node->GetObject<Ipv4> ();
+  for (uint32_t i = 1; i <= 2; i++)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetAddress (Mac48Address::Allocate ());
+      node->AddDevice (device);
+      NS_TEST_ASSERT_MSG_EQ (m_ipv4->AddInterface (device), i, "Unexpected interface index");
+      m_ipv4->AddAddress (i, Ipv4InterfaceAddress (Ipv4Address (0xc0a80001 + (i << 8)), Ipv4Mask ("/24")));
+      m_ipv4->SetUp (i);
+    }
+
+  // 10.*.3.* through interface 1, which the old linear scans ranked as a
+  // /24, and 10.7.0.0/16 through interface 2.
+  Ptr<Ipv4StaticRouting> staticRouting = CreateObject<Ipv4StaticRouting> ();
+  staticRouting->SetIpv4 (m_ipv4);
+  staticRouting->AddNetworkRouteTo (Ipv4Address ("10.0.3.0"), Ipv4Mask ("255.0.255.0"), 1);
+  staticRouting->AddNetworkRouteTo (Ipv4Address ("10.7.0.0"), Ipv4Mask ("255.255.0.0"), 2);
+  Ptr<Ipv4GlobalRouting> globalRouting = CreateObject<Ipv4GlobalRouting> ();
+  globalRouting->SetIpv4 (m_ipv4);
+  globalRouting->AddNetworkRouteTo (Ipv4Address ("10.0.3.0"), Ipv4Mask ("255.0.255.0"), 1);
+  globalRouting->AddNetworkRouteTo (Ipv4Address ("10.7.0.0"), Ipv4Mask ("255.255.0.0"), 2);
+
+  Ptr<Ipv4RoutingProtocol> protocols[] = { staticRouting, globalRouting };
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (Lookup (protocols[i], "10.8.3.9"), 1, "Non-contiguous mask not matched");
+      NS_TEST_EXPECT_MSG_EQ (Lookup (protocols[i], "10.7.3.9"), 1, "Non-contiguous mask not ranked as a /24");
+      NS_TEST_EXPECT_MSG_EQ (Lookup (protocols[i], "10.7.4.9"), 2, "/16 route not matched");
+      NS_TEST_EXPECT_MSG_EQ (Lookup (protocols[i], "10.8.4.9"), -1, "Unexpected route");
+    }
+
+  staticRouting->Dispose ();
+  globalRouting->Dispose ();
+  m_ipv4 = 0;
+  Simulator::Destroy ();
+}
+
+/**
+ * Compare the trie with a linear scan of random routes, while routes are
+ * added and removed.
+ */
+class Ipv4RouteTrieRandomTestCase : public TestCase
+{
+public:
+  Ipv4RouteTrieRandomTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Check the lookups of a few addresses against a linear scan.
+   * \param trie the trie.
+   * \param routes the routes in the trie.
+   */
+  void Check (Ipv4RouteTrie const &trie, std::vector<Ipv4RoutingTableEntry *> const &routes);
+
+  Ptr<UniformRandomVariable> m_random; //!< The random numbers of the test.
+};
+
+Ipv4RouteTrieRandomTestCase::Ipv4RouteTrieRandomTestCase ()
+  : TestCase ("Check longest prefix match against a linear scan")
+{
+}
+
+void
+Ipv4RouteTrieRandomTestCase::Check (Ipv4RouteTrie const &trie, std::vector<Ipv4RoutingTableEntry *> const &routes)
+{
+  for (uint32_t k = 0; k < 200; k++)
+    {
+      // Addresses close to the routes, so that long prefixes match.
+      Ipv4Address dest = routes.empty () ? Ipv4Address (m_random->GetInteger (0, 0xffffffffU))
+        : Ipv4Address (routes[m_random->GetInteger (0, routes.size () - 1)]->GetDestNetwork ().Get ()
+                       ^ (m_random->GetInteger (0, 0xffffffffU) >> m_random->GetInteger (8, 31)));
+      int32_t longest = -1;
+      uint32_t count = 0;
+      for (uint32_t i = 0; i < routes.size (); i++)
+        {
+          Ipv4Mask mask = routes[i]->GetDestNetworkMask ();
+          if (mask.IsMatch (dest, routes[i]->GetDestNetwork ()))
+            {
+              int32_t length = mask.GetPrefixLength ();
+              if (length > longest)
+                {
+                  longest = length;
+                  count = 0;
+                }
+              if (length == longest)
+                {
+                  count++;
+                }
+            }
+        }
+      Ipv4RouteTrie::Routes const *matches[Ipv4RouteTrie::MAX_MATCHES];
+      uint32_t n = trie.Lookup (dest, matches);
+      if (longest < 0)
+        {
+          NS_TEST_ASSERT_MSG_EQ (n, 0U, "Unexpected match for " << dest);
+          continue;
+        }
+      NS_TEST_ASSERT_MSG_GT (n, 0U, "No match for " << dest);
+      NS_TEST_ASSERT_MSG_EQ (matches[n - 1]->size (), count, "Wrong number of routes for " << dest);
+      NS_TEST_ASSERT_MSG_EQ (matches[n - 1]->at (0).first->GetDestNetworkMask ().GetPrefixLength (), longest,
+                             "Wrong longest prefix for " << dest);
+    }
+}
+
+void
+Ipv4RouteTrieRandomTestCase::DoRun (void)
+{
+  m_random = CreateObject<UniformRandomVariable> ();
+  m_random->SetStream (1);
+  Ipv4RouteTrie trie;
+  std::vector<Ipv4RoutingTableEntry *> routes;
+  for (uint32_t round = 0; round < 20; round++)
+    {
+      for (uint32_t i = 0; i < 100; i++)
+        {
+          uint32_t length = m_random->GetInteger (0, 32);
+          // Few distinct prefixes, so that some of them are shared.
+          uint32_t network = m_random->GetInteger (0, 63) << 26 | m_random->GetInteger (0, 3) << 16 | m_random->GetInteger (0, 15);
+          Ipv4Mask mask (length == 0 ? 0 : 0xffffffffU << (32 - length));
+          Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
+          *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo (Ipv4Address (network), mask, i);
+          routes.push_back (route);
+          trie.Insert (route);
+        }
+      Check (trie, routes);
+      for (uint32_t i = 0; i < 70; i++)
+        {
+          uint32_t k = m_random->GetInteger (0, routes.size () - 1);
+          trie.Remove (routes[k]);
+          delete routes[k];
+          routes.erase (routes.begin () + k);
+        }
+      Check (trie, routes);
+    }
+  for (uint32_t i = 0; i < routes.size (); i++)
+    {
+      trie.Remove (routes[i]);
+      delete routes[i];
+    }
+  routes.clear ();
+  Check (trie, routes);
+}
+
+/**
+ * IPv4 longest prefix match trie TestSuite
+ */
+static class Ipv4RouteTrieTestSuite : public TestSuite
+{
+public:
+  Ipv4RouteTrieTestSuite ()
+    : TestSuite ("ipv4-route-trie", UNIT)
+  {
+    AddTestCase (new Ipv4RouteTrieBasicTestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4RouteTrieRandomTestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4RouteTrieNonContiguousTestCase, TestCase::QUICK);
+  }
+} g_ipv4RouteTrieTestSuite;
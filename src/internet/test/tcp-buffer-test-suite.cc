@@ -0,0 +1,206 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/packet.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/tcp-header.h"
+#include "ns3/tcp-tx-buffer.h"
+#include "ns3/tcp-rx-buffer.h"
+
+using namespace ns3;
+
+namespace {
+
+/**
+ * \param offset the offset of a chunk in the byte stream.
+ * \param size the size of the chunk.
+ * \returns a packet holding the bytes of the stream at this offset.
+ */
+Ptr<Packet>
+MakeChunk (uint32_t offset, uint32_t size)
+{
+  std::vector<uint8_t> bytes (size);
+  for (uint32_t i = 0; i < size; i++)
+    {
+      bytes[i] = (offset + i) * 7 % 251;
+    }
+  return Create<Packet> (size == 0 ? 0 : &bytes[0], size);
+}
+
+/**
+ * \param p a packet.
+ * \param offset the offset of the packet in the byte stream.
+ * \returns true if the packet holds the bytes of the stream at this offset.
+ */
+bool
+IsChunk (Ptr<Packet> p, uint32_t offset)
+{
+  std::vector<uint8_t> bytes (p->GetSize () + 1);
+  p->CopyData (&bytes[0], p->GetSize ());
+  for (uint32_t i = 0; i < p->GetSize (); i++)
+    {
+      if (bytes[i] != (offset + i) * 7 % 251)
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+} // anonymous namespace
+
+/**
+ * Copy random segments of a stream written in chunks of random sizes into
+ * a TcpTxBuffer, while the head of the buffer is acknowledged.
+ */
+class TcpTxBufferTestCase : public TestCase
+{
+public:
+  TcpTxBufferTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TcpTxBufferTestCase::TcpTxBufferTestCase ()
+  : TestCase ("Check the segments copied from the Tx buffer")
+{
+}
+
+void
+TcpTxBufferTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  random->SetStream (1);
+  // Start close to the wrap around of the sequence numbers.
+  SequenceNumber32 isn (0xffff0000U);
+  Ptr<TcpTxBuffer> buffer = CreateObject<TcpTxBuffer> ();
+  buffer->SetMaxBufferSize (100000);
+  buffer->SetHeadSequence (isn);
+  uint32_t written = 0;
+  uint32_t acked = 0;
+  uint32_t sent = 0;
+  for (uint32_t round = 0; round < 200; round++)
+    {
+      while (buffer->Available () > 2000)
+        {
+          uint32_t size = random->GetInteger (1, 1500);
+          NS_TEST_ASSERT_MSG_EQ (buffer->Add (MakeChunk (written, size)), true, "Chunk rejected");
+          written += size;
+        }
+      NS_TEST_ASSERT_MSG_EQ (buffer->Size (), written - acked, "Wrong buffer size");
+      NS_TEST_ASSERT_MSG_EQ (buffer->TailSequence (), isn + SequenceNumber32 (written), "Wrong tail sequence");
+
+      // Send segments in sequence, then retransmit one of them.
+      for (uint32_t k = 0; k < 20 && sent < written; k++)
+        {
+          Ptr<Packet> p = buffer->CopyFromSequence (536, isn + SequenceNumber32 (sent));
+          NS_TEST_ASSERT_MSG_EQ (p->GetSize (), std::min (536U, written - sent), "Wrong segment size");
+          NS_TEST_ASSERT_MSG_EQ (IsChunk (p, sent), true, "Wrong segment data at " << sent);
+          sent += p->GetSize ();
+        }
+      uint32_t offset = random->GetInteger (acked, sent);
+      Ptr<Packet> p = buffer->CopyFromSequence (random->GetInteger (1, 3000), isn + SequenceNumber32 (offset));
+      NS_TEST_ASSERT_MSG_EQ (IsChunk (p, offset), true, "Wrong retransmitted data at " << offset);
+
+      acked = random->GetInteger (acked, sent);
+      buffer->DiscardUpTo (isn + SequenceNumber32 (acked));
+      NS_TEST_ASSERT_MSG_EQ (buffer->HeadSequence (), isn + SequenceNumber32 (acked), "Wrong head sequence");
+      NS_TEST_ASSERT_MSG_EQ (buffer->Size (), written - acked, "Wrong buffer size after discard");
+    }
+  buffer->DiscardUpTo (isn + SequenceNumber32 (written));
+  NS_TEST_ASSERT_MSG_EQ (buffer->Size (), 0U, "Data left after discarding all");
+}
+
+/**
+ * Add random, overlapping and out-of-order segments of a stream to a
+ * TcpRxBuffer, and check the data extracted from it.
+ */
+class TcpRxBufferTestCase : public TestCase
+{
+public:
+  TcpRxBufferTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TcpRxBufferTestCase::TcpRxBufferTestCase ()
+  : TestCase ("Check the data extracted from the Rx buffer")
+{
+}
+
+void
+TcpRxBufferTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  random->SetStream (1);
+  SequenceNumber32 isn (0xfffff000U);
+  Ptr<TcpRxBuffer> buffer = CreateObject<TcpRxBuffer> ();
+  buffer->SetMaxBufferSize (10000);
+  buffer->SetNextRxSequence (isn);
+  std::vector<bool> received (100000, false);
+  uint32_t extracted = 0;
+  uint32_t next = 0;
+  while (extracted < 50000)
+    {
+      // A segment within the window, which may overlap the received data.
+      uint32_t offset = random->GetInteger (extracted, extracted + 8499);
+      uint32_t size = random->GetInteger (1, 1500);
+      TcpHeader header;
+      header.SetSequenceNumber (isn + SequenceNumber32 (offset));
+      buffer->Add (MakeChunk (offset, size), header);
+      for (uint32_t i = offset; i < offset + size; i++)
+        {
+          received[i] = true;
+        }
+      while (received[next])
+        {
+          next++;
+        }
+      NS_TEST_ASSERT_MSG_EQ (buffer->NextRxSequence (), isn + SequenceNumber32 (next), "Wrong next sequence");
+      NS_TEST_ASSERT_MSG_EQ (buffer->Available (), next - extracted, "Wrong available size");
+
+      if (random->GetInteger (0, 3) == 0)
+        {
+          Ptr<Packet> p = buffer->Extract (random->GetInteger (1, 5000));
+          if (next == extracted)
+            {
+              NS_TEST_ASSERT_MSG_EQ (p, 0, "Data extracted from a hole");
+              continue;
+            }
+          NS_TEST_ASSERT_MSG_EQ (IsChunk (p, extracted), true, "Wrong data extracted at " << extracted);
+          extracted += p->GetSize ();
+        }
+    }
+}
+
+/**
+ * TCP Tx and Rx buffers TestSuite
+ */
+static class TcpBufferTestSuite : public TestSuite
+{
+public:
+  TcpBufferTestSuite ()
+    : TestSuite ("tcp-buffer", UNIT)
+  {
+    AddTestCase (new TcpTxBufferTestCase, TestCase::QUICK);
+    AddTestCase (new TcpRxBufferTestCase, TestCase::QUICK);
+  }
+} g_tcpBufferTestSuite;
@@ -0,0 +1,846 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "parallel-simulator-impl.h"
+
+#include "ns3/core-config.h"
+#include "ns3/simulator.h"
+#include "ns3/scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/channel.h"
+#include "ns3/channel-list.h"
+#include "ns3/net-device.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+#include <pthread.h>
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ParallelSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED (ParallelSimulatorImpl);
+
+/**
+ * \ingroup mpi
+ *
+ * \brief A reusable barrier for a fixed number of threads.
+ */
+class ParallelBarrier
+{
+public:
+  /**
+   * \param n the number of threads which must call Wait before
+   *        any of them is released.
+   */
+  ParallelBarrier (uint32_t n)
+    : m_n (n),
+      m_count (0),
+      m_generation (0)
+  {
+    pthread_mutex_init (&m_mutex, 0);
+    pthread_cond_init (&m_cond, 0);
+  }
+  ~ParallelBarrier ()
+  {
+    pthread_mutex_destroy (&m_mutex);
+    pthread_cond_destroy (&m_cond);
+  }
+  /** Block until all the threads have reached the barrier. */
+  void Wait (void)
+  {
+    pthread_mutex_lock (&m_mutex);
+    uint32_t generation = m_generation;
+    m_count++;
+    if (m_count == m_n)
+      {
+        m_count = 0;
+        m_generation++;
+        pthread_cond_broadcast (&m_cond);
+      }
+    else
+      {
+        while (generation == m_generation)
+          {
+            pthread_cond_wait (&m_cond, &m_mutex);
+          }
+      }
+    pthread_mutex_unlock (&m_mutex);
+  }
+private:
+  uint32_t m_n;             //!< Number of threads.
+  uint32_t m_count;         //!< Number of threads waiting.
+  uint32_t m_generation;    //!< Incremented each time the barrier opens.
+  pthread_mutex_t m_mutex;  //!< Protects the counters.
+  pthread_cond_t m_cond;    //!< Signaled when the barrier opens.
+};
+
+#ifdef HAVE_TLS
+/**
+ * Index plus one of the partition run by the calling thread, or zero
+ * if the calling thread does not run a partition.
+ */
+static __thread uint32_t g_currentPartition = 0;
+#endif
+
+/** A timestamp which is never reached. */
+static const uint64_t INFINITE_TS = 0x7fffffffffffffffLL;
+
+TypeId
+ParallelSimulatorImpl::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ParallelSimulatorImpl")
+    .SetParent<SimulatorImpl> ()
+    .SetGroupName ("Mpi")
+    .AddConstructor<ParallelSimulatorImpl> ()
+  ;
+  return tid;
+}
+
+ParallelSimulatorImpl::ParallelSimulatorImpl ()
+  : m_barrier (0),
+    m_running (false),
+    m_finished (false),
+    m_windowEnd (0),
+    m_stopTs (INFINITE_TS),
+    m_currentTs (0),
+    m_lookAhead (INFINITE_TS),
+    m_maxLookAhead (INFINITE_TS)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+ParallelSimulatorImpl::~ParallelSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+ParallelSimulatorImpl::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t i = 0; i < m_partitions.size (); ++i)
+    {
+      Partition *partition = m_partitions[i];
+      while (!partition->events->IsEmpty ())
+        {
+          Scheduler::Event next = partition->events->RemoveNext ();
+          next.impl->Unref ();
+        }
+      for (uint32_t j = 0; j < partition->outbox.size (); ++j)
+        {
+          for (uint32_t k = 0; k < partition->outbox[j].size (); ++k)
+            {
+              partition->outbox[j][k].impl->Unref ();
+            }
+        }
+      delete partition;
+    }
+  m_partitions.clear ();
+  delete m_barrier;
+  m_barrier = 0;
+  SimulatorImpl::DoDispose ();
+}
+
+void
+ParallelSimulatorImpl::Destroy ()
+{
+  NS_LOG_FUNCTION (this);
+  while (!m_destroyEvents.empty ())
+    {
+      Ptr<EventImpl> ev = m_destroyEvents.front ().PeekEventImpl ();
+      m_destroyEvents.pop_front ();
+      NS_LOG_LOGIC ("handle destroy " << ev);
+      if (!ev->IsCancelled ())
+        {
+          ev->Invoke ();
+        }
+    }
+}
+
+ParallelSimulatorImpl::Partition *
+ParallelSimulatorImpl::CreatePartition (uint32_t id)
+{
+  NS_LOG_FUNCTION (this << id);
+  Partition *partition = new Partition ();
+  partition->simulator = this;
+  partition->id = id;
+  partition->events = m_schedulerFactory.Create<Scheduler> ();
+  // uids are allocated from 4.
+  // uid 0 is "invalid" events
+  // uid 1 is "now" events
+  // uid 2 is "destroy" events
+  partition->uid = 4;
+  // before ::Run is entered, the m_currentUid will be zero
+  partition->currentUid = 0;
+  partition->currentTs = 0;
+  partition->currentContext = 0xffffffff;
+  partition->windowTs = 0;
+  partition->windowUid = 0;
+  partition->unscheduledEvents = 0;
+  partition->stop = false;
+  return partition;
+}
+
+void
+ParallelSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
+{
+  NS_LOG_FUNCTION (this << schedulerFactory);
+  NS_ASSERT_MSG (!m_running, "Cannot change the scheduler during Simulator::Run");
+  m_schedulerFactory = schedulerFactory;
+  if (m_partitions.empty ())
+    {
+      m_partitions.push_back (CreatePartition (0));
+      return;
+    }
+  for (uint32_t i = 0; i < m_partitions.size (); ++i)
+    {
+      Ptr<Scheduler> scheduler = m_schedulerFactory.Create<Scheduler> ();
+      Ptr<Scheduler> events = m_partitions[i]->events;
+      while (!events->IsEmpty ())
+        {
+          scheduler->Insert (events->RemoveNext ());
+        }
+      m_partitions[i]->events = scheduler;
+    }
+}
+
+void
+ParallelSimulatorImpl::SetMaximumLookAhead (const Time lookAhead)
+{
+  if (lookAhead > 0)
+    {
+      NS_LOG_FUNCTION (this << lookAhead);
+      m_maxLookAhead = lookAhead.GetTimeStep ();
+    }
+  else
+    {
+      NS_LOG_WARN ("attempted to set look ahead negative: " << lookAhead);
+    }
+}
+
+ParallelSimulatorImpl::Partition *
+ParallelSimulatorImpl::GetCurrentPartition (void) const
+{
+#ifdef HAVE_TLS
+  uint32_t index = g_currentPartition;
+  return index == 0 ? 0 : m_partitions[index - 1];
+#else
+  if (!m_running)
+    {
+      return 0;
+    }
+  for (uint32_t i = 0; i < m_partitions.size (); ++i)
+    {
+      if (SystemThread::Equals (m_partitions[i]->threadId))
+        {
+          return m_partitions[i];
+        }
+    }
+  return 0;
+#endif
+}
+
+uint32_t
+ParallelSimulatorImpl::GetPartitionId (uint32_t context) const
+{
+  if (context < m_contextPartition.size ())
+    {
+      return m_contextPartition[context];
+    }
+  return 0;
+}
+
+void
+ParallelSimulatorImpl::Insert (Partition *partition, Scheduler::Event &ev)
+{
+  ev.key.m_uid = partition->uid;
+  partition->uid++;
+  partition->unscheduledEvents++;
+  partition->events->Insert (ev);
+}
+
+void
+ParallelSimulatorImpl::CreatePartitions (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  uint32_t nPartitions = m_partitions.size ();
+  m_contextPartition.assign (NodeList::GetNNodes (), 0);
+  for (NodeList::Iterator i = NodeList::Begin (); i != NodeList::End (); ++i)
+    {
+      uint32_t systemId = (*i)->GetSystemId ();
+      m_contextPartition[(*i)->GetId ()] = systemId;
+      nPartitions = std::max (nPartitions, systemId + 1);
+    }
+  NS_LOG_LOGIC ("partitions=" << nPartitions);
+  if (nPartitions == 1)
+    {
+      // everything belongs to partition 0 already.
+      m_partitions[0]->outbox.resize (1);
+      return;
+    }
+
+  // New uids are allocated above all the existing ones, so that
+  // events keep their uid, and their EventId remains valid, when
+  // they move to a new partition.
+  uint32_t uid = 0;
+  for (uint32_t i = 0; i < m_partitions.size (); ++i)
+    {
+      uid = std::max (uid, m_partitions[i]->uid);
+    }
+  while (m_partitions.size () < nPartitions)
+    {
+      Partition *partition = CreatePartition (m_partitions.size ());
+      partition->currentTs = m_currentTs;
+      m_partitions.push_back (partition);
+    }
+
+  std::vector<Scheduler::Event> misplaced;
+  for (uint32_t i = 0; i < m_partitions.size (); ++i)
+    {
+      Partition *partition = m_partitions[i];
+      partition->uid = uid;
+      partition->outbox.resize (nPartitions);
+      Ptr<Scheduler> events = m_schedulerFactory.Create<Scheduler> ();
+      while (!partition->events->IsEmpty ())
+        {
+          Scheduler::Event ev = partition->events->RemoveNext ();
+          if (GetPartitionId (ev.key.m_context) == i)
+            {
+              events->Insert (ev);
+            }
+          else
+            {
+              partition->unscheduledEvents--;
+              misplaced.push_back (ev);
+            }
+        }
+      partition->events = events;
+    }
+  for (std::vector<Scheduler::Event>::const_iterator i = misplaced.begin ();
+       i != misplaced.end (); ++i)
+    {
+      Partition *partition = m_partitions[GetPartitionId (i->key.m_context)];
+      partition->unscheduledEvents++;
+      partition->events->Insert (*i);
+    }
+}
+
+void
+ParallelSimulatorImpl::CalculateLookAhead (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_lookAhead = m_maxLookAhead;
+  if (m_partitions.size () == 1)
+    {
+      // no synchronization needed at all.
+      m_lookAhead = INFINITE_TS;
+      return;
+    }
+
+  for (ChannelList::Iterator i = ChannelList::Begin (); i != ChannelList::End (); ++i)
+    {
+      Ptr<Channel> channel = *i;
+      bool crossPartition = false;
+      uint32_t first = 0;
+      for (uint32_t j = 0; j < channel->GetNDevices (); ++j)
+        {
+          Ptr<Node> node = channel->GetDevice (j)->GetNode ();
+          if (node == 0)
+            {
+              continue;
+            }
+          uint32_t partition = GetPartitionId (node->GetId ());
+          if (j == 0)
+            {
+              first = partition;
+            }
+          else if (partition != first)
+            {
+              crossPartition = true;
+              break;
+            }
+        }
+      if (!crossPartition)
+        {
+          continue;
+        }
+
+      TimeValue delay;
+      if (!channel->GetAttributeFailSafe ("Delay", delay))
+        {
+          NS_FATAL_ERROR ("Channel " << channel->GetId () << " of type " <<
+                          channel->GetInstanceTypeId ().GetName () <<
+                          " connects nodes of different partitions but has no Delay attribute");
+        }
+      if (!delay.Get ().IsStrictlyPositive ())
+        {
+          NS_FATAL_ERROR ("Channel " << channel->GetId () <<
+                          " connects nodes of different partitions with a zero delay");
+        }
+      m_lookAhead = std::min (m_lookAhead, (uint64_t)delay.Get ().GetTimeStep ());
+    }
+  NS_LOG_LOGIC ("lookahead=" << m_lookAhead);
+}
+
+void
+ParallelSimulatorImpl::Synchronize (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  // Deliver the cross-partition events. The order of delivery only
+  // depends on the order in which each partition ran its own events,
+  // which keeps the simulation deterministic.
+  for (uint32_t i = 0; i < m_partitions.size (); ++i)
+    {
+      Partition *source = m_partitions[i];
+      for (uint32_t j = 0; j < source->outbox.size (); ++j)
+        {
+          std::vector<Scheduler::Event> &outbox = source->outbox[j];
+          for (uint32_t k = 0; k < outbox.size (); ++k)
+            {
+              Insert (m_partitions[j], outbox[k]);
+            }
+          outbox.clear ();
+        }
+    }
+
+  bool stop = false;
+  uint64_t next = INFINITE_TS;
+  for (uint32_t i = 0; i < m_partitions.size (); ++i)
+    {
+      Partition *partition = m_partitions[i];
+      partition->windowTs = partition->currentTs;
+      partition->windowUid = partition->currentUid;
+      stop = stop || partition->stop;
+      if (!partition->events->IsEmpty ())
+        {
+          next = std::min (next, partition->events->PeekNext ().key.m_ts);
+        }
+    }
+
+  if (!stop && next >= m_stopTs && m_stopTs != INFINITE_TS)
+    {
+      // Simulator::Stop (delay): all partitions stop together.
+      for (uint32_t i = 0; i < m_partitions.size (); ++i)
+        {
+          m_partitions[i]->currentTs = std::max (m_partitions[i]->currentTs, m_stopTs);
+        }
+      m_stopTs = INFINITE_TS;
+      stop = true;
+    }
+  if (stop || next == INFINITE_TS)
+    {
+      m_finished = true;
+      return;
+    }
+
+  if (m_lookAhead >= INFINITE_TS - next)
+    {
+      m_windowEnd = INFINITE_TS;
+    }
+  else
+    {
+      m_windowEnd = next + m_lookAhead;
+    }
+  m_windowEnd = std::min (m_windowEnd, m_stopTs);
+  NS_LOG_LOGIC ("window=[" << next << "," << m_windowEnd << ")");
+}
+
+void
+ParallelSimulatorImpl::ProcessOneEvent (Partition *partition)
+{
+  Scheduler::Event next = partition->events->RemoveNext ();
+
+  NS_ASSERT (next.key.m_ts >= partition->currentTs);
+  partition->unscheduledEvents--;
+
+  NS_LOG_LOGIC ("handle " << next.key.m_ts << " in partition " << partition->id);
+  partition->currentTs = next.key.m_ts;
+  partition->currentContext = next.key.m_context;
+  partition->currentUid = next.key.m_uid;
+  next.impl->Invoke ();
+  next.impl->Unref ();
+}
+
+void
+ParallelSimulatorImpl::RunPartitionThread (Partition *partition)
+{
+  partition->simulator->RunPartition (partition);
+}
+
+void
+ParallelSimulatorImpl::RunPartition (Partition *partition)
+{
+  NS_LOG_FUNCTION (this << partition->id);
+#ifdef HAVE_TLS
+  g_currentPartition = partition->id + 1;
+#endif
+  partition->threadId = SystemThread::Self ();
+  while (true)
+    {
+      m_barrier->Wait ();
+      if (partition->id == 0)
+        {
+          Synchronize ();
+        }
+      m_barrier->Wait ();
+      if (m_finished)
+        {
+          break;
+        }
+      while (!partition->stop
+             && !partition->events->IsEmpty ()
+             && partition->events->PeekNext ().key.m_ts < __atomic_load_n (&m_windowEnd, __ATOMIC_RELAXED))
+        {
+          ProcessOneEvent (partition);
+        }
+    }
+#ifdef HAVE_TLS
+  g_currentPartition = 0;
+#endif
+}
+
+void
+ParallelSimulatorImpl::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT_MSG (!m_running, "Simulator::Run is not reentrant");
+
+  CreatePartitions ();
+  CalculateLookAhead ();
+
+  uint32_t nPartitions = m_partitions.size ();
+  for (uint32_t i = 0; i < nPartitions; ++i)
+    {
+      m_partitions[i]->stop = false;
+    }
+  m_finished = false;
+  delete m_barrier;
+  m_barrier = new ParallelBarrier (nPartitions);
+  m_running = true;
+
+  for (uint32_t i = 1; i < nPartitions; ++i)
+    {
+      Partition *partition = m_partitions[i];
+      partition->thread = Create<SystemThread> (MakeBoundCallback (&ParallelSimulatorImpl::RunPartitionThread, partition));
+      partition->thread->Start ();
+    }
+  RunPartition (m_partitions[0]);
+  for (uint32_t i = 1; i < nPartitions; ++i)
+    {
+      m_partitions[i]->thread->Join ();
+      m_partitions[i]->thread = 0;
+    }
+  m_running = false;
+
+  bool empty = true;
+  int unscheduledEvents = 0;
+  for (uint32_t i = 0; i < nPartitions; ++i)
+    {
+      m_currentTs = std::max (m_currentTs, m_partitions[i]->currentTs);
+      empty = empty && m_partitions[i]->events->IsEmpty ();
+      unscheduledEvents += m_partitions[i]->unscheduledEvents;
+    }
+
+  // If the simulator stopped naturally by lack of events, make a
+  // consistency test to check that we didn't lose any events along the way.
+  NS_ASSERT (!empty || unscheduledEvents == 0);
+}
+
+bool
+ParallelSimulatorImpl::IsFinished (void) const
+{
+  for (uint32_t i = 0; i < m_partitions.size (); ++i)
+    {
+      if (m_partitions[i]->stop)
+        {
+          return true;
+        }
+    }
+  for (uint32_t i = 0; i < m_partitions.size (); ++i)
+    {
+      if (!m_partitions[i]->events->IsEmpty ())
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+uint32_t
+ParallelSimulatorImpl::GetSystemId (void) const
+{
+  Partition *partition = GetCurrentPartition ();
+  return partition == 0 ? 0 : partition->id;
+}
+
+void
+ParallelSimulatorImpl::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+  Partition *partition = GetCurrentPartition ();
+  if (partition != 0)
+    {
+      partition->stop = true;
+    }
+  else
+    {
+      CriticalSection cs (m_mutex);
+      m_stopTs = m_currentTs;
+    }
+}
+
+void
+ParallelSimulatorImpl::Stop (Time const &time)
+{
+  NS_LOG_FUNCTION (this << time.GetTimeStep ());
+  CriticalSection cs (m_mutex);
+  uint64_t stopTs = Now ().GetTimeStep () + time.GetTimeStep ();
+  m_stopTs = std::min (m_stopTs, stopTs);
+  if (m_running && stopTs < m_windowEnd)
+    {
+      // Do not let the partitions run the events of the current window
+      // which follow the stop time.
+      __atomic_store_n (&m_windowEnd, stopTs, __ATOMIC_RELAXED);
+    }
+}
+
+//
+// Schedule an event for a _relative_ time in the future.
+//
+EventId
+ParallelSimulatorImpl::Schedule (Time const &time, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << time.GetTimeStep () << event);
+
+  Partition *partition = GetCurrentPartition ();
+  NS_ASSERT_MSG (partition != 0 || !m_running, "Simulator::Schedule Thread-unsafe invocation!");
+  uint64_t now = m_currentTs;
+  uint32_t context = 0xffffffff;
+  if (partition != 0)
+    {
+      now = partition->currentTs;
+      context = partition->currentContext;
+    }
+  else
+    {
+      partition = m_partitions[0];
+    }
+
+  Time tAbsolute = time + TimeStep (now);
+  NS_ASSERT (tAbsolute.IsPositive ());
+  NS_ASSERT (tAbsolute >= TimeStep (now));
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = (uint64_t) tAbsolute.GetTimeStep ();
+  ev.key.m_context = context;
+  Insert (partition, ev);
+  return EventId (event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
+}
+
+void
+ParallelSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &time, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << context << time.GetTimeStep () << event);
+
+  Partition *source = GetCurrentPartition ();
+  NS_ASSERT_MSG (source != 0 || !m_running, "Simulator::ScheduleWithContext Thread-unsafe invocation!");
+  Partition *destination = m_partitions[GetPartitionId (context)];
+
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_context = context;
+  if (source == 0)
+    {
+      ev.key.m_ts = std::max (m_currentTs, destination->currentTs) + time.GetTimeStep ();
+      Insert (destination, ev);
+    }
+  else if (source == destination)
+    {
+      ev.key.m_ts = source->currentTs + time.GetTimeStep ();
+      Insert (destination, ev);
+    }
+  else
+    {
+      ev.key.m_ts = source->currentTs + time.GetTimeStep ();
+      if (ev.key.m_ts < __atomic_load_n (&m_windowEnd, __ATOMIC_RELAXED))
+        {
+          NS_FATAL_ERROR ("Event scheduled by partition " << source->id <<
+                          " for context " << context << " in partition " << destination->id <<
+                          " at " << TimeStep (ev.key.m_ts) << " is within the lookahead");
+        }
+      // the uid is allocated by the destination partition on delivery.
+      ev.key.m_uid = 0;
+      source->outbox[destination->id].push_back (ev);
+    }
+}
+
+EventId
+ParallelSimulatorImpl::ScheduleNow (EventImpl *event)
+{
+  return Schedule (TimeStep (0), event);
+}
+
+EventId
+ParallelSimulatorImpl::ScheduleDestroy (EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << event);
+
+  CriticalSection cs (m_mutex);
+  EventId id (Ptr<EventImpl> (event, false), Now ().GetTimeStep (), 0xffffffff, 2);
+  m_destroyEvents.push_back (id);
+  return id;
+}
+
+Time
+ParallelSimulatorImpl::Now (void) const
+{
+  // Do not add function logging here, to avoid stack overflow
+  Partition *partition = GetCurrentPartition ();
+  return TimeStep (partition == 0 ? m_currentTs : partition->currentTs);
+}
+
+Time
+ParallelSimulatorImpl::GetDelayLeft (const EventId &id) const
+{
+  if (IsExpired (id))
+    {
+      return TimeStep (0);
+    }
+  else
+    {
+      return TimeStep (id.GetTs ()) - Now ();
+    }
+}
+
+void
+ParallelSimulatorImpl::Remove (const EventId &id)
+{
+  if (id.GetUid () == 2)
+    {
+      // destroy events.
+      CriticalSection cs (m_mutex);
+      for (DestroyEvents::iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              m_destroyEvents.erase (i);
+              break;
+            }
+        }
+      return;
+    }
+  if (IsExpired (id))
+    {
+      return;
+    }
+  Partition *owner = m_partitions[GetPartitionId (id.GetContext ())];
+  Partition *partition = GetCurrentPartition ();
+  if (partition != 0 && partition != owner)
+    {
+      // the scheduler of another partition cannot be modified safely.
+      id.PeekEventImpl ()->Cancel ();
+      return;
+    }
+  Scheduler::Event event;
+  event.impl = id.PeekEventImpl ();
+  event.key.m_ts = id.GetTs ();
+  event.key.m_context = id.GetContext ();
+  event.key.m_uid = id.GetUid ();
+  owner->events->Remove (event);
+  event.impl->Cancel ();
+  // whenever we remove an event from the event list, we have to unref it.
+  event.impl->Unref ();
+
+  owner->unscheduledEvents--;
+}
+
+void
+ParallelSimulatorImpl::Cancel (const EventId &id)
+{
+  if (!IsExpired (id))
+    {
+      id.PeekEventImpl ()->Cancel ();
+    }
+}
+
+bool
+ParallelSimulatorImpl::IsExpired (const EventId &id) const
+{
+  if (id.GetUid () == 2)
+    {
+      if (id.PeekEventImpl () == 0
+          || id.PeekEventImpl ()->IsCancelled ())
+        {
+          return true;
+        }
+      // destroy events.
+      CriticalSection cs (const_cast<SystemMutex &> (m_mutex));
+      for (DestroyEvents::const_iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              return false;
+            }
+        }
+      return true;
+    }
+  const Partition *owner = m_partitions[GetPartitionId (id.GetContext ())];
+  uint64_t currentTs = owner->currentTs;
+  uint32_t currentUid = owner->currentUid;
+  if (m_running && GetCurrentPartition () != owner)
+    {
+      // The owner runs on another thread: only its state at the start
+      // of the window, set while all threads wait, can be read safely.
+      currentTs = owner->windowTs;
+      currentUid = owner->windowUid;
+    }
+  if (id.PeekEventImpl () == 0
+      || id.GetTs () < currentTs
+      || (id.GetTs () == currentTs
+          && id.GetUid () <= currentUid)
+      || id.PeekEventImpl ()->IsCancelled ())
+    {
+      return true;
+    }
+  else
+    {
+      return false;
+    }
+}
+
+Time
+ParallelSimulatorImpl::GetMaximumSimulationTime (void) const
+{
+  return TimeStep (INFINITE_TS);
+}
+
+uint32_t
+ParallelSimulatorImpl::GetContext (void) const
+{
+  Partition *partition = GetCurrentPartition ();
+  return partition == 0 ? 0xffffffff : partition->currentContext;
+}
+
+} // namespace ns3
@@ -0,0 +1,223 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NS3_PARALLEL_SIMULATOR_IMPL_H
+#define NS3_PARALLEL_SIMULATOR_IMPL_H
+
+#include "ns3/simulator-impl.h"
+#include "ns3/scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/object-factory.h"
+#include "ns3/system-thread.h"
+#include "ns3/system-mutex.h"
+#include "ns3/ptr.h"
+
+#include <list>
+#include <vector>
+
+namespace ns3 {
+
+class ParallelBarrier;
+
+/**
+ * \ingroup simulator
+ * \ingroup mpi
+ *
+ * \brief Multi-threaded conservative simulator for shared memory machines.
+ *
+ * Nodes are partitioned according to their system id (see
+ * Node::GetSystemId), exactly as for the DistributedSimulatorImpl,
+ * but all partitions live in the same process: each one owns its own
+ * scheduler and runs on its own thread. Events are assigned to the
+ * partition of the node identified by their context; events whose
+ * context is not a node id belong to partition 0, which runs on the
+ * thread that called Simulator::Run.
+ *
+ * Partitions are synchronized with a barrier-based granted time window:
+ * during each window, every partition runs all of its events whose
+ * timestamp is smaller than the smallest pending timestamp plus the
+ * lookahead. The lookahead is the smallest "Delay" attribute of the
+ * channels which connect nodes of different partitions, and can be
+ * further bounded with SetMaximumLookAhead.
+ *
+ * Events scheduled with Simulator::ScheduleWithContext for a node of
+ * another partition are queued in a per-partition outbox and inserted
+ * into the target scheduler at the next window boundary. The event is
+ * handed over by pointer, so the reference counts of the objects bound
+ * to it must not be shared with the sending partition:
+ * PointToPointChannel hands over a deep copy of each packet
+ * (Packet::DeepCopy), and its destination device by plain pointer.
+ * The other channels must not connect nodes of different partitions,
+ * and the packet metadata (Packet::EnablePrinting) is not supported.
+ *
+ * Restrictions:
+ *  - a cross-partition event must be scheduled at least one lookahead
+ *    in the future, otherwise the simulation aborts;
+ *  - Simulator::Remove on an event owned by another partition only
+ *    cancels it, and Simulator::IsExpired reports it as expired only
+ *    if it was run before the current window;
+ *  - Simulator::Stop () without a delay stops the calling partition
+ *    immediately, and the other ones at the end of the current window.
+ *    Simulator::Stop (delay) stops all partitions at the same time,
+ *    before any event scheduled at exactly that time, if the delay is
+ *    at least the lookahead; with a shorter delay, the other partitions
+ *    may already have run some events of the current window past the
+ *    stop time;
+ *  - the models used by nodes of different partitions must not share
+ *    unsynchronized state besides the events handed over through
+ *    Simulator::ScheduleWithContext.
+ */
+class ParallelSimulatorImpl : public SimulatorImpl
+{
+public:
+  static TypeId GetTypeId (void);
+
+  ParallelSimulatorImpl ();
+  ~ParallelSimulatorImpl ();
+
+  // virtual from SimulatorImpl
+  virtual void Destroy ();
+  virtual bool IsFinished (void) const;
+  virtual void Stop (void);
+  virtual void Stop (Time const &time);
+  virtual EventId Schedule (Time const &time, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, Time const &time, EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+  virtual EventId ScheduleDestroy (EventImpl *event);
+  virtual void Remove (const EventId &id);
+  virtual void Cancel (const EventId &id);
+  virtual bool IsExpired (const EventId &id) const;
+  virtual void Run (void);
+  virtual Time Now (void) const;
+  virtual Time GetDelayLeft (const EventId &id) const;
+  virtual Time GetMaximumSimulationTime (void) const;
+  virtual void SetScheduler (ObjectFactory schedulerFactory);
+  /**
+   * \returns the index of the partition of the calling thread, or
+   *          zero outside of Simulator::Run.
+   */
+  virtual uint32_t GetSystemId (void) const;
+  virtual uint32_t GetContext (void) const;
+
+  /**
+   * Bound the lookahead computed from the channels connecting
+   * partitions.
+   *
+   * \param lookAhead the maximum lookahead.
+   */
+  void SetMaximumLookAhead (const Time lookAhead);
+
+private:
+  /** The state of a partition of the simulation. */
+  struct Partition
+  {
+    ParallelSimulatorImpl *simulator; //!< The simulator owning this partition.
+    uint32_t id;                    //!< Index of this partition.
+    Ptr<Scheduler> events;          //!< Pending events.
+    uint32_t uid;                   //!< Next event uid.
+    uint32_t currentUid;            //!< Uid of the event being executed.
+    uint64_t currentTs;             //!< Timestamp of the event being executed.
+    uint32_t currentContext;        //!< Context of the event being executed.
+    uint64_t windowTs;              //!< currentTs at the start of the window.
+    uint32_t windowUid;             //!< currentUid at the start of the window.
+    int unscheduledEvents;          //!< Number of events inserted but not yet run.
+    bool stop;                      //!< Simulator::Stop was called by this partition.
+    /** Events for other partitions, indexed by destination partition. */
+    std::vector<std::vector<Scheduler::Event> > outbox;
+    Ptr<SystemThread> thread;       //!< Thread running this partition, if not partition 0.
+    SystemThread::ThreadId threadId; //!< Id of the thread running this partition.
+  };
+
+  virtual void DoDispose (void);
+
+  /**
+   * \returns the partition run by the calling thread, or 0 outside
+   *          of Simulator::Run.
+   */
+  Partition * GetCurrentPartition (void) const;
+  /**
+   * \param context an event context.
+   * \returns the index of the partition which owns the events of this context.
+   */
+  uint32_t GetPartitionId (uint32_t context) const;
+  /**
+   * Insert an event in a partition.
+   *
+   * \param partition the partition.
+   * \param ev the event, whose uid is set by this method.
+   */
+  void Insert (Partition *partition, Scheduler::Event &ev);
+  /**
+   * Create the partitions from the system ids of the nodes, and move
+   * every pending event into the partition which owns its context.
+   */
+  void CreatePartitions (void);
+  /** Compute the lookahead from the channels connecting partitions. */
+  void CalculateLookAhead (void);
+  /**
+   * Deliver the content of all outboxes and compute the next window.
+   * Called by a single thread while all the others wait.
+   */
+  void Synchronize (void);
+  /**
+   * Main loop of a partition thread.
+   * \param partition the partition run by the calling thread.
+   */
+  void RunPartition (Partition *partition);
+  /**
+   * Entry point of the threads created for partitions other than 0.
+   * \param partition the partition run by the new thread.
+   */
+  static void RunPartitionThread (Partition *partition);
+  /**
+   * \param id the index of the new partition.
+   * \returns a new empty partition.
+   */
+  Partition * CreatePartition (uint32_t id);
+  /**
+   * Run the next event of a partition.
+   * \param partition the partition.
+   */
+  void ProcessOneEvent (Partition *partition);
+
+  typedef std::list<EventId> DestroyEvents;
+
+  DestroyEvents m_destroyEvents;
+  /** Protects m_destroyEvents and m_stopTs from concurrent partitions. */
+  SystemMutex m_mutex;
+  ObjectFactory m_schedulerFactory;
+  std::vector<Partition *> m_partitions;
+  /** The partition which owns each context, indexed by node id. */
+  std::vector<uint32_t> m_contextPartition;
+  ParallelBarrier *m_barrier;
+  bool m_running;
+  bool m_finished;
+  /**
+   * Events with a timestamp smaller than this can be run in this window.
+   * Lowered by Simulator::Stop (delay) while the partitions run.
+   */
+  uint64_t m_windowEnd;
+  /** Timestamp requested by Simulator::Stop (delay). */
+  uint64_t m_stopTs;
+  /** Timestamp reported by Simulator::Now outside of Simulator::Run. */
+  uint64_t m_currentTs;
+  uint64_t m_lookAhead;
+  uint64_t m_maxLookAhead;
+};
+
+} // namespace ns3
+
+#endif /* NS3_PARALLEL_SIMULATOR_IMPL_H */
@@ -0,0 +1,276 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/parallel-simulator-impl.h"
+#include "ns3/node.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/nstime.h"
+
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * Pass tokens around a ring of nodes, each in its own partition, and
+ * check that every event runs in the partition of its node, in order.
+ */
+class ParallelSimulatorRingTestCase : public TestCase
+{
+public:
+  /**
+   * \param nNodes number of nodes (and partitions) in the ring.
+   * \param hops number of hops of each token, or zero to stop the
+   *        simulation with Simulator::Stop.
+   */
+  ParallelSimulatorRingTestCase (uint32_t nNodes, uint32_t hops);
+private:
+  virtual void DoRun (void);
+  /**
+   * Receive a token on a node and forward it to the next node.
+   * \param index index of the receiving node.
+   * \param hops number of hops left.
+   */
+  void Receive (uint32_t index, uint32_t hops);
+  /**
+   * A local event scheduled by Receive.
+   * \param index index of the node.
+   */
+  void Local (uint32_t index);
+
+  uint32_t m_nNodes;
+  uint32_t m_hops;
+  std::vector<Ptr<Node> > m_nodes;
+  /** Number of tokens received by each node. */
+  std::vector<uint32_t> m_received;
+  /** Number of local events run by each node. */
+  std::vector<uint32_t> m_local;
+  /** Timestamp of the last event run by each node. */
+  std::vector<Time> m_last;
+  /** Number of events run out of order or in the wrong partition. */
+  std::vector<uint32_t> m_errors;
+};
+
+ParallelSimulatorRingTestCase::ParallelSimulatorRingTestCase (uint32_t nNodes, uint32_t hops)
+  : TestCase ("Check token passing between partitions"),
+    m_nNodes (nNodes),
+    m_hops (hops)
+{
+}
+
+void
+ParallelSimulatorRingTestCase::Receive (uint32_t index, uint32_t hops)
+{
+  Ptr<Node> node = m_nodes[index];
+  if (Simulator::GetSystemId () != node->GetSystemId ()
+      || Simulator::GetContext () != node->GetId ()
+      || Simulator::Now () < m_last[index])
+    {
+      m_errors[index]++;
+    }
+  m_last[index] = Simulator::Now ();
+  m_received[index]++;
+  Simulator::Schedule (MicroSeconds (500), &ParallelSimulatorRingTestCase::Local, this, index);
+  if (hops == 1)
+    {
+      return;
+    }
+  uint32_t next = (index + 1) % m_nNodes;
+  Simulator::ScheduleWithContext (m_nodes[next]->GetId (), MilliSeconds (1),
+                                  &ParallelSimulatorRingTestCase::Receive, this, next, hops - 1);
+}
+
+void
+ParallelSimulatorRingTestCase::Local (uint32_t index)
+{
+  if (Simulator::GetSystemId () != m_nodes[index]->GetSystemId ()
+      || Simulator::Now () < m_last[index])
+    {
+      m_errors[index]++;
+    }
+  m_last[index] = Simulator::Now ();
+  m_local[index]++;
+}
+
+void
+ParallelSimulatorRingTestCase::DoRun (void)
+{
+  Simulator::Destroy ();
+  Simulator::SetImplementation (CreateObject<ParallelSimulatorImpl> ());
+
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  channel->SetAttribute ("Delay", TimeValue (MilliSeconds (1)));
+  for (uint32_t i = 0; i < m_nNodes; ++i)
+    {
+      Ptr<Node> node = CreateObject<Node> (i);
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetChannel (channel);
+      node->AddDevice (device);
+      m_nodes.push_back (node);
+    }
+  m_received.assign (m_nNodes, 0);
+  m_local.assign (m_nNodes, 0);
+  m_last.assign (m_nNodes, Seconds (0));
+  m_errors.assign (m_nNodes, 0);
+
+  for (uint32_t i = 0; i < m_nNodes; ++i)
+    {
+      Simulator::ScheduleWithContext (m_nodes[i]->GetId (), Seconds (0),
+                                      &ParallelSimulatorRingTestCase::Receive, this, i, m_hops);
+    }
+  if (m_hops == 0)
+    {
+      Simulator::Stop (MilliSeconds (100));
+    }
+  Simulator::Run ();
+
+  // Each node receives one token per millisecond.
+  uint32_t expected = m_hops == 0 ? 100 : m_hops;
+  for (uint32_t i = 0; i < m_nNodes; ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_errors[i], 0, "event run out of order or in the wrong partition");
+      NS_TEST_EXPECT_MSG_EQ (m_received[i], expected, "unexpected number of tokens received");
+      NS_TEST_EXPECT_MSG_EQ (m_local[i], expected, "unexpected number of local events");
+    }
+  if (m_hops == 0)
+    {
+      NS_TEST_EXPECT_MSG_EQ (Simulator::Now (), MilliSeconds (100), "simulation did not stop on time");
+    }
+  else
+    {
+      NS_TEST_EXPECT_MSG_EQ (Simulator::Now (), MilliSeconds (m_hops - 1) + MicroSeconds (500),
+                             "simulation did not run all events");
+    }
+
+  m_nodes.clear ();
+  Simulator::Destroy ();
+}
+
+/**
+ * Stop the simulation with Simulator::Stop (delay) from an event, with
+ * a delay shorter than the lookahead, and check that the partition which
+ * called it runs no event at or after the stop time.
+ */
+class ParallelSimulatorStopTestCase : public TestCase
+{
+public:
+  /**
+   * \param nNodes number of nodes (and partitions): with a single one,
+   *        the lookahead is infinite.
+   */
+  ParallelSimulatorStopTestCase (uint32_t nNodes);
+private:
+  virtual void DoRun (void);
+  /**
+   * A periodic event of a node, until the simulation is stopped or
+   * one second has elapsed.
+   * \param index index of the node.
+   */
+  void Tick (uint32_t index);
+  /** Stop the simulation shortly. */
+  void StopSoon (void);
+
+  uint32_t m_nNodes;
+  /** Timestamp of the last event run by each node. */
+  std::vector<Time> m_last;
+};
+
+ParallelSimulatorStopTestCase::ParallelSimulatorStopTestCase (uint32_t nNodes)
+  : TestCase ("Check Simulator::Stop (delay) called from an event"),
+    m_nNodes (nNodes)
+{
+}
+
+void
+ParallelSimulatorStopTestCase::Tick (uint32_t index)
+{
+  m_last[index] = Simulator::Now ();
+  if (Simulator::Now () < Seconds (1))
+    {
+      Simulator::Schedule (MicroSeconds (100), &ParallelSimulatorStopTestCase::Tick, this, index);
+    }
+}
+
+void
+ParallelSimulatorStopTestCase::StopSoon (void)
+{
+  Simulator::Stop (MicroSeconds (250));
+}
+
+void
+ParallelSimulatorStopTestCase::DoRun (void)
+{
+  Simulator::Destroy ();
+  Simulator::SetImplementation (CreateObject<ParallelSimulatorImpl> ());
+
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  channel->SetAttribute ("Delay", TimeValue (MilliSeconds (1)));
+  std::vector<Ptr<Node> > nodes;
+  for (uint32_t i = 0; i < m_nNodes; ++i)
+    {
+      Ptr<Node> node = CreateObject<Node> (i);
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetChannel (channel);
+      node->AddDevice (device);
+      nodes.push_back (node);
+    }
+  m_last.assign (m_nNodes, Seconds (0));
+
+  for (uint32_t i = 0; i < m_nNodes; ++i)
+    {
+      Simulator::ScheduleWithContext (nodes[i]->GetId (), Seconds (0),
+                                      &ParallelSimulatorStopTestCase::Tick, this, i);
+    }
+  Simulator::ScheduleWithContext (nodes[0]->GetId (), MicroSeconds (10050),
+                                  &ParallelSimulatorStopTestCase::StopSoon, this);
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_last[0], MicroSeconds (10200), "events run after the stop time");
+  if (m_nNodes == 1)
+    {
+      NS_TEST_EXPECT_MSG_EQ (Simulator::Now (), MicroSeconds (10300), "simulation did not stop on time");
+    }
+  // The other partitions may have run the window of the stop, but no more.
+  for (uint32_t i = 1; i < m_nNodes; ++i)
+    {
+      NS_TEST_EXPECT_MSG_LT (m_last[i], MicroSeconds (10050) + MilliSeconds (1),
+                             "events run beyond the window of the stop");
+    }
+  NS_TEST_EXPECT_MSG_LT (Simulator::Now (), MicroSeconds (10050) + MilliSeconds (1),
+                         "simulation did not stop at the end of the window");
+
+  nodes.clear ();
+  Simulator::Destroy ();
+}
+
+/**
+ * Parallel simulator test suite.
+ */
+class ParallelSimulatorTestSuite : public TestSuite
+{
+public:
+  ParallelSimulatorTestSuite ()
+    : TestSuite ("parallel-simulator", UNIT)
+  {
+    AddTestCase (new ParallelSimulatorRingTestCase (1, 50), TestCase::QUICK);
+    AddTestCase (new ParallelSimulatorRingTestCase (4, 50), TestCase::QUICK);
+    AddTestCase (new ParallelSimulatorRingTestCase (4, 0), TestCase::QUICK);
+    AddTestCase (new ParallelSimulatorStopTestCase (1), TestCase::QUICK);
+    AddTestCase (new ParallelSimulatorStopTestCase (2), TestCase::QUICK);
+  }
+} g_parallelSimulatorTestSuite;
@@ -26,6 +26,7 @@
 #include "ns3/ptr.h"
 #include "ns3/node.h"
 #include "ns3/names.h"
+#include "ns3/simulator.h"
 #include "ns3/net-device.h"
 #include "ns3/pcap-file-wrapper.h"
 
@@ -35,6 +36,8 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("TraceHelper");
 
+Ptr<PcapWriter> PcapHelper::m_multiplexWriter = 0;
+
 PcapHelper::PcapHelper ()
 {
   NS_LOG_FUNCTION_NOARGS ();
@@ -56,7 +59,14 @@ PcapHelper::CreateFile (
   NS_LOG_FUNCTION (filename << filemode << dataLinkType << snapLen << tzCorrection);
 
   Ptr<PcapFileWrapper> file = CreateObject<PcapFileWrapper> ();
-  file->Open (filename, filemode);
+  if (m_multiplexWriter != 0)
+    {
+      file->Open (m_multiplexWriter, filename);
+    }
+  else
+    {
+      file->Open (filename, filemode);
+    }
   NS_ABORT_MSG_IF (file->Fail (), "Unable to Open " << filename << " for mode " << filemode);
 
   file->Init (dataLinkType, snapLen, tzCorrection);
@@ -76,6 +86,24 @@ PcapHelper::CreateFile (
   return file;
 }
 
+void
+PcapHelper::EnableMultiplexing (std::string filename, bool asynchronous,
+                                enum PcapWriter::Compression compression)
+{
+  NS_LOG_FUNCTION (filename << asynchronous << compression);
+  m_multiplexWriter = Create<PcapWriter> ();
+  m_multiplexWriter->Open (filename, PcapWriter::PCAPNG, compression, asynchronous, 1 << 20);
+  NS_ABORT_MSG_IF (m_multiplexWriter->Fail (), "Unable to Open " << filename);
+  Simulator::ScheduleDestroy (&PcapHelper::DisableMultiplexing);
+}
+
+void
+PcapHelper::DisableMultiplexing (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  m_multiplexWriter = 0;
+}
+
 std::string
 PcapHelper::GetFilenameFromDevice (std::string prefix, Ptr<NetDevice> device, bool useObjectNames)
 {
@@ -101,6 +101,29 @@ public:
    */
   Ptr<PcapFileWrapper> CreateFile (std::string filename, std::ios::openmode filemode,
                                    uint32_t dataLinkType,  uint32_t snapLen = std::numeric_limits<uint32_t>::max (), int32_t tzCorrection = 0);
+
+  /**
+   * @brief Write the pcap traces enabled from now on to a single pcapng file.
+   *
+   * The files created by CreateFile, and thus by the EnablePcap methods
+   * of the helpers, become the interfaces of the pcapng file, named
+   * after the files, until DisableMultiplexing is called or the
+   * simulator is destroyed.
+   *
+   * @param filename name of the pcapng file
+   * @param asynchronous write the file from a background thread
+   * @param compression compression of the file
+   */
+  static void EnableMultiplexing (std::string filename, bool asynchronous = true,
+                                  enum PcapWriter::Compression compression = PcapWriter::NONE);
+
+  /**
+   * @brief Write the pcap traces enabled from now on to their own files.
+   *
+   * The pcapng file opened by EnableMultiplexing is closed once the
+   * traces written to it are disabled.
+   */
+  static void DisableMultiplexing (void);
   /**
    * @brief Hook a trace source to the default trace sink
    * 
@@ -121,6 +144,8 @@ private:
    * @param p the packet to write
    */
   static void DefaultSink (Ptr<PcapFileWrapper> file, Ptr<const Packet> p);
+
+  static Ptr<PcapWriter> m_multiplexWriter; //!< writer of the pcapng file, if multiplexing
 };
 
 template <typename T> void
@@ -20,6 +20,10 @@
 #include "buffer.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
 
 #define LOG_INTERNAL_STATE(y)                                                                    \
   NS_LOG_LOGIC (y << "start="<<m_start<<", end="<<m_end<<", zero start="<<m_zeroAreaStart<<              \
@@ -52,46 +56,201 @@ NS_LOG_COMPONENT_DEFINE ("Buffer");
 
 uint32_t Buffer::g_recommendedStart = 0;
 #ifdef BUFFER_FREE_LIST
-/* The following macros are pretty evil but they are needed to allow us to
- * keep track of 3 possible states for the g_freeList variable:
- *  - uninitialized means that no one has created a buffer yet
- *    so no one has created the associated free list (it is created
- *    on-demand when the first buffer is created)
- *  - initialized means that the free list exists and is valid
- *  - destroyed means that the static destructors of this compilation unit
- *    have run so, the free list has been cleared from its content
- * The key is that in destroyed state, we are careful not re-create it
- * which is a typical weakness of lazy evaluation schemes which use 
- * '0' as a special value to indicate both un-initialized and destroyed.
- * Note that it is important to use '0' as the marker for un-initialized state
- * because the variable holding this state information is initialized to zero
- * which the compiler assigns to zero-memory which is initialized to _zero_
- * before the constructors run so this ensures perfect handling of crazy 
- * constructor orderings.
+
+/**
+ * \ingroup packet
+ * Free lists of released Buffer data, one per size class.
+ *
+ * Each thread owns its own free lists so that no locking is needed:
+ * the data released by a thread is recycled into its own lists,
+ * whichever thread allocated it.  The sizes of the classes are powers
+ * of two, so that small buffers, such as those of acknowledgements,
+ * do not hold on to the storage of full-sized frames.
  */
-#define MAGIC_DESTROYED (~(long) 0)
-#define IS_UNINITIALIZED(x) (x == (Buffer::FreeList*)0)
-#define IS_DESTROYED(x) (x == (Buffer::FreeList*)MAGIC_DESTROYED)
-#define IS_INITIALIZED(x) (!IS_UNINITIALIZED (x) && !IS_DESTROYED (x))
-#define DESTROYED ((Buffer::FreeList*)MAGIC_DESTROYED)
-#define UNINITIALIZED ((Buffer::FreeList*)0)
-uint32_t Buffer::g_maxSize = 0;
-Buffer::FreeList *Buffer::g_freeList = 0;
-struct Buffer::LocalStaticDestructor Buffer::g_localStaticDestructor;
+struct BufferFreeList
+{
+  /** The smallest size class holds 2^MIN_SHIFT bytes. */
+  static const uint32_t MIN_SHIFT = 6;
+  /** Number of size classes. Larger data are not recycled. */
+  static const uint32_t N_CLASSES = 11;
 
-Buffer::LocalStaticDestructor::~LocalStaticDestructor(void)
+  /** A released data, linked through its own storage. */
+  struct Block
+  {
+    Block *next;  //!< Next free data of the same size class.
+  };
+
+  Block *head[N_CLASSES];        //!< Free list of each size class.
+  uint32_t count[N_CLASSES];     //!< Length of each free list.
+  Buffer::FreeListStats stats;   //!< Statistics of the free lists.
+};
+
+/** Maximum number of data kept in each free list. */
+static uint32_t g_maxFreeBuffers = 1000;
+/** Maximum number of bytes kept in the free lists of a thread. */
+static uint32_t g_maxFreeBytes = 4 * 1024 * 1024;
+/** Set once the free lists are destroyed, at the end of the program. */
+static bool g_freeListDestroyed = false;
+
+/**
+ * \ingroup packet
+ * \param size a data size.
+ * \returns the smallest size class which can hold size bytes,
+ *          or BufferFreeList::N_CLASSES if there is none.
+ */
+static uint32_t
+GetSizeClass (uint32_t size)
 {
-  NS_LOG_FUNCTION (this);
-  if (IS_INITIALIZED (g_freeList))
+  uint32_t sizeClass = 0;
+  while (sizeClass < BufferFreeList::N_CLASSES
+         && (1U << (sizeClass + BufferFreeList::MIN_SHIFT)) < size)
+    {
+      sizeClass++;
+    }
+  return sizeClass;
+}
+
+/**
+ * \ingroup packet
+ * Release all the data held by free lists.
+ * \param freeList the free lists.
+ */
+static void
+ClearBufferFreeList (BufferFreeList *freeList)
+{
+  for (uint32_t i = 0; i < BufferFreeList::N_CLASSES; i++)
     {
-      for (Buffer::FreeList::iterator i = g_freeList->begin ();
-           i != g_freeList->end (); i++)
+      while (freeList->head[i] != 0)
         {
-          Buffer::Deallocate (*i);
+          BufferFreeList::Block *block = freeList->head[i];
+          freeList->head[i] = block->next;
+          delete [] reinterpret_cast<uint8_t *> (block);
         }
-      delete g_freeList;
-      g_freeList = DESTROYED;
+      freeList->count[i] = 0;
+    }
+  freeList->stats.buffers = 0;
+  freeList->stats.bytes = 0;
+}
+
+#if !defined (HAVE_PTHREAD_H)
+
+/** The free lists of the only thread there is. */
+static BufferFreeList g_bufferFreeList;
+
+/**
+ * \ingroup packet
+ * \returns the free lists of the calling thread.
+ */
+static BufferFreeList *
+GetBufferFreeList (void)
+{
+  return g_freeListDestroyed ? 0 : &g_bufferFreeList;
+}
+
+/**
+ * \ingroup packet
+ * Release the free lists of the calling thread.
+ */
+static void
+ReleaseBufferFreeList (void)
+{
+  ClearBufferFreeList (&g_bufferFreeList);
+}
+
+#elif defined (HAVE_TLS)
+
+/** The free lists of the calling thread, created on first use. */
+static __thread BufferFreeList *g_bufferFreeList = 0;
+/** Key used to release the free lists of a thread when it exits. */
+static pthread_key_t g_bufferFreeListKey;
+/** Make sure g_bufferFreeListKey is created once. */
+static pthread_once_t g_bufferFreeListOnce = PTHREAD_ONCE_INIT;
+
+/**
+ * \ingroup packet
+ * Release the free lists of an exiting thread.
+ * \param freeList the free lists.
+ */
+static void
+DestroyBufferFreeList (void *freeList)
+{
+  BufferFreeList *f = static_cast<BufferFreeList *> (freeList);
+  ClearBufferFreeList (f);
+  delete f;
+  g_bufferFreeList = 0;
+}
+
+/** \ingroup packet Create g_bufferFreeListKey. */
+static void
+CreateBufferFreeListKey (void)
+{
+  pthread_key_create (&g_bufferFreeListKey, &DestroyBufferFreeList);
+}
+
+/**
+ * \ingroup packet
+ * \returns the free lists of the calling thread.
+ */
+static BufferFreeList *
+GetBufferFreeList (void)
+{
+  if (g_bufferFreeList == 0 && !g_freeListDestroyed)
+    {
+      pthread_once (&g_bufferFreeListOnce, &CreateBufferFreeListKey);
+      g_bufferFreeList = new BufferFreeList ();
+      pthread_setspecific (g_bufferFreeListKey, g_bufferFreeList);
     }
+  return g_bufferFreeList;
+}
+
+/**
+ * \ingroup packet
+ * Release the free lists of the calling thread.
+ */
+static void
+ReleaseBufferFreeList (void)
+{
+  if (g_bufferFreeList != 0)
+    {
+      pthread_setspecific (g_bufferFreeListKey, 0);
+      DestroyBufferFreeList (g_bufferFreeList);
+    }
+}
+
+#else
+
+/**
+ * \ingroup packet
+ * Threads are available but thread-local storage is not: do not
+ * recycle buffer data at all.
+ * \returns 0
+ */
+static BufferFreeList *
+GetBufferFreeList (void)
+{
+  return 0;
+}
+
+/**
+ * \ingroup packet
+ * There are no free lists to release.
+ */
+static void
+ReleaseBufferFreeList (void)
+{
+}
+
+#endif
+
+struct Buffer::LocalStaticDestructor Buffer::g_localStaticDestructor;
+
+Buffer::LocalStaticDestructor::~LocalStaticDestructor(void)
+{
+  NS_LOG_FUNCTION (this);
+  // The buffers destroyed from now on, by the static destructors
+  // of other compilation units, release their data directly.
+  g_freeListDestroyed = true;
+  ReleaseBufferFreeList ();
 }
 
 void
@@ -99,19 +258,26 @@ Buffer::Recycle (struct Buffer::Data *data)
 {
   NS_LOG_FUNCTION (data);
   NS_ASSERT (data->m_count == 0);
-  NS_ASSERT (!IS_UNINITIALIZED (g_freeList));
-  g_maxSize = std::max (g_maxSize, data->m_size);
-  /* feed into free list */
-  if (data->m_size < g_maxSize ||
-      IS_DESTROYED (g_freeList) ||
-      g_freeList->size () > 1000)
+  BufferFreeList *freeList = GetBufferFreeList ();
+  uint32_t size = data->m_size;
+  uint32_t sizeClass = GetSizeClass (size);
+  if (freeList != 0
+      && sizeClass < BufferFreeList::N_CLASSES
+      && size == (1U << (sizeClass + BufferFreeList::MIN_SHIFT))
+      && freeList->count[sizeClass] < g_maxFreeBuffers
+      && freeList->stats.bytes + size <= g_maxFreeBytes)
     {
-      Buffer::Deallocate (data);
+      // The link to the next free data overwrites the header.
+      BufferFreeList::Block *block = reinterpret_cast<BufferFreeList::Block *> (data);
+      block->next = freeList->head[sizeClass];
+      freeList->head[sizeClass] = block;
+      freeList->count[sizeClass]++;
+      freeList->stats.buffers++;
+      freeList->stats.bytes += size;
     }
   else
     {
-      NS_ASSERT (IS_INITIALIZED (g_freeList));
-      g_freeList->push_back (data);
+      Buffer::Deallocate (data);
     }
 }
 
@@ -119,29 +285,81 @@ Buffer::Data *
 Buffer::Create (uint32_t dataSize)
 {
   NS_LOG_FUNCTION (dataSize);
-  /* try to find a buffer correctly sized. */
-  if (IS_UNINITIALIZED (g_freeList))
+  uint32_t sizeClass = GetSizeClass (dataSize);
+  BufferFreeList *freeList = GetBufferFreeList ();
+  if (sizeClass >= BufferFreeList::N_CLASSES)
     {
-      g_freeList = new Buffer::FreeList ();
+      if (freeList != 0)
+        {
+          freeList->stats.misses++;
+        }
+      return Buffer::Allocate (dataSize);
     }
-  else if (IS_INITIALIZED (g_freeList))
+  uint32_t size = 1U << (sizeClass + BufferFreeList::MIN_SHIFT);
+  if (freeList != 0)
     {
-      while (!g_freeList->empty ()) 
+      if (freeList->head[sizeClass] != 0)
         {
-          struct Buffer::Data *data = g_freeList->back ();
-          g_freeList->pop_back ();
-          if (data->m_size >= dataSize) 
-            {
-              data->m_count = 1;
-              return data;
-            }
-          Buffer::Deallocate (data);
+          BufferFreeList::Block *block = freeList->head[sizeClass];
+          freeList->head[sizeClass] = block->next;
+          freeList->count[sizeClass]--;
+          freeList->stats.hits++;
+          freeList->stats.buffers--;
+          freeList->stats.bytes -= size;
+          // The link to the next free data overwrote the header.
+          struct Buffer::Data *data = reinterpret_cast<struct Buffer::Data *> (block);
+          data->m_size = size;
+          data->m_count = 1;
+          return data;
         }
+      freeList->stats.misses++;
     }
-  struct Buffer::Data *data = Buffer::Allocate (dataSize);
+  struct Buffer::Data *data = Buffer::Allocate (size);
   NS_ASSERT (data->m_count == 1);
   return data;
 }
+
+Buffer::FreeListStats
+Buffer::GetFreeListStats (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  BufferFreeList *freeList = GetBufferFreeList ();
+  if (freeList != 0)
+    {
+      return freeList->stats;
+    }
+  FreeListStats stats = { 0, 0, 0, 0 };
+  return stats;
+}
+
+void
+Buffer::SetFreeListLimits (uint32_t maxBuffers, uint32_t maxBytes)
+{
+  NS_LOG_FUNCTION (maxBuffers << maxBytes);
+  g_maxFreeBuffers = maxBuffers;
+  g_maxFreeBytes = maxBytes;
+  BufferFreeList *freeList = GetBufferFreeList ();
+  if (freeList == 0)
+    {
+      return;
+    }
+  // Trim the free lists of the calling thread, largest data first.
+  for (uint32_t i = BufferFreeList::N_CLASSES; i-- > 0; )
+    {
+      uint32_t size = 1U << (i + BufferFreeList::MIN_SHIFT);
+      while (freeList->head[i] != 0
+             && (freeList->count[i] > g_maxFreeBuffers
+                 || freeList->stats.bytes > g_maxFreeBytes))
+        {
+          BufferFreeList::Block *block = freeList->head[i];
+          freeList->head[i] = block->next;
+          freeList->count[i]--;
+          freeList->stats.buffers--;
+          freeList->stats.bytes -= size;
+          delete [] reinterpret_cast<uint8_t *> (block);
+        }
+    }
+}
 #else /* BUFFER_FREE_LIST */
 void
 Buffer::Recycle (struct Buffer::Data *data)
@@ -157,6 +375,20 @@ Buffer::Create (uint32_t size)
   NS_LOG_FUNCTION (size);
   return Allocate (size);
 }
+
+Buffer::FreeListStats
+Buffer::GetFreeListStats (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  FreeListStats stats = { 0, 0, 0, 0 };
+  return stats;
+}
+
+void
+Buffer::SetFreeListLimits (uint32_t maxBuffers, uint32_t maxBytes)
+{
+  NS_LOG_FUNCTION (maxBuffers << maxBytes);
+}
 #endif /* BUFFER_FREE_LIST */
 
 struct Buffer::Data *
@@ -270,7 +502,7 @@ Buffer::operator = (Buffer const&o)
       m_data = o.m_data;
       m_data->m_count++;
     }
-  g_recommendedStart = std::max (g_recommendedStart, m_maxZeroAreaStart);
+  UpdateRecommendedStart ();
   m_maxZeroAreaStart = o.m_maxZeroAreaStart;
   m_zeroAreaStart = o.m_zeroAreaStart;
   m_zeroAreaEnd = o.m_zeroAreaEnd;
@@ -280,11 +512,24 @@ Buffer::operator = (Buffer const&o)
   return *this;
 }
 
+void
+Buffer::UpdateRecommendedStart (void) const
+{
+  // Only the buffers with a virtual payload tell how much room the
+  // headers need: learning from the buffers filled with real data
+  // would size all the new buffers after the largest payloads.
+  if (m_zeroAreaEnd != m_zeroAreaStart
+      && m_maxZeroAreaStart > g_recommendedStart)
+    {
+      g_recommendedStart = m_maxZeroAreaStart;
+    }
+}
+
 Buffer::~Buffer ()
 {
   NS_LOG_FUNCTION (this);
   NS_ASSERT (CheckInternalState ());
-  g_recommendedStart = std::max (g_recommendedStart, m_maxZeroAreaStart);
+  UpdateRecommendedStart ();
   m_data->m_count--;
   if (m_data->m_count == 0) 
     {
@@ -415,19 +660,38 @@ void
 Buffer::AddAtEnd (const Buffer &o)
 {
   NS_LOG_FUNCTION (this << &o);
-  if (m_data->m_count == 1 &&
+  uint32_t zeroSize = m_zeroAreaEnd - m_zeroAreaStart;
+  uint32_t oZeroSize = o.m_zeroAreaEnd - o.m_zeroAreaStart;
+  if (this != &o &&
       m_end == m_zeroAreaEnd &&
-      m_end == m_data->m_dirtyEnd &&
       o.m_start == o.m_zeroAreaStart &&
-      o.m_zeroAreaEnd - o.m_zeroAreaStart > 0)
+      oZeroSize > 0)
     {
       /**
        * This is an optimization which kicks in when
        * we attempt to aggregate two buffers which contain
-       * adjacent zero areas.
+       * adjacent zero areas: the zero area of the other
+       * buffer is merged into ours, so that the payload
+       * stays virtual.
        */
-      uint32_t zeroSize = o.m_zeroAreaEnd - o.m_zeroAreaStart;
-      m_zeroAreaEnd += zeroSize;
+      if (m_data->m_count > 1)
+        {
+          /* The dirty area of shared data does not account for
+           * a larger zero area: move our bytes, which precede
+           * the zero area, to private data first.
+           */
+          uint32_t internalSize = GetInternalSize ();
+          struct Buffer::Data *newData = Buffer::Create (internalSize);
+          memcpy (newData->m_data, m_data->m_data + m_start, internalSize);
+          m_data->m_count--;
+          m_data = newData;
+          m_zeroAreaStart -= m_start;
+          m_zeroAreaEnd -= m_start;
+          m_end -= m_start;
+          m_start = 0;
+          m_data->m_dirtyStart = m_start;
+        }
+      m_zeroAreaEnd += oZeroSize;
       m_end = m_zeroAreaEnd;
       m_data->m_dirtyEnd = m_zeroAreaEnd;
       uint32_t endData = o.m_end - o.m_zeroAreaEnd;
@@ -441,14 +705,38 @@ Buffer::AddAtEnd (const Buffer &o)
       return;
     }
 
-  Buffer dst = CreateFullCopy ();
-  Buffer src = o.CreateFullCopy ();
-
-  dst.AddAtEnd (src.GetSize ());
-  Buffer::Iterator destStart = dst.End ();
-  destStart.Prev (src.GetSize ());
-  destStart.Write (src.Begin (), src.End ());
-  *this = dst;
+  if (m_data == o.m_data)
+    {
+      /* The two buffers share their data, possibly because they are
+       * the same buffer: append a private copy of the other buffer.
+       */
+      Buffer dst = CreateFullCopy ();
+      Buffer src = o.CreateFullCopy ();
+
+      dst.AddAtEnd (src.GetSize ());
+      Buffer::Iterator destStart = dst.End ();
+      destStart.Prev (src.GetSize ());
+      destStart.Write (src.Begin (), src.End ());
+      *this = dst;
+    }
+  /* Only one zero area can stay virtual: keep the largest one and
+   * write the bytes of the other buffer next to it.
+   */
+  else if (zeroSize >= oZeroSize)
+    {
+      uint32_t size = o.GetSize ();
+      AddAtEnd (size);
+      Buffer::Iterator destStart = End ();
+      destStart.Prev (size);
+      destStart.Write (o.Begin (), o.End ());
+    }
+  else
+    {
+      Buffer dst = o;
+      dst.AddAtStart (GetSize ());
+      dst.Begin ().Write (Begin (), End ());
+      *this = dst;
+    }
   NS_ASSERT (CheckInternalState ());
 }
 
@@ -872,25 +1160,36 @@ Buffer::Iterator::Write (Iterator start, Iterator end)
   uint32_t size = end.m_current - start.m_current;
   NS_ASSERT_MSG (CheckNoZero (m_current, m_current + size),
                  GetWriteErrorMessage ());
+  // the destination may follow the zero area of this buffer
+  uint8_t *to;
+  if (m_current <= m_zeroStart)
+    {
+      to = &m_data[m_current];
+    }
+  else
+    {
+      to = &m_data[m_current - (m_zeroEnd - m_zeroStart)];
+    }
   if (start.m_current <= start.m_zeroStart)
     {
       uint32_t toCopy = std::min (size, start.m_zeroStart - start.m_current);
-      memcpy (&m_data[m_current], &start.m_data[start.m_current], toCopy);
+      memcpy (to, &start.m_data[start.m_current], toCopy);
       start.m_current += toCopy;
       m_current += toCopy;
+      to += toCopy;
       size -= toCopy;
     }
   if (start.m_current <= start.m_zeroEnd)
     {
       uint32_t toCopy = std::min (size, start.m_zeroEnd - start.m_current);
-      memset (&m_data[m_current], 0, toCopy);
+      memset (to, 0, toCopy);
       start.m_current += toCopy;
       m_current += toCopy;
+      to += toCopy;
       size -= toCopy;
     }
   uint32_t toCopy = std::min (size, start.m_dataEnd - start.m_current);
   uint8_t *from = &start.m_data[start.m_current - (start.m_zeroEnd-start.m_zeroStart)];
-  uint8_t *to = &m_data[m_current];
   memcpy (to, from, toCopy);
   m_current += toCopy;
 }
@@ -899,150 +1198,65 @@ void
 Buffer::Iterator::WriteU16 (uint16_t data)
 {
   NS_LOG_FUNCTION (this << data);
-  WriteU8 (data & 0xff);
-  data >>= 8;
-  WriteU8 (data & 0xff);
+  WriteLsb (WriteSpan (2), data, 2);
 }
 void 
 Buffer::Iterator::WriteU32 (uint32_t data)
 {
   NS_LOG_FUNCTION (this << data);
-  WriteU8 (data & 0xff);
-  data >>= 8;
-  WriteU8 (data & 0xff);
-  data >>= 8;
-  WriteU8 (data & 0xff);
-  data >>= 8;
-  WriteU8 (data & 0xff);
+  WriteLsb (WriteSpan (4), data, 4);
 }
 void 
 Buffer::Iterator::WriteU64 (uint64_t data)
 {
   NS_LOG_FUNCTION (this << data);
-  WriteU8 (data & 0xff);
-  data >>= 8;
-  WriteU8 (data & 0xff);
-  data >>= 8;
-  WriteU8 (data & 0xff);
-  data >>= 8;
-  WriteU8 (data & 0xff);
-  data >>= 8;
-  WriteU8 (data & 0xff);
-  data >>= 8;
-  WriteU8 (data & 0xff);
-  data >>= 8;
-  WriteU8 (data & 0xff);
-  data >>= 8;
-  WriteU8 (data & 0xff);
+  WriteLsb (WriteSpan (8), data, 8);
 }
 void 
 Buffer::Iterator::WriteHtolsbU16 (uint16_t data)
 {
   NS_LOG_FUNCTION (this << data);
-  WriteU8 ((data >> 0) & 0xff);
-  WriteU8 ((data >> 8) & 0xff);
+  WriteLsb (WriteSpan (2), data, 2);
 }
 void 
 Buffer::Iterator::WriteHtolsbU32 (uint32_t data)
 {
   NS_LOG_FUNCTION (this << data);
-  WriteU8 ((data >> 0) & 0xff);
-  WriteU8 ((data >> 8) & 0xff);
-  WriteU8 ((data >> 16) & 0xff);
-  WriteU8 ((data >> 24) & 0xff);
+  WriteLsb (WriteSpan (4), data, 4);
 }
 void 
 Buffer::Iterator::WriteHtolsbU64 (uint64_t data)
 {
   NS_LOG_FUNCTION (this << data);
-  WriteU8 ((data >> 0) & 0xff);
-  WriteU8 ((data >> 8) & 0xff);
-  WriteU8 ((data >> 16) & 0xff);
-  WriteU8 ((data >> 24) & 0xff);
-  WriteU8 ((data >> 32) & 0xff);
-  WriteU8 ((data >> 40) & 0xff);
-  WriteU8 ((data >> 48) & 0xff);
-  WriteU8 ((data >> 56) & 0xff);
+  WriteLsb (WriteSpan (8), data, 8);
 }
 
 void 
 Buffer::Iterator::WriteHtonU64 (uint64_t data)
 {
   NS_LOG_FUNCTION (this << data);
-  WriteU8 ((data >> 56) & 0xff);
-  WriteU8 ((data >> 48) & 0xff);
-  WriteU8 ((data >> 40) & 0xff);
-  WriteU8 ((data >> 32) & 0xff);
-  WriteU8 ((data >> 24) & 0xff);
-  WriteU8 ((data >> 16) & 0xff);
-  WriteU8 ((data >> 8) & 0xff);
-  WriteU8 ((data >> 0) & 0xff);
+  WriteMsb (WriteSpan (8), data, 8);
 }
 void 
 Buffer::Iterator::Write (uint8_t const*buffer, uint32_t size)
 {
   NS_LOG_FUNCTION (this << &buffer << size);
-  NS_ASSERT_MSG (CheckNoZero (m_current, size),
-                 GetWriteErrorMessage ());
-  uint8_t *to;
-  if (m_current <= m_zeroStart)
-    {
-      to = &m_data[m_current];
-    }
-  else
-    {
-      to = &m_data[m_current - (m_zeroEnd - m_zeroStart)];
-    }
-  memcpy (to, buffer, size);
-  m_current += size;
+  memcpy (WriteSpan (size), buffer, size);
 }
 
 uint32_t 
 Buffer::Iterator::ReadU32 (void)
 {
   NS_LOG_FUNCTION (this);
-  uint8_t byte0 = ReadU8 ();
-  uint8_t byte1 = ReadU8 ();
-  uint8_t byte2 = ReadU8 ();
-  uint8_t byte3 = ReadU8 ();
-  uint32_t data = byte3;
-  data <<= 8;
-  data |= byte2;
-  data <<= 8;
-  data |= byte1;
-  data <<= 8;
-  data |= byte0;
-  return data;
+  uint8_t scratch[4];
+  return ReadLsb (ReadSpan (scratch, 4), 4);
 }
 uint64_t 
 Buffer::Iterator::ReadU64 (void)
 {
   NS_LOG_FUNCTION (this);
-  uint8_t byte0 = ReadU8 ();
-  uint8_t byte1 = ReadU8 ();
-  uint8_t byte2 = ReadU8 ();
-  uint8_t byte3 = ReadU8 ();
-  uint8_t byte4 = ReadU8 ();
-  uint8_t byte5 = ReadU8 ();
-  uint8_t byte6 = ReadU8 ();
-  uint8_t byte7 = ReadU8 ();
-  uint64_t data = byte7;
-  data <<= 8;
-  data |= byte6;
-  data <<= 8;
-  data |= byte5;
-  data <<= 8;
-  data |= byte4;
-  data <<= 8;
-  data |= byte3;
-  data <<= 8;
-  data |= byte2;
-  data <<= 8;
-  data |= byte1;
-  data <<= 8;
-  data |= byte0;
-
-  return data;
+  uint8_t scratch[8];
+  return ReadLsb (ReadSpan (scratch, 8), 8);
 }
 uint16_t 
 Buffer::Iterator::SlowReadNtohU16 (void)
@@ -1072,89 +1286,54 @@ uint64_t
 Buffer::Iterator::ReadNtohU64 (void)
 {
   NS_LOG_FUNCTION (this);
-  uint64_t retval = 0;
-  retval |= ReadU8 ();
-  retval <<= 8;
-  retval |= ReadU8 ();
-  retval <<= 8;
-  retval |= ReadU8 ();
-  retval <<= 8;
-  retval |= ReadU8 ();
-  retval <<= 8;
-  retval |= ReadU8 ();
-  retval <<= 8;
-  retval |= ReadU8 ();
-  retval <<= 8;
-  retval |= ReadU8 ();
-  retval <<= 8;
-  retval |= ReadU8 ();
-  return retval;
+  uint8_t scratch[8];
+  return ReadMsb (ReadSpan (scratch, 8), 8);
 }
 uint16_t 
 Buffer::Iterator::ReadLsbtohU16 (void)
 {
   NS_LOG_FUNCTION (this);
-  uint8_t byte0 = ReadU8 ();
-  uint8_t byte1 = ReadU8 ();
-  uint16_t data = byte1;
-  data <<= 8;
-  data |= byte0;
-  return data;
+  uint8_t scratch[2];
+  return ReadLsb (ReadSpan (scratch, 2), 2);
 }
 uint32_t 
 Buffer::Iterator::ReadLsbtohU32 (void)
 {
   NS_LOG_FUNCTION (this);
-  uint8_t byte0 = ReadU8 ();
-  uint8_t byte1 = ReadU8 ();
-  uint8_t byte2 = ReadU8 ();
-  uint8_t byte3 = ReadU8 ();
-  uint32_t data = byte3;
-  data <<= 8;
-  data |= byte2;
-  data <<= 8;
-  data |= byte1;
-  data <<= 8;
-  data |= byte0;
-  return data;
+  uint8_t scratch[4];
+  return ReadLsb (ReadSpan (scratch, 4), 4);
 }
 uint64_t 
 Buffer::Iterator::ReadLsbtohU64 (void)
 {
   NS_LOG_FUNCTION (this);
-  uint8_t byte0 = ReadU8 ();
-  uint8_t byte1 = ReadU8 ();
-  uint8_t byte2 = ReadU8 ();
-  uint8_t byte3 = ReadU8 ();
-  uint8_t byte4 = ReadU8 ();
-  uint8_t byte5 = ReadU8 ();
-  uint8_t byte6 = ReadU8 ();
-  uint8_t byte7 = ReadU8 ();
-  uint64_t data = byte7;
-  data <<= 8;
-  data |= byte6;
-  data <<= 8;
-  data |= byte5;
-  data <<= 8;
-  data |= byte4;
-  data <<= 8;
-  data |= byte3;
-  data <<= 8;
-  data |= byte2;
-  data <<= 8;
-  data |= byte1;
-  data <<= 8;
-  data |= byte0;
-
-  return data;
+  uint8_t scratch[8];
+  return ReadLsb (ReadSpan (scratch, 8), 8);
 }
 void 
 Buffer::Iterator::Read (uint8_t *buffer, uint32_t size)
 {
   NS_LOG_FUNCTION (this << &buffer << size);
-  for (uint32_t i = 0; i < size; i++)
+  NS_ASSERT_MSG (m_current >= m_dataStart &&
+                 m_current + size <= m_dataEnd,
+                 GetReadErrorMessage ());
+  if (m_current + size <= m_zeroStart)
+    {
+      memcpy (buffer, &m_data[m_current], size);
+      m_current += size;
+    }
+  else if (m_current >= m_zeroEnd)
     {
-      buffer[i] = ReadU8 ();
+      memcpy (buffer, &m_data[m_current - (m_zeroEnd - m_zeroStart)], size);
+      m_current += size;
+    }
+  else
+    {
+      // The data overlaps the virtual zero area.
+      for (uint32_t i = 0; i < size; i++)
+        {
+          buffer[i] = ReadU8 ();
+        }
     }
 }
 
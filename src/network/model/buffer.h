@@ -38,9 +38,13 @@ namespace ns3 {
  * automatically adjusted to hold any data prepended
  * or appended by the user. Its implementation is optimized
  * to ensure that the number of buffer resizes is minimized,
- * by creating new Buffers of the maximum size ever used.
- * The correct maximum size is learned at runtime during use by 
- * recording the maximum size of each packet.
+ * by reserving in new Buffers the room used by the headers of
+ * the previous ones. The room needed is learned at runtime during
+ * use by recording the headers added in front of each payload.
+ *
+ * The storage released by Buffers is recycled through free lists,
+ * one per thread and per power-of-two size class: see
+ * Buffer::GetFreeListStats and Buffer::SetFreeListLimits.
  *
  * \internal
  * The implementation of the Buffer class uses a COW (Copy On Write)
@@ -65,10 +69,14 @@ namespace ns3 {
  * contains real data bytes in its BufferData instance but it also
  * contains "virtual zero data" which typically is used to represent
  * application-level payload. No memory is allocated to store the
- * zero bytes of application-level payload unless the user fragments
- * a Buffer: this application-level payload is kept track of with
- * a pair of integers which describe where in the buffer content
- * the "virtual zero area" starts and ends.
+ * zero bytes of application-level payload: this application-level
+ * payload is kept track of with a pair of integers which describe
+ * where in the buffer content the "virtual zero area" starts and ends.
+ * Fragments keep their share of the zero area, and appending a Buffer
+ * to another merges their zero areas when they are adjacent. Only
+ * PeekData, and the appending of Buffers whose zero areas are
+ * separated by real bytes, write zero bytes into memory: in the
+ * latter case, the largest zero area stays virtual.
  *
  * \verbatim
  * ***: unused bytes
@@ -237,6 +245,17 @@ public:
      * by size bytes.
      */
     void Write (uint8_t const*buffer, uint32_t size);
+    /**
+     * \param size number of bytes to write.
+     * \returns a pointer to the size bytes following the iterator
+     *          position, which are contiguous in memory.
+     *
+     * Check once that the next size bytes can be written, and advance
+     * the iterator position by size bytes.  Headers of a fixed size can
+     * then be written through the pointer returned, rather than through
+     * the checked Write methods.
+     */
+    inline uint8_t *WriteSpan (uint32_t size);
     /**
      * \param start the start of the data to copy
      * \param end the end of the data to copy
@@ -355,6 +374,18 @@ public:
      * read.
      */
     inline void Read (Iterator start, uint32_t size);
+    /**
+     * \param scratch an array of at least size bytes
+     * \param size number of bytes to read
+     * \returns a pointer to the size bytes following the iterator position
+     *
+     * Check once that the next size bytes can be read, and advance the
+     * iterator position by size bytes.  The pointer returned points to
+     * the internal buffer when the bytes are contiguous in memory; when
+     * they overlap the virtual zero area, they are copied in scratch
+     * and the pointer returned is scratch.
+     */
+    inline uint8_t const *ReadSpan (uint8_t *scratch, uint32_t size);
 
     /**
      * \brief Calculate the checksum.
@@ -520,7 +551,9 @@ private:
   /**
    * \param o the buffer to append to the end of this buffer.
    *
-   * Add bytes at the end of the Buffer.
+   * Add bytes at the end of the Buffer. The virtual zero areas
+   * of the two buffers are merged if they are adjacent; otherwise
+   * the largest one is kept virtual.
    * Any call to this method invalidates any Iterator
    * pointing to this Buffer.
    */
@@ -609,6 +642,74 @@ private:
    */
   int32_t GetCurrentEndOffset (void) const;
 
+  /**
+   * \brief Statistics of the free lists of buffer data of a thread.
+   */
+  struct FreeListStats
+  {
+    uint64_t hits;      //!< Number of data reused from the free lists.
+    uint64_t misses;    //!< Number of data allocated from the heap.
+    uint32_t buffers;   //!< Number of data held by the free lists.
+    uint32_t bytes;     //!< Number of bytes held by the free lists.
+  };
+
+  /**
+   * \brief Get the statistics of the free lists of the calling thread.
+   *
+   * The data released by the buffers is kept in free lists, one per
+   * thread and per power-of-two size class, and reused by the next
+   * buffers created by the same thread.
+   *
+   * \returns the statistics of the free lists of the calling thread.
+   */
+  static FreeListStats GetFreeListStats (void);
+  /**
+   * \brief Set the limits of the free lists of each thread.
+   *
+   * The data released beyond these limits is returned to the heap.
+   * The free lists of the calling thread are trimmed to the new
+   * limits right away, those of the other threads are not.
+   *
+   * \param maxBuffers the maximum number of data kept in each size class.
+   * \param maxBytes the maximum number of bytes kept by the free lists.
+   */
+  static void SetFreeListLimits (uint32_t maxBuffers, uint32_t maxBytes);
+
+  /**
+   * \brief Write an integer in network (big-endian) byte order.
+   *
+   * Headers of a fixed size write their fields with this method and
+   * WriteLsb in the bytes returned by Iterator::WriteSpan, in the byte
+   * order of WriteHtonU16 and WriteU16 respectively.
+   *
+   * \param buffer the bytes to write
+   * \param data the integer
+   * \param size the number of bytes to write, at most 8
+   */
+  static inline void WriteMsb (uint8_t *buffer, uint64_t data, uint32_t size);
+  /**
+   * \brief Write an integer in little-endian byte order.
+   * \param buffer the bytes to write
+   * \param data the integer
+   * \param size the number of bytes to write, at most 8
+   */
+  static inline void WriteLsb (uint8_t *buffer, uint64_t data, uint32_t size);
+  /**
+   * \brief Read an integer in network (big-endian) byte order.
+   * \param buffer the bytes to read, for instance returned by
+   *        Iterator::ReadSpan
+   * \param size the number of bytes to read, at most 8
+   * \returns the integer
+   */
+  static inline uint64_t ReadMsb (uint8_t const *buffer, uint32_t size);
+  /**
+   * \brief Read an integer in little-endian byte order.
+   * \param buffer the bytes to read
+   * \param size the number of bytes to read, at most 8
+   * \returns the integer
+   */
+  static inline uint64_t ReadLsb (uint8_t const *buffer, uint32_t size);
+
   /** 
    * Copy the specified amount of data from the buffer to the given output stream.
    * 
@@ -733,6 +834,12 @@ private:
    */
   uint32_t GetInternalEnd (void) const;
 
+  /**
+   * \brief Update g_recommendedStart with the room used by the
+   * headers of this buffer.
+   */
+  void UpdateRecommendedStart (void) const;
+
   /**
    * \brief Recycle the buffer memory
    * \param data the buffer data storage
@@ -798,15 +905,11 @@ private:
   uint32_t m_end;
 
 #ifdef BUFFER_FREE_LIST
-  /// Container for buffer data
-  typedef std::vector<struct Buffer::Data*> FreeList;
   /// Local static destructor structure
   struct LocalStaticDestructor 
   {
     ~LocalStaticDestructor ();
   };
-  static uint32_t g_maxSize; //!< Max observed data size
-  static FreeList *g_freeList; //!< Buffer data container
   static struct LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
 #endif
 };
@@ -1053,6 +1156,94 @@ Buffer::Iterator::Read (Buffer::Iterator start, uint32_t size)
   start.Write (*this, end);
 }
 
+void
+Buffer::WriteMsb (uint8_t *buffer, uint64_t data, uint32_t size)
+{
+  NS_ASSERT (size <= 8);
+  for (uint32_t i = 0; i < size; i++)
+    {
+      buffer[size - 1 - i] = (data >> (8 * i)) & 0xff;
+    }
+}
+
+void
+Buffer::WriteLsb (uint8_t *buffer, uint64_t data, uint32_t size)
+{
+  NS_ASSERT (size <= 8);
+  for (uint32_t i = 0; i < size; i++)
+    {
+      buffer[i] = (data >> (8 * i)) & 0xff;
+    }
+}
+
+uint64_t
+Buffer::ReadMsb (uint8_t const *buffer, uint32_t size)
+{
+  NS_ASSERT (size <= 8);
+  uint64_t data = 0;
+  for (uint32_t i = 0; i < size; i++)
+    {
+      data <<= 8;
+      data |= buffer[i];
+    }
+  return data;
+}
+
+uint64_t
+Buffer::ReadLsb (uint8_t const *buffer, uint32_t size)
+{
+  NS_ASSERT (size <= 8);
+  uint64_t data = 0;
+  for (uint32_t i = size; i > 0; i--)
+    {
+      data <<= 8;
+      data |= buffer[i - 1];
+    }
+  return data;
+}
+
+uint8_t *
+Buffer::Iterator::WriteSpan (uint32_t size)
+{
+  NS_ASSERT_MSG (CheckNoZero (m_current, m_current + size),
+                 GetWriteErrorMessage ());
+  uint8_t *buffer;
+  if (m_current + size <= m_zeroStart)
+    {
+      buffer = &m_data[m_current];
+    }
+  else
+    {
+      buffer = &m_data[m_current - (m_zeroEnd - m_zeroStart)];
+    }
+  m_current += size;
+  return buffer;
+}
+
+uint8_t const *
+Buffer::Iterator::ReadSpan (uint8_t *scratch, uint32_t size)
+{
+  NS_ASSERT_MSG (m_current >= m_dataStart &&
+                 m_current + size <= m_dataEnd,
+                 GetReadErrorMessage ());
+  uint8_t const *buffer;
+  if (m_current + size <= m_zeroStart)
+    {
+      buffer = &m_data[m_current];
+    }
+  else if (m_current >= m_zeroEnd)
+    {
+      buffer = &m_data[m_current - (m_zeroEnd - m_zeroStart)];
+    }
+  else
+    {
+      Read (scratch, size);
+      return scratch;
+    }
+  m_current += size;
+  return buffer;
+}
+
 
 Buffer::Buffer (Buffer const&o)
   : m_data (o.m_data),
@@ -21,6 +21,8 @@
 #include "ns3/object.h"
 #include "ns3/log.h"
 #include "ns3/uinteger.h"
+#include "ns3/packet.h"
+#include "ns3/packet-burst.h"
 #include "net-device.h"
 
 namespace ns3 {
@@ -43,4 +45,22 @@ NetDevice::~NetDevice ()
   NS_LOG_FUNCTION (this);
 }
 
+bool
+NetDevice::SendBurst (Ptr<PacketBurst> burst, const Address& dest, uint16_t protocolNumber)
+{
+  NS_LOG_FUNCTION (this << burst << dest << protocolNumber);
+  bool ok = true;
+  for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin (); i != burst->End (); ++i)
+    {
+      ok = Send (*i, dest, protocolNumber) && ok;
+    }
+  return ok;
+}
+
+void
+NetDevice::SetReceiveBurstCallback (ReceiveBurstCallback cb)
+{
+  NS_LOG_FUNCTION (this << &cb);
+}
+
 } // namespace ns3
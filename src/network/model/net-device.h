@@ -35,6 +35,7 @@ namespace ns3 {
 class Node;
 class Channel;
 class Packet;
+class PacketBurst;
 
 /**
  * \ingroup network
@@ -236,6 +237,21 @@ public:
    * \return whether the Send operation succeeded 
    */
   virtual bool SendFrom (Ptr<Packet> packet, const Address& source, const Address& dest, uint16_t protocolNumber) = 0;
+  /**
+   * \param burst packets sent from above down to Network Device
+   * \param dest mac address of the destination (already resolved)
+   * \param protocolNumber identifies the type of payload contained in
+   *        these packets. Used to call the right L3Protocol when the packets
+   *        are received.
+   *
+   *  Called from higher layer to send several packets into Network Device
+   *  to the same destination Address.  Devices which queue their packets
+   *  can override this method to enqueue the whole burst before starting
+   *  a transmission.  The default implementation calls Send for each packet.
+   *
+   * \return whether the Send operation succeeded for all the packets
+   */
+  virtual bool SendBurst (Ptr<PacketBurst> burst, const Address& dest, uint16_t protocolNumber);
   /**
    * \returns the node base class which contains this network
    *          interface.
@@ -302,6 +318,26 @@ public:
    */
   virtual void SetReceiveCallback (ReceiveCallback cb) = 0;
 
+  /**
+   * \param device a pointer to the net device which is calling this callback
+   * \param burst the packets received
+   * \param protocol the 16 bit protocol number associated with these packets.
+   * \param sender the address of the sender
+   * \returns true if the callback could handle the packets successfully, false
+   *          otherwise.
+   */
+  typedef Callback< bool, Ptr<NetDevice>, Ptr<const PacketBurst>, uint16_t, const Address & > ReceiveBurstCallback;
+
+  /**
+   * \param cb callback to invoke whenever several packets have been received
+   *        together and must be forwarded to the higher layers.
+   *
+   * Devices which receive packets in bursts call this callback rather than
+   * the ReceiveCallback once for each packet.  The default implementation
+   * ignores the callback: the device keeps delivering its packets one by one.
+   */
+  virtual void SetReceiveBurstCallback (ReceiveBurstCallback cb);
+
 
   /**
    * \param device a pointer to the net device which is calling this callback
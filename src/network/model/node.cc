@@ -23,6 +23,7 @@
 #include "net-device.h"
 #include "application.h"
 #include "ns3/packet.h"
+#include "ns3/packet-burst.h"
 #include "ns3/simulator.h"
 #include "ns3/object-vector.h"
 #include "ns3/uinteger.h"
@@ -126,6 +127,7 @@ Node::AddDevice (Ptr<NetDevice> device)
   device->SetNode (this);
   device->SetIfIndex (index);
   device->SetReceiveCallback (MakeCallback (&Node::NonPromiscReceiveFromDevice, this));
+  device->SetReceiveBurstCallback (MakeCallback (&Node::NonPromiscReceiveBurstFromDevice, this));
   Simulator::ScheduleWithContext (GetId (), Seconds (0.0), 
                                   &NetDevice::Initialize, device);
   NotifyDeviceAdded (device);
@@ -223,8 +225,22 @@ Node::RegisterProtocolHandler (ProtocolHandler handler,
                                bool promiscuous)
 {
   NS_LOG_FUNCTION (this << &handler << protocolType << device << promiscuous);
+  RegisterProtocolHandler (handler, MakeNullCallback<void,Ptr<NetDevice>, Ptr<const PacketBurst>,uint16_t,
+                                                     const Address &, const Address &, NetDevice::PacketType> (),
+                           protocolType, device, promiscuous);
+}
+
+void
+Node::RegisterProtocolHandler (ProtocolHandler handler,
+                               BurstProtocolHandler burstHandler,
+                               uint16_t protocolType,
+                               Ptr<NetDevice> device,
+                               bool promiscuous)
+{
+  NS_LOG_FUNCTION (this << &handler << &burstHandler << protocolType << device << promiscuous);
   struct Node::ProtocolHandlerEntry entry;
   entry.handler = handler;
+  entry.burstHandler = burstHandler;
   entry.protocol = protocolType;
   entry.device = device;
   entry.promiscuous = promiscuous;
@@ -290,6 +306,44 @@ Node::NonPromiscReceiveFromDevice (Ptr<NetDevice> device, Ptr<const Packet> pack
   return ReceiveFromDevice (device, packet, protocol, from, device->GetAddress (), NetDevice::PacketType (0), false);
 }
 
+bool
+Node::NonPromiscReceiveBurstFromDevice (Ptr<NetDevice> device, Ptr<const PacketBurst> burst, uint16_t protocol,
+                                        const Address &from)
+{
+  NS_LOG_FUNCTION (this << device << burst << protocol << &from);
+  NS_ASSERT_MSG (Simulator::GetContext () == GetId (), "Received packets with erroneous context ; " <<
+                 "make sure the channels in use are correctly updating events context " <<
+                 "when transfering events from one node to another.");
+  NS_LOG_DEBUG ("Node " << GetId () << " ReceiveBurstFromDevice:  dev "
+                        << device->GetIfIndex () << " (type=" << device->GetInstanceTypeId ().GetName ()
+                        << ") " << burst->GetNPackets () << " packets");
+  Address to = device->GetAddress ();
+  bool found = false;
+
+  for (ProtocolHandlerList::iterator i = m_handlers.begin ();
+       i != m_handlers.end (); i++)
+    {
+      if ((i->device == 0 || i->device == device)
+          && (i->protocol == 0 || i->protocol == protocol)
+          && !i->promiscuous)
+        {
+          if (!i->burstHandler.IsNull ())
+            {
+              i->burstHandler (device, burst, protocol, from, to, NetDevice::PacketType (0));
+            }
+          else
+            {
+              for (std::list<Ptr<Packet> >::const_iterator j = burst->Begin (); j != burst->End (); ++j)
+                {
+                  i->handler (device, *j, protocol, from, to, NetDevice::PacketType (0));
+                }
+            }
+          found = true;
+        }
+    }
+  return found;
+}
+
 bool
 Node::ReceiveFromDevice (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
                          const Address &from, const Address &to, NetDevice::PacketType packetType, bool promiscuous)
@@ -163,6 +163,36 @@ public:
                                 uint16_t protocolType,
                                 Ptr<NetDevice> device,
                                 bool promiscuous=false);
+  /**
+   * A protocol handler which receives several packets at once
+   *
+   * \param device a pointer to the net device which received the packets
+   * \param burst the packets received
+   * \param protocol the 16 bit protocol number associated with these packets.
+   * \param sender the address of the sender
+   * \param receiver the address of the receiver
+   * \param packetType type of the packets received
+   */
+  typedef Callback<void,Ptr<NetDevice>, Ptr<const PacketBurst>,uint16_t,const Address &,
+                   const Address &, NetDevice::PacketType> BurstProtocolHandler;
+  /**
+   * \param handler the handler to register, called for the packets
+   *        received one by one
+   * \param burstHandler the handler called for the packets which a
+   *        device receives in bursts
+   * \param protocolType the type of protocol this handler is
+   *        interested in, zero to match all protocols.
+   * \param device the device attached to this handler. If the
+   *        value is zero, the handler is attached to all
+   *        devices on this node.
+   * \param promiscuous whether to register a promiscuous mode handler.
+   *        Promiscuous mode handlers always receive the packets one by one.
+   */
+  void RegisterProtocolHandler (ProtocolHandler handler,
+                                BurstProtocolHandler burstHandler,
+                                uint16_t protocolType,
+                                Ptr<NetDevice> device,
+                                bool promiscuous=false);
   /**
    * \param handler the handler to unregister
    *
@@ -224,6 +254,20 @@ private:
    * \returns true if the packet has been delivered to a protocol handler.
    */
   bool NonPromiscReceiveFromDevice (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from);
+  /**
+   * \brief Receive several packets from a device in non-promiscuous mode.
+   *
+   * The packets are passed as a whole to the protocol handlers registered
+   * with a BurstProtocolHandler, and one by one to the other handlers.
+   *
+   * \param device the device
+   * \param burst the packets
+   * \param protocol the protocol
+   * \param from the sender
+   * \returns true if the packets have been delivered to a protocol handler.
+   */
+  bool NonPromiscReceiveBurstFromDevice (Ptr<NetDevice> device, Ptr<const PacketBurst> burst, uint16_t protocol,
+                                         const Address &from);
   /**
    * \brief Receive a packet from a device in promiscuous mode.
    * \param device the device
@@ -261,6 +305,7 @@ private:
    */
   struct ProtocolHandlerEntry {
     ProtocolHandler handler; //!< the protocol handler
+    BurstProtocolHandler burstHandler; //!< the protocol handler for bursts, if any
     Ptr<NetDevice> device;   //!< the NetDevice
     uint16_t protocol;       //!< the protocol number
     bool promiscuous;        //!< true if it is a promiscuous handler
@@ -33,6 +33,7 @@ NS_LOG_COMPONENT_DEFINE ("PacketMetadata");
 
 bool PacketMetadata::m_enable = false;
 bool PacketMetadata::m_enableChecking = false;
+uint64_t PacketMetadata::m_sampleThreshold = static_cast<uint64_t> (1) << 32;
 bool PacketMetadata::m_metadataSkipped = false;
 uint32_t PacketMetadata::m_maxSize = 0;
 uint16_t PacketMetadata::m_chunkUid = 0;
@@ -60,6 +61,7 @@ PacketMetadata::Enable (void)
                  "to call ns3::PacketMetadata::Enable () near the beginning of"
                  " the program, before any packets are sent.");
   m_enable = true;
+  m_sampleThreshold = static_cast<uint64_t> (1) << 32;
 }
 
 void 
@@ -70,6 +72,30 @@ PacketMetadata::EnableChecking (void)
   m_enableChecking = true;
 }
 
+void
+PacketMetadata::EnableSampling (double fraction)
+{
+  NS_LOG_FUNCTION (fraction);
+  NS_ASSERT_MSG (fraction >= 0 && fraction <= 1,
+                 "The fraction of sampled packets must be between 0 and 1");
+  Enable ();
+  m_sampleThreshold = static_cast<uint64_t> (fraction * 4294967296.0);
+}
+
+bool
+PacketMetadata::IsRecorded (void) const
+{
+  if (m_data != 0)
+    {
+      return true;
+    }
+  if (!m_enable)
+    {
+      m_metadataSkipped = true;
+    }
+  return false;
+}
+
 void
 PacketMetadata::ReserveCopy (uint32_t size)
 {
@@ -133,6 +159,10 @@ bool
 PacketMetadata::IsStateOk (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_data == 0)
+    {
+      return m_head == 0xffff && m_tail == 0xffff && m_used == 0;
+    }
   bool ok = m_used <= m_data->m_size;
   ok &= IsPointerOk (m_head);
   ok &= IsPointerOk (m_tail);
@@ -664,9 +694,8 @@ void
 PacketMetadata::DoAddHeader (uint32_t uid, uint32_t size)
 {
   NS_LOG_FUNCTION (this << uid << size);
-  if (!m_enable)
+  if (!IsRecorded ())
     {
-      m_metadataSkipped = true;
       return;
     }
 
@@ -686,9 +715,8 @@ PacketMetadata::RemoveHeader (const Header &header, uint32_t size)
   uint32_t uid = header.GetInstanceTypeId ().GetUid () << 1;
   NS_LOG_FUNCTION (this << &header << size);
   NS_ASSERT (IsStateOk ());
-  if (!m_enable) 
+  if (!IsRecorded ())
     {
-      m_metadataSkipped = true;
       return;
     }
   struct PacketMetadata::SmallItem item;
@@ -734,9 +762,8 @@ PacketMetadata::AddTrailer (const Trailer &trailer, uint32_t size)
   uint32_t uid = trailer.GetInstanceTypeId ().GetUid () << 1;
   NS_LOG_FUNCTION (this << &trailer << size);
   NS_ASSERT (IsStateOk ());
-  if (!m_enable)
+  if (!IsRecorded ())
     {
-      m_metadataSkipped = true;
       return;
     }
   struct PacketMetadata::SmallItem item;
@@ -756,9 +783,8 @@ PacketMetadata::RemoveTrailer (const Trailer &trailer, uint32_t size)
   uint32_t uid = trailer.GetInstanceTypeId ().GetUid () << 1;
   NS_LOG_FUNCTION (this << &trailer << size);
   NS_ASSERT (IsStateOk ());
-  if (!m_enable) 
+  if (!IsRecorded ())
     {
-      m_metadataSkipped = true;
       return;
     }
   struct PacketMetadata::SmallItem item;
@@ -803,9 +829,8 @@ PacketMetadata::AddAtEnd (PacketMetadata const&o)
 {
   NS_LOG_FUNCTION (this << &o);
   NS_ASSERT (IsStateOk ());
-  if (!m_enable) 
+  if (!IsRecorded ())
     {
-      m_metadataSkipped = true;
       return;
     }
   if (m_tail == 0xffff)
@@ -816,6 +841,21 @@ PacketMetadata::AddAtEnd (PacketMetadata const&o)
       NS_ASSERT (IsStateOk ());
       return;
     }
+  if (o.m_data == 0)
+    {
+      // The items of o were not recorded, so those of the
+      // result cannot be: stop recording this packet.
+      m_data->m_count--;
+      if (m_data->m_count == 0)
+        {
+          PacketMetadata::Recycle (m_data);
+        }
+      m_data = 0;
+      m_head = 0xffff;
+      m_tail = 0xffff;
+      m_used = 0;
+      return;
+    }
   if (o.m_head == 0xffff)
     {
       NS_ASSERT (o.m_tail == 0xffff);
@@ -880,9 +920,8 @@ void
 PacketMetadata::AddPaddingAtEnd (uint32_t end)
 {
   NS_LOG_FUNCTION (this << end);
-  if (!m_enable)
+  if (!IsRecorded ())
     {
-      m_metadataSkipped = true;
       return;
     }
 }
@@ -891,9 +930,8 @@ PacketMetadata::RemoveAtStart (uint32_t start)
 {
   NS_LOG_FUNCTION (this << start);
   NS_ASSERT (IsStateOk ());
-  if (!m_enable) 
+  if (!IsRecorded ())
     {
-      m_metadataSkipped = true;
       return;
     }
   NS_ASSERT (m_data != 0);
@@ -954,9 +992,8 @@ PacketMetadata::RemoveAtEnd (uint32_t end)
 {
   NS_LOG_FUNCTION (this << end);
   NS_ASSERT (IsStateOk ());
-  if (!m_enable) 
+  if (!IsRecorded ())
     {
-      m_metadataSkipped = true;
       return;
     }
   NS_ASSERT (m_data != 0);
@@ -1292,6 +1329,11 @@ PacketMetadata::Deserialize (const uint8_t* buffer, uint32_t size)
 
   struct PacketMetadata::SmallItem item = {0};
   struct PacketMetadata::ExtraItem extraItem = {0};
+  if (desSize > 0 && m_data == 0)
+    {
+      m_data = PacketMetadata::Create (10);
+      memset (m_data->m_data, 0xff, 4);
+    }
   while (desSize > 0)
     {
       uint32_t uidStringSize = 0;
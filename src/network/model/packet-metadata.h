@@ -153,12 +153,26 @@ private:
 
   /**
    * \brief Enable the packet metadata
+   *
+   * The metadata of all the packets is recorded, even if
+   * EnableSampling was called before.
    */
   static void Enable (void);
   /**
    * \brief Enable the packet metadata checking
    */
   static void EnableChecking (void);
+  /**
+   * \brief Enable the packet metadata for a sample of the packets
+   * \param fraction the fraction of the packets whose metadata is
+   *        recorded, between 0 and 1.
+   *
+   * The packets are selected by a hash of their uid, so that the same
+   * packets are selected from one run to the next. The copies and
+   * fragments of a selected packet are recorded too. The other
+   * packets cost as much as with the metadata disabled.
+   */
+  static void EnableSampling (double fraction);
 
   /**
    * \brief Constructor
@@ -644,6 +658,21 @@ public:
    * \returns a pointer to the created buffer storage
    */
   static struct PacketMetadata::Data *Create (uint32_t size);
+  /**
+   * \brief Check if the metadata of a new packet is recorded
+   * \param uid the packet uid
+   * \returns true if the packet belongs to the sample set by EnableSampling
+   */
+  static inline bool IsSampled (uint64_t uid);
+  /**
+   * \brief Check if the operations on this packet are recorded
+   *
+   * Records in m_metadataSkipped that an operation is skipped
+   * because the metadata is disabled.
+   *
+   * \returns true if the operations on this packet are recorded
+   */
+  bool IsRecorded (void) const;
   /**
    * \brief Allocate a buffer data storage
    * \param n the storage size to create
@@ -659,6 +688,11 @@ public:
   static DataFreeList m_freeList; //!< the metadata data storage
   static bool m_enable; //!< Enable the packet metadata
   static bool m_enableChecking; //!< Enable the packet metadata checking
+  /**
+   * The packets whose hashed uid is below this threshold, out of 2^32,
+   * are recorded.
+   */
+  static uint64_t m_sampleThreshold;
 
   /**
    * Set to true when adding metadata to a packet is skipped because
@@ -670,7 +704,7 @@ public:
   static uint32_t m_maxSize; //!< maximum metadata size
   static uint16_t m_chunkUid; //!< Chunk Uid
 
-  struct Data *m_data; //!< Metadata storage
+  struct Data *m_data; //!< Metadata storage, or null if not recorded
   /*
      head -(next)-> tail
        ^             |
@@ -686,14 +720,25 @@ public:
 
 namespace ns3 {
 
+bool
+PacketMetadata::IsSampled (uint64_t uid)
+{
+  // Fibonacci hashing spreads consecutive uids over the 32 bits.
+  return ((uid * 0x9e3779b97f4a7c15ULL) >> 32) < m_sampleThreshold;
+}
+
 PacketMetadata::PacketMetadata (uint64_t uid, uint32_t size)
-  : m_data (PacketMetadata::Create (10)),
+  : m_data (0),
     m_head (0xffff),
     m_tail (0xffff),
     m_used (0),
     m_packetUid (uid)
 {
-  memset (m_data->m_data, 0xff, 4);
+  if (m_enable && IsSampled (uid))
+    {
+      m_data = PacketMetadata::Create (10);
+      memset (m_data->m_data, 0xff, 4);
+    }
   if (size > 0)
     {
       DoAddHeader (0, size);
@@ -706,9 +751,11 @@ PacketMetadata::PacketMetadata (PacketMetadata const &o)
     m_used (o.m_used),
     m_packetUid (o.m_packetUid)
 {
-  NS_ASSERT (m_data != 0);
-  NS_ASSERT (m_data->m_count < std::numeric_limits<uint32_t>::max());
-  m_data->m_count++;
+  if (m_data != 0)
+    {
+      NS_ASSERT (m_data->m_count < std::numeric_limits<uint32_t>::max());
+      m_data->m_count++;
+    }
 }
 PacketMetadata &
 PacketMetadata::operator = (PacketMetadata const& o)
@@ -716,15 +763,19 @@ PacketMetadata::operator = (PacketMetadata const& o)
   if (m_data != o.m_data) 
     {
       // not self assignment
-      NS_ASSERT (m_data != 0);
-      m_data->m_count--;
-      if (m_data->m_count == 0) 
+      if (m_data != 0)
         {
-          PacketMetadata::Recycle (m_data);
+          m_data->m_count--;
+          if (m_data->m_count == 0) 
+            {
+              PacketMetadata::Recycle (m_data);
+            }
         }
       m_data = o.m_data;
-      NS_ASSERT (m_data != 0);
-      m_data->m_count++;
+      if (m_data != 0)
+        {
+          m_data->m_count++;
+        }
     }
   m_head = o.m_head;
   m_tail = o.m_tail;
@@ -734,7 +785,10 @@ PacketMetadata::operator = (PacketMetadata const& o)
 }
 PacketMetadata::~PacketMetadata ()
 {
-  NS_ASSERT (m_data != 0);
+  if (m_data == 0)
+    {
+      return;
+    }
   m_data->m_count--;
   if (m_data->m_count == 0) 
     {
@@ -20,7 +20,7 @@
 
 /**
 \file   packet-tag-list.cc
-\brief  Implements a linked list of Packet tags, including copy-on-write semantics.
+\brief  Implements a contiguous list of Packet tags, including copy-on-write semantics.
 */
 
 #include "packet-tag-list.h"
@@ -28,261 +28,195 @@
 #include "tag.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
-#include <cstring>
+#include <algorithm>
+#include <new>
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("PacketTagList");
 
-bool
-PacketTagList::COWTraverse (Tag & tag, PacketTagList::COWWriter Writer)
+uint64_t
+PacketTagList::GetMaskBit (TypeId tid)
 {
-  TypeId tid = tag.GetInstanceTypeId ();
-  NS_LOG_FUNCTION (this << tid);
-  NS_LOG_INFO     ("looking for " << tid);
+  return static_cast<uint64_t> (1) << (tid.GetUid () & 63);
+}
 
-  // trivial case when list is empty
-  if (m_next == 0)
+struct PacketTagList::TagBlock *
+PacketTagList::Allocate (uint32_t capacity)
+{
+  NS_LOG_FUNCTION (capacity);
+  NS_ASSERT (capacity >= 1);
+  uint32_t size = sizeof (struct TagBlock) + (capacity - 1) * sizeof (struct TagData);
+  uint8_t *b = new uint8_t [size];
+  // The TypeId of each tag must be constructed before it is assigned.
+  struct TagBlock *block = new (b) TagBlock;
+  for (uint32_t i = 1; i < capacity; i++)
     {
-      return false;
+      new (&block->tags[i]) TagData;
     }
+  block->count = 1;
+  block->size = 0;
+  block->capacity = capacity;
+  block->mask = 0;
+  return block;
+}
 
-  bool found = false;
-
-  struct TagData ** prevNext = &m_next; // previous node's next pointer
-  struct TagData  * cur      =  m_next; // cursor to current node
-  struct TagData  * it = 0;             // utility
-
-  // Search from the head of the list until we find tid or a merge
-  while (cur != 0)
+void
+PacketTagList::Deallocate (struct TagBlock *block)
+{
+  NS_LOG_FUNCTION (block);
+  NS_ASSERT (block->count == 0);
+  for (uint32_t i = 1; i < block->capacity; i++)
     {
-      if (cur->count > 1)
-        {
-          // found merge
-          NS_LOG_INFO ("found initial merge before tid");
-          break;
-        }
-      else if (cur->tid == tid)
-        {
-          NS_LOG_INFO ("found tid before initial merge, calling writer");
-          found = (this->*Writer)(tag, true, cur, prevNext);
-          break;
-        }
-      else
-        {
-          // no merge or tid found yet, move on
-          prevNext = &cur->next;
-          cur      =  cur->next;
-        }
-    }  // while !found && !cow
+      block->tags[i].~TagData ();
+    }
+  block->~TagBlock ();
+  uint8_t *b = reinterpret_cast<uint8_t *> (block);
+  delete [] b;
+}
 
-  // did we find it or run out of tags?
-  if (cur == 0 || found)
+int32_t
+PacketTagList::Find (TypeId tid) const
+{
+  if (m_block == 0 || (m_block->mask & GetMaskBit (tid)) == 0)
     {
-      NS_LOG_INFO ("returning after header with found: " << found);
-      return found;
+      return -1;
     }
-
-  // From here on out, we have to copy the list
-  // until we find tid, then link past it
-
-  // Before we do all that work, let's make sure tid really exists
-  for (it = cur; it != 0; it = it->next)
+  for (int32_t i = m_block->size - 1; i >= 0; i--)
     {
-      if (it->tid == tid)
+      if (m_block->tags[i].tid == tid)
         {
-          break;
+          return i;
         }
     }
-  if (it == 0)
+  return -1;
+}
+
+void
+PacketTagList::Unshare (uint32_t capacity)
+{
+  NS_LOG_FUNCTION (this << capacity);
+  if (m_block == 0)
     {
-      // got to end of list without finding tid
-      NS_LOG_INFO ("tid not found after first merge");
-      return found;
+      m_block = Allocate (capacity > INLINE_TAGS ? capacity : INLINE_TAGS);
+      return;
     }
-
-  // At this point cur is a merge, but untested for tid
-  NS_ASSERT (cur != 0);
-  NS_ASSERT (cur->count > 1);
-
-  /*
-     Walk the remainder of the list, copying, until we find tid
-     As we put a copy of the cur node onto our list,
-     we move the merge point down the list.
-
-     Starting position                  End position
-       T1 is a merge                     T1.count decremented
-                                         T2 is a merge
-                                         T1' is a copy of T1
-
-          other                             other
-               \                                 \
-      Prev  ->  T1  ->  T2  -> ...                T1  ->  T2  -> ...
-           /   /                                         /|
-      pNext cur                         Prev  ->  T1' --/ |
-                                                     /    |
-                                                pNext   cur
-
-     When we reach tid, we link past it, decrement count, and we're done.
-  */
-
-  // Should normally check for null cur pointer,
-  // but since we know tid exists, we'll skip this test
-  while ( /* cur && */ cur->tid != tid)
+  if (m_block->count == 1 && m_block->capacity >= capacity)
     {
-      NS_ASSERT (cur != 0);
-      NS_ASSERT (cur->count > 1);
-      cur->count--;                       // unmerge cur
-      struct TagData * copy = new struct TagData ();
-      copy->tid = cur->tid;
-      copy->count = 1;
-      memcpy (copy->data, cur->data, TagData::MAX_SIZE);
-      copy->next = cur->next;             // merge into tail
-      copy->next->count++;                // mark new merge
-      *prevNext = copy;                   // point prior list at copy
-      prevNext = &copy->next;             // advance
-      cur      =  copy->next;
+      return;
     }
-  // Sanity check:
-  NS_ASSERT (cur != 0);                 // cur should be non-zero
-  NS_ASSERT (cur->tid == tid);          // cur->tid should be tid
-  NS_ASSERT (cur->count > 1);           // cur should be a merge
-
-  // link around tid, removing it from our list
-  found = (this->*Writer)(tag, false, cur, prevNext);
-  return found;
-
+  uint32_t newCapacity = m_block->capacity;
+  while (newCapacity < capacity)
+    {
+      newCapacity *= 2;
+    }
+  struct TagBlock *copy = Allocate (newCapacity);
+  copy->size = m_block->size;
+  copy->mask = m_block->mask;
+  std::copy (m_block->tags, m_block->tags + m_block->size, copy->tags);
+  RemoveAll ();
+  m_block = copy;
 }
 
 bool
 PacketTagList::Remove (Tag & tag)
 {
-  return COWTraverse (tag, &PacketTagList::RemoveWriter);
-}
-
-// COWWriter implementing Remove
-bool
-PacketTagList::RemoveWriter (Tag & tag, bool preMerge,
-                             struct PacketTagList::TagData  * cur,
-                             struct PacketTagList::TagData ** prevNext)
-{
-  NS_LOG_FUNCTION_NOARGS ();
-
-  // found tid
-  bool found = true;
-  tag.Deserialize (TagBuffer (cur->data,
-                              cur->data + TagData::MAX_SIZE));
-  *prevNext = cur->next;            // link around cur
-
-  if (preMerge)
+  TypeId tid = tag.GetInstanceTypeId ();
+  NS_LOG_FUNCTION (this << tid);
+  int32_t i = Find (tid);
+  if (i < 0)
     {
-      // found tid before first merge, so delete cur
-      delete cur;
+      return false;
     }
-  else
+  Unshare (m_block->size);
+  struct TagData *cur = &m_block->tags[i];
+  tag.Deserialize (TagBuffer (cur->data, cur->data + TagData::MAX_SIZE));
+  m_block->size--;
+  std::copy (cur + 1, cur + 1 + (m_block->size - i), cur);
+  m_block->mask = 0;
+  for (uint32_t j = 0; j < m_block->size; j++)
     {
-      // cur is always a merge at this point
-      // unmerge cur, since we linked around it already
-      cur->count--;
-      if (cur->next != 0)
-        {
-          // there's a next, so make it a merge
-          cur->next->count++;
-        }
+      m_block->mask |= GetMaskBit (m_block->tags[j].tid);
     }
-  return found;
+  return true;
 }
 
 bool
 PacketTagList::Replace (Tag & tag)
 {
-  bool found = COWTraverse (tag, &PacketTagList::ReplaceWriter);
-  if (!found)
+  TypeId tid = tag.GetInstanceTypeId ();
+  NS_LOG_FUNCTION (this << tid);
+  int32_t i = Find (tid);
+  if (i < 0)
     {
       Add (tag);
+      return false;
     }
-  return found;
-}
-
-// COWWriter implementing Replace
-bool
-PacketTagList::ReplaceWriter (Tag & tag, bool preMerge,
-                              struct PacketTagList::TagData  * cur,
-                              struct PacketTagList::TagData ** prevNext)
-{
-  NS_LOG_FUNCTION_NOARGS ();
-
-  // found tid
-  bool found = true;
-  if (preMerge)
-    {
-      // found tid before first merge, so just rewrite
-      tag.Serialize (TagBuffer (cur->data,
-                                cur->data + tag.GetSerializedSize ()));
-    }
-  else
-    {
-      // cur is always a merge at this point
-      // need to copy, replace, and link past cur
-      cur->count--;                     // unmerge cur
-      struct TagData * copy = new struct TagData ();
-      copy->tid = tag.GetInstanceTypeId ();
-      copy->count = 1;
-      tag.Serialize (TagBuffer (copy->data,
-                                copy->data + tag.GetSerializedSize ()));
-      copy->next = cur->next;           // merge into tail
-      if (copy->next != 0)
-        {
-          copy->next->count++;          // mark new merge
-        }
-      *prevNext = copy;                 // point prior list at copy
-    }
-  return found;
+  Unshare (m_block->size);
+  struct TagData *cur = &m_block->tags[i];
+  NS_ASSERT (tag.GetSerializedSize () <= TagData::MAX_SIZE);
+  tag.Serialize (TagBuffer (cur->data, cur->data + tag.GetSerializedSize ()));
+  return true;
 }
 
 void 
 PacketTagList::Add (const Tag &tag) const
 {
-  NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
+  TypeId tid = tag.GetInstanceTypeId ();
+  NS_LOG_FUNCTION (this << tid);
   // ensure this id was not yet added
-  for (struct TagData *cur = m_next; cur != 0; cur = cur->next) 
-    {
-      NS_ASSERT (cur->tid != tag.GetInstanceTypeId ());
-    }
-  struct TagData * head = new struct TagData ();
-  head->count = 1;
-  head->next = 0;
-  head->tid = tag.GetInstanceTypeId ();
-  head->next = m_next;
+  NS_ASSERT (Find (tid) < 0);
+  PacketTagList *self = const_cast<PacketTagList *> (this);
+  self->Unshare (m_block == 0 ? 1 : m_block->size + 1);
+  struct TagData *cur = &m_block->tags[m_block->size];
+  cur->tid = tid;
   NS_ASSERT (tag.GetSerializedSize () <= TagData::MAX_SIZE);
-  tag.Serialize (TagBuffer (head->data, head->data + tag.GetSerializedSize ()));
-
-  const_cast<PacketTagList *> (this)->m_next = head;
+  tag.Serialize (TagBuffer (cur->data, cur->data + tag.GetSerializedSize ()));
+  m_block->size++;
+  m_block->mask |= GetMaskBit (tid);
 }
 
 bool
 PacketTagList::Peek (Tag &tag) const
 {
-  NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
   TypeId tid = tag.GetInstanceTypeId ();
-  for (struct TagData *cur = m_next; cur != 0; cur = cur->next) 
+  NS_LOG_FUNCTION (this << tid);
+  int32_t i = Find (tid);
+  if (i < 0)
     {
-      if (cur->tid == tid) 
-        {
-          /* found tag */
-          tag.Deserialize (TagBuffer (cur->data, cur->data + TagData::MAX_SIZE));
-          return true;
-        }
+      /* no tag found */
+      return false;
     }
-  /* no tag found */
-  return false;
+  struct TagData *cur = &m_block->tags[i];
+  tag.Deserialize (TagBuffer (cur->data, cur->data + TagData::MAX_SIZE));
+  return true;
 }
 
 const struct PacketTagList::TagData *
-PacketTagList::Head (void) const
+PacketTagList::Begin (void) const
 {
-  return m_next;
+  return m_block == 0 ? 0 : m_block->tags;
 }
 
-} /* namespace ns3 */
+uint32_t
+PacketTagList::GetN (void) const
+{
+  return m_block == 0 ? 0 : m_block->size;
+}
 
+PacketTagList
+PacketTagList::DeepCopy (void) const
+{
+  NS_LOG_FUNCTION (this);
+  PacketTagList copy;
+  if (m_block != 0 && m_block->size > 0)
+    {
+      copy.Unshare (m_block->size);
+      copy.m_block->size = m_block->size;
+      copy.m_block->mask = m_block->mask;
+      std::copy (m_block->tags, m_block->tags + m_block->size, copy.m_block->tags);
+    }
+  return copy;
+}
+
+} /* namespace ns3 */
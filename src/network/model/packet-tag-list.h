@@ -22,7 +22,7 @@
 
 /**
 \file   packet-tag-list.h
-\brief  Defines a linked list of Packet tags, including copy-on-write semantics.
+\brief  Defines a contiguous list of Packet tags, including copy-on-write semantics.
 */
 
 #include <stdint.h>
@@ -43,94 +43,42 @@ class Tag;
  *
  * \internal
  *
- * The implementation of this class is a bit tricky.  Refer to this
- * diagram in the discussion that follows.
+ * The tags are stored in serialized form, oldest first, in a single
+ * contiguous block of TagData, shared by the copies of the list:
  *
- * \dot
- *    digraph {
- *        rankdir = "LR";
- *        clusterrank = local;
- *        node [ shape = record, fontname="FreeSans", fontsize="10" ];
- *        oth  [ label="<l> Other branch | <n> next | <c> ..." ];
- *        PTL1 [ label="<l> PacketTagList A | <n> m_next" , shape=Mrecord];
- *        PTL2 [ label="<l> PacketTagList B | <n> m_next" , shape=Mrecord];
- *        oth:n  -> T7:l ;
- *        PTL2:n -> T6:l ;
- *        PTL1:n -> T5:l ;
- *        T1   [ label="<l> T1  | <n> next | <c> count = 1" ];
- *        T2   [ label="<l> T2  | <n> next | <c> count = 1" ];
- *        T3   [ label="<l> T3  | <n> next | <c> count = 2" ];
- *        T4   [ label="<l> T4  | <n> next | <c> count = 1" ];
- *        T5   [ label="<l> T5  | <n> next | <c> count = 2" ];
- *        T6   [ label="<l> T6  | <n> next | <c> count = 1" ];
- *        T7   [ label="<l> T7  | <n> next | <c> count = 1" ];
- *        NULL [ label="0", shape = ellipse ];
- *        subgraph cluster_list {
- *          penwidth = 0;
- *          T6:n -> T5:l ;
- *          T5:n -> T4:l ;
- *          T4:n -> T3:l ;
- *          T7:n -> T3:l ;
- *          T3:n -> T2:l ;
- *          T2:n -> T1:l ;
- *          T1:n -> NULL ;
- *        };
- *      };
- * \enddot
+ *   - The block starts with room for INLINE_TAGS tags, enough for the
+ *     tags which a packet typically carries, so that adding these
+ *     tags allocates at most once per packet.  It doubles in size
+ *     when more room is needed.
  *
- *   - Tags are stored in serialized form in a tree of TagData
- *     structures. (<tt>T1-T7</tt> in the diagram)
- *
- *   - Each TagData points (\c next pointers in the diagram)
- *     toward the root of the tree, which is a null pointer.
- *
- *   - \c count is the number of incoming pointers to this
- *     TagData.  Branch points, where branches merge or join, have
- *     <tt>count \> 1</tt> (\c T3, \c T5); successive links along
- *     a branch have <tt>count = 1</tt> (\c T1, \c T2, \c T4, \c T6, \c T7).
- *
- *   - Each PacketTagList points to a specific TagData,
- *     which is the most recent Tag added to the packet. (<tt>T5-T7</tt>)
- *
- *   - Conceptually, therefore, each Packet has a PacketTagList which
- *     points to a singly-linked list of TagData.
+ *   - The block also holds a mask with one bit set per tag type,
+ *     indexed by the low bits of the TypeId uid, which lets #Peek,
+ *     #Remove and #Replace tell in constant time that a tag type
+ *     is not in the list, the most frequent case.  Otherwise, the
+ *     few tags of the block are searched from the newest one.
  *
  * \par <b> Copy-on-write </b> is implemented as follows:
  *
- *   - #Add prepends the new tag to the list (growing that branch of the tree,
- *     as \c T6). This is a constant time operation, and does not affect
- *     any other #PacketTagList's, hence this is a \c const function.
- *
  *   - Copy constructor (PacketTagList(const PacketTagList & o))
  *     and assignment (#operator=(const PacketTagList & o)
- *     simply join the tree at the same place as the original
- *     PacketTagList \c o, incrementing the \c count.
- *     For assignment, the old branch is deleted, up to
- *     the first branch point, which has its \c count decremented.
- *     (PacketTagList \c B started as a copy of PacketTagList \c A,
- *     before \c T6 was added to \c B).
+ *     simply point to the block of the original PacketTagList
+ *     \c o, incrementing its \c count.
  *
- *   - #Remove and #Replace are a little tricky, depending on where the
- *     target tag is found relative to the first branch point:
- *     - \e Target before <em> the first branch point: </em> \n
- *       The target is just dealt with in place (linked around and deleted,
- *       in the case of #Remove; rewritten in the case of #Replace).
- *     - \e Target at or after <em> the first branch point: </em> \n
- *       The portion of the list between the first branch and the target is
- *       shared. This portion is copied before the #Remove or #Replace is
- *       performed.
+ *   - #Add, #Remove and #Replace modify the block in place when
+ *     this list is its only user.  Otherwise, they first make a private
+ *     copy of the block, and leave the shared one untouched.
+ *     #Add does not change any other PacketTagList, hence
+ *     this is a \c const function.
  *
  * \par <b> Memory Management: </b>
  * \n
  * Packet tags must serialize to a finite maximum size, see TagData
- *
- * This documentation entitles the original author to a free beer.
  */
 class PacketTagList 
 {
 public:
   /**
-   * Tree node for sharing serialized tags.
+   * Serialized tag stored in the list.
    *
    * See PacketTagList for a discussion of the data structure.
    *
@@ -146,15 +94,9 @@ public:
      * in this constant.
      *
      * \internal
-     * Ideally, TagData would be 32 bytes in size, so they require
-     * no padding on 64-bit architectures.  (The architecture
-     * affects the size because of the \c #next pointer.)
-     * This would leave 18 bytes for \c #data.  However,
-     * ns3:Ipv6PacketInfoTag needs 19 bytes!  The current
-     * implementation allows 20 bytes, which gives TagData
-     * a size of 30 bytes on 32-byte machines (which gets
-     * padded with 2 bytes), and 34 bytes on 64-bit machines, which
-     * gets padded to 40 bytes.
+     * ns3:Ipv6PacketInfoTag needs 19 bytes.  The current
+     * implementation allows 20 bytes, which, with the 2 bytes of
+     * \c #tid, gives TagData a size of 22 bytes, with no padding.
      */
     enum TagData_e
     {
@@ -162,9 +104,7 @@ public:
   };
 
     uint8_t data[MAX_SIZE];   /**< Serialization buffer */
-    struct TagData * next;   /**< Pointer to next in list */
     TypeId tid;               /**< Type of the tag serialized into #data */
-    uint32_t count;           /**< Number of incoming links */
   };  /* struct TagData */
 
   /**
@@ -176,8 +116,8 @@ public:
    *
    * \param [in] o The PacketTagList to copy.
    *
-   * This makes a light-weight copy by #RemoveAll, then
-   * pointing to the same \ref TagData as \pname{o}.
+   * This makes a light-weight copy, pointing to the same
+   * tags as \pname{o}.
    */
   inline PacketTagList (PacketTagList const &o);
   /**
@@ -187,18 +127,18 @@ public:
    * \returns the copied object
    *
    * This makes a light-weight copy by #RemoveAll, then
-   * pointing to the same \ref TagData as \pname{o}.
+   * pointing to the same tags as \pname{o}.
    */
   inline PacketTagList &operator = (PacketTagList const &o);
   /**
    * Destructor
    *
-   * #RemoveAll's the tags up to the first merge.
+   * #RemoveAll's the tags.
    */
   inline ~PacketTagList ();
 
   /**
-   * Add a tag to the head of this branch.
+   * Add a tag to the end of this list.
    *
    * \param [in] tag The tag to add
    */
@@ -230,67 +170,87 @@ public:
    */
   bool Peek (Tag &tag) const;
   /**
-   * Remove all tags from this list (up to the first merge).
+   * Remove all tags from this list.
    */
   inline void RemoveAll (void);
   /**
-   * \returns pointer to head of tag list
+   * \returns pointer to the first (oldest) tag of the list
    */
-  const struct PacketTagList::TagData *Head (void) const;
+  const struct PacketTagList::TagData *Begin (void) const;
+  /**
+   * \returns the number of tags in the list
+   */
+  uint32_t GetN (void) const;
+  /**
+   * Copy the tags into a list of their own.
+   *
+   * Unlike the copy constructor, the copy shares no storage with this
+   * list, not even its reference count, so that it may be handed over
+   * to another thread.
+   *
+   * \returns the copy
+   */
+  PacketTagList DeepCopy (void) const;
 
 private:
   /**
-   * Typedef of method function pointer for copy-on-write operations
+   * Number of tags which fit in a new block.
+   */
+  static const uint32_t INLINE_TAGS = 4;
+
+  /**
+   * Shared block of tags.
+   */
+  struct TagBlock
+  {
+    uint32_t count;           /**< Number of PacketTagList using the block */
+    uint32_t size;            /**< Number of tags in #tags */
+    uint32_t capacity;        /**< Number of tags which fit in #tags */
+    uint64_t mask;            /**< One bit set per tag type, see GetMaskBit */
+    /**
+     * The tags, oldest first.  The block is allocated with room
+     * for #capacity tags.
+     */
+    struct TagData tags[1];
+  };
+
+  /**
+   * \param [in] tid A tag type.
+   * \returns the bit of TagBlock::mask for \pname{tid}.
+   */
+  static uint64_t GetMaskBit (TypeId tid);
+  /**
+   * Allocate a block.
    *
-   * \param [in] tag The tag type to operate on.
-   * \param [in] preMerge True if \pname{tag} was found before the first merge,
-   *             false otherwise.
-   * \param [in] cur Pointer to the tag.
-   * \param [in] prevNext Pointer to the struct TagData.next pointer
-   *          pointing to \pname{cur}.
-   * \returns True if operation successful, false otherwise
+   * \param [in] capacity The number of tags which fit in the block.
+   * \returns a new block, with a \c count of one and no tag.
    */
-  typedef bool (PacketTagList::*COWWriter)
-    (Tag       & tag, bool         preMerge,
-    struct TagData * cur, struct TagData ** prevNext);
+  static struct TagBlock *Allocate (uint32_t capacity);
   /**
-   * Traverse the list implementing copy-on-write, using \pname{Writer}.
+   * Release a block.
    *
-   * \param [in] tag The tag type to operate on.
-   * \param [in] Writer The copy-on-write function to use.
-   * \returns True if \pname{tag} found, false otherwise.
+   * \param [in] block The block, whose \c count has dropped to zero.
    */
-  bool COWTraverse   (Tag & tag, PacketTagList::COWWriter Writer);
+  static void Deallocate (struct TagBlock *block);
   /**
-   * Copy-on-write implementing Remove.
+   * Find a tag in the list.
    *
-   * \param [in] tag The target tag type to remove.
-   * \param [in] preMerge True if \pname{tag} was found before the first merge,
-   *             false otherwise.
-   * \param [in] cur Pointer to the tag.
-   * \param [in] prevNext Pointer to the struct TagData.next pointer
-   *          pointing to \pname{cur}.
-   * \returns True, since tag will definitely be removed.
+   * \param [in] tid The tag type to find.
+   * \returns the index of the tag in the block, or -1 if not found.
    */
-  bool RemoveWriter  (Tag       & tag, bool         preMerge,
-                      struct TagData * cur, struct TagData ** prevNext);
+  int32_t Find (TypeId tid) const;
   /**
-   * Copy-on-write implementing Replace
+   * Make sure this list is the only user of its block, and that
+   * the block has room for \pname{capacity} tags.
    *
-   * \param [in] tag The target tag type to replace
-   * \param [in] preMerge True if \pname{tag} was found before the first merge,
-   *          false otherwise.
-   * \param [in] cur Pointer to the tag
-   * \param [in] prevNext Pointer to the struct TagData.next pointer
-   *          pointing to \pname{cur}.
-   * \returns True, since tag value will definitely be replaced.
+   * \param [in] capacity The number of tags needed.
    */
-  bool ReplaceWriter (Tag & tag, bool preMerge, struct TagData * cur, struct TagData ** prevNext);
+  void Unshare (uint32_t capacity);
 
   /**
-   * Pointer to first \ref TagData on the list
+   * Block holding the tags, or null if the list is empty.
    */
-  struct TagData *m_next;
+  struct TagBlock *m_block;
 };
 
 } // namespace ns3
@@ -302,16 +262,16 @@ private:
 namespace ns3 {
 
 PacketTagList::PacketTagList ()
-  : m_next ()
+  : m_block (0)
 {
 }
 
 PacketTagList::PacketTagList (PacketTagList const &o)
-  : m_next (o.m_next)
+  : m_block (o.m_block)
 {
-  if (m_next != 0)
+  if (m_block != 0)
     {
-      m_next->count++;
+      m_block->count++;
     }
 }
 
@@ -319,15 +279,15 @@ PacketTagList &
 PacketTagList::operator = (PacketTagList const &o)
 {
   // self assignment
-  if (m_next == o.m_next) 
+  if (m_block == o.m_block) 
     {
       return *this;
     }
   RemoveAll ();
-  m_next = o.m_next;
-  if (m_next != 0) 
+  m_block = o.m_block;
+  if (m_block != 0) 
     {
-      m_next->count++;
+      m_block->count++;
     }
   return *this;
 }
@@ -340,25 +300,15 @@ PacketTagList::~PacketTagList ()
 void
 PacketTagList::RemoveAll (void)
 {
-  struct TagData *prev = 0;
-  for (struct TagData *cur = m_next; cur != 0; cur = cur->next)
+  if (m_block != 0)
     {
-      cur->count--;
-      if (cur->count > 0) 
+      m_block->count--;
+      if (m_block->count == 0)
         {
-          break;
+          Deallocate (m_block);
         }
-      if (prev != 0) 
-        {
-	  delete prev;
-        }
-      prev = cur;
-    }
-  if (prev != 0) 
-    {
-      delete prev;
+      m_block = 0;
     }
-  m_next = 0;
 }
 
 } // namespace ns3
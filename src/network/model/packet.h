@@ -168,9 +168,11 @@ private:
   friend class Packet;
   /**
    * Constructor
-   * \param head head of the items
+   * \param tags the items, oldest first
+   * \param n the number of items
    */
-  PacketTagIterator (const struct PacketTagList::TagData *head);
+  PacketTagIterator (const struct PacketTagList::TagData *tags, uint32_t n);
+  const struct PacketTagList::TagData *m_begin;    //!< first (oldest) tag of the packet
   const struct PacketTagList::TagData *m_current;  //!< actual position over the set of tags in a packet
 };
 
@@ -194,7 +196,9 @@ private:
  * output from Packet::Print. If you wish to only enable
  * checking of metadata, and do not need any printing capability, you can
  * call Packet::EnableChecking: its runtime cost is lower than
- * Packet::EnablePrinting.
+ * Packet::EnablePrinting. To keep this cost low in long runs, call
+ * Packet::EnableSampledPrinting instead, which maintains the metadata
+ * of a sample of the packets only.
  *
  * - The set of tags contain simulation-specific information which cannot
  * be stored in the packet byte buffer because the protocol headers or trailers
@@ -422,6 +426,17 @@ public:
    * same datasets internally.
    */
   Ptr<Packet> Copy (void) const;
+  /**
+   * \brief performs a deep copy of the packet.
+   *
+   * \returns a copy of the packet, with the same uid, bytes, tags
+   * and metadata.
+   *
+   * Unlike Copy, the copy shares no storage nor reference count with
+   * the original packet, so that it may be handed over to another
+   * thread (see ParallelSimulatorImpl).  It is much more expensive.
+   */
+  Ptr<Packet> DeepCopy (void) const;
 
   /**
    * \brief Returns the packet's Uid.
@@ -500,6 +515,20 @@ public:
    * errors will be detected and will abort the program.
    */
   static void EnableChecking (void);
+  /**
+   * \brief Enable printing the metadata of a sample of the packets.
+   *
+   * \param fraction the fraction of the packets whose metadata is
+   *        maintained, between 0 and 1.
+   *
+   * This method is like EnablePrinting, but the metadata is only
+   * maintained for the given fraction of the packets, selected by
+   * a hash of their uid; the copies and fragments of a selected
+   * packet are selected too. Packet::Print prints nothing for the
+   * other packets. It can be called again, with another fraction,
+   * to change the sample of the packets created from then on.
+   */
+  static void EnableSampledPrinting (double fraction);
 
   /**
    * \brief Returns number of bytes required for packet
@@ -701,7 +730,11 @@ private:
   /* Please see comments above about nix-vector */
   Ptr<NixVector> m_nixVector; //!< the packet's Nix vector
 
-  static uint32_t m_globalUid; //!< Global counter of packets Uid
+  /**
+   * Global counter of packets Uid, incremented atomically since the
+   * threads of ParallelSimulatorImpl create packets concurrently.
+   */
+  static uint32_t m_globalUid;
 };
 
 /**
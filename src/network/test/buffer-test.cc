@@ -340,6 +340,192 @@ BufferTest::DoRun (void)
   val2 <<= 8;
   val2 |= i.ReadU8 ();
   NS_TEST_ASSERT_MSG_EQ (val1, val2, "Bad ReadNtohU16()");
+
+  // Appending fragments merges their zero areas.
+  buffer = Buffer (3000);
+  buffer.AddAtStart (2);
+  i = buffer.Begin ();
+  i.WriteU8 (0x1);
+  i.WriteU8 (0x2);
+  buffer.AddAtEnd (1);
+  i = buffer.End ();
+  i.Prev (1);
+  i.WriteU8 (0x3);
+  frag0 = buffer.CreateFragment (0, 1000);
+  frag1 = buffer.CreateFragment (1000, 2003);
+  frag0.AddAtEnd (frag1);
+  NS_TEST_ASSERT_MSG_EQ (frag0.GetSize (), 3003, "Bad size of appended fragments");
+  NS_TEST_EXPECT_MSG_LT (frag0.GetSerializedSize (), 100, "Zero area was materialized");
+  i = frag0.Begin ();
+  NS_TEST_EXPECT_MSG_EQ (i.ReadU8 (), 0x1, "Bad header after append");
+  NS_TEST_EXPECT_MSG_EQ (i.ReadU8 (), 0x2, "Bad header after append");
+  i.Next (2000);
+  NS_TEST_EXPECT_MSG_EQ (i.ReadU8 (), 0x0, "Bad payload after append");
+  i = frag0.End ();
+  i.Prev (1);
+  NS_TEST_EXPECT_MSG_EQ (i.ReadU8 (), 0x3, "Bad trailer after append");
+  ENSURE_WRITTEN_BYTES (buffer, 2, 0x1, 0x2);
+
+  // Appending buffers with separate zero areas keeps the largest one.
+  buffer = Buffer (500);
+  buffer.AddAtEnd (1);
+  i = buffer.End ();
+  i.Prev (1);
+  i.WriteU8 (0x5);
+  other = Buffer (4000);
+  other.AddAtStart (1);
+  other.Begin ().WriteU8 (0x6);
+  buffer.AddAtEnd (other);
+  NS_TEST_ASSERT_MSG_EQ (buffer.GetSize (), 4502, "Bad size of appended buffers");
+  NS_TEST_EXPECT_MSG_LT (buffer.GetSerializedSize (), 1000, "Largest zero area was materialized");
+  i = buffer.Begin ();
+  i.Next (500);
+  NS_TEST_EXPECT_MSG_EQ (i.ReadU8 (), 0x5, "Bad trailer after append");
+  NS_TEST_EXPECT_MSG_EQ (i.ReadU8 (), 0x6, "Bad header after append");
+  NS_TEST_EXPECT_MSG_EQ (i.ReadU8 (), 0x0, "Bad payload after append");
+}
+//-----------------------------------------------------------------------------
+class BufferFreeListTest : public TestCase {
+public:
+  virtual void DoRun (void);
+  BufferFreeListTest ();
+};
+
+BufferFreeListTest::BufferFreeListTest ()
+  : TestCase ("Buffer free lists") {
+}
+
+void
+BufferFreeListTest::DoRun (void)
+{
+  // Start from empty free lists.
+  Buffer::SetFreeListLimits (0, 0);
+  Buffer::FreeListStats before = Buffer::GetFreeListStats ();
+  NS_TEST_ASSERT_MSG_EQ (before.buffers, 0U, "Free lists were not trimmed");
+  NS_TEST_ASSERT_MSG_EQ (before.bytes, 0U, "Free lists were not trimmed");
+  Buffer::SetFreeListLimits (1000, 4 * 1024 * 1024);
+
+  // Small data is recycled in its own size class.
+  {
+    Buffer small;
+    small.AddAtStart (100);
+  }
+  Buffer::FreeListStats released = Buffer::GetFreeListStats ();
+  NS_TEST_ASSERT_MSG_GT (released.buffers, 0U, "Data was not recycled");
+  NS_TEST_ASSERT_MSG_GT (released.bytes, 0U, "Data was not recycled");
+  NS_TEST_EXPECT_MSG_LT (released.bytes, 1024U, "Small data was not recycled in a small class");
+  {
+    Buffer small;
+    small.AddAtStart (100);
+  }
+  Buffer::FreeListStats reused = Buffer::GetFreeListStats ();
+  NS_TEST_EXPECT_MSG_GT (reused.hits, released.hits, "Data was not reused");
+  NS_TEST_EXPECT_MSG_EQ (reused.misses, released.misses, "Data was allocated");
+  NS_TEST_EXPECT_MSG_EQ (reused.bytes, released.bytes, "Data was not reused");
+
+  // Large data does not serve small buffers.
+  {
+    Buffer large;
+    large.AddAtStart (4000);
+  }
+  Buffer::FreeListStats large = Buffer::GetFreeListStats ();
+  NS_TEST_EXPECT_MSG_GT_OR_EQ (large.bytes, reused.bytes + 4096, "Large data was not recycled");
+  {
+    Buffer small;
+    small.AddAtStart (100);
+  }
+  Buffer::FreeListStats afterLarge = Buffer::GetFreeListStats ();
+  NS_TEST_EXPECT_MSG_EQ (afterLarge.bytes, large.bytes, "Large data was used for a small buffer");
+
+  // The limits bound the recycled data.
+  Buffer::SetFreeListLimits (2, 1000000);
+  {
+    Buffer buffers[10];
+    for (uint32_t i = 0; i < 10; ++i)
+      {
+        buffers[i].AddAtStart (1000);
+      }
+  }
+  Buffer::FreeListStats limited = Buffer::GetFreeListStats ();
+  // Each buffer released the data of two size classes: the initial one
+  // and the one which replaced it to make room for the 1000 bytes.
+  NS_TEST_EXPECT_MSG_LT_OR_EQ (limited.buffers, afterLarge.buffers + 4, "Limits were not applied");
+  Buffer::SetFreeListLimits (1000, 4 * 1024 * 1024);
+}
+//-----------------------------------------------------------------------------
+class BufferSpanTest : public TestCase {
+public:
+  virtual void DoRun (void);
+  BufferSpanTest ();
+};
+
+BufferSpanTest::BufferSpanTest ()
+  : TestCase ("Buffer spans") {
+}
+
+void
+BufferSpanTest::DoRun (void)
+{
+  // 4 bytes, 10 bytes of the virtual zero area, 4 bytes.
+  Buffer buffer (10);
+  buffer.AddAtStart (4);
+  buffer.AddAtEnd (4);
+  NS_TEST_ASSERT_MSG_EQ (buffer.GetSize (), 18U, "Wrong buffer size");
+
+  Buffer::Iterator i = buffer.Begin ();
+  uint8_t *span = i.WriteSpan (4);
+  for (uint8_t j = 0; j < 4; j++)
+    {
+      span[j] = j + 1;
+    }
+  NS_TEST_EXPECT_MSG_EQ (i.GetDistanceFrom (buffer.Begin ()), 4U, "WriteSpan did not move the iterator");
+  i = buffer.End ();
+  i.Prev (4);
+  i.WriteHtonU32 (0x05060708);
+
+  uint8_t scratch[10];
+  i = buffer.Begin ();
+  uint8_t const *data = i.ReadSpan (scratch, 4);
+  NS_TEST_EXPECT_MSG_NE ((data == scratch), true, "Contiguous bytes were copied");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)data[0], 1U, "Wrong byte");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)data[3], 4U, "Wrong byte");
+  data = i.ReadSpan (scratch, 10);
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)data[0], 0U, "The zero area was not read as zeroes");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)data[9], 0U, "The zero area was not read as zeroes");
+  data = i.ReadSpan (scratch, 4);
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)data[0], 5U, "Wrong byte");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)data[3], 8U, "Wrong byte");
+  NS_TEST_EXPECT_MSG_EQ (i.IsEnd (), true, "ReadSpan did not move the iterator");
+
+  // Multi-byte reads across the virtual zero area.
+  i = buffer.Begin ();
+  i.Next (2);
+  NS_TEST_EXPECT_MSG_EQ (i.ReadNtohU64 (), 0x0304000000000000ULL, "Wrong value across the zero area");
+  i = buffer.End ();
+  i.Prev (6);
+  NS_TEST_EXPECT_MSG_EQ (i.ReadLsbtohU32 (), 0x06050000U, "Wrong value across the zero area");
+  i = buffer.Begin ();
+  uint8_t bytes[18];
+  i.Read (bytes, 18);
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)bytes[3], 4U, "Wrong byte");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)bytes[4], 0U, "Wrong byte");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)bytes[17], 8U, "Wrong byte");
+
+  // Round trips of the multi-byte writes.
+  Buffer other;
+  other.AddAtStart (28);
+  i = other.Begin ();
+  i.WriteHtonU64 (0x0102030405060708ULL);
+  i.WriteU64 (0x1112131415161718ULL);
+  i.WriteHtolsbU32 (0x21222324);
+  i.WriteU32 (0x31323334);
+  i = other.Begin ();
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)i.PeekU8 (), 1U, "WriteHtonU64 is not big-endian");
+  NS_TEST_EXPECT_MSG_EQ (i.ReadNtohU64 (), 0x0102030405060708ULL, "Wrong value");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)i.PeekU8 (), 0x18U, "WriteU64 is not little-endian");
+  NS_TEST_EXPECT_MSG_EQ (i.ReadU64 (), 0x1112131415161718ULL, "Wrong value");
+  NS_TEST_EXPECT_MSG_EQ (i.ReadLsbtohU32 (), 0x21222324U, "Wrong value");
+  NS_TEST_EXPECT_MSG_EQ (i.ReadU32 (), 0x31323334U, "Wrong value");
 }
 //-----------------------------------------------------------------------------
 class BufferTestSuite : public TestSuite
@@ -352,6 +538,8 @@ BufferTestSuite::BufferTestSuite ()
   : TestSuite ("buffer", UNIT)
 {
   AddTestCase (new BufferTest, TestCase::QUICK);
+  AddTestCase (new BufferFreeListTest, TestCase::QUICK);
+  AddTestCase (new BufferSpanTest, TestCase::QUICK);
 }
 
 static BufferTestSuite g_bufferTestSuite;
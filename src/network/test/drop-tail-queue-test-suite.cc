@@ -19,6 +19,8 @@
 #include "ns3/test.h"
 #include "ns3/drop-tail-queue.h"
 #include "ns3/uinteger.h"
+#include "ns3/enum.h"
+#include <vector>
 
 using namespace ns3;
 
@@ -77,6 +79,95 @@ DropTailQueueTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ ((p == 0), true, "There are really no packets in there");
 }
 
+class DropTailQueueRingTestCase : public TestCase
+{
+public:
+  DropTailQueueRingTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Count a dequeued packet.
+   * \param p the packet
+   */
+  void Dequeued (Ptr<const Packet> p);
+
+  uint32_t m_dequeued;
+};
+
+DropTailQueueRingTestCase::DropTailQueueRingTestCase ()
+  : TestCase ("Check the ring buffer and the batched dequeue of the drop tail queue"),
+    m_dequeued (0)
+{
+}
+
+void
+DropTailQueueRingTestCase::Dequeued (Ptr<const Packet> p)
+{
+  m_dequeued++;
+}
+
+void
+DropTailQueueRingTestCase::DoRun (void)
+{
+  Ptr<DropTailQueue> queue = CreateObject<DropTailQueue> ();
+  queue->SetAttribute ("MaxPackets", UintegerValue (1000));
+  queue->TraceConnectWithoutContext ("Dequeue", MakeCallback (&DropTailQueueRingTestCase::Dequeued, this));
+
+  //
+  // Keep the ring partly full while it grows, so that its packets wrap
+  // around its end when it is reallocated.
+  //
+  std::vector<uint64_t> uids;
+  uint32_t next = 0;
+  for (uint32_t round = 0; round < 100; round++)
+    {
+      for (uint32_t i = 0; i < 10; i++)
+        {
+          Ptr<Packet> p = Create<Packet> (round);
+          uids.push_back (p->GetUid ());
+          NS_TEST_ASSERT_MSG_EQ (queue->Enqueue (p), true, "The queue is not full");
+        }
+      for (uint32_t i = 0; i < 7; i++)
+        {
+          Ptr<Packet> p = queue->Dequeue ();
+          NS_TEST_ASSERT_MSG_EQ ((p != 0), true, "The queue is not empty");
+          NS_TEST_ASSERT_MSG_EQ (p->GetUid (), uids[next], "Packets are not dequeued in order");
+          next++;
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 300U, "Wrong number of packets");
+  NS_TEST_EXPECT_MSG_EQ (queue->Peek ()->GetUid (), uids[next], "Wrong packet at the front");
+
+  std::vector<Ptr<Packet> > packets;
+  NS_TEST_EXPECT_MSG_EQ (queue->DequeueBatch (packets, 100), 100U, "Wrong number of packets in the batch");
+  NS_TEST_EXPECT_MSG_EQ (queue->DequeueBatch (packets, 1000), 200U, "Wrong number of packets in the batch");
+  NS_TEST_EXPECT_MSG_EQ (queue->DequeueBatch (packets, 1000), 0U, "Batch from an empty queue");
+  NS_TEST_ASSERT_MSG_EQ (packets.size (), 300U, "Wrong number of packets dequeued");
+  for (uint32_t i = 0; i < packets.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (packets[i]->GetUid (), uids[next + i], "Packets are not dequeued in order");
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->IsEmpty (), true, "The queue should be empty");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNBytes (), 0U, "The queue should hold no bytes");
+  NS_TEST_EXPECT_MSG_EQ (m_dequeued, 1000U, "Dequeue trace not fired for each packet");
+
+  //
+  // A byte-limited queue.
+  //
+  queue = CreateObject<DropTailQueue> ();
+  queue->SetAttribute ("Mode", EnumValue (Queue::QUEUE_MODE_BYTES));
+  queue->SetAttribute ("MaxBytes", UintegerValue (1000));
+  uint32_t accepted = 0;
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      accepted += queue->Enqueue (Create<Packet> (300)) ? 1 : 0;
+    }
+  NS_TEST_EXPECT_MSG_EQ (accepted, 3U, "Wrong number of packets accepted");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNBytes (), 900U, "Wrong number of bytes in the queue");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetTotalDroppedPackets (), 7U, "Wrong number of packets dropped");
+}
+
 static class DropTailQueueTestSuite : public TestSuite
 {
 public:
@@ -84,5 +175,6 @@ public:
     : TestSuite ("drop-tail-queue", UNIT)
   {
     AddTestCase (new DropTailQueueTestCase (), TestCase::QUICK);
+    AddTestCase (new DropTailQueueRingTestCase (), TestCase::QUICK);
   }
 } g_dropTailQueueTestSuite;
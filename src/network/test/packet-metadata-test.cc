@@ -821,6 +821,57 @@ PacketMetadataTest::DoRun (void)
                                  p3->GetSize ());
   delete [] buf;
   NS_TEST_EXPECT_MSG_EQ (msg, std::string ("hello world"), "Could not find original data in received packet");
+
+  // Record the metadata of a quarter of the packets only.
+  PacketMetadata::EnableSampling (0.25);
+  uint32_t nSampled = 0;
+  Ptr<Packet> sampled = 0;
+  Ptr<Packet> skipped = 0;
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      p = Create<Packet> (10);
+      ADD_HEADER (p, 2);
+      if (p->BeginItem ().HasNext ())
+        {
+          nSampled++;
+          sampled = p;
+        }
+      else
+        {
+          skipped = p;
+        }
+    }
+  NS_TEST_EXPECT_MSG_GT (nSampled, 150U, "Too few packets sampled");
+  NS_TEST_EXPECT_MSG_LT (nSampled, 350U, "Too many packets sampled");
+  NS_TEST_ASSERT_MSG_EQ ((sampled != 0 && skipped != 0), true, "No sampling");
+
+  // The fragments of a sampled packet are sampled too.
+  CHECK_HISTORY (sampled, 2, 2, 10);
+  p1 = sampled->CreateFragment (0, 7);
+  CHECK_HISTORY (p1, 2, 2, 5);
+
+  // A packet which includes a skipped packet is not sampled.
+  p2 = sampled->Copy ();
+  p2->AddAtEnd (skipped);
+  NS_TEST_EXPECT_MSG_EQ (p2->BeginItem ().HasNext (), false, "Partial metadata recorded");
+  NS_TEST_EXPECT_MSG_EQ (p2->GetSize (), 24U, "Wrong size");
+  CHECK_HISTORY (sampled, 2, 2, 10);
+  REM_HEADER (sampled, 2);
+  CHECK_HISTORY (sampled, 1, 10);
+
+  // Enable records all the packets again.
+  PacketMetadata::Enable ();
+  nSampled = 0;
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      p = Create<Packet> (10);
+      ADD_HEADER (p, 2);
+      if (p->BeginItem ().HasNext ())
+        {
+          nSampled++;
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (nSampled, 1000U, "Sampling not reset by Enable");
 }
 //-----------------------------------------------------------------------------
 class PacketMetadataTestSuite : public TestSuite
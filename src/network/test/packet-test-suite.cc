@@ -675,6 +675,36 @@ PacketTagListTest::DoRun (void)
     ReplaceCheck (7);
   }
   
+  { // Iteration
+    std::cout << GetName () << "check iteration order" << std::endl;
+    Ptr<Packet> p = Create<Packet> (10);
+    p->AddPacketTag (t1);
+    p->AddPacketTag (t2);
+    p->AddPacketTag (t3);
+    p->AddPacketTag (t4);
+    p->AddPacketTag (t5);
+    Ptr<Packet> copy = p->Copy ();
+    p->RemovePacketTag (t3);
+    copy->AddPacketTag (t6);
+    TypeId expected[] = { t5.GetTypeId (), t4.GetTypeId (),
+                          t2.GetTypeId (), t1.GetTypeId () };
+    uint32_t n = 0;
+    PacketTagIterator i = p->GetPacketTagIterator ();
+    while (i.HasNext ())
+      {
+        PacketTagIterator::Item item = i.Next ();
+        NS_TEST_ASSERT_MSG_LT (n, 4U, "too many tags");
+        NS_TEST_EXPECT_MSG_EQ (item.GetTypeId (), expected[n],
+                               "tags are not iterated from the most recent");
+        n++;
+      }
+    NS_TEST_EXPECT_MSG_EQ (n, 4U, "missing tags");
+    NS_TEST_EXPECT_MSG_EQ (copy->PeekPacketTag (t3), true,
+                           "tag removed from the copy of a packet");
+    NS_TEST_EXPECT_MSG_EQ (p->PeekPacketTag (t6), false,
+                           "tag added to the original of a packet");
+  }
+
   { // Timing
     std::cout << GetName () << "add+remove timing" << std::endl;
     int flm = std::numeric_limits<int>::max ();
@@ -25,6 +25,8 @@
 #include "ns3/log.h"
 #include "ns3/test.h"
 #include "ns3/pcap-file.h"
+#include "ns3/pcap-writer.h"
+#include "ns3/packet.h"
 
 using namespace ns3;
 
@@ -956,6 +958,205 @@ RecordHeaderTestCase::DoRun (void)
   f.Close ();
 }
 
+// ===========================================================================
+// Test case to make sure that the pcap files written by PcapWriter, in the
+// background and in batches, can be read back by PcapFile.
+// ===========================================================================
+class PcapWriterTestCase : public TestCase
+{
+public:
+  PcapWriterTestCase ();
+
+private:
+  virtual void DoSetup (void);
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  std::string m_testFilename;
+};
+
+PcapWriterTestCase::PcapWriterTestCase ()
+  : TestCase ("Check that the pcap files written by PcapWriter can be read by PcapFile")
+{
+}
+
+void
+PcapWriterTestCase::DoSetup (void)
+{
+  std::stringstream filename;
+  uint32_t n = rand ();
+  filename << n;
+  m_testFilename = CreateTempDirFilename (filename.str () + ".pcap");
+}
+
+void
+PcapWriterTestCase::DoTeardown (void)
+{
+  if (remove (m_testFilename.c_str ()))
+    {
+      NS_LOG_ERROR ("Failed to delete file " << m_testFilename);
+    }
+}
+
+void
+PcapWriterTestCase::DoRun (void)
+{
+  //
+  // Write enough packets, truncated to the snapshot length, to fill a few
+  // small batches.
+  //
+  Ptr<PcapWriter> writer = Create<PcapWriter> ();
+  writer->Open (m_testFilename, PcapWriter::PCAP, PcapWriter::NONE, true, 256);
+  NS_TEST_ASSERT_MSG_EQ (writer->Fail (), false, "Open (" << m_testFilename << ") returns error");
+  writer->WriteFileHeader (1234, 100, 7);
+
+  uint8_t buffer[128];
+  for (uint32_t i = 0; i < sizeof (buffer); ++i)
+    {
+      buffer[i] = i;
+    }
+  for (uint32_t i = 0; i < 50; ++i)
+    {
+      writer->Write (0, MicroSeconds (1000001 * i), buffer, i * 2 + 20);
+    }
+  writer->Close ();
+  NS_TEST_ASSERT_MSG_EQ (writer->Fail (), false, "Close () returns error");
+
+  PcapFile f;
+  f.Open (m_testFilename, std::ios::in);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Open (" << m_testFilename << ", \"std::ios::in\") returns error");
+  NS_TEST_ASSERT_MSG_EQ (f.GetMagic (), 0xa1b2c3d4, "Wrong magic number");
+  NS_TEST_ASSERT_MSG_EQ (f.GetDataLinkType (), 1234U, "Wrong data link type");
+  NS_TEST_ASSERT_MSG_EQ (f.GetSnapLen (), 100U, "Wrong snapshot length");
+  NS_TEST_ASSERT_MSG_EQ (f.GetTimeZoneOffset (), 7, "Wrong time zone offset");
+
+  uint8_t data[128];
+  uint32_t tsSec, tsUsec, inclLen, origLen, readLen;
+  for (uint32_t i = 0; i < 50; ++i)
+    {
+      f.Read (data, sizeof (data), tsSec, tsUsec, inclLen, origLen, readLen);
+      NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Read () of packet " << i << " returns error");
+      NS_TEST_EXPECT_MSG_EQ (tsSec, i, "Wrong seconds in packet " << i);
+      NS_TEST_EXPECT_MSG_EQ (tsUsec, i, "Wrong microseconds in packet " << i);
+      NS_TEST_EXPECT_MSG_EQ (origLen, i * 2 + 20, "Wrong original length of packet " << i);
+      NS_TEST_EXPECT_MSG_EQ (inclLen, std::min (i * 2 + 20, 100U), "Wrong included length of packet " << i);
+      NS_TEST_EXPECT_MSG_EQ (memcmp (data, buffer, inclLen), 0, "Wrong data in packet " << i);
+    }
+  f.Read (data, sizeof (data), tsSec, tsUsec, inclLen, origLen, readLen);
+  NS_TEST_EXPECT_MSG_EQ (f.Eof (), true, "Read () past the last packet does not return EOF");
+  f.Close ();
+
+  if (PcapWriter::IsGzipAvailable ())
+    {
+      writer = Create<PcapWriter> ();
+      writer->Open (m_testFilename, PcapWriter::PCAP, PcapWriter::GZIP, true, 256);
+      writer->WriteFileHeader (1234, 100, 7);
+      writer->Write (0, Seconds (1), buffer, sizeof (buffer));
+      writer->Close ();
+      NS_TEST_ASSERT_MSG_EQ (writer->Fail (), false, "Close () of a compressed file returns error");
+
+      FILE *file = fopen (m_testFilename.c_str (), "rb");
+      NS_TEST_ASSERT_MSG_NE (file, 0, "Unable to open the compressed file");
+      uint8_t magic[2] = { 0, 0 };
+      size_t read = fread (magic, 1, 2, file);
+      fclose (file);
+      NS_TEST_EXPECT_MSG_EQ (read, 2U, "The compressed file is empty");
+      NS_TEST_EXPECT_MSG_EQ ((magic[0] == 0x1f && magic[1] == 0x8b), true, "The file is not compressed with gzip");
+    }
+}
+
+// ===========================================================================
+// Test case to make sure that the packets of several interfaces are
+// multiplexed in the blocks of a single pcapng file.
+// ===========================================================================
+class PcapngWriterTestCase : public TestCase
+{
+public:
+  PcapngWriterTestCase ();
+
+private:
+  virtual void DoSetup (void);
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  std::string m_testFilename;
+};
+
+PcapngWriterTestCase::PcapngWriterTestCase ()
+  : TestCase ("Check the blocks of the pcapng files written by PcapWriter")
+{
+}
+
+void
+PcapngWriterTestCase::DoSetup (void)
+{
+  std::stringstream filename;
+  uint32_t n = rand ();
+  filename << n;
+  m_testFilename = CreateTempDirFilename (filename.str () + ".pcapng");
+}
+
+void
+PcapngWriterTestCase::DoTeardown (void)
+{
+  if (remove (m_testFilename.c_str ()))
+    {
+      NS_LOG_ERROR ("Failed to delete file " << m_testFilename);
+    }
+}
+
+void
+PcapngWriterTestCase::DoRun (void)
+{
+  Ptr<PcapWriter> writer = Create<PcapWriter> ();
+  writer->Open (m_testFilename, PcapWriter::PCAPNG, PcapWriter::NONE, false, 4096);
+  NS_TEST_ASSERT_MSG_EQ (writer->Fail (), false, "Open (" << m_testFilename << ") returns error");
+  NS_TEST_EXPECT_MSG_EQ (writer->AddInterface (1, 65535, "n0-d0"), 0U, "Wrong first interface identifier");
+  NS_TEST_EXPECT_MSG_EQ (writer->AddInterface (105, 10, "n1-wifi"), 1U, "Wrong second interface identifier");
+
+  Ptr<Packet> p = Create<Packet> (13);
+  writer->Write (0, MicroSeconds (5), 0, p);
+  writer->Write (1, Seconds (5000), 0, p);
+  writer->Close ();
+  NS_TEST_ASSERT_MSG_EQ (writer->Fail (), false, "Close () returns error");
+
+  //
+  // Walk the blocks of the file: a section header, two interface
+  // descriptions and two enhanced packets, each ending with its length.
+  //
+  FILE *file = fopen (m_testFilename.c_str (), "rb");
+  NS_TEST_ASSERT_MSG_NE (file, 0, "Unable to open " << m_testFilename);
+  uint32_t expectedTypes[] = { 0x0a0d0d0a, 1, 1, 6, 6 };
+  uint32_t expectedInterfaces[] = { 0, 1 };
+  uint32_t expectedCaptured[] = { 13, 10 };
+  uint64_t expectedTimes[] = { 5, 5000000000ULL };
+  for (uint32_t i = 0; i < 5; ++i)
+    {
+      uint32_t header[2];
+      NS_TEST_ASSERT_MSG_EQ (fread (header, 4, 2, file), 2U, "Missing block " << i);
+      NS_TEST_EXPECT_MSG_EQ (header[0], expectedTypes[i], "Wrong type of block " << i);
+      NS_TEST_ASSERT_MSG_EQ (header[1] % 4, 0U, "Block " << i << " is not aligned");
+      std::vector<uint32_t> body ((header[1] - 8) / 4);
+      NS_TEST_ASSERT_MSG_EQ (fread (&body[0], 4, body.size (), file), body.size (), "Truncated block " << i);
+      NS_TEST_EXPECT_MSG_EQ (body.back (), header[1], "Wrong trailing length of block " << i);
+      if (i == 0)
+        {
+          NS_TEST_EXPECT_MSG_EQ (body[0], 0x1a2b3c4dU, "Wrong byte order magic");
+        }
+      if (i >= 3)
+        {
+          NS_TEST_EXPECT_MSG_EQ (body[0], expectedInterfaces[i - 3], "Wrong interface of packet " << i - 3);
+          uint64_t us = (static_cast<uint64_t> (body[1]) << 32) | body[2];
+          NS_TEST_EXPECT_MSG_EQ (us, expectedTimes[i - 3], "Wrong time stamp of packet " << i - 3);
+          NS_TEST_EXPECT_MSG_EQ (body[3], expectedCaptured[i - 3], "Wrong captured length of packet " << i - 3);
+          NS_TEST_EXPECT_MSG_EQ (body[4], 13U, "Wrong original length of packet " << i - 3);
+        }
+    }
+  uint8_t extra;
+  NS_TEST_EXPECT_MSG_EQ (fread (&extra, 1, 1, file), 0U, "Unexpected data after the last block");
+  fclose (file);
+}
+
 // ===========================================================================
 // Test case to make sure that the Pcap File Object can read out the contents
 // of a known good pcap file.
@@ -1135,6 +1336,8 @@ PcapFileTestSuite::PcapFileTestSuite ()
   //AddTestCase (new AppendModeCreateTestCase, TestCase::QUICK);
   AddTestCase (new FileHeaderTestCase, TestCase::QUICK);
   AddTestCase (new RecordHeaderTestCase, TestCase::QUICK);
+  AddTestCase (new PcapWriterTestCase, TestCase::QUICK);
+  AddTestCase (new PcapngWriterTestCase, TestCase::QUICK);
   AddTestCase (new ReadFileTestCase, TestCase::QUICK);
   AddTestCase (new DiffTestCase, TestCase::QUICK);
 }
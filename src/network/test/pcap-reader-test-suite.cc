@@ -0,0 +1,431 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <vector>
+
+#include "ns3/log.h"
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/pcap-file.h"
+#include "ns3/pcap-writer.h"
+#include "ns3/pcap-reader.h"
+#include "ns3/pcap-replay.h"
+#include "ns3/mac48-address.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-channel.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("PcapReaderTestSuite");
+
+/**
+ * \param extension the extension of the file name
+ * \returns a file name built from a random number.
+ */
+static std::string
+RandomFilename (std::string const &extension)
+{
+  std::stringstream filename;
+  filename << rand () << extension;
+  return filename.str ();
+}
+
+/**
+ * Write a 32-bit value in big endian byte order.
+ * \param file the file.
+ * \param v the value.
+ */
+static void
+WriteBigEndian32 (FILE *file, uint32_t v)
+{
+  uint8_t bytes[4] = { uint8_t (v >> 24), uint8_t (v >> 16), uint8_t (v >> 8), uint8_t (v) };
+  fwrite (bytes, 1, 4, file);
+}
+
+/**
+ * Write a big endian pcapng file with one interface and one packet.
+ * \param filename the name of the file.
+ * \param resolution the if_tsresol option of the interface.
+ */
+static void
+WritePcapng (std::string const &filename, uint8_t resolution)
+{
+  FILE *file = fopen (filename.c_str (), "wb");
+  uint32_t blocks[] = {
+    // section header
+    0x0a0d0d0a, 28, 0x1a2b3c4d, 0x00010000, 0xffffffff, 0xffffffff, 28,
+    // interface description, with the if_tsresol option
+    0x00000001, 32, 0x00010000, 65535, 0x00090001, uint32_t (resolution) << 24, 0, 32,
+    // enhanced packet of 4 bytes
+    0x00000006, 36, 0, 0, 1000, 4, 4, 0x01020304, 36
+  };
+  for (uint32_t i = 0; i < sizeof (blocks) / sizeof (blocks[0]); ++i)
+    {
+      WriteBigEndian32 (file, blocks[i]);
+    }
+  fclose (file);
+}
+
+// ===========================================================================
+// Test case to make sure that PcapReader returns the records of pcap files,
+// in both byte orders and time stamp resolutions.
+// ===========================================================================
+class PcapReaderPcapTestCase : public TestCase
+{
+public:
+  PcapReaderPcapTestCase ();
+
+private:
+  virtual void DoSetup (void);
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  std::string m_testFilename;
+};
+
+PcapReaderPcapTestCase::PcapReaderPcapTestCase ()
+  : TestCase ("Check that PcapReader reads pcap files")
+{
+}
+
+void
+PcapReaderPcapTestCase::DoSetup (void)
+{
+  m_testFilename = CreateTempDirFilename (RandomFilename (".pcap"));
+}
+
+void
+PcapReaderPcapTestCase::DoTeardown (void)
+{
+  if (remove (m_testFilename.c_str ()))
+    {
+      NS_LOG_ERROR ("Failed to delete file " << m_testFilename);
+    }
+}
+
+void
+PcapReaderPcapTestCase::DoRun (void)
+{
+  uint8_t buffer[100];
+  for (uint32_t i = 0; i < sizeof (buffer); ++i)
+    {
+      buffer[i] = i;
+    }
+  PcapFile f;
+  f.Open (m_testFilename, std::ios::out);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Open (" << m_testFilename << ") returns error");
+  f.Init (1, 64);
+  f.Write (1, 2, buffer, 10);
+  f.Write (3, 999999, buffer, 100);
+  f.Write (4, 0, buffer, 0);
+  f.Close ();
+
+  Ptr<PcapReader> reader = Create<PcapReader> ();
+  reader->Open (m_testFilename);
+  NS_TEST_ASSERT_MSG_EQ (reader->Fail (), false, "Open (" << m_testFilename << ") returns error");
+  NS_TEST_EXPECT_MSG_EQ (reader->IsPcapng (), false, "A pcap file is read as a pcapng file");
+  NS_TEST_ASSERT_MSG_EQ (reader->GetNInterfaces (), 1U, "Wrong number of interfaces");
+  NS_TEST_EXPECT_MSG_EQ (reader->GetInterface (0).dataLinkType, 1U, "Wrong data link type");
+  NS_TEST_EXPECT_MSG_EQ (reader->GetInterface (0).snapLen, 64U, "Wrong snapshot length");
+
+  Time times[] = { MicroSeconds (1000002), MicroSeconds (3999999), Seconds (4) };
+  uint32_t inclLens[] = { 10, 64, 0 };
+  uint32_t origLens[] = { 10, 100, 0 };
+  uint32_t n = 0;
+  for (PcapReader::Iterator i = reader->Begin (); i != reader->End (); ++i, ++n)
+    {
+      NS_TEST_ASSERT_MSG_LT (n, 3U, "Too many records");
+      NS_TEST_EXPECT_MSG_EQ (i->timestamp, times[n], "Wrong time stamp of record " << n);
+      NS_TEST_EXPECT_MSG_EQ (i->interface, 0U, "Wrong interface of record " << n);
+      NS_TEST_EXPECT_MSG_EQ (i->dataLinkType, 1U, "Wrong data link type of record " << n);
+      NS_TEST_EXPECT_MSG_EQ (i->inclLen, inclLens[n], "Wrong included length of record " << n);
+      NS_TEST_EXPECT_MSG_EQ (i->origLen, origLens[n], "Wrong original length of record " << n);
+      NS_TEST_EXPECT_MSG_EQ (memcmp (i->data, buffer, i->inclLen), 0, "Wrong data in record " << n);
+    }
+  NS_TEST_EXPECT_MSG_EQ (n, 3U, "Wrong number of records");
+  reader->Close ();
+
+  //
+  // A big endian file, with nanosecond time stamps and a truncated
+  // last record.
+  //
+  FILE *file = fopen (m_testFilename.c_str (), "wb");
+  NS_TEST_ASSERT_MSG_NE (file, 0, "Unable to create " << m_testFilename);
+  WriteBigEndian32 (file, 0xa1b23c4d);
+  WriteBigEndian32 (file, 0x00020004);
+  WriteBigEndian32 (file, 0);
+  WriteBigEndian32 (file, 0);
+  WriteBigEndian32 (file, 65535);
+  WriteBigEndian32 (file, 101);
+  WriteBigEndian32 (file, 2);
+  WriteBigEndian32 (file, 500);
+  WriteBigEndian32 (file, 4);
+  WriteBigEndian32 (file, 4);
+  WriteBigEndian32 (file, 0x45000004);
+  WriteBigEndian32 (file, 3);
+  WriteBigEndian32 (file, 0);
+  WriteBigEndian32 (file, 8);
+  WriteBigEndian32 (file, 8);
+  WriteBigEndian32 (file, 0x45000008);
+  fclose (file);
+
+  reader->Open (m_testFilename);
+  NS_TEST_ASSERT_MSG_EQ (reader->Fail (), false, "Open (" << m_testFilename << ") returns error");
+  NS_TEST_EXPECT_MSG_EQ (reader->GetInterface (0).dataLinkType, 101U, "Wrong data link type");
+  PcapReader::Iterator i = reader->Begin ();
+  NS_TEST_ASSERT_MSG_EQ ((i != reader->End ()), true, "Missing record");
+  NS_TEST_EXPECT_MSG_EQ (i->timestamp, NanoSeconds (2000000500), "Wrong time stamp");
+  NS_TEST_EXPECT_MSG_EQ (i->inclLen, 4U, "Wrong included length");
+  NS_TEST_EXPECT_MSG_EQ (i->data[0], 0x45, "Wrong data");
+  ++i;
+  NS_TEST_EXPECT_MSG_EQ ((i == reader->End ()), true, "The truncated record is returned");
+}
+
+// ===========================================================================
+// Test case to make sure that PcapReader returns the records of pcapng
+// files, with the interfaces they belong to.
+// ===========================================================================
+class PcapReaderPcapngTestCase : public TestCase
+{
+public:
+  PcapReaderPcapngTestCase ();
+
+private:
+  virtual void DoSetup (void);
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  std::string m_testFilename;
+};
+
+PcapReaderPcapngTestCase::PcapReaderPcapngTestCase ()
+  : TestCase ("Check that PcapReader reads pcapng files")
+{
+}
+
+void
+PcapReaderPcapngTestCase::DoSetup (void)
+{
+  m_testFilename = CreateTempDirFilename (RandomFilename (".pcapng"));
+}
+
+void
+PcapReaderPcapngTestCase::DoTeardown (void)
+{
+  if (remove (m_testFilename.c_str ()))
+    {
+      NS_LOG_ERROR ("Failed to delete file " << m_testFilename);
+    }
+}
+
+void
+PcapReaderPcapngTestCase::DoRun (void)
+{
+  Ptr<PcapWriter> writer = Create<PcapWriter> ();
+  writer->Open (m_testFilename, PcapWriter::PCAPNG, PcapWriter::NONE, false, 4096);
+  NS_TEST_ASSERT_MSG_EQ (writer->Fail (), false, "Open (" << m_testFilename << ") returns error");
+  writer->AddInterface (1, 65535, "n0-d0");
+  writer->AddInterface (105, 10, "n1-wifi");
+  uint8_t buffer[13];
+  for (uint32_t i = 0; i < sizeof (buffer); ++i)
+    {
+      buffer[i] = i;
+    }
+  writer->Write (0, MicroSeconds (5), buffer, 13);
+  writer->Write (1, Seconds (5000), buffer, 13);
+  writer->Write (0, Seconds (5001), buffer, 1);
+  writer->Close ();
+
+  Ptr<PcapReader> reader = Create<PcapReader> ();
+  reader->Open (m_testFilename);
+  NS_TEST_ASSERT_MSG_EQ (reader->Fail (), false, "Open (" << m_testFilename << ") returns error");
+  NS_TEST_EXPECT_MSG_EQ (reader->IsPcapng (), true, "A pcapng file is read as a pcap file");
+  NS_TEST_ASSERT_MSG_EQ (reader->GetNInterfaces (), 2U, "Wrong number of interfaces");
+  NS_TEST_EXPECT_MSG_EQ (reader->GetInterface (1).dataLinkType, 105U, "Wrong data link type");
+  NS_TEST_EXPECT_MSG_EQ (reader->GetInterface (1).snapLen, 10U, "Wrong snapshot length");
+
+  Time times[] = { MicroSeconds (5), Seconds (5000), Seconds (5001) };
+  uint32_t interfaces[] = { 0, 1, 0 };
+  uint32_t dataLinkTypes[] = { 1, 105, 1 };
+  uint32_t inclLens[] = { 13, 10, 1 };
+  uint32_t origLens[] = { 13, 13, 1 };
+  uint32_t n = 0;
+  for (PcapReader::Iterator i = reader->Begin (); i != reader->End (); ++i, ++n)
+    {
+      NS_TEST_ASSERT_MSG_LT (n, 3U, "Too many records");
+      NS_TEST_EXPECT_MSG_EQ (i->timestamp, times[n], "Wrong time stamp of record " << n);
+      NS_TEST_EXPECT_MSG_EQ (i->interface, interfaces[n], "Wrong interface of record " << n);
+      NS_TEST_EXPECT_MSG_EQ (i->dataLinkType, dataLinkTypes[n], "Wrong data link type of record " << n);
+      NS_TEST_EXPECT_MSG_EQ (i->inclLen, inclLens[n], "Wrong included length of record " << n);
+      NS_TEST_EXPECT_MSG_EQ (i->origLen, origLens[n], "Wrong original length of record " << n);
+      NS_TEST_EXPECT_MSG_EQ (memcmp (i->data, buffer, i->inclLen), 0, "Wrong data in record " << n);
+    }
+  NS_TEST_EXPECT_MSG_EQ (n, 3U, "Wrong number of records");
+
+  // A resolution of 2^-10 s.
+  WritePcapng (m_testFilename, 0x80 | 10);
+  reader->Open (m_testFilename);
+  NS_TEST_ASSERT_MSG_EQ (reader->Fail (), false, "Valid time stamp resolution rejected");
+  NS_TEST_EXPECT_MSG_EQ (reader->Begin ()->timestamp, Seconds (1000.0 / 1024), "Wrong time stamp");
+  // Resolutions whose units do not fit in 64 bits.
+  uint8_t invalid[] = { 0x80 | 64, 0x80 | 127, 20 };
+  for (uint32_t i = 0; i < sizeof (invalid); ++i)
+    {
+      WritePcapng (m_testFilename, invalid[i]);
+      reader->Open (m_testFilename);
+      NS_TEST_EXPECT_MSG_EQ (reader->Fail (), true, "Invalid time stamp resolution " << uint32_t (invalid[i]) << " accepted");
+      NS_TEST_EXPECT_MSG_EQ ((reader->Begin () == reader->End ()), true, "Records read with an invalid resolution");
+    }
+  reader->Close ();
+}
+
+// ===========================================================================
+// Test case to make sure that PcapReplay sends the packets of a capture
+// through a device, at their recorded times.
+// ===========================================================================
+class PcapReplayTestCase : public TestCase
+{
+public:
+  PcapReplayTestCase ();
+
+private:
+  virtual void DoSetup (void);
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+  /**
+   * Receive a packet.
+   * \param device the receiving device.
+   * \param p the packet.
+   * \param protocol the protocol of the packet.
+   * \param from the sender of the packet.
+   * \returns true.
+   */
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from);
+
+  std::string m_testFilename;
+  std::vector<Time> m_times;
+  std::vector<uint32_t> m_sizes;
+  std::vector<uint16_t> m_protocols;
+};
+
+PcapReplayTestCase::PcapReplayTestCase ()
+  : TestCase ("Check that PcapReplay sends the packets of a capture at their times")
+{
+}
+
+void
+PcapReplayTestCase::DoSetup (void)
+{
+  m_testFilename = CreateTempDirFilename (RandomFilename (".pcap"));
+}
+
+void
+PcapReplayTestCase::DoTeardown (void)
+{
+  if (remove (m_testFilename.c_str ()))
+    {
+      NS_LOG_ERROR ("Failed to delete file " << m_testFilename);
+    }
+}
+
+bool
+PcapReplayTestCase::Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from)
+{
+  m_times.push_back (Simulator::Now ());
+  m_sizes.push_back (p->GetSize ());
+  m_protocols.push_back (protocol);
+  return true;
+}
+
+void
+PcapReplayTestCase::DoRun (void)
+{
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Ptr<SimpleNetDevice> input = CreateObject<SimpleNetDevice> ();
+  Ptr<SimpleNetDevice> output = CreateObject<SimpleNetDevice> ();
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  a->AddDevice (input);
+  b->AddDevice (output);
+  input->SetAddress (Mac48Address::Allocate ());
+  input->SetChannel (channel);
+  output->SetAddress (Mac48Address::Allocate ());
+  output->SetChannel (channel);
+  output->SetReceiveCallback (MakeCallback (&PcapReplayTestCase::Receive, this));
+
+  //
+  // Three Ethernet frames to the output device, the second one truncated
+  // by the capture, and a frame to another device.
+  //
+  uint8_t frame[100];
+  memset (frame, 0, sizeof (frame));
+  Mac48Address::ConvertFrom (output->GetAddress ()).CopyTo (frame);
+  Mac48Address::ConvertFrom (input->GetAddress ()).CopyTo (frame + 6);
+  frame[12] = 0x08;
+  frame[13] = 0x00;
+  PcapFile f;
+  f.Open (m_testFilename, std::ios::out);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Open (" << m_testFilename << ") returns error");
+  f.Init (1, 64);
+  f.Write (1000, 0, frame, 20);
+  f.Write (1000, 500000, frame, 100);
+  f.Write (1002, 0, frame, 50);
+  Mac48Address::Allocate ().CopyTo (frame);
+  f.Write (1002, 100, frame, 50);
+  f.Close ();
+
+  Ptr<PcapReplay> replay = CreateObject<PcapReplay> ();
+  replay->SetAttribute ("Filename", StringValue (m_testFilename));
+  replay->SetDevice (input);
+  a->AddApplication (replay);
+  replay->SetStartTime (Seconds (2));
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (replay->GetSent (), 4U, "Wrong number of packets sent");
+  NS_TEST_ASSERT_MSG_EQ (m_times.size (), 3U, "Wrong number of packets received");
+  NS_TEST_EXPECT_MSG_EQ (m_times[0], Seconds (2), "Wrong time of the first packet");
+  NS_TEST_EXPECT_MSG_EQ (m_times[1], Seconds (2.5), "Wrong time of the second packet");
+  NS_TEST_EXPECT_MSG_EQ (m_times[2], Seconds (4), "Wrong time of the third packet");
+  NS_TEST_EXPECT_MSG_EQ (m_sizes[0], 6U, "Wrong size of the first packet");
+  NS_TEST_EXPECT_MSG_EQ (m_sizes[1], 86U, "Wrong size of the truncated packet");
+  NS_TEST_EXPECT_MSG_EQ (m_sizes[2], 36U, "Wrong size of the third packet");
+  NS_TEST_EXPECT_MSG_EQ (m_protocols[0], 0x0800, "Wrong protocol");
+}
+
+class PcapReaderTestSuite : public TestSuite
+{
+public:
+  PcapReaderTestSuite ();
+};
+
+PcapReaderTestSuite::PcapReaderTestSuite ()
+  : TestSuite ("pcap-reader", UNIT)
+{
+  AddTestCase (new PcapReaderPcapTestCase, TestCase::QUICK);
+  AddTestCase (new PcapReaderPcapngTestCase, TestCase::QUICK);
+  AddTestCase (new PcapReplayTestCase, TestCase::QUICK);
+}
+
+static PcapReaderTestSuite pcapReaderTestSuite;
@@ -0,0 +1,133 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/drop-tail-queue.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+/**
+ * Check the fluid work, delay and loss of a queue while a fluid source
+ * overloads its link, then stops.
+ */
+class QueueFluidTestCase : public TestCase
+{
+public:
+  QueueFluidTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Check the state of the queue.
+   * \param backlog the expected work, in bytes
+   * \param loss the expected loss ratio
+   */
+  void Check (double backlog, double loss);
+  /**
+   * \brief Enqueue and dequeue a packet.
+   * \param enqueued true if the packet should be enqueued
+   * \param wait the expected wait of the packet
+   */
+  void SendPacket (bool enqueued, Time wait);
+
+  Ptr<Queue> m_queue; //!< The queue.
+};
+
+QueueFluidTestCase::QueueFluidTestCase ()
+  : TestCase ("Check the fluid work of a queue")
+{
+}
+
+void
+QueueFluidTestCase::Check (double backlog, double loss)
+{
+  NS_TEST_EXPECT_MSG_EQ_TOL (m_queue->GetFluidBacklog (), backlog, 1, "Wrong fluid work at " << Simulator::Now ());
+  NS_TEST_EXPECT_MSG_EQ_TOL (m_queue->GetFluidLossRatio (), loss, 1e-9, "Wrong fluid loss at " << Simulator::Now ());
+  NS_TEST_EXPECT_MSG_EQ_TOL (m_queue->GetFluidDelay ().GetSeconds (), backlog / 1e6, 1e-6,
+                             "Wrong fluid delay at " << Simulator::Now ());
+}
+
+void
+QueueFluidTestCase::SendPacket (bool enqueued, Time wait)
+{
+  uint32_t dropped = m_queue->GetTotalDroppedPackets ();
+  NS_TEST_EXPECT_MSG_EQ (m_queue->Enqueue (Create<Packet> (1000)), enqueued, "Wrong enqueue at " << Simulator::Now ());
+  if (!enqueued)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_queue->GetTotalDroppedPackets (), dropped + 1, "Drop not counted");
+      return;
+    }
+  NS_TEST_EXPECT_MSG_NE (m_queue->Dequeue (), 0, "Packet not dequeued");
+  NS_TEST_EXPECT_MSG_EQ_TOL (m_queue->GetFluidWait ().GetSeconds (), wait.GetSeconds (), 1e-6,
+                             "Wrong wait at " << Simulator::Now ());
+}
+
+void
+QueueFluidTestCase::DoRun (void)
+{
+  m_queue = CreateObject<DropTailQueue> ();
+  m_queue->SetAttribute ("MaxPackets", UintegerValue (1000));
+  m_queue->SetAttribute ("FluidMaxBytes", DoubleValue (100000));
+
+  // Without a link, the fluid is ignored.
+  NS_TEST_ASSERT_MSG_EQ (m_queue->GetFluidLinkRate (), DataRate (0), "Fluid link rate set by default");
+  m_queue->AddFluidRate (DataRate ("12Mb/s"));
+  Simulator::Schedule (Seconds (0.1), &QueueFluidTestCase::Check, this, 0, 0);
+  Simulator::Run ();
+  m_queue->RemoveFluidRate (DataRate ("12Mb/s"));
+  Simulator::Destroy ();
+
+  // A link of 1 MB/s, overloaded by 0.5 MB/s during 0.3 s.
+  m_queue->SetFluidLinkRate (DataRate ("8Mb/s"));
+  NS_TEST_ASSERT_MSG_EQ (m_queue->GetFluidLinkRate (), DataRate ("8Mb/s"), "Wrong fluid link rate");
+  m_queue->AddFluidRate (DataRate ("4Mb/s"));
+  m_queue->AddFluidRate (DataRate ("8Mb/s"));
+  Simulator::Schedule (Seconds (0.1), &QueueFluidTestCase::Check, this, 50000, 0);
+  Simulator::Schedule (Seconds (0.1), &QueueFluidTestCase::SendPacket, this, true, Seconds (0.05));
+  Simulator::Schedule (Seconds (0.2), &QueueFluidTestCase::Check, this, 100000, 1.0 / 3);
+  // One packet in three is lost, as the fluid.
+  Simulator::Schedule (Seconds (0.3), &QueueFluidTestCase::SendPacket, this, true, Seconds (0.1));
+  Simulator::Schedule (Seconds (0.3), &QueueFluidTestCase::SendPacket, this, true, Seconds (0.1));
+  Simulator::Schedule (Seconds (0.3), &QueueFluidTestCase::SendPacket, this, false, Seconds (0));
+  Simulator::Schedule (Seconds (0.3), &Queue::RemoveFluidRate, m_queue, DataRate ("8Mb/s"));
+  Simulator::Schedule (Seconds (0.4), &QueueFluidTestCase::Check, this, 50000, 0);
+  Simulator::Schedule (Seconds (0.4), &Queue::RemoveFluidRate, m_queue, DataRate ("4Mb/s"));
+  Simulator::Schedule (Seconds (0.43), &QueueFluidTestCase::Check, this, 20000, 0);
+  Simulator::Schedule (Seconds (0.5), &QueueFluidTestCase::Check, this, 0, 0);
+  Simulator::Schedule (Seconds (0.5), &QueueFluidTestCase::SendPacket, this, true, Seconds (0));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_queue->GetFluidRate (), DataRate (0), "Fluid left in the queue");
+  NS_TEST_ASSERT_MSG_EQ (m_queue->GetTotalDroppedPackets (), 1U, "Wrong number of drops");
+  m_queue = 0;
+}
+
+/**
+ * Queue fluid model TestSuite
+ */
+static class QueueFluidTestSuite : public TestSuite
+{
+public:
+  QueueFluidTestSuite ()
+    : TestSuite ("queue-fluid", UNIT)
+  {
+    AddTestCase (new QueueFluidTestCase, TestCase::QUICK);
+  }
+} g_queueFluidTestSuite;
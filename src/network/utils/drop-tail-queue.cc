@@ -16,6 +16,7 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
 #include "ns3/log.h"
 #include "ns3/enum.h"
 #include "ns3/uinteger.h"
@@ -56,7 +57,8 @@ TypeId DropTailQueue::GetTypeId (void)
 
 DropTailQueue::DropTailQueue () :
   Queue (),
-  m_packets (),
+  m_head (0),
+  m_count (0),
   m_bytesInQueue (0)
 {
   NS_LOG_FUNCTION (this);
@@ -65,6 +67,10 @@ DropTailQueue::DropTailQueue () :
 DropTailQueue::~DropTailQueue ()
 {
   NS_LOG_FUNCTION (this);
+  while (m_count > 0)
+    {
+      Pop ();
+    }
 }
 
 void
@@ -86,7 +92,7 @@ DropTailQueue::DoEnqueue (Ptr<Packet> p)
 {
   NS_LOG_FUNCTION (this << p);
 
-  if (m_mode == QUEUE_MODE_PACKETS && (m_packets.size () >= m_maxPackets))
+  if (m_mode == QUEUE_MODE_PACKETS && (m_count >= m_maxPackets))
     {
       NS_LOG_LOGIC ("Queue full (at max packets) -- droppping pkt");
       Drop (p);
@@ -100,10 +106,16 @@ DropTailQueue::DoEnqueue (Ptr<Packet> p)
       return false;
     }
 
+  if (m_count == m_ring.size ())
+    {
+      Grow ();
+    }
+  p->Ref ();
+  m_ring[(m_head + m_count) & (m_ring.size () - 1)] = PeekPointer (p);
+  m_count++;
   m_bytesInQueue += p->GetSize ();
-  m_packets.push (p);
 
-  NS_LOG_LOGIC ("Number packets " << m_packets.size ());
+  NS_LOG_LOGIC ("Number packets " << m_count);
   NS_LOG_LOGIC ("Number bytes " << m_bytesInQueue);
 
   return true;
@@ -114,42 +126,90 @@ DropTailQueue::DoDequeue (void)
 {
   NS_LOG_FUNCTION (this);
 
-  if (m_packets.empty ())
+  if (m_count == 0)
     {
       NS_LOG_LOGIC ("Queue empty");
       return 0;
     }
 
-  Ptr<Packet> p = m_packets.front ();
-  m_packets.pop ();
-  m_bytesInQueue -= p->GetSize ();
+  Ptr<Packet> p = Pop ();
 
   NS_LOG_LOGIC ("Popped " << p);
 
-  NS_LOG_LOGIC ("Number packets " << m_packets.size ());
+  NS_LOG_LOGIC ("Number packets " << m_count);
   NS_LOG_LOGIC ("Number bytes " << m_bytesInQueue);
 
   return p;
 }
 
+uint32_t
+DropTailQueue::DoDequeueBatch (std::vector<Ptr<Packet> > &packets, uint32_t maxPackets)
+{
+  NS_LOG_FUNCTION (this << maxPackets);
+
+  uint32_t n = std::min (maxPackets, m_count);
+  packets.reserve (packets.size () + n);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      packets.push_back (Pop ());
+    }
+
+  NS_LOG_LOGIC ("Popped " << n << " packets");
+
+  NS_LOG_LOGIC ("Number packets " << m_count);
+  NS_LOG_LOGIC ("Number bytes " << m_bytesInQueue);
+
+  return n;
+}
+
 Ptr<const Packet>
 DropTailQueue::DoPeek (void) const
 {
   NS_LOG_FUNCTION (this);
 
-  if (m_packets.empty ())
+  if (m_count == 0)
     {
       NS_LOG_LOGIC ("Queue empty");
       return 0;
     }
 
-  Ptr<Packet> p = m_packets.front ();
+  Ptr<Packet> p = m_ring[m_head];
 
-  NS_LOG_LOGIC ("Number packets " << m_packets.size ());
+  NS_LOG_LOGIC ("Number packets " << m_count);
   NS_LOG_LOGIC ("Number bytes " << m_bytesInQueue);
 
   return p;
 }
 
+void
+DropTailQueue::Grow (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  // The capacity stays a power of two, so that indexes wrap with a mask.
+  std::vector<Packet *> ring (m_ring.empty () ? 16 : 2 * m_ring.size ());
+  for (uint32_t i = 0; i < m_count; i++)
+    {
+      ring[i] = m_ring[(m_head + i) & (m_ring.size () - 1)];
+    }
+  m_ring.swap (ring);
+  m_head = 0;
+
+  NS_LOG_LOGIC ("Capacity " << m_ring.size ());
+}
+
+Ptr<Packet>
+DropTailQueue::Pop (void)
+{
+  NS_ASSERT (m_count > 0);
+  // Take over the reference held by the ring.
+  Ptr<Packet> p = Ptr<Packet> (m_ring[m_head], false);
+  m_ring[m_head] = 0;
+  m_head = (m_head + 1) & (m_ring.size () - 1);
+  m_count--;
+  m_bytesInQueue -= p->GetSize ();
+  return p;
+}
+
 } // namespace ns3
 
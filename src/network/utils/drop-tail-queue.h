@@ -19,7 +19,7 @@
 #ifndef DROPTAIL_H
 #define DROPTAIL_H
 
-#include <queue>
+#include <vector>
 #include "ns3/packet.h"
 #include "ns3/queue.h"
 
@@ -31,6 +31,10 @@ class TraceContainer;
  * \ingroup queue
  *
  * \brief A FIFO packet queue that drops tail-end packets on overflow
+ *
+ * The packets are stored in a ring buffer which grows, by doubling,
+ * up to the number of packets the queue has held at once: once it is
+ * large enough, enqueuing and dequeuing packets allocates no memory.
  */
 class DropTailQueue : public Queue {
 public:
@@ -66,9 +70,22 @@ public:
 private:
   virtual bool DoEnqueue (Ptr<Packet> p);
   virtual Ptr<Packet> DoDequeue (void);
+  virtual uint32_t DoDequeueBatch (std::vector<Ptr<Packet> > &packets, uint32_t maxPackets);
   virtual Ptr<const Packet> DoPeek (void) const;
 
-  std::queue<Ptr<Packet> > m_packets; //!< the packets in the queue
+  /**
+   * Double the capacity of the ring buffer.
+   */
+  void Grow (void);
+  /**
+   * Remove the packet at the front of the ring buffer.
+   * \return the packet
+   */
+  Ptr<Packet> Pop (void);
+
+  std::vector<Packet *> m_ring;       //!< the packets in the queue, each holding a reference
+  uint32_t m_head;                    //!< index of the front packet in m_ring
+  uint32_t m_count;                   //!< number of packets in m_ring
   uint32_t m_maxPackets;              //!< max packets in the queue
   uint32_t m_maxBytes;                //!< max bytes in the queue
   uint32_t m_bytesInQueue;            //!< actual bytes in the queue
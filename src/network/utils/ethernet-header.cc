@@ -161,29 +161,34 @@ EthernetHeader::Serialize (Buffer::Iterator start) const
 {
   NS_LOG_FUNCTION (this << &start);
   Buffer::Iterator i = start;
+  uint8_t *buffer = i.WriteSpan (GetSerializedSize ());
 
   if (m_enPreambleSfd)
     {
-      i.WriteU64 (m_preambleSfd);
+      Buffer::WriteLsb (buffer, m_preambleSfd, PREAMBLE_SIZE);
+      buffer += PREAMBLE_SIZE;
     }
-  WriteTo (i, m_destination);
-  WriteTo (i, m_source);
-  i.WriteHtonU16 (m_lengthType);
+  m_destination.CopyTo (buffer);
+  m_source.CopyTo (buffer + MAC_ADDR_SIZE);
+  Buffer::WriteMsb (buffer + 2 * MAC_ADDR_SIZE, m_lengthType, LENGTH_SIZE);
 }
 uint32_t
 EthernetHeader::Deserialize (Buffer::Iterator start)
 {
   NS_LOG_FUNCTION (this << &start);
   Buffer::Iterator i = start;
+  uint8_t scratch[PREAMBLE_SIZE + LENGTH_SIZE + 2 * MAC_ADDR_SIZE];
+  uint8_t const *buffer = i.ReadSpan (scratch, GetSerializedSize ());
 
   if (m_enPreambleSfd)
     {
-      m_enPreambleSfd = i.ReadU64 ();
+      m_preambleSfd = Buffer::ReadLsb (buffer, PREAMBLE_SIZE);
+      buffer += PREAMBLE_SIZE;
     }
 
-  ReadFrom (i, m_destination);
-  ReadFrom (i, m_source);
-  m_lengthType = i.ReadNtohU16 ();
+  m_destination.CopyFrom (buffer);
+  m_source.CopyFrom (buffer + MAC_ADDR_SIZE);
+  m_lengthType = Buffer::ReadMsb (buffer + 2 * MAC_ADDR_SIZE, LENGTH_SIZE);
 
   return GetSerializedSize ();
 }
@@ -18,6 +18,8 @@
 
 #include "ns3/log.h"
 #include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/enum.h"
 #include "ns3/buffer.h"
 #include "ns3/header.h"
 #include "pcap-file-wrapper.h"
@@ -40,12 +42,33 @@ PcapFileWrapper::GetTypeId (void)
                    UintegerValue (PcapFile::SNAPLEN_DEFAULT),
                    MakeUintegerAccessor (&PcapFileWrapper::m_snapLen),
                    MakeUintegerChecker<uint32_t> (0, PcapFile::SNAPLEN_DEFAULT))
+    .AddAttribute ("Asynchronous",
+                   "Write the file from a background thread, when threads are available",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PcapFileWrapper::m_asynchronous),
+                   MakeBooleanChecker ())
+    .AddAttribute ("Compression",
+                   "Compression of the files created",
+                   EnumValue (PcapWriter::NONE),
+                   MakeEnumAccessor (&PcapFileWrapper::m_compression),
+                   MakeEnumChecker (PcapWriter::NONE, "None",
+                                    PcapWriter::GZIP, "Gzip"))
+    .AddAttribute ("BufferSize",
+                   "Number of bytes buffered before being written, "
+                   "if Asynchronous or Compression is set",
+                   UintegerValue (1 << 20),
+                   MakeUintegerAccessor (&PcapFileWrapper::m_bufferSize),
+                   MakeUintegerChecker<uint32_t> ())
   ;
   return tid;
 }
 
 
 PcapFileWrapper::PcapFileWrapper ()
+  : m_interface (0),
+    m_dataLinkType (0),
+    m_writerSnapLen (0),
+    m_tzCorrection (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -61,12 +84,20 @@ bool
 PcapFileWrapper::Fail (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_writer != 0)
+    {
+      return m_writer->Fail ();
+    }
   return m_file.Fail ();
 }
 bool 
 PcapFileWrapper::Eof (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_writer != 0)
+    {
+      return false;
+    }
   return m_file.Eof ();
 }
 void 
@@ -80,6 +111,17 @@ void
 PcapFileWrapper::Close (void)
 {
   NS_LOG_FUNCTION (this);
+  if (m_writer != 0)
+    {
+      // A pcapng file may be shared with other wrappers: it is closed
+      // when its writer is released by all of them.
+      if (m_writer->GetFormat () == PcapWriter::PCAP)
+        {
+          m_writer->Close ();
+        }
+      m_writer = 0;
+      return;
+    }
   m_file.Close ();
 }
 
@@ -87,9 +129,25 @@ void
 PcapFileWrapper::Open (std::string const &filename, std::ios::openmode mode)
 {
   NS_LOG_FUNCTION (this << filename << mode);
+  bool truncate = (mode & std::ios::out) && !(mode & (std::ios::in | std::ios::app));
+  if (truncate && (m_asynchronous || m_compression != PcapWriter::NONE))
+    {
+      m_writer = Create<PcapWriter> ();
+      m_writer->Open (filename, PcapWriter::PCAP, m_compression, m_asynchronous, m_bufferSize);
+      return;
+    }
   m_file.Open (filename, mode);
 }
 
+void
+PcapFileWrapper::Open (Ptr<PcapWriter> writer, std::string const &name)
+{
+  NS_LOG_FUNCTION (this << writer << name);
+  NS_ASSERT (writer->GetFormat () == PcapWriter::PCAPNG);
+  m_writer = writer;
+  m_interfaceName = name;
+}
+
 void
 PcapFileWrapper::Init (uint32_t dataLinkType, uint32_t snapLen, int32_t tzCorrection)
 {
@@ -99,6 +157,21 @@ PcapFileWrapper::Init (uint32_t dataLinkType, uint32_t snapLen, int32_t tzCorrec
   // a snaplen, we use the one provided.
   //
   NS_LOG_FUNCTION (this << dataLinkType << snapLen << tzCorrection);
+  if (m_writer != 0)
+    {
+      m_dataLinkType = dataLinkType;
+      m_writerSnapLen = snapLen != std::numeric_limits<uint32_t>::max () ? snapLen : m_snapLen;
+      m_tzCorrection = tzCorrection;
+      if (m_writer->GetFormat () == PcapWriter::PCAPNG)
+        {
+          m_interface = m_writer->AddInterface (m_dataLinkType, m_writerSnapLen, m_interfaceName);
+        }
+      else
+        {
+          m_writer->WriteFileHeader (m_dataLinkType, m_writerSnapLen, m_tzCorrection);
+        }
+      return;
+    }
   if (snapLen != std::numeric_limits<uint32_t>::max ())
     {
       m_file.Init (dataLinkType, snapLen, tzCorrection);
@@ -113,6 +186,11 @@ void
 PcapFileWrapper::Write (Time t, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (this << t << p);
+  if (m_writer != 0)
+    {
+      m_writer->Write (m_interface, t, 0, p);
+      return;
+    }
   uint64_t current = t.GetMicroSeconds ();
   uint64_t s = current / 1000000;
   uint64_t us = current % 1000000;
@@ -124,6 +202,11 @@ void
 PcapFileWrapper::Write (Time t, Header &header, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (this << t << &header << p);
+  if (m_writer != 0)
+    {
+      m_writer->Write (m_interface, t, &header, p);
+      return;
+    }
   uint64_t current = t.GetMicroSeconds ();
   uint64_t s = current / 1000000;
   uint64_t us = current % 1000000;
@@ -135,6 +218,11 @@ void
 PcapFileWrapper::Write (Time t, uint8_t const *buffer, uint32_t length)
 {
   NS_LOG_FUNCTION (this << t << &buffer << length);
+  if (m_writer != 0)
+    {
+      m_writer->Write (m_interface, t, buffer, length);
+      return;
+    }
   uint64_t current = t.GetMicroSeconds ();
   uint64_t s = current / 1000000;
   uint64_t us = current % 1000000;
@@ -146,6 +234,10 @@ uint32_t
 PcapFileWrapper::GetMagic (void)
 {
   NS_LOG_FUNCTION (this);
+  if (m_writer != 0)
+    {
+      return 0xa1b2c3d4;
+    }
   return m_file.GetMagic ();
 }
 
@@ -153,6 +245,10 @@ uint16_t
 PcapFileWrapper::GetVersionMajor (void)
 {
   NS_LOG_FUNCTION (this);
+  if (m_writer != 0)
+    {
+      return 2;
+    }
   return m_file.GetVersionMajor ();
 }
 
@@ -160,6 +256,10 @@ uint16_t
 PcapFileWrapper::GetVersionMinor (void)
 {
   NS_LOG_FUNCTION (this);
+  if (m_writer != 0)
+    {
+      return 4;
+    }
   return m_file.GetVersionMinor ();
 }
 
@@ -167,6 +267,10 @@ int32_t
 PcapFileWrapper::GetTimeZoneOffset (void)
 {
   NS_LOG_FUNCTION (this);
+  if (m_writer != 0)
+    {
+      return m_tzCorrection;
+    }
   return m_file.GetTimeZoneOffset ();
 }
 
@@ -174,6 +278,10 @@ uint32_t
 PcapFileWrapper::GetSigFigs (void)
 {
   NS_LOG_FUNCTION (this);
+  if (m_writer != 0)
+    {
+      return 0;
+    }
   return m_file.GetSigFigs ();
 }
 
@@ -181,6 +289,10 @@ uint32_t
 PcapFileWrapper::GetSnapLen (void)
 {
   NS_LOG_FUNCTION (this);
+  if (m_writer != 0)
+    {
+      return m_writerSnapLen;
+    }
   return m_file.GetSnapLen ();
 }
 
@@ -188,6 +300,10 @@ uint32_t
 PcapFileWrapper::GetDataLinkType (void)
 {
   NS_LOG_FUNCTION (this);
+  if (m_writer != 0)
+    {
+      return m_dataLinkType;
+    }
   return m_file.GetDataLinkType ();
 }
 
@@ -27,6 +27,7 @@
 #include "ns3/object.h"
 #include "ns3/nstime.h"
 #include "pcap-file.h"
+#include "pcap-writer.h"
 
 namespace ns3 {
 
@@ -35,6 +36,11 @@ namespace ns3 {
  * ns-3 interface to the low-level public methods of PcapFile.  Users are
  * encouraged to use this object instead of class ns3::PcapFile in ns-3
  * public APIs.
+ *
+ * When its Asynchronous or Compression attribute is set, a file opened
+ * for writing is written by a PcapWriter instead, in batches of
+ * BufferSize bytes. A PcapFileWrapper can also write the packets of
+ * one interface of a pcapng file shared with other wrappers.
  */
 class PcapFileWrapper : public Object
 {
@@ -77,6 +83,16 @@ public:
    */
   void Open (std::string const &filename, std::ios::openmode mode);
 
+  /**
+   * Write the packets of a new interface of a pcapng file.  Init adds
+   * the interface to the file, which is closed when the last wrapper
+   * writing to it is destroyed.
+   *
+   * \param writer the writer of the pcapng file.
+   * \param name the name of the interface.
+   */
+  void Open (Ptr<PcapWriter> writer, std::string const &name);
+
   /**
    * Close the underlying pcap file.
    */
@@ -215,6 +231,15 @@ public:
 private:
   PcapFile m_file; //!< Pcap file
   uint32_t m_snapLen; //!< max length of saved packets
+  bool m_asynchronous; //!< write the file from a background thread
+  enum PcapWriter::Compression m_compression; //!< compression of the file
+  uint32_t m_bufferSize; //!< size of the batches of the writer
+  Ptr<PcapWriter> m_writer; //!< writer of the file, if not m_file
+  std::string m_interfaceName; //!< name of the interface in a pcapng file
+  uint32_t m_interface; //!< identifier of the interface in a pcapng file
+  uint32_t m_dataLinkType; //!< data link type given to the writer
+  uint32_t m_writerSnapLen; //!< snapshot length given to the writer
+  int32_t m_tzCorrection; //!< time zone offset given to the writer
 };
 
 } // namespace ns3
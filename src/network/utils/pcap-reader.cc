@@ -0,0 +1,441 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "pcap-reader.h"
+#include "ns3/network-config.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PcapReader");
+
+/** Magic number of pcap files, with microsecond time stamps. */
+static const uint32_t PCAP_MAGIC = 0xa1b2c3d4;
+/** Magic number of pcap files, with nanosecond time stamps. */
+static const uint32_t PCAP_NSEC_MAGIC = 0xa1b23c4d;
+/** Size of the header of pcap files. */
+static const uint32_t PCAP_FILE_HEADER_SIZE = 24;
+/** Size of the header of pcap records. */
+static const uint32_t PCAP_RECORD_HEADER_SIZE = 16;
+/** Byte order magic number of pcapng files. */
+static const uint32_t PCAPNG_BYTE_ORDER_MAGIC = 0x1a2b3c4d;
+/** Pcapng section header block type. */
+static const uint32_t PCAPNG_SECTION_HEADER = 0x0a0d0d0a;
+/** Pcapng interface description block type. */
+static const uint32_t PCAPNG_INTERFACE_DESCRIPTION = 0x00000001;
+/** Pcapng enhanced packet block type. */
+static const uint32_t PCAPNG_ENHANCED_PACKET = 0x00000006;
+/** Pcapng if_tsresol option code. */
+static const uint16_t PCAPNG_IF_TSRESOL = 9;
+
+/**
+ * \param v a 16-bit value.
+ * \returns v with its bytes swapped.
+ */
+static inline uint16_t
+Swap16 (uint16_t v)
+{
+  return (v >> 8) | (v << 8);
+}
+
+/**
+ * \param v a 32-bit value.
+ * \returns v with its bytes swapped.
+ */
+static inline uint32_t
+Swap32 (uint32_t v)
+{
+  return (v >> 24) | ((v >> 8) & 0x0000ff00) | ((v << 8) & 0x00ff0000) | (v << 24);
+}
+
+PcapReader::Iterator::Iterator ()
+  : m_reader (0),
+    m_offset (0),
+    m_next (0),
+    m_swap (false)
+{
+  m_record.interface = 0;
+  m_record.dataLinkType = 0;
+  m_record.inclLen = 0;
+  m_record.origLen = 0;
+  m_record.data = 0;
+}
+
+PcapReader::Iterator::Iterator (PcapReader const *reader, uint64_t offset)
+  : m_reader (reader),
+    m_offset (offset),
+    m_next (offset),
+    m_swap (false)
+{
+  m_record.interface = 0;
+  m_record.dataLinkType = 0;
+  m_record.inclLen = 0;
+  m_record.origLen = 0;
+  m_record.data = 0;
+  Load ();
+}
+
+PcapReader::Record const &
+PcapReader::Iterator::operator* (void) const
+{
+  NS_ASSERT (m_offset < m_reader->m_size);
+  return m_record;
+}
+
+PcapReader::Record const *
+PcapReader::Iterator::operator-> (void) const
+{
+  NS_ASSERT (m_offset < m_reader->m_size);
+  return &m_record;
+}
+
+PcapReader::Iterator &
+PcapReader::Iterator::operator++ (void)
+{
+  Load ();
+  return *this;
+}
+
+bool
+PcapReader::Iterator::operator== (Iterator const &o) const
+{
+  return m_reader == o.m_reader && m_offset == o.m_offset;
+}
+
+bool
+PcapReader::Iterator::operator!= (Iterator const &o) const
+{
+  return !(*this == o);
+}
+
+uint16_t
+PcapReader::Iterator::Read16 (uint64_t offset) const
+{
+  uint16_t v;
+  std::memcpy (&v, m_reader->m_data + offset, 2);
+  return m_swap ? Swap16 (v) : v;
+}
+
+uint32_t
+PcapReader::Iterator::Read32 (uint64_t offset) const
+{
+  uint32_t v;
+  std::memcpy (&v, m_reader->m_data + offset, 4);
+  return m_swap ? Swap32 (v) : v;
+}
+
+void
+PcapReader::Iterator::Load (void)
+{
+  uint64_t size = m_reader->m_size;
+  while (m_next < size)
+    {
+      uint64_t offset = m_next;
+      if (!m_reader->m_pcapng)
+        {
+          if (offset == 0)
+            {
+              if (size < PCAP_FILE_HEADER_SIZE)
+                {
+                  break;
+                }
+              uint32_t magic;
+              std::memcpy (&magic, m_reader->m_data, 4);
+              m_swap = magic != PCAP_MAGIC && magic != PCAP_NSEC_MAGIC;
+              magic = Read32 (0);
+              Interface interface;
+              interface.snapLen = Read32 (16);
+              interface.dataLinkType = Read32 (20);
+              interface.unitsPerSecond = magic == PCAP_NSEC_MAGIC ? 1000000000 : 1000000;
+              m_interfaces.push_back (interface);
+              m_next = PCAP_FILE_HEADER_SIZE;
+              continue;
+            }
+          if (offset + PCAP_RECORD_HEADER_SIZE > size)
+            {
+              break;
+            }
+          uint32_t inclLen = Read32 (offset + 8);
+          if (offset + PCAP_RECORD_HEADER_SIZE + inclLen > size)
+            {
+              break;
+            }
+          uint64_t units = m_interfaces[0].unitsPerSecond;
+          uint64_t ns = static_cast<uint64_t> (Read32 (offset)) * 1000000000 + Read32 (offset + 4) * (1000000000 / units);
+          m_record.timestamp = NanoSeconds (ns);
+          m_record.interface = 0;
+          m_record.dataLinkType = m_interfaces[0].dataLinkType;
+          m_record.inclLen = inclLen;
+          m_record.origLen = Read32 (offset + 12);
+          m_record.data = m_reader->m_data + offset + PCAP_RECORD_HEADER_SIZE;
+          m_offset = offset;
+          m_next = offset + PCAP_RECORD_HEADER_SIZE + inclLen;
+          return;
+        }
+
+      if (offset + 12 > size)
+        {
+          break;
+        }
+      uint32_t type = Read32 (offset);
+      if (type == PCAPNG_SECTION_HEADER)
+        {
+          uint32_t magic;
+          std::memcpy (&magic, m_reader->m_data + offset + 8, 4);
+          m_swap = magic != PCAPNG_BYTE_ORDER_MAGIC;
+          m_interfaces.clear ();
+        }
+      uint32_t length = Read32 (offset + 4);
+      if (length < 12 || length % 4 != 0 || offset + length > size)
+        {
+          NS_LOG_WARN ("Truncated or invalid block at offset " << offset);
+          break;
+        }
+      m_next = offset + length;
+      if (type == PCAPNG_INTERFACE_DESCRIPTION && length >= 20)
+        {
+          Interface interface;
+          interface.dataLinkType = Read16 (offset + 8);
+          interface.snapLen = Read32 (offset + 12);
+          interface.unitsPerSecond = 1000000;
+          uint64_t option = offset + 16;
+          while (option + 4 <= m_next - 4)
+            {
+              uint16_t code = Read16 (option);
+              uint16_t optionLength = Read16 (option + 2);
+              if (code == 0 || option + 4 + optionLength > m_next - 4)
+                {
+                  break;
+                }
+              if (code == PCAPNG_IF_TSRESOL && optionLength >= 1)
+                {
+                  uint8_t resolution = m_reader->m_data[option + 4];
+                  // 2^63 and 10^19 are the largest units which fit in 64 bits.
+                  if ((resolution & 0x7f) > ((resolution & 0x80) ? 63 : 19))
+                    {
+                      NS_LOG_WARN ("Invalid time stamp resolution " << uint32_t (resolution) <<
+                                   " at offset " << offset);
+                      m_reader->m_fail = true;
+                      m_offset = size;
+                      m_next = size;
+                      return;
+                    }
+                  uint64_t units = 1;
+                  for (uint8_t i = 0; i < (resolution & 0x7f); ++i)
+                    {
+                      units *= (resolution & 0x80) ? 2 : 10;
+                    }
+                  interface.unitsPerSecond = units;
+                }
+              option += 4 + ((optionLength + 3) & ~3U);
+            }
+          m_interfaces.push_back (interface);
+        }
+      else if (type == PCAPNG_ENHANCED_PACKET && length >= 32)
+        {
+          uint32_t interface = Read32 (offset + 8);
+          uint32_t inclLen = Read32 (offset + 20);
+          if (interface >= m_interfaces.size () || 28 + inclLen + 4 > length)
+            {
+              NS_LOG_WARN ("Invalid packet block at offset " << offset);
+              continue;
+            }
+          uint64_t ts = (static_cast<uint64_t> (Read32 (offset + 12)) << 32) | Read32 (offset + 16);
+          uint64_t units = m_interfaces[interface].unitsPerSecond;
+          uint64_t rest = ts % units;
+          uint64_t ns = (ts / units) * 1000000000;
+          if (rest <= std::numeric_limits<uint64_t>::max () / 1000000000)
+            {
+              ns += rest * 1000000000 / units;
+            }
+          else
+            {
+              ns += static_cast<uint64_t> (static_cast<long double> (rest) * 1000000000 / units);
+            }
+          m_record.timestamp = NanoSeconds (ns);
+          m_record.interface = interface;
+          m_record.dataLinkType = m_interfaces[interface].dataLinkType;
+          m_record.inclLen = inclLen;
+          m_record.origLen = Read32 (offset + 24);
+          m_record.data = m_reader->m_data + offset + 28;
+          m_offset = offset;
+          return;
+        }
+    }
+  m_offset = size;
+  m_next = size;
+}
+
+PcapReader::PcapReader ()
+  : m_data (0),
+    m_size (0),
+    m_fail (false),
+    m_pcapng (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+PcapReader::~PcapReader ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+void
+PcapReader::Open (std::string const &filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  Close ();
+  m_fail = true;
+#ifdef HAVE_SYS_MMAN_H
+  int fd = open (filename.c_str (), O_RDONLY);
+  if (fd < 0)
+    {
+      return;
+    }
+  struct stat st;
+  if (fstat (fd, &st) != 0 || st.st_size == 0)
+    {
+      close (fd);
+      return;
+    }
+  void *data = mmap (0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close (fd);
+  if (data == MAP_FAILED)
+    {
+      return;
+    }
+  madvise (data, st.st_size, MADV_SEQUENTIAL);
+  m_data = static_cast<uint8_t const *> (data);
+  m_size = st.st_size;
+#else
+  // Without mmap, the file is read in memory at once.
+  std::ifstream file (filename.c_str (), std::ios::in | std::ios::binary | std::ios::ate);
+  if (!file)
+    {
+      return;
+    }
+  m_size = file.tellg ();
+  uint8_t *data = new uint8_t[m_size];
+  file.seekg (0);
+  file.read (reinterpret_cast<char *> (data), m_size);
+  m_data = data;
+  if (!file)
+    {
+      Close ();
+      return;
+    }
+#endif
+
+  if (m_size < 12)
+    {
+      Close ();
+      return;
+    }
+  uint32_t magic;
+  std::memcpy (&magic, m_data, 4);
+  if (magic == PCAPNG_SECTION_HEADER)
+    {
+      m_pcapng = true;
+    }
+  else if (magic != PCAP_MAGIC && magic != PCAP_NSEC_MAGIC
+           && Swap32 (magic) != PCAP_MAGIC && Swap32 (magic) != PCAP_NSEC_MAGIC)
+    {
+      NS_LOG_WARN (filename << " is not a pcap or pcapng file");
+      Close ();
+      return;
+    }
+  m_fail = false;
+  m_interfaces = Begin ().m_interfaces;
+}
+
+bool
+PcapReader::Fail (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_fail;
+}
+
+void
+PcapReader::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_data != 0)
+    {
+#ifdef HAVE_SYS_MMAN_H
+      munmap (const_cast<uint8_t *> (m_data), m_size);
+#else
+      delete [] m_data;
+#endif
+    }
+  m_data = 0;
+  m_size = 0;
+  m_pcapng = false;
+  m_interfaces.clear ();
+}
+
+bool
+PcapReader::IsPcapng (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_pcapng;
+}
+
+uint32_t
+PcapReader::GetNInterfaces (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_interfaces.size ();
+}
+
+PcapReader::Interface const &
+PcapReader::GetInterface (uint32_t i) const
+{
+  NS_LOG_FUNCTION (this << i);
+  NS_ASSERT (i < m_interfaces.size ());
+  return m_interfaces[i];
+}
+
+PcapReader::Iterator
+PcapReader::Begin (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return Iterator (this, 0);
+}
+
+PcapReader::Iterator
+PcapReader::End (void) const
+{
+  NS_LOG_FUNCTION (this);
+  Iterator end;
+  end.m_reader = this;
+  end.m_offset = m_size;
+  end.m_next = m_size;
+  return end;
+}
+
+} // namespace ns3
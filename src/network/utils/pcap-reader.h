@@ -0,0 +1,187 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PCAP_READER_H
+#define PCAP_READER_H
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "ns3/simple-ref-count.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup network
+ * \brief Reader of pcap and pcapng files mapped in memory.
+ *
+ * The file is mapped in memory rather than read, so that captures larger
+ * than the memory can be iterated over: only the pages being read are
+ * loaded, and the records point to the packet data in the mapping
+ * rather than copying it. The mapping must outlive the records.
+ *
+ * Both byte orders are supported, as well as the pcap files with
+ * nanosecond time stamps. In pcapng files, the enhanced packet blocks
+ * are returned, with the time stamp resolution of their interface;
+ * the other blocks, and the packets of truncated blocks, are skipped.
+ *
+ * \code
+ *   Ptr<PcapReader> reader = Create<PcapReader> ();
+ *   reader->Open ("trace.pcap");
+ *   for (PcapReader::Iterator i = reader->Begin (); i != reader->End (); ++i)
+ *     {
+ *       Process (i->timestamp, i->data, i->inclLen);
+ *     }
+ * \endcode
+ */
+class PcapReader : public SimpleRefCount<PcapReader>
+{
+public:
+  /** A packet record of the file. */
+  struct Record
+  {
+    Time timestamp;          //!< The time stamp of the packet.
+    uint32_t interface;      //!< The interface of the packet, 0 in a pcap file.
+    uint32_t dataLinkType;   //!< The data link type of the interface.
+    uint32_t inclLen;        //!< The number of bytes of the packet in the file.
+    uint32_t origLen;        //!< The size of the packet on the wire.
+    uint8_t const *data;     //!< The bytes of the packet, in the mapping.
+  };
+
+  /** A description of an interface of the file. */
+  struct Interface
+  {
+    uint32_t dataLinkType;   //!< The data link type of the packets.
+    uint32_t snapLen;        //!< The maximum number of bytes per packet.
+    uint64_t unitsPerSecond; //!< The resolution of the time stamps.
+  };
+
+  /**
+   * \brief Iterator over the packet records of a PcapReader.
+   */
+  class Iterator
+  {
+public:
+    Iterator ();
+    /**
+     * \returns the current record.
+     */
+    Record const &operator* (void) const;
+    /**
+     * \returns the current record.
+     */
+    Record const *operator-> (void) const;
+    /**
+     * Move to the next record.
+     * \returns this iterator.
+     */
+    Iterator &operator++ (void);
+    /**
+     * \param o another iterator
+     * \returns true if both iterators are at the same record.
+     */
+    bool operator== (Iterator const &o) const;
+    /**
+     * \param o another iterator
+     * \returns true if the iterators are at different records.
+     */
+    bool operator!= (Iterator const &o) const;
+
+private:
+    friend class PcapReader;
+    /**
+     * Constructor.
+     * \param reader the reader iterated over.
+     * \param offset the offset of the first block of the file, or the
+     *        size of the file for the end iterator.
+     */
+    Iterator (PcapReader const *reader, uint64_t offset);
+    /**
+     * Parse the blocks from m_next until the next packet record.
+     */
+    void Load (void);
+    /**
+     * \param offset an offset in the file.
+     * \returns the 16-bit value at this offset, in the byte order of the file.
+     */
+    uint16_t Read16 (uint64_t offset) const;
+    /**
+     * \param offset an offset in the file.
+     * \returns the 32-bit value at this offset, in the byte order of the file.
+     */
+    uint32_t Read32 (uint64_t offset) const;
+
+    PcapReader const *m_reader;           //!< The reader iterated over.
+    uint64_t m_offset;                    //!< The offset of the current record.
+    uint64_t m_next;                      //!< The offset of the next block.
+    bool m_swap;                          //!< True if the section is byte-swapped.
+    std::vector<Interface> m_interfaces;  //!< The interfaces of the section.
+    Record m_record;                      //!< The current record.
+  };
+
+  PcapReader ();
+  ~PcapReader ();
+
+  /**
+   * Map a pcap or pcapng file in memory.
+   * \param filename the name of the file.
+   */
+  void Open (std::string const &filename);
+  /**
+   * \returns true if the file could not be mapped, is not a pcap
+   *          or pcapng file, or if an invalid interface description
+   *          was met while iterating over its records.  The iteration
+   *          stops at such a description.
+   */
+  bool Fail (void) const;
+  /**
+   * Unmap the file. The records returned so far become invalid.
+   */
+  void Close (void);
+  /**
+   * \returns true if the file is a pcapng file.
+   */
+  bool IsPcapng (void) const;
+  /**
+   * \returns the number of interfaces described before the first packet.
+   */
+  uint32_t GetNInterfaces (void) const;
+  /**
+   * \param i the index of an interface.
+   * \returns the description of the interface.
+   */
+  Interface const &GetInterface (uint32_t i) const;
+  /**
+   * \returns an iterator to the first packet record.
+   */
+  Iterator Begin (void) const;
+  /**
+   * \returns an iterator past the last packet record.
+   */
+  Iterator End (void) const;
+
+private:
+  uint8_t const *m_data;                  //!< The file mapped in memory.
+  uint64_t m_size;                        //!< The size of the file.
+  mutable bool m_fail;                    //!< True after an error, also set by the iterators.
+  bool m_pcapng;                          //!< True for a pcapng file.
+  std::vector<Interface> m_interfaces;    //!< The interfaces before the first packet.
+};
+
+} // namespace ns3
+
+#endif /* PCAP_READER_H */
@@ -0,0 +1,213 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "pcap-replay.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/net-device.h"
+#include "ns3/mac48-address.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/trace-helper.h"
+#include <limits>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PcapReplay");
+
+NS_OBJECT_ENSURE_REGISTERED (PcapReplay);
+
+TypeId
+PcapReplay::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::PcapReplay")
+    .SetParent<Application> ()
+    .SetGroupName ("Network")
+    .AddConstructor<PcapReplay> ()
+    .AddAttribute ("Filename",
+                   "Name of the pcap or pcapng file to replay",
+                   StringValue (""),
+                   MakeStringAccessor (&PcapReplay::m_filename),
+                   MakeStringChecker ())
+    .AddAttribute ("Interface",
+                   "Interface of the pcapng file to replay, all of them by default",
+                   UintegerValue (std::numeric_limits<uint32_t>::max ()),
+                   MakeUintegerAccessor (&PcapReplay::m_interface),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddTraceSource ("Tx", "A packet has been sent",
+                     MakeTraceSourceAccessor (&PcapReplay::m_txTrace),
+                     "ns3::Packet::TracedCallback")
+  ;
+  return tid;
+}
+
+PcapReplay::PcapReplay ()
+  : m_sent (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+PcapReplay::~PcapReplay ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+PcapReplay::SetDevice (Ptr<NetDevice> device)
+{
+  NS_LOG_FUNCTION (this << device);
+  m_device = device;
+}
+
+uint64_t
+PcapReplay::GetSent (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_sent;
+}
+
+void
+PcapReplay::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_device = 0;
+  m_current = PcapReader::Iterator ();
+  m_reader = 0;
+  Application::DoDispose ();
+}
+
+void
+PcapReplay::StartApplication (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT_MSG (m_device != 0, "Device not set");
+  m_reader = Create<PcapReader> ();
+  m_reader->Open (m_filename);
+  NS_ABORT_MSG_IF (m_reader->Fail (), "Unable to read " << m_filename);
+  m_current = m_reader->Begin ();
+  m_start = Simulator::Now ();
+  m_origin = Time (-1);
+  ScheduleNext ();
+}
+
+void
+PcapReplay::StopApplication (void)
+{
+  NS_LOG_FUNCTION (this);
+  Simulator::Cancel (m_sendEvent);
+  m_current = PcapReader::Iterator ();
+  m_reader = 0;
+}
+
+void
+PcapReplay::ScheduleNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  PcapReader::Iterator end = m_reader->End ();
+  for (; m_current != end; ++m_current)
+    {
+      uint32_t dataLinkType = m_current->dataLinkType;
+      if ((m_interface == std::numeric_limits<uint32_t>::max () || m_current->interface == m_interface)
+          && (dataLinkType == PcapHelper::DLT_EN10MB || dataLinkType == PcapHelper::DLT_RAW))
+        {
+          break;
+        }
+      NS_LOG_LOGIC ("Skip a packet of interface " << m_current->interface
+                    << " and data link type " << dataLinkType);
+    }
+  if (m_current == end)
+    {
+      NS_LOG_INFO ("End of " << m_filename << " after " << m_sent << " packets");
+      return;
+    }
+  if (m_origin.IsNegative ())
+    {
+      m_origin = m_current->timestamp;
+    }
+  Time delay = m_start + (m_current->timestamp - m_origin) - Simulator::Now ();
+  if (delay.IsNegative ())
+    {
+      // The records are not sorted: send this one right away.
+      delay = Seconds (0);
+    }
+  m_sendEvent = Simulator::Schedule (delay, &PcapReplay::Send, this);
+}
+
+void
+PcapReplay::Send (void)
+{
+  NS_LOG_FUNCTION (this);
+  PcapReader::Record const &record = *m_current;
+  uint8_t const *data = record.data;
+  uint32_t size = record.inclLen;
+  Address to = m_device->GetBroadcast ();
+  Address from;
+  uint16_t protocol = 0;
+  bool ok = true;
+  if (record.dataLinkType == PcapHelper::DLT_EN10MB)
+    {
+      ok = size >= 14;
+      if (ok)
+        {
+          Mac48Address destination;
+          Mac48Address source;
+          destination.CopyFrom (data);
+          source.CopyFrom (data + 6);
+          to = destination;
+          from = source;
+          protocol = (data[12] << 8) | data[13];
+          data += 14;
+          size -= 14;
+        }
+    }
+  else
+    {
+      ok = size >= 1;
+      if (ok)
+        {
+          protocol = (data[0] >> 4) == 6 ? 0x86DD : 0x0800;
+        }
+    }
+
+  if (ok)
+    {
+      Ptr<Packet> p = Create<Packet> (data, size);
+      if (record.origLen > record.inclLen)
+        {
+          p->AddPaddingAtEnd (record.origLen - record.inclLen);
+        }
+      m_txTrace (p);
+      if (!from.IsInvalid () && m_device->SupportsSendFrom ())
+        {
+          m_device->SendFrom (p, from, to, protocol);
+        }
+      else
+        {
+          m_device->Send (p, to, protocol);
+        }
+      m_sent++;
+    }
+  else
+    {
+      NS_LOG_WARN ("Skip a packet of " << record.inclLen << " bytes, too short for its headers");
+    }
+  ++m_current;
+  ScheduleNext ();
+}
+
+} // namespace ns3
@@ -0,0 +1,106 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PCAP_REPLAY_H
+#define PCAP_REPLAY_H
+
+#include <string>
+#include "ns3/application.h"
+#include "ns3/event-id.h"
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/traced-callback.h"
+#include "pcap-reader.h"
+
+namespace ns3 {
+
+class NetDevice;
+class Packet;
+
+/**
+ * \ingroup network
+ *
+ * \brief Replay the packets of a capture file through a NetDevice.
+ *
+ * The packets of a pcap or pcapng file, read through a PcapReader, are
+ * sent through the device at their recorded times, relative to the
+ * first packet of the file and to the start of the application. The
+ * file is mapped in memory and a single packet is pending at a time,
+ * so that captures larger than the memory can be replayed.
+ *
+ * Ethernet frames (DLT_EN10MB) are sent to their destination MAC
+ * address, from their source address if the device supports SendFrom,
+ * and with their EtherType. Raw IPv4 and IPv6 packets (DLT_RAW) are
+ * broadcast. The packets of the other data link types are skipped.
+ * Packets truncated by the capture are padded with zeros to their
+ * original size.
+ */
+class PcapReplay : public Application
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  PcapReplay ();
+  virtual ~PcapReplay ();
+
+  /**
+   * \param device the device through which the packets are sent.
+   */
+  void SetDevice (Ptr<NetDevice> device);
+
+  /**
+   * \returns the number of packets sent so far.
+   */
+  uint64_t GetSent (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  virtual void StartApplication (void);
+  virtual void StopApplication (void);
+
+  /**
+   * \brief Skip the records which are not replayed, and schedule the
+   * sending of the current record.
+   */
+  void ScheduleNext (void);
+  /**
+   * \brief Send the current record, and move to the next one.
+   */
+  void Send (void);
+
+  std::string m_filename;             //!< Name of the capture file
+  uint32_t m_interface;               //!< Interface replayed in a pcapng file
+  Ptr<NetDevice> m_device;            //!< Device through which the packets are sent
+  Ptr<PcapReader> m_reader;           //!< Reader of the capture file
+  PcapReader::Iterator m_current;     //!< Next record to send
+  Time m_origin;                      //!< Time stamp of the first record
+  Time m_start;                       //!< Time the replay started
+  uint64_t m_sent;                    //!< Number of packets sent
+  EventId m_sendEvent;                //!< Event to send the next packet
+
+  /// Traced Callback: sent packets.
+  TracedCallback<Ptr<const Packet> > m_txTrace;
+};
+
+} // namespace ns3
+
+#endif /* PCAP_REPLAY_H */
@@ -0,0 +1,505 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "pcap-writer.h"
+#include "ns3/core-config.h"
+#include "ns3/network-config.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/packet.h"
+#include "ns3/header.h"
+#include "ns3/buffer.h"
+#include <cstdio>
+#include <cstring>
+#include <list>
+
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#include "ns3/system-thread.h"
+#endif
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PcapWriter");
+
+/** Magic number of pcap files, with microsecond time stamps. */
+static const uint32_t PCAP_MAGIC = 0xa1b2c3d4;
+/** Byte order magic number of pcapng files. */
+static const uint32_t PCAPNG_BYTE_ORDER_MAGIC = 0x1a2b3c4d;
+/** Pcapng section header block type. */
+static const uint32_t PCAPNG_SECTION_HEADER = 0x0a0d0d0a;
+/** Pcapng interface description block type. */
+static const uint32_t PCAPNG_INTERFACE_DESCRIPTION = 0x00000001;
+/** Pcapng enhanced packet block type. */
+static const uint32_t PCAPNG_ENHANCED_PACKET = 0x00000006;
+/** Pcapng if_name option code. */
+static const uint16_t PCAPNG_IF_NAME = 2;
+/** Maximum number of batches waiting for the background thread. */
+static const uint32_t MAX_PENDING_BATCHES = 4;
+
+/**
+ * \ingroup network
+ * The file written by a PcapWriter, and the state it shares with
+ * its background thread.
+ */
+struct PcapWriterPrivate
+{
+  FILE *file;                                   //!< The file, if not compressed.
+#ifdef HAVE_ZLIB
+  gzFile gzfile;                                //!< The file, if compressed.
+#endif
+#ifdef HAVE_PTHREAD_H
+  Ptr<SystemThread> thread;                     //!< The background thread, if any.
+  pthread_mutex_t mutex;                        //!< Protects the fields below.
+#endif
+  bool fail;                                    //!< True after an error.
+#ifdef HAVE_PTHREAD_H
+  pthread_cond_t cond;                          //!< Signaled when they change.
+  std::list<std::vector<uint8_t> *> pending;    //!< Batches to write, oldest first.
+  std::list<std::vector<uint8_t> *> free;       //!< Batches written, for reuse.
+  bool writing;                                 //!< True while the thread writes a batch.
+  bool stop;                                    //!< True to stop the thread.
+#endif
+};
+
+PcapWriter::PcapWriter ()
+  : m_format (PCAP),
+    m_current (new std::vector<uint8_t> ()),
+    m_batchSize (0),
+    m_priv (new PcapWriterPrivate ())
+{
+  NS_LOG_FUNCTION (this);
+  m_priv->file = 0;
+#ifdef HAVE_ZLIB
+  m_priv->gzfile = 0;
+#endif
+  m_priv->fail = false;
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_init (&m_priv->mutex, 0);
+  pthread_cond_init (&m_priv->cond, 0);
+  m_priv->writing = false;
+  m_priv->stop = false;
+#endif
+}
+
+PcapWriter::~PcapWriter ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+#ifdef HAVE_PTHREAD_H
+  for (std::list<std::vector<uint8_t> *>::iterator i = m_priv->free.begin ();
+       i != m_priv->free.end (); ++i)
+    {
+      delete *i;
+    }
+  pthread_mutex_destroy (&m_priv->mutex);
+  pthread_cond_destroy (&m_priv->cond);
+#endif
+  delete m_priv;
+  delete m_current;
+}
+
+bool
+PcapWriter::IsGzipAvailable (void)
+{
+#ifdef HAVE_ZLIB
+  return true;
+#else
+  return false;
+#endif
+}
+
+void
+PcapWriter::Open (std::string const &filename, enum Format format,
+                  enum Compression compression, bool asynchronous,
+                  uint32_t batchSize)
+{
+  NS_LOG_FUNCTION (this << filename << format << compression << asynchronous << batchSize);
+  NS_ASSERT (m_priv->file == 0);
+  m_format = format;
+  m_batchSize = batchSize;
+  m_current->reserve (batchSize);
+  if (compression == GZIP)
+    {
+#ifdef HAVE_ZLIB
+      m_priv->gzfile = gzopen (filename.c_str (), "wb");
+      m_priv->fail = m_priv->gzfile == 0;
+#else
+      NS_FATAL_ERROR ("Compressed pcap files need zlib, which was not found by configure");
+#endif
+    }
+  else
+    {
+      m_priv->file = std::fopen (filename.c_str (), "wb");
+      m_priv->fail = m_priv->file == 0;
+    }
+  if (m_priv->fail)
+    {
+      return;
+    }
+#ifdef HAVE_PTHREAD_H
+  if (asynchronous)
+    {
+      m_priv->thread = Create<SystemThread> (MakeCallback (&PcapWriter::Run, this));
+      m_priv->thread->Start ();
+    }
+#endif
+  if (m_format == PCAPNG)
+    {
+      // The section header block, of unknown section length.
+      uint32_t blockLength = 28;
+      uint16_t major = 1;
+      uint16_t minor = 0;
+      uint64_t sectionLength = 0xffffffffffffffffULL;
+      Append (&PCAPNG_SECTION_HEADER, 4);
+      Append (&blockLength, 4);
+      Append (&PCAPNG_BYTE_ORDER_MAGIC, 4);
+      Append (&major, 2);
+      Append (&minor, 2);
+      Append (&sectionLength, 8);
+      Append (&blockLength, 4);
+    }
+}
+
+bool
+PcapWriter::Fail (void) const
+{
+  NS_LOG_FUNCTION (this);
+#ifdef HAVE_PTHREAD_H
+  // The background thread sets the flag when a write fails.
+  pthread_mutex_lock (&m_priv->mutex);
+  bool fail = m_priv->fail;
+  pthread_mutex_unlock (&m_priv->mutex);
+  return fail;
+#else
+  return m_priv->fail;
+#endif
+}
+
+enum PcapWriter::Format
+PcapWriter::GetFormat (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_format;
+}
+
+void
+PcapWriter::WriteFileHeader (uint32_t dataLinkType, uint32_t snapLen, int32_t tzCorrection)
+{
+  NS_LOG_FUNCTION (this << dataLinkType << snapLen << tzCorrection);
+  NS_ASSERT (m_format == PCAP && m_snapLen.empty ());
+  uint16_t major = 2;
+  uint16_t minor = 4;
+  uint32_t sigFigs = 0;
+  Append (&PCAP_MAGIC, 4);
+  Append (&major, 2);
+  Append (&minor, 2);
+  Append (&tzCorrection, 4);
+  Append (&sigFigs, 4);
+  Append (&snapLen, 4);
+  Append (&dataLinkType, 4);
+  m_snapLen.push_back (snapLen);
+}
+
+uint32_t
+PcapWriter::AddInterface (uint32_t dataLinkType, uint32_t snapLen, std::string const &name)
+{
+  NS_LOG_FUNCTION (this << dataLinkType << snapLen << name);
+  NS_ASSERT (m_format == PCAPNG);
+  uint16_t linkType = dataLinkType;
+  uint16_t reserved = 0;
+  uint16_t nameLength = name.size ();
+  uint32_t namePadding = (4 - nameLength % 4) % 4;
+  uint32_t endOfOptions = 0;
+  uint32_t blockLength = 20 + 4 + nameLength + namePadding + 4;
+  Append (&PCAPNG_INTERFACE_DESCRIPTION, 4);
+  Append (&blockLength, 4);
+  Append (&linkType, 2);
+  Append (&reserved, 2);
+  Append (&snapLen, 4);
+  Append (&PCAPNG_IF_NAME, 2);
+  Append (&nameLength, 2);
+  Append (name.c_str (), nameLength);
+  std::memset (Grow (namePadding), 0, namePadding);
+  Append (&endOfOptions, 4);
+  Append (&blockLength, 4);
+  m_snapLen.push_back (snapLen);
+  return m_snapLen.size () - 1;
+}
+
+uint32_t
+PcapWriter::WriteRecordHeader (uint32_t interface, Time t, uint32_t totalLen)
+{
+  NS_LOG_FUNCTION (this << interface << t << totalLen);
+  NS_ASSERT (interface < m_snapLen.size ());
+  uint32_t inclLen = std::min (totalLen, m_snapLen[interface]);
+  uint64_t us = t.GetMicroSeconds ();
+  if (m_format == PCAP)
+    {
+      uint32_t tsSec = us / 1000000;
+      uint32_t tsUsec = us % 1000000;
+      Append (&tsSec, 4);
+      Append (&tsUsec, 4);
+      Append (&inclLen, 4);
+      Append (&totalLen, 4);
+    }
+  else
+    {
+      uint32_t blockLength = 28 + ((inclLen + 3) & ~3U) + 4;
+      uint32_t tsHigh = us >> 32;
+      uint32_t tsLow = us & 0xffffffff;
+      Append (&PCAPNG_ENHANCED_PACKET, 4);
+      Append (&blockLength, 4);
+      Append (&interface, 4);
+      Append (&tsHigh, 4);
+      Append (&tsLow, 4);
+      Append (&inclLen, 4);
+      Append (&totalLen, 4);
+    }
+  return inclLen;
+}
+
+void
+PcapWriter::WriteRecordTrailer (uint32_t inclLen)
+{
+  NS_LOG_FUNCTION (this << inclLen);
+  if (m_format == PCAPNG)
+    {
+      uint32_t padding = (4 - inclLen % 4) % 4;
+      uint32_t blockLength = 28 + inclLen + padding + 4;
+      std::memset (Grow (padding), 0, padding);
+      Append (&blockLength, 4);
+    }
+  MaybeSubmit ();
+}
+
+void
+PcapWriter::Write (uint32_t interface, Time t, Header const *header, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (this << interface << t << header << p);
+  uint32_t headerSize = header == 0 ? 0 : header->GetSerializedSize ();
+  uint32_t inclLen = WriteRecordHeader (interface, t, headerSize + p->GetSize ());
+  uint8_t *data = Grow (inclLen);
+  if (headerSize != 0)
+    {
+      Buffer headerBuffer;
+      headerBuffer.AddAtStart (headerSize);
+      header->Serialize (headerBuffer.Begin ());
+      uint32_t copied = headerBuffer.CopyData (data, std::min (headerSize, inclLen));
+      data += copied;
+      inclLen -= copied;
+      headerSize = copied;
+    }
+  p->CopyData (data, inclLen);
+  WriteRecordTrailer (headerSize + inclLen);
+}
+
+void
+PcapWriter::Write (uint32_t interface, Time t, uint8_t const *data, uint32_t length)
+{
+  NS_LOG_FUNCTION (this << interface << t << &data << length);
+  uint32_t inclLen = WriteRecordHeader (interface, t, length);
+  Append (data, inclLen);
+  WriteRecordTrailer (inclLen);
+}
+
+void
+PcapWriter::Append (void const *data, uint32_t size)
+{
+  std::memcpy (Grow (size), data, size);
+}
+
+uint8_t *
+PcapWriter::Grow (uint32_t size)
+{
+  uint32_t offset = m_current->size ();
+  m_current->resize (offset + size);
+  return &(*m_current)[0] + offset;
+}
+
+void
+PcapWriter::MaybeSubmit (void)
+{
+  if (m_current->size () >= m_batchSize)
+    {
+      Submit ();
+    }
+}
+
+void
+PcapWriter::Submit (void)
+{
+  NS_LOG_FUNCTION (this << m_current->size ());
+  if (m_current->empty ())
+    {
+      return;
+    }
+#ifdef HAVE_PTHREAD_H
+  if (m_priv->thread != 0)
+    {
+      pthread_mutex_lock (&m_priv->mutex);
+      // Do not let the simulation run too far ahead of the disk.
+      while (m_priv->pending.size () >= MAX_PENDING_BATCHES)
+        {
+          pthread_cond_wait (&m_priv->cond, &m_priv->mutex);
+        }
+      m_priv->pending.push_back (m_current);
+      if (m_priv->free.empty ())
+        {
+          m_current = new std::vector<uint8_t> ();
+          m_current->reserve (m_batchSize);
+        }
+      else
+        {
+          m_current = m_priv->free.front ();
+          m_priv->free.pop_front ();
+        }
+      pthread_cond_broadcast (&m_priv->cond);
+      pthread_mutex_unlock (&m_priv->mutex);
+      return;
+    }
+#endif
+  Output (*m_current);
+  m_current->clear ();
+}
+
+void
+PcapWriter::Output (std::vector<uint8_t> const &batch)
+{
+  NS_LOG_FUNCTION (this << batch.size ());
+  bool ok = false;
+  if (m_priv->file != 0)
+    {
+      ok = std::fwrite (&batch[0], 1, batch.size (), m_priv->file) == batch.size ();
+    }
+#ifdef HAVE_ZLIB
+  else if (m_priv->gzfile != 0)
+    {
+      ok = gzwrite (m_priv->gzfile, &batch[0], batch.size ()) == static_cast<int> (batch.size ());
+    }
+#endif
+  if (!ok)
+    {
+#ifdef HAVE_PTHREAD_H
+      pthread_mutex_lock (&m_priv->mutex);
+      m_priv->fail = true;
+      pthread_mutex_unlock (&m_priv->mutex);
+#else
+      m_priv->fail = true;
+#endif
+    }
+}
+
+void
+PcapWriter::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_lock (&m_priv->mutex);
+  while (true)
+    {
+      while (m_priv->pending.empty () && !m_priv->stop)
+        {
+          pthread_cond_wait (&m_priv->cond, &m_priv->mutex);
+        }
+      if (m_priv->pending.empty ())
+        {
+          break;
+        }
+      std::vector<uint8_t> *batch = m_priv->pending.front ();
+      m_priv->pending.pop_front ();
+      m_priv->writing = true;
+      pthread_mutex_unlock (&m_priv->mutex);
+      Output (*batch);
+      batch->clear ();
+      pthread_mutex_lock (&m_priv->mutex);
+      m_priv->writing = false;
+      m_priv->free.push_back (batch);
+      pthread_cond_broadcast (&m_priv->cond);
+    }
+  pthread_mutex_unlock (&m_priv->mutex);
+#endif
+}
+
+void
+PcapWriter::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  Submit ();
+#ifdef HAVE_PTHREAD_H
+  if (m_priv->thread != 0)
+    {
+      pthread_mutex_lock (&m_priv->mutex);
+      while (!m_priv->pending.empty () || m_priv->writing)
+        {
+          pthread_cond_wait (&m_priv->cond, &m_priv->mutex);
+        }
+      pthread_mutex_unlock (&m_priv->mutex);
+    }
+#endif
+  if (m_priv->file != 0)
+    {
+      std::fflush (m_priv->file);
+    }
+#ifdef HAVE_ZLIB
+  if (m_priv->gzfile != 0)
+    {
+      gzflush (m_priv->gzfile, Z_SYNC_FLUSH);
+    }
+#endif
+}
+
+void
+PcapWriter::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  Submit ();
+#ifdef HAVE_PTHREAD_H
+  if (m_priv->thread != 0)
+    {
+      pthread_mutex_lock (&m_priv->mutex);
+      m_priv->stop = true;
+      pthread_cond_broadcast (&m_priv->cond);
+      pthread_mutex_unlock (&m_priv->mutex);
+      m_priv->thread->Join ();
+      m_priv->thread = 0;
+      m_priv->stop = false;
+    }
+#endif
+  if (m_priv->file != 0)
+    {
+      if (std::fclose (m_priv->file) != 0)
+        {
+          m_priv->fail = true;
+        }
+      m_priv->file = 0;
+    }
+#ifdef HAVE_ZLIB
+  if (m_priv->gzfile != 0)
+    {
+      if (gzclose (m_priv->gzfile) != Z_OK)
+        {
+          m_priv->fail = true;
+        }
+      m_priv->gzfile = 0;
+    }
+#endif
+}
+
+} // namespace ns3
@@ -0,0 +1,204 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PCAP_WRITER_H
+#define PCAP_WRITER_H
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+class Packet;
+class Header;
+struct PcapWriterPrivate;
+
+/**
+ * \ingroup network
+ * \brief Buffered writer of pcap and pcapng files.
+ *
+ * The records are formatted in memory and written to the file in large
+ * batches, from a background thread if requested and if threads are
+ * available. The file can be compressed with gzip, if ns-3 was
+ * configured with zlib.
+ *
+ * A pcap file holds the packets of a single interface. A pcapng
+ * file can hold the packets of any number of interfaces, with their
+ * own data link types: PcapHelper uses it to write the traces of
+ * many devices to a single file.
+ *
+ * PcapFileWrapper uses this class when its Asynchronous or Compression
+ * attribute is set. Most users do not need to use it directly.
+ */
+class PcapWriter : public SimpleRefCount<PcapWriter>
+{
+public:
+  /** File formats. */
+  enum Format
+  {
+    PCAP,     //!< Classic pcap file, with a single interface.
+    PCAPNG    //!< Pcapng file, with any number of interfaces.
+  };
+
+  /** Compression of the file. */
+  enum Compression
+  {
+    NONE,     //!< Not compressed.
+    GZIP      //!< Compressed with gzip.
+  };
+
+  PcapWriter ();
+  ~PcapWriter ();
+
+  /**
+   * \returns true if gzip compression is available.
+   */
+  static bool IsGzipAvailable (void);
+
+  /**
+   * Create a file, truncating it if it exists.
+   *
+   * \param filename the name of the file.
+   * \param format the format of the file. A pcapng file starts with
+   *        its section header, and its interfaces are added with
+   *        AddInterface. A pcap file starts with the header written
+   *        by WriteFileHeader.
+   * \param compression the compression of the file.
+   * \param asynchronous true to write the batches from a background
+   *        thread, false to write them from the caller.
+   * \param batchSize the number of bytes which are formatted in
+   *        memory before being written to the file.
+   */
+  void Open (std::string const &filename, enum Format format,
+             enum Compression compression, bool asynchronous,
+             uint32_t batchSize);
+  /**
+   * \returns true if the file could not be created or written.
+   */
+  bool Fail (void) const;
+  /**
+   * \returns the format of the file.
+   */
+  enum Format GetFormat (void) const;
+
+  /**
+   * Write the header of a pcap file.
+   *
+   * \param dataLinkType the data link type of the packets.
+   * \param snapLen the maximum number of bytes written per packet.
+   * \param tzCorrection the time zone offset from UTC.
+   */
+  void WriteFileHeader (uint32_t dataLinkType, uint32_t snapLen, int32_t tzCorrection);
+  /**
+   * Add an interface to a pcapng file.
+   *
+   * \param dataLinkType the data link type of the packets.
+   * \param snapLen the maximum number of bytes written per packet.
+   * \param name the name of the interface.
+   * \returns the identifier of the interface in the file.
+   */
+  uint32_t AddInterface (uint32_t dataLinkType, uint32_t snapLen, std::string const &name);
+
+  /**
+   * Write a packet.
+   *
+   * \param interface the identifier of the interface of the packet,
+   *        for a pcapng file.
+   * \param t the time stamp of the packet.
+   * \param header a header to write in front of the packet, or null.
+   * \param p the packet.
+   */
+  void Write (uint32_t interface, Time t, Header const *header, Ptr<const Packet> p);
+  /**
+   * Write a packet.
+   *
+   * \param interface the identifier of the interface of the packet,
+   *        for a pcapng file.
+   * \param t the time stamp of the packet.
+   * \param data the packet.
+   * \param length the size of the packet.
+   */
+  void Write (uint32_t interface, Time t, uint8_t const *data, uint32_t length);
+
+  /**
+   * Write the pending batches to the file.
+   */
+  void Flush (void);
+  /**
+   * Flush and close the file.
+   */
+  void Close (void);
+
+private:
+  /**
+   * Write the header of a packet record.
+   *
+   * \param interface the interface of the packet.
+   * \param t the time stamp of the packet.
+   * \param totalLen the size of the packet.
+   * \returns the number of bytes of the packet to write.
+   */
+  uint32_t WriteRecordHeader (uint32_t interface, Time t, uint32_t totalLen);
+  /**
+   * Finish a packet record.
+   *
+   * \param inclLen the number of bytes of the packet written.
+   */
+  void WriteRecordTrailer (uint32_t inclLen);
+  /**
+   * Append bytes to the current batch.
+   * \param data the bytes.
+   * \param size the number of bytes.
+   */
+  void Append (void const *data, uint32_t size);
+  /**
+   * Make room at the end of the current batch.
+   * \param size the number of bytes.
+   * \returns the start of the room made.
+   */
+  uint8_t *Grow (uint32_t size);
+  /**
+   * Hand the current batch over to the output, if it is large enough.
+   */
+  void MaybeSubmit (void);
+  /**
+   * Hand the current batch over to the output.
+   */
+  void Submit (void);
+  /**
+   * Write a batch to the file.
+   * \param batch the batch.
+   */
+  void Output (std::vector<uint8_t> const &batch);
+  /**
+   * Body of the background thread: write the submitted batches.
+   */
+  void Run (void);
+
+  enum Format m_format;                   //!< The file format.
+  std::vector<uint8_t> *m_current;        //!< The batch being formatted.
+  uint32_t m_batchSize;                   //!< The size of the batches.
+  std::vector<uint32_t> m_snapLen;        //!< The snapshot length of each interface.
+  struct PcapWriterPrivate *m_priv;       //!< The file, and the thread writing it.
+};
+
+} // namespace ns3
+
+#endif /* PCAP_WRITER_H */
@@ -16,14 +16,109 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
 #include "ns3/log.h"
 #include "ns3/trace-source-accessor.h"
+#include "ns3/double.h"
+#include "ns3/simulator.h"
+#include "ns3/tag.h"
 #include "queue.h"
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Queue");
 
+/**
+ * The time at which a packet enqueued with fluid ahead of it may be
+ * transmitted, once the fluid has been served.
+ */
+class QueueFluidTag : public Tag
+{
+public:
+  QueueFluidTag ();
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer i) const;
+  virtual void Deserialize (TagBuffer i);
+  virtual void Print (std::ostream &os) const;
+
+  /**
+   * \param ready the time at which the packet may be transmitted
+   */
+  void SetReadyTime (Time ready);
+  /**
+   * \return the time at which the packet may be transmitted
+   */
+  Time GetReadyTime (void) const;
+
+private:
+  int64_t m_ready; //!< Ready time, in time steps
+};
+
+QueueFluidTag::QueueFluidTag ()
+  : m_ready (0)
+{
+}
+
+TypeId
+QueueFluidTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::QueueFluidTag")
+    .SetParent<Tag> ()
+    .AddConstructor<QueueFluidTag> ()
+  ;
+  return tid;
+}
+
+TypeId
+QueueFluidTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+QueueFluidTag::GetSerializedSize (void) const
+{
+  return 8;
+}
+
+void
+QueueFluidTag::Serialize (TagBuffer i) const
+{
+  i.WriteU64 (m_ready);
+}
+
+void
+QueueFluidTag::Deserialize (TagBuffer i)
+{
+  m_ready = i.ReadU64 ();
+}
+
+void
+QueueFluidTag::Print (std::ostream &os) const
+{
+  os << "ReadyTime=" << m_ready;
+}
+
+void
+QueueFluidTag::SetReadyTime (Time ready)
+{
+  m_ready = ready.GetTimeStep ();
+}
+
+Time
+QueueFluidTag::GetReadyTime (void) const
+{
+  return TimeStep (m_ready);
+}
+
+NS_OBJECT_ENSURE_REGISTERED (QueueFluidTag);
+
 NS_OBJECT_ENSURE_REGISTERED (Queue);
 
 TypeId 
@@ -41,11 +136,25 @@ Queue::GetTypeId (void)
     .AddTraceSource ("Drop", "Drop a packet stored in the queue.",
                      MakeTraceSourceAccessor (&Queue::m_traceDrop),
                      "ns3::Packet::TracedCallback")
+    .AddAttribute ("FluidMaxBytes",
+                   "The maximum number of bytes of fluid and packets waiting "
+                   "for the link, when the queue carries fluid traffic.",
+                   DoubleValue (150000),
+                   MakeDoubleAccessor (&Queue::m_fluidMaxBytes),
+                   MakeDoubleChecker<double> (0))
   ;
   return tid;
 }
 
 Queue::Queue() : 
+  m_fluidLinkRate (0),
+  m_fluidRate (0),
+  m_fluidMaxBytes (150000),
+  m_fluidBacklog (0),
+  m_fluidUpdate (Seconds (0)),
+  m_fluidReady (Seconds (0)),
+  m_fluidPackets (0),
+  m_fluidDropCredit (0),
   m_nBytes (0),
   m_nTotalReceivedBytes (0),
   m_nPackets (0),
@@ -67,14 +176,48 @@ Queue::Enqueue (Ptr<Packet> p)
 {
   NS_LOG_FUNCTION (this << p);
 
+  //
+  // With fluid ahead of it, the packet waits for the fluid work to be
+  // served, and is lost if this work is at its bound.
+  //
+  bool fluid = false;
+  if (m_fluidRate > 0 || m_fluidBacklog > 0)
+    {
+      UpdateFluid ();
+      if (m_fluidBacklog + p->GetSize () > m_fluidMaxBytes)
+        {
+          // While the fluid overflows, the packets which do not fit are
+          // lost in the same ratio as the fluid, and replace it otherwise.
+          double loss = GetFluidLossRatio ();
+          m_fluidDropCredit += loss;
+          if (loss == 0 || m_fluidDropCredit >= 1)
+            {
+              m_fluidDropCredit = std::max (m_fluidDropCredit - 1, 0.0);
+              NS_LOG_LOGIC ("Fluid work full, dropping " << p);
+              Drop (p);
+              return false;
+            }
+        }
+      if (m_fluidBacklog > 0)
+        {
+          QueueFluidTag tag;
+          tag.SetReadyTime (Simulator::Now () + GetFluidDelay ());
+          p->AddPacketTag (tag);
+          fluid = true;
+        }
+    }
+
   //
   // If DoEnqueue fails, Queue::Drop is called by the subclass
   //
   bool retval = DoEnqueue (p);
   if (retval)
     {
-      NS_LOG_LOGIC ("m_traceEnqueue (p)");
-      m_traceEnqueue (p);
+      if (!m_traceEnqueue.IsEmpty ())
+        {
+          NS_LOG_LOGIC ("m_traceEnqueue (p)");
+          m_traceEnqueue (p);
+        }
 
       uint32_t size = p->GetSize ();
       m_nBytes += size;
@@ -82,6 +225,15 @@ Queue::Enqueue (Ptr<Packet> p)
 
       m_nPackets++;
       m_nTotalReceivedPackets++;
+
+      if (m_fluidRate > 0 || m_fluidBacklog > 0)
+        {
+          m_fluidBacklog += size;
+        }
+      if (fluid)
+        {
+          m_fluidPackets++;
+        }
     }
   return retval;
 }
@@ -100,13 +252,58 @@ Queue::Dequeue (void)
 
       m_nBytes -= packet->GetSize ();
       m_nPackets--;
+      DequeueFluid (packet);
 
-      NS_LOG_LOGIC ("m_traceDequeue (packet)");
-      m_traceDequeue (packet);
+      if (!m_traceDequeue.IsEmpty ())
+        {
+          NS_LOG_LOGIC ("m_traceDequeue (packet)");
+          m_traceDequeue (packet);
+        }
     }
   return packet;
 }
 
+uint32_t
+Queue::DequeueBatch (std::vector<Ptr<Packet> > &packets, uint32_t maxPackets)
+{
+  NS_LOG_FUNCTION (this << maxPackets);
+  uint32_t first = packets.size ();
+  uint32_t n = DoDequeueBatch (packets, maxPackets);
+  NS_ASSERT (packets.size () == first + n);
+  for (uint32_t i = first; i < first + n; i++)
+    {
+      uint32_t size = packets[i]->GetSize ();
+      NS_ASSERT (m_nBytes >= size);
+      NS_ASSERT (m_nPackets > 0);
+      m_nBytes -= size;
+      m_nPackets--;
+      DequeueFluid (packets[i]);
+      if (!m_traceDequeue.IsEmpty ())
+        {
+          m_traceDequeue (packets[i]);
+        }
+    }
+  return n;
+}
+
+uint32_t
+Queue::DoDequeueBatch (std::vector<Ptr<Packet> > &packets, uint32_t maxPackets)
+{
+  NS_LOG_FUNCTION (this << maxPackets);
+  uint32_t n = 0;
+  while (n < maxPackets)
+    {
+      Ptr<Packet> packet = DoDequeue ();
+      if (packet == 0)
+        {
+          break;
+        }
+      packets.push_back (packet);
+      n++;
+    }
+  return n;
+}
+
 void
 Queue::DequeueAll (void)
 {
@@ -191,6 +388,124 @@ Queue::ResetStatistics (void)
   m_nTotalDroppedPackets = 0;
 }
 
+void
+Queue::SetFluidLinkRate (DataRate rate)
+{
+  NS_LOG_FUNCTION (this << rate);
+  UpdateFluid ();
+  m_fluidLinkRate = rate;
+}
+
+DataRate
+Queue::GetFluidLinkRate (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_fluidLinkRate;
+}
+
+void
+Queue::AddFluidRate (DataRate rate)
+{
+  NS_LOG_FUNCTION (this << rate);
+  UpdateFluid ();
+  m_fluidRate += rate.GetBitRate ();
+}
+
+void
+Queue::RemoveFluidRate (DataRate rate)
+{
+  NS_LOG_FUNCTION (this << rate);
+  NS_ASSERT_MSG (m_fluidRate >= rate.GetBitRate (), "Removing more fluid than was added");
+  UpdateFluid ();
+  m_fluidRate -= rate.GetBitRate ();
+}
+
+DataRate
+Queue::GetFluidRate (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return DataRate (m_fluidRate);
+}
+
+double
+Queue::GetFluidBacklog (void)
+{
+  NS_LOG_FUNCTION (this);
+  UpdateFluid ();
+  return m_fluidBacklog;
+}
+
+Time
+Queue::GetFluidDelay (void)
+{
+  NS_LOG_FUNCTION (this);
+  UpdateFluid ();
+  if (m_fluidBacklog == 0)
+    {
+      return Seconds (0);
+    }
+  return Seconds (m_fluidBacklog * 8 / m_fluidLinkRate.GetBitRate ());
+}
+
+double
+Queue::GetFluidLossRatio (void)
+{
+  NS_LOG_FUNCTION (this);
+  UpdateFluid ();
+  uint64_t link = m_fluidLinkRate.GetBitRate ();
+  if (m_fluidRate <= link || m_fluidBacklog < m_fluidMaxBytes)
+    {
+      return 0;
+    }
+  return static_cast<double> (m_fluidRate - link) / m_fluidRate;
+}
+
+Time
+Queue::GetFluidWait (void) const
+{
+  NS_LOG_FUNCTION (this);
+  Time now = Simulator::Now ();
+  return m_fluidReady > now ? m_fluidReady - now : Seconds (0);
+}
+
+void
+Queue::UpdateFluid (void)
+{
+  NS_LOG_FUNCTION (this);
+  Time now = Simulator::Now ();
+  double elapsed = (now - m_fluidUpdate).GetSeconds ();
+  m_fluidUpdate = now;
+  if (m_fluidLinkRate.GetBitRate () == 0)
+    {
+      // No link to serve the fluid: the queue ignores it.
+      m_fluidBacklog = 0;
+      return;
+    }
+  if (m_fluidRate == 0 && m_fluidBacklog == 0)
+    {
+      return;
+    }
+  // The rates are constant since the last update, so that the work
+  // changes linearly until it reaches one of its bounds.
+  double drift = (static_cast<double> (m_fluidRate) - m_fluidLinkRate.GetBitRate ()) / 8;
+  m_fluidBacklog = std::min (std::max (m_fluidBacklog + drift * elapsed, 0.0), m_fluidMaxBytes);
+}
+
+void
+Queue::DequeueFluid (Ptr<Packet> packet)
+{
+  QueueFluidTag tag;
+  if (m_fluidPackets > 0 && packet->RemovePacketTag (tag))
+    {
+      m_fluidPackets--;
+      m_fluidReady = tag.GetReadyTime ();
+    }
+  else
+    {
+      m_fluidReady = Seconds (0);
+    }
+}
+
 void
 Queue::Drop (Ptr<Packet> p)
 {
@@ -199,8 +514,11 @@ Queue::Drop (Ptr<Packet> p)
   m_nTotalDroppedPackets++;
   m_nTotalDroppedBytes += p->GetSize ();
 
-  NS_LOG_LOGIC ("m_traceDrop (p)");
-  m_traceDrop (p);
+  if (!m_traceDrop.IsEmpty ())
+    {
+      NS_LOG_LOGIC ("m_traceDrop (p)");
+      m_traceDrop (p);
+    }
 }
 
 } // namespace ns3
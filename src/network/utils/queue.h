@@ -26,9 +26,12 @@
 
 #include <string>
 #include <list>
+#include <vector>
 #include "ns3/packet.h"
 #include "ns3/object.h"
 #include "ns3/traced-callback.h"
+#include "ns3/nstime.h"
+#include "ns3/data-rate.h"
 
 namespace ns3 {
 
@@ -41,6 +44,21 @@ namespace ns3 {
  * \brief Abstract base class for packet Queues
  * 
  * This class defines the base APIs for packet queues in the ns-3 system
+ *
+ * A queue may also carry flow-level (fluid) traffic, which stands for
+ * aggregates of flows without simulating their packets: fluid sources
+ * add their rate to the queues of their path, and the queue keeps the
+ * amount of work (fluid and packet bytes) waiting for the link, which
+ * is served at the rate given by the device with SetFluidLinkRate.
+ * The work grows at the fluid rate minus the link rate, and is bounded
+ * by the FluidMaxBytes attribute: above it, the excess fluid is lost,
+ * and the packets which do not fit are lost in the same ratio.  A packet enqueued while
+ * fluid is present must wait for the work ahead of it: the device asks
+ * for this wait with GetFluidWait after dequeueing the packet.
+ *
+ * The model is a FIFO approximation, whatever the discipline of the
+ * subclass: the fluid is served in order with the packets, and only
+ * the queue discipline of the packets themselves applies to them.
  */
 class Queue : public Object
 {
@@ -69,6 +87,14 @@ public:
    * \return 0 if the operation was not successful; the packet otherwise.
    */
   Ptr<Packet> Dequeue (void);
+  /**
+   * Remove packets from the front of the Queue, for devices which
+   * transmit several packets at once.
+   * \param packets the vector to which the packets are appended
+   * \param maxPackets the maximum number of packets to remove
+   * \return the number of packets removed
+   */
+  uint32_t DequeueBatch (std::vector<Ptr<Packet> > &packets, uint32_t maxPackets);
   /**
    * Get a copy of the item at the front of the queue without removing it
    * \return 0 if the operation was not successful; the packet otherwise.
@@ -119,6 +145,60 @@ public:
    */
   void ResetStatistics (void);
 
+  /**
+   * \brief Set the rate at which the link serves the queue.
+   *
+   * Devices which support fluid traffic call this method; fluid added
+   * to a queue whose link rate is zero is ignored.  Only
+   * PointToPointNetDevice does so for now: the queues of the other
+   * devices neither delay nor drop the fluid.
+   *
+   * \param rate the rate of the link
+   */
+  void SetFluidLinkRate (DataRate rate);
+  /**
+   * \return the rate at which the link serves the queue, zero if its
+   * device does not support fluid traffic
+   */
+  DataRate GetFluidLinkRate (void) const;
+  /**
+   * \brief Add a fluid source to the queue.
+   * \param rate the rate of the source
+   */
+  void AddFluidRate (DataRate rate);
+  /**
+   * \brief Remove a fluid source from the queue.
+   * \param rate the rate of the source, as given to AddFluidRate
+   */
+  void RemoveFluidRate (DataRate rate);
+  /**
+   * \return the total rate of the fluid sources of the queue
+   */
+  DataRate GetFluidRate (void) const;
+  /**
+   * \return the work, in bytes, which a packet enqueued now would wait for
+   */
+  double GetFluidBacklog (void);
+  /**
+   * \return the delay which a packet enqueued now would wait for
+   */
+  Time GetFluidDelay (void);
+  /**
+   * \return the fraction of the fluid which is lost, because the work
+   * is at its bound and the fluid rate exceeds the link rate
+   */
+  double GetFluidLossRatio (void);
+  /**
+   * \brief Get the time that the last dequeued packet must still wait for
+   * the fluid enqueued before it.
+   *
+   * Devices which support fluid traffic call this method after Dequeue,
+   * and delay the transmission of the packet by the returned time.
+   *
+   * \return the wait of the last dequeued packet
+   */
+  Time GetFluidWait (void) const;
+
   /**
    * \brief Enumeration of the modes supported in the class.
    *
@@ -166,12 +246,42 @@ private:
    * \return the packet.
    */
   virtual Ptr<Packet> DoDequeue (void) = 0;
+  /**
+   * Pull packets from the queue
+   *
+   * The default implementation calls DoDequeue for each packet.
+   *
+   * \param packets the vector to which the packets are appended
+   * \param maxPackets the maximum number of packets to pull
+   * \return the number of packets pulled
+   */
+  virtual uint32_t DoDequeueBatch (std::vector<Ptr<Packet> > &packets, uint32_t maxPackets);
   /**
    * Peek the front packet in the queue
    * \return the packet.
    */
   virtual Ptr<const Packet> DoPeek (void) const = 0;
 
+  /**
+   * \brief Bring the fluid work up to date, at the rates of the fluid
+   * sources and of the link since the last update.
+   */
+  void UpdateFluid (void);
+  /**
+   * \brief Record the ready time of a dequeued packet, if it has one.
+   * \param packet the dequeued packet
+   */
+  void DequeueFluid (Ptr<Packet> packet);
+
+  DataRate m_fluidLinkRate;         //!< Rate of the link which serves the queue
+  uint64_t m_fluidRate;             //!< Total rate of the fluid sources, in bit/s
+  double m_fluidMaxBytes;           //!< Bound of the fluid work
+  double m_fluidBacklog;            //!< Work waiting for the link, in bytes
+  Time m_fluidUpdate;               //!< Time of the last update of the work
+  Time m_fluidReady;                //!< Ready time of the last dequeued packet
+  uint32_t m_fluidPackets;          //!< Number of queued packets with a ready time
+  double m_fluidDropCredit;         //!< Loss ratio accumulated by the packets since the last drop
+
 protected:
   /**
    *  \brief Drop a packet 
@@ -20,6 +20,7 @@
 #include "point-to-point-net-device.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/packet.h"
+#include "ns3/node.h"
 #include "ns3/simulator.h"
 #include "ns3/log.h"
 
@@ -80,6 +81,24 @@ PointToPointChannel::Attach (Ptr<PointToPointNetDevice> device)
       m_link[1].m_dst = m_link[0].m_src;
       m_link[0].m_state = IDLE;
       m_link[1].m_state = IDLE;
+      FindNodes ();
+    }
+}
+
+void
+PointToPointChannel::FindNodes (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_nDevices < N_DEVICES)
+    {
+      return;
+    }
+  for (uint32_t i = 0; i < N_DEVICES; i++)
+    {
+      Ptr<Node> src = m_link[i].m_src->GetNode ();
+      Ptr<Node> dst = m_link[i].m_dst->GetNode ();
+      m_link[i].m_dstNode = PeekPointer (dst);
+      m_link[i].m_crossSystem = src != 0 && dst != 0 && src->GetSystemId () != dst->GetSystemId ();
     }
 }
 
@@ -96,13 +115,31 @@ PointToPointChannel::TransmitStart (
   NS_ASSERT (m_link[1].m_state != INITIALIZING);
 
   uint32_t wire = src == m_link[0].m_src ? 0 : 1;
+  Link &link = m_link[wire];
+  NS_ASSERT_MSG (link.m_dstNode != 0, "The device is not added to a node");
 
-  Simulator::ScheduleWithContext (m_link[wire].m_dst->GetNode ()->GetId (),
-                                  txTime + m_delay, &PointToPointNetDevice::Receive,
-                                  m_link[wire].m_dst, p);
+  if (link.m_crossSystem)
+    {
+      // The receiver may run on the thread of another partition (see
+      // ParallelSimulatorImpl), which must share no reference count with
+      // this one: hand it a deep copy of the packet, and the device by
+      // plain pointer.
+      Simulator::ScheduleWithContext (link.m_dstNode->GetId (),
+                                      txTime + m_delay, &PointToPointNetDevice::Receive,
+                                      PeekPointer (link.m_dst), p->DeepCopy ());
+    }
+  else
+    {
+      Simulator::ScheduleWithContext (link.m_dstNode->GetId (),
+                                      txTime + m_delay, &PointToPointNetDevice::Receive,
+                                      link.m_dst, p);
+    }
 
   // Call the tx anim callback on the net device
-  m_txrxPointToPoint (p, src, m_link[wire].m_dst, txTime, txTime + m_delay);
+  if (!m_txrxPointToPoint.IsEmpty ())
+    {
+      m_txrxPointToPoint (p, src, link.m_dst, txTime, txTime + m_delay);
+    }
   return true;
 }
 
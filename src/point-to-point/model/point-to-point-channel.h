@@ -29,6 +29,7 @@
 namespace ns3 {
 
 class PointToPointNetDevice;
+class Node;
 class Packet;
 
 /**
@@ -71,6 +72,16 @@ public:
    */
   void Attach (Ptr<PointToPointNetDevice> device);
 
+  /**
+   * \brief Find the nodes of the attached devices.
+   *
+   * The devices call this method when they are added to a node.  The
+   * nodes are kept by plain pointer, so that the transmissions do not
+   * touch their reference counts, which are not thread-safe, from the
+   * thread of another partition of a ParallelSimulatorImpl.
+   */
+  void FindNodes (void);
+
   /**
    * \brief Transmit a packet over this channel
    * \param p Packet to transmit
@@ -190,11 +201,13 @@ public:
     /** \brief Create the link, it will be in INITIALIZING state
      *
      */
-    Link() : m_state (INITIALIZING), m_src (0), m_dst (0) {}
+    Link() : m_state (INITIALIZING), m_src (0), m_dst (0), m_dstNode (0), m_crossSystem (false) {}
 
     WireState                  m_state; //!< State of the link
     Ptr<PointToPointNetDevice> m_src;   //!< First NetDevice
     Ptr<PointToPointNetDevice> m_dst;   //!< Second NetDevice
+    Node                      *m_dstNode; //!< Node of the second NetDevice
+    bool                       m_crossSystem; //!< True if the nodes have different system ids
   };
 
   Link    m_link[N_DEVICES]; //!< Link model
@@ -25,6 +25,7 @@
 #include "ns3/trace-source-accessor.h"
 #include "ns3/uinteger.h"
 #include "ns3/pointer.h"
+#include "ns3/packet-burst.h"
 #include "point-to-point-net-device.h"
 #include "point-to-point-channel.h"
 #include "ppp-header.h"
@@ -55,7 +56,8 @@ PointToPointNetDevice::GetTypeId (void)
     .AddAttribute ("DataRate", 
                    "The default data rate for point to point links",
                    DataRateValue (DataRate ("32768b/s")),
-                   MakeDataRateAccessor (&PointToPointNetDevice::m_bps),
+                   MakeDataRateAccessor (&PointToPointNetDevice::SetDataRate,
+                                         &PointToPointNetDevice::GetDataRate),
                    MakeDataRateChecker ())
     .AddAttribute ("ReceiveErrorModel", 
                    "The receiver error model used to simulate packet loss",
@@ -67,6 +69,20 @@ PointToPointNetDevice::GetTypeId (void)
                    TimeValue (Seconds (0.0)),
                    MakeTimeAccessor (&PointToPointNetDevice::m_tInterframeGap),
                    MakeTimeChecker ())
+    .AddAttribute ("ReceiveBurstSize",
+                   "The maximum number of received packets delivered at once "
+                   "to the upper layers which accept bursts, as with interrupt "
+                   "coalescing.  With the default value, 1, every packet is "
+                   "delivered when it is received.",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&PointToPointNetDevice::m_rxBurstSize),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("ReceiveBurstDelay",
+                   "The maximum time a received packet is held to be delivered "
+                   "with the next ones, when ReceiveBurstSize is greater than 1.",
+                   TimeValue (MicroSeconds (50)),
+                   MakeTimeAccessor (&PointToPointNetDevice::m_rxBurstDelay),
+                   MakeTimeChecker ())
 
     //
     // Transmit queueing discipline for the device which includes its own set
@@ -75,7 +91,8 @@ PointToPointNetDevice::GetTypeId (void)
     .AddAttribute ("TxQueue", 
                    "A queue to use as the transmit queue in the device.",
                    PointerValue (),
-                   MakePointerAccessor (&PointToPointNetDevice::m_queue),
+                   MakePointerAccessor (&PointToPointNetDevice::SetQueue,
+                                        &PointToPointNetDevice::GetQueue),
                    MakePointerChecker<Queue> ())
 
     //
@@ -176,6 +193,7 @@ PointToPointNetDevice::PointToPointNetDevice ()
   :
     m_txMachineState (READY),
     m_channel (0),
+    m_rxBurstProtocol (0),
     m_linkUp (false),
     m_currentPkt (0)
 {
@@ -214,6 +232,9 @@ PointToPointNetDevice::DoDispose ()
   m_channel = 0;
   m_receiveErrorModel = 0;
   m_currentPkt = 0;
+  m_rxBurstEvent.Cancel ();
+  m_rxBurst = 0;
+  m_rxBurstCallback = MakeNullCallback<bool, Ptr<NetDevice>, Ptr<const PacketBurst>, uint16_t, const Address &> ();
   NetDevice::DoDispose ();
 }
 
@@ -222,6 +243,17 @@ PointToPointNetDevice::SetDataRate (DataRate bps)
 {
   NS_LOG_FUNCTION (this);
   m_bps = bps;
+  if (m_queue != 0)
+    {
+      m_queue->SetFluidLinkRate (m_bps);
+    }
+}
+
+DataRate
+PointToPointNetDevice::GetDataRate (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_bps;
 }
 
 void
@@ -247,7 +279,11 @@ PointToPointNetDevice::TransmitStart (Ptr<Packet> p)
   m_currentPkt = p;
   m_phyTxBeginTrace (m_currentPkt);
 
-  Time txTime = m_bps.CalculateBytesTxTime (p->GetSize ());
+  //
+  // The packet may have to wait for the fluid traffic queued before it,
+  // which occupies the link meanwhile.
+  //
+  Time txTime = m_queue->GetFluidWait () + m_bps.CalculateBytesTxTime (p->GetSize ());
   Time txCompleteTime = txTime + m_tInterframeGap;
 
   NS_LOG_LOGIC ("Schedule TransmitCompleteEvent in " << txCompleteTime.GetSeconds () << "sec");
@@ -320,6 +356,10 @@ PointToPointNetDevice::SetQueue (Ptr<Queue> q)
 {
   NS_LOG_FUNCTION (this << q);
   m_queue = q;
+  if (m_queue != 0)
+    {
+      m_queue->SetFluidLinkRate (m_bps);
+    }
 }
 
 void
@@ -375,10 +415,50 @@ PointToPointNetDevice::Receive (Ptr<Packet> packet)
         }
 
       m_macRxTrace (originalPacket);
-      m_rxCallback (this, packet, protocol, GetRemote ());
+      if (m_rxBurstSize <= 1 || m_rxBurstCallback.IsNull ())
+        {
+          m_rxCallback (this, packet, protocol, GetRemote ());
+          return;
+        }
+
+      //
+      // Hold the packet for a burst, which is delivered when it is full or
+      // when its first packet has waited for the maximum delay.  A burst
+      // carries the packets of a single protocol.
+      //
+      if (m_rxBurst != 0 && protocol != m_rxBurstProtocol)
+        {
+          FlushReceiveBurst ();
+        }
+      if (m_rxBurst == 0)
+        {
+          m_rxBurst = CreateObject<PacketBurst> ();
+          m_rxBurstProtocol = protocol;
+          m_rxBurstEvent = Simulator::Schedule (m_rxBurstDelay, &PointToPointNetDevice::FlushReceiveBurst, this);
+        }
+      m_rxBurst->AddPacket (packet);
+      if (m_rxBurst->GetNPackets () >= m_rxBurstSize)
+        {
+          FlushReceiveBurst ();
+        }
     }
 }
 
+void
+PointToPointNetDevice::FlushReceiveBurst (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_rxBurstEvent.Cancel ();
+  if (m_rxBurst == 0)
+    {
+      return;
+    }
+  Ptr<PacketBurst> burst = m_rxBurst;
+  m_rxBurst = 0;
+  NS_LOG_LOGIC ("Deliver a burst of " << burst->GetNPackets () << " packets");
+  m_rxBurstCallback (this, burst, m_rxBurstProtocol, GetRemote ());
+}
+
 Ptr<Queue>
 PointToPointNetDevice::GetQueue (void) const
 { 
@@ -555,6 +635,47 @@ PointToPointNetDevice::Send (
   return false;
 }
 
+bool
+PointToPointNetDevice::SendBurst (
+  Ptr<PacketBurst> burst,
+  const Address &dest,
+  uint16_t protocolNumber)
+{
+  NS_LOG_FUNCTION (this << burst << dest << protocolNumber);
+
+  bool ok = true;
+  for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin (); i != burst->End (); ++i)
+    {
+      Ptr<Packet> packet = *i;
+      if (IsLinkUp () == false)
+        {
+          m_macTxDropTrace (packet);
+          ok = false;
+          continue;
+        }
+      AddHeader (packet, protocolNumber);
+      m_macTxTrace (packet);
+      if (!m_queue->Enqueue (packet))
+        {
+          m_macTxDropTrace (packet);
+          ok = false;
+        }
+    }
+
+  //
+  // The whole burst is queued: start a single transmission if the channel
+  // is ready, the next packets follow from TransmitComplete.
+  //
+  if (m_txMachineState == READY && !m_queue->IsEmpty ())
+    {
+      Ptr<Packet> packet = m_queue->Dequeue ();
+      m_snifferTrace (packet);
+      m_promiscSnifferTrace (packet);
+      ok = TransmitStart (packet) && ok;
+    }
+  return ok;
+}
+
 bool
 PointToPointNetDevice::SendFrom (Ptr<Packet> packet, 
                                  const Address &source, 
@@ -576,6 +697,10 @@ PointToPointNetDevice::SetNode (Ptr<Node> node)
 {
   NS_LOG_FUNCTION (this);
   m_node = node;
+  if (m_channel != 0)
+    {
+      m_channel->FindNodes ();
+    }
 }
 
 bool
@@ -591,6 +716,12 @@ PointToPointNetDevice::SetReceiveCallback (NetDevice::ReceiveCallback cb)
   m_rxCallback = cb;
 }
 
+void
+PointToPointNetDevice::SetReceiveBurstCallback (NetDevice::ReceiveBurstCallback cb)
+{
+  m_rxBurstCallback = cb;
+}
+
 void
 PointToPointNetDevice::SetPromiscReceiveCallback (NetDevice::PromiscReceiveCallback cb)
 {
@@ -30,10 +30,12 @@
 #include "ns3/data-rate.h"
 #include "ns3/ptr.h"
 #include "ns3/mac48-address.h"
+#include "ns3/event-id.h"
 
 namespace ns3 {
 
 class Queue;
+class PacketBurst;
 class PointToPointChannel;
 class ErrorModel;
 
@@ -94,6 +96,13 @@ public:
    */
   void SetDataRate (DataRate bps);
 
+  /**
+   * Get the Data Rate used for transmission of packets.
+   *
+   * \returns the data rate at which this object operates
+   */
+  DataRate GetDataRate (void) const;
+
   /**
    * Set the interframe gap used to separate packets.  The interframe gap
    * defines the minimum space required between packets sent by this device.
@@ -182,6 +191,7 @@ public:
 
   virtual bool Send (Ptr<Packet> packet, const Address &dest, uint16_t protocolNumber);
   virtual bool SendFrom (Ptr<Packet> packet, const Address& source, const Address& dest, uint16_t protocolNumber);
+  virtual bool SendBurst (Ptr<PacketBurst> burst, const Address &dest, uint16_t protocolNumber);
 
   virtual Ptr<Node> GetNode (void) const;
   virtual void SetNode (Ptr<Node> node);
@@ -189,6 +199,7 @@ public:
   virtual bool NeedsArp (void) const;
 
   virtual void SetReceiveCallback (NetDevice::ReceiveCallback cb);
+  virtual void SetReceiveBurstCallback (NetDevice::ReceiveBurstCallback cb);
 
   virtual Address GetMulticast (Ipv6Address addr) const;
 
@@ -237,6 +248,11 @@ private:
    */
   Address GetRemote (void) const;
 
+  /**
+   * \brief Deliver the packets held for a receive burst to the upper layers.
+   */
+  void FlushReceiveBurst (void);
+
   /**
    * Adds the necessary headers and trailers to a packet of data in order to
    * respect the protocol implemented by the agent.
@@ -444,6 +460,12 @@ private:
   NetDevice::ReceiveCallback m_rxCallback;   //!< Receive callback
   NetDevice::PromiscReceiveCallback m_promiscCallback;  //!< Receive callback
                                                         //   (promisc data)
+  NetDevice::ReceiveBurstCallback m_rxBurstCallback;    //!< Receive callback (bursts)
+  uint32_t m_rxBurstSize;     //!< Maximum number of packets per receive burst
+  Time m_rxBurstDelay;        //!< Maximum time a packet is held for a receive burst
+  Ptr<PacketBurst> m_rxBurst; //!< Packets held for the next receive burst
+  uint16_t m_rxBurstProtocol; //!< Protocol of the packets held for the next receive burst
+  EventId m_rxBurstEvent;     //!< Event delivering the packets held for a receive burst
   uint32_t m_ifIndex; //!< Index of the interface
   bool m_linkUp;      //!< Identify if the link is up or not
   TracedCallback<> m_linkChangeCallbacks;  //!< Callback for the link change event
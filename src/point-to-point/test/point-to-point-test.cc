@@ -3,6 +3,12 @@
 #include "ns3/simulator.h"
 #include "ns3/point-to-point-net-device.h"
 #include "ns3/point-to-point-channel.h"
+#include "ns3/packet-burst.h"
+#include "ns3/uinteger.h"
+#include "ns3/nstime.h"
+#include "ns3/flow-id-tag.h"
+#include "ns3/parallel-simulator-impl.h"
+#include <vector>
 
 using namespace ns3;
 
@@ -73,6 +79,262 @@ PointToPointTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \brief Test the bursts of packets sent and received by the PointToPoint model
+ *
+ * A burst of packets is sent from one NetDevice to another, which delivers
+ * them in bursts to a handler accepting them, and one by one to a handler
+ * which does not.
+ */
+class PointToPointBurstTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointBurstTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Send a burst of packets to the device specified
+   *
+   * \param device NetDevice to send to
+   * \param n number of packets
+   */
+  void SendBurst (Ptr<PointToPointNetDevice> device, uint32_t n);
+  /**
+   * \brief Receive a packet
+   *
+   * \param device the receiving device
+   * \param packet the packet
+   * \param protocol the protocol
+   * \param from the sender
+   * \param to the receiver
+   * \param packetType the type of the packet
+   */
+  void Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                const Address &from, const Address &to, NetDevice::PacketType packetType);
+  /**
+   * \brief Receive a burst of packets
+   *
+   * \param device the receiving device
+   * \param burst the packets
+   * \param protocol the protocol
+   * \param from the sender
+   * \param to the receiver
+   * \param packetType the type of the packets
+   */
+  void ReceiveBurst (Ptr<NetDevice> device, Ptr<const PacketBurst> burst, uint16_t protocol,
+                     const Address &from, const Address &to, NetDevice::PacketType packetType);
+
+  uint32_t m_received;              //!< Packets received one by one
+  std::vector<uint32_t> m_bursts;   //!< Sizes of the bursts received
+  std::vector<Time> m_burstTimes;   //!< Times of the bursts received
+};
+
+PointToPointBurstTest::PointToPointBurstTest ()
+  : TestCase ("PointToPoint bursts"),
+    m_received (0)
+{
+}
+
+void
+PointToPointBurstTest::SendBurst (Ptr<PointToPointNetDevice> device, uint32_t n)
+{
+  Ptr<PacketBurst> burst = CreateObject<PacketBurst> ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      burst->AddPacket (Create<Packet> (100));
+    }
+  NS_TEST_EXPECT_MSG_EQ (device->SendBurst (burst, device->GetBroadcast (), 0x800), true, "The burst was not sent");
+}
+
+void
+PointToPointBurstTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                                const Address &from, const Address &to, NetDevice::PacketType packetType)
+{
+  NS_TEST_EXPECT_MSG_EQ (packet->GetSize (), 100U, "Wrong packet size");
+  m_received++;
+}
+
+void
+PointToPointBurstTest::ReceiveBurst (Ptr<NetDevice> device, Ptr<const PacketBurst> burst, uint16_t protocol,
+                                     const Address &from, const Address &to, NetDevice::PacketType packetType)
+{
+  NS_TEST_EXPECT_MSG_EQ (protocol, 0x800, "Wrong protocol");
+  m_bursts.push_back (burst->GetNPackets ());
+  m_burstTimes.push_back (Simulator::Now ());
+}
+
+void
+PointToPointBurstTest::DoRun (void)
+{
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Ptr<PointToPointNetDevice> devA = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+
+  devA->Attach (channel);
+  devA->SetAddress (Mac48Address::Allocate ());
+  devA->SetQueue (CreateObject<DropTailQueue> ());
+  devB->Attach (channel);
+  devB->SetAddress (Mac48Address::Allocate ());
+  devB->SetQueue (CreateObject<DropTailQueue> ());
+  devB->SetAttribute ("ReceiveBurstSize", UintegerValue (4));
+  devB->SetAttribute ("ReceiveBurstDelay", TimeValue (Seconds (1.0)));
+
+  a->AddDevice (devA);
+  b->AddDevice (devB);
+  b->RegisterProtocolHandler (MakeCallback (&PointToPointBurstTest::Receive, this),
+                              MakeCallback (&PointToPointBurstTest::ReceiveBurst, this),
+                              0x800, devB);
+  b->RegisterProtocolHandler (MakeCallback (&PointToPointBurstTest::Receive, this), 0, devB);
+
+  Simulator::Schedule (Seconds (1.0), &PointToPointBurstTest::SendBurst, this, devA, 5);
+
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_bursts.size (), 2U, "Wrong number of bursts");
+  NS_TEST_EXPECT_MSG_EQ (m_bursts[0], 4U, "The first burst should be full");
+  NS_TEST_EXPECT_MSG_EQ (m_bursts[1], 1U, "The second burst should hold the last packet");
+  NS_TEST_EXPECT_MSG_LT (m_burstTimes[0], Seconds (2.0), "The full burst should be delivered right away");
+  NS_TEST_EXPECT_MSG_GT (m_burstTimes[1], Seconds (2.0), "The last packet should wait for the burst delay");
+  NS_TEST_EXPECT_MSG_EQ (m_received, 5U, "The packets should be delivered one by one to the other handler");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \brief Test the PointToPoint model across the partitions of a
+ * ParallelSimulatorImpl
+ *
+ * Two nodes in different partitions, thus run by different threads,
+ * exchange packets in both directions, which must arrive in the partition
+ * of the receiver with their uid and tags.
+ */
+class PointToPointParallelTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointParallelTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Send packets tagged with their uid
+   *
+   * \param device NetDevice to send to
+   * \param n number of packets
+   */
+  void SendPackets (Ptr<PointToPointNetDevice> device, uint32_t n);
+  /**
+   * \brief Receive a packet
+   *
+   * \param device the receiving device
+   * \param packet the packet
+   * \param protocol the protocol
+   * \param from the sender
+   * \param to the receiver
+   * \param packetType the type of the packet
+   */
+  void Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                const Address &from, const Address &to, NetDevice::PacketType packetType);
+
+  std::vector<uint32_t> m_received; //!< Packets received by each node
+  std::vector<uint32_t> m_errors;   //!< Packets received damaged or in the wrong partition by each node
+};
+
+PointToPointParallelTest::PointToPointParallelTest ()
+  : TestCase ("PointToPoint across partitions")
+{
+}
+
+void
+PointToPointParallelTest::SendPackets (Ptr<PointToPointNetDevice> device, uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (1000);
+      FlowIdTag tag (static_cast<uint32_t> (p->GetUid ()));
+      p->AddPacketTag (tag);
+      p->AddByteTag (tag);
+      device->Send (p, device->GetBroadcast (), 0x800);
+    }
+}
+
+void
+PointToPointParallelTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                                   const Address &from, const Address &to, NetDevice::PacketType packetType)
+{
+  uint32_t index = device->GetNode ()->GetSystemId ();
+  uint32_t uid = static_cast<uint32_t> (packet->GetUid ());
+  FlowIdTag packetTag;
+  FlowIdTag byteTag;
+  if (Simulator::GetSystemId () != index
+      || packet->GetSize () != 1000
+      || !packet->PeekPacketTag (packetTag)
+      || packetTag.GetFlowId () != uid
+      || !packet->FindFirstMatchingByteTag (byteTag)
+      || byteTag.GetFlowId () != uid)
+    {
+      m_errors[index]++;
+    }
+  m_received[index]++;
+}
+
+void
+PointToPointParallelTest::DoRun (void)
+{
+  Simulator::Destroy ();
+  Simulator::SetImplementation (CreateObject<ParallelSimulatorImpl> ());
+
+  Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+  channel->SetAttribute ("Delay", TimeValue (MilliSeconds (1)));
+  std::vector<Ptr<PointToPointNetDevice> > devices;
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Ptr<Node> node = CreateObject<Node> (i);
+      Ptr<PointToPointNetDevice> device = CreateObject<PointToPointNetDevice> ();
+      device->SetAttribute ("DataRate", DataRateValue (DataRate ("10Mb/s")));
+      device->SetAddress (Mac48Address::Allocate ());
+      device->SetQueue (CreateObject<DropTailQueue> ());
+      node->AddDevice (device);
+      device->Attach (channel);
+      node->RegisterProtocolHandler (MakeCallback (&PointToPointParallelTest::Receive, this), 0x800, device);
+      devices.push_back (device);
+    }
+  m_received.assign (2, 0);
+  m_errors.assign (2, 0);
+
+  // 50 ms of traffic in each direction, over 50 windows.
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Simulator::ScheduleWithContext (devices[i]->GetNode ()->GetId (), Seconds (0),
+                                      &PointToPointParallelTest::SendPackets, this, devices[i], 60);
+    }
+  Simulator::Run ();
+
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_received[i], 60U, "Packets lost by node " << i);
+      NS_TEST_EXPECT_MSG_EQ (m_errors[i], 0U, "Packets damaged or received in the wrong partition by node " << i);
+    }
+
+  Simulator::Destroy ();
+}
+
 /**
  * \brief TestSuite for PointToPoint module
  */
@@ -89,6 +351,8 @@ PointToPointTestSuite::PointToPointTestSuite ()
   : TestSuite ("devices-point-to-point", UNIT)
 {
   AddTestCase (new PointToPointTest, TestCase::QUICK);
+  AddTestCase (new PointToPointBurstTest, TestCase::QUICK);
+  AddTestCase (new PointToPointParallelTest, TestCase::QUICK);
 }
 
 static PointToPointTestSuite g_pointToPointTestSuite; //!< The testsuite
@@ -133,6 +133,7 @@ SingleModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
 
 
   Ptr<MobilityModel> senderMobility = txParams->txPhy->GetMobility ();
+  EventBatch receptions;
 
   for (PhyList::const_iterator rxPhyIterator = m_phyList.begin ();
        rxPhyIterator != m_phyList.end ();
@@ -197,17 +198,19 @@ SingleModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
             {
               // the receiver has a NetDevice, so we expect that it is attached to a Node
               uint32_t dstNode =  netDev->GetNode ()->GetId ();
-              Simulator::ScheduleWithContext (dstNode, delay, &SingleModelSpectrumChannel::StartRx, this, rxParams, *rxPhyIterator);
+              receptions.Add (dstNode, delay,
+                              MakeEvent (&SingleModelSpectrumChannel::StartRx, this, rxParams, *rxPhyIterator));
             }
           else
             {
               // the receiver is not attached to a NetDevice, so we cannot assume that it is attached to a node
-              Simulator::Schedule (delay, &SingleModelSpectrumChannel::StartRx, this,
-                                   rxParams, *rxPhyIterator);
+              receptions.Add (Simulator::GetContext (), delay,
+                              MakeEvent (&SingleModelSpectrumChannel::StartRx, this,
+                                         rxParams, *rxPhyIterator));
             }
         }
     }
-
+  Simulator::ScheduleBatch (receptions);
 }
 
 void
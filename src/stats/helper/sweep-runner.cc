@@ -0,0 +1,293 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "sweep-runner.h"
+#include "ns3/data-collector.h"
+#include "ns3/data-output-interface.h"
+#include "ns3/command-line.h"
+#include "ns3/config.h"
+#include "ns3/string.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/assert.h"
+#include "ns3/fatal-error.h"
+#include "ns3/log.h"
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SweepRunner");
+
+SweepRunner::SweepRunner ()
+  : m_maxWorkers (0),
+    m_cmd (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+SweepRunner::~SweepRunner ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+SweepRunner::SetMaxWorkers (uint32_t workers)
+{
+  NS_LOG_FUNCTION (this << workers);
+  m_maxWorkers = workers;
+}
+
+void
+SweepRunner::SetCommandLine (CommandLine &cmd)
+{
+  NS_LOG_FUNCTION (this << &cmd);
+  m_cmd = &cmd;
+}
+
+void
+SweepRunner::SetExperiment (std::string experiment, std::string strategy)
+{
+  NS_LOG_FUNCTION (this << experiment << strategy);
+  m_experiment = experiment;
+  m_strategy = strategy;
+}
+
+void
+SweepRunner::SetDataOutput (Ptr<DataOutputInterface> output)
+{
+  NS_LOG_FUNCTION (this << output);
+  m_output = output;
+}
+
+uint32_t
+SweepRunner::AddPoint (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_points.push_back (Settings ());
+  m_status.push_back (-1);
+  return m_points.size () - 1;
+}
+
+void
+SweepRunner::Set (uint32_t point, std::string name, std::string value)
+{
+  NS_LOG_FUNCTION (this << point << name << value);
+  NS_ASSERT (point < m_points.size ());
+  m_points[point].push_back (std::make_pair (name, value));
+}
+
+void
+SweepRunner::Set (uint32_t point, std::string name, uint64_t value)
+{
+  std::ostringstream oss;
+  oss << value;
+  Set (point, name, oss.str ());
+}
+
+uint32_t
+SweepRunner::GetNPoints (void) const
+{
+  return m_points.size ();
+}
+
+int
+SweepRunner::GetStatus (uint32_t point) const
+{
+  NS_ASSERT (point < m_status.size ());
+  return m_status[point];
+}
+
+uint32_t
+SweepRunner::Run (RunCallback run)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t maxWorkers = m_maxWorkers;
+  if (maxWorkers == 0)
+    {
+      long n = sysconf (_SC_NPROCESSORS_ONLN);
+      maxWorkers = n > 0 ? n : 1;
+    }
+  // The workers lock this file around their output. Unlike a pipe
+  // holding a token, the lock is released if a worker crashes.
+  FILE *lockFile = std::tmpfile ();
+  if (lockFile == 0)
+    {
+      NS_FATAL_ERROR ("SweepRunner::Run(): tmpfile() failed: " << std::strerror (errno));
+    }
+  // The output buffered so far would otherwise be written again by
+  // every worker.
+  std::cout.flush ();
+  std::cerr.flush ();
+  std::clog.flush ();
+  std::fflush (0);
+
+  std::vector<pid_t> pids (m_points.size (), -1);
+  uint32_t running = 0;
+  for (uint32_t i = 0; i < m_points.size (); ++i)
+    {
+      if (running == maxWorkers)
+        {
+          Wait (pids);
+          running--;
+        }
+      pid_t pid = fork ();
+      if (pid < 0)
+        {
+          NS_FATAL_ERROR ("SweepRunner::Run(): fork() failed: " << std::strerror (errno));
+        }
+      if (pid == 0)
+        {
+          RunPoint (i, run, fileno (lockFile));
+          std::cout.flush ();
+          std::cerr.flush ();
+          std::fflush (0);
+          // Leave without running the destructors of the objects
+          // shared with the calling process.
+          _exit (0);
+        }
+      NS_LOG_LOGIC ("point " << i << " runs in process " << pid);
+      pids[i] = pid;
+      running++;
+    }
+  while (running > 0)
+    {
+      Wait (pids);
+      running--;
+    }
+  std::fclose (lockFile);
+
+  uint32_t failed = 0;
+  for (uint32_t i = 0; i < m_status.size (); ++i)
+    {
+      if (m_status[i] != 0)
+        {
+          failed++;
+        }
+    }
+  return failed;
+}
+
+uint32_t
+SweepRunner::Wait (std::vector<pid_t> &pids)
+{
+  NS_LOG_FUNCTION (this);
+  while (true)
+    {
+      int status;
+      pid_t pid = waitpid (-1, &status, 0);
+      if (pid < 0)
+        {
+          if (errno == EINTR)
+            {
+              continue;
+            }
+          NS_FATAL_ERROR ("SweepRunner::Run(): waitpid() failed: " << std::strerror (errno));
+        }
+      for (uint32_t i = 0; i < pids.size (); ++i)
+        {
+          if (pids[i] == pid)
+            {
+              pids[i] = -1;
+              m_status[i] = WIFEXITED (status) ? WEXITSTATUS (status) : -1;
+              NS_LOG_LOGIC ("point " << i << " exited with " << m_status[i]);
+              return i;
+            }
+        }
+      // Not one of our workers: a process forked by the simulation itself.
+    }
+}
+
+void
+SweepRunner::RunPoint (uint32_t point, RunCallback run, int lock)
+{
+  NS_LOG_FUNCTION (this << point << lock);
+  const Settings &settings = m_points[point];
+  Apply (settings);
+  RandomVariableStream::ResetStreams ();
+
+  std::ostringstream runId;
+  runId << point;
+  std::ostringstream input;
+  for (Settings::const_iterator i = settings.begin (); i != settings.end (); ++i)
+    {
+      input << (i == settings.begin () ? "" : " ") << i->first << "=" << i->second;
+    }
+  Ptr<DataCollector> collector = CreateObject<DataCollector> ();
+  collector->DescribeRun (m_experiment, m_strategy, input.str (), runId.str ());
+  for (Settings::const_iterator i = settings.begin (); i != settings.end (); ++i)
+    {
+      collector->AddMetadata (i->first, i->second);
+    }
+
+  run (point, collector);
+
+  if (m_output != 0)
+    {
+      struct flock fl;
+      std::memset (&fl, 0, sizeof (fl));
+      fl.l_type = F_WRLCK;
+      fl.l_whence = SEEK_SET;
+      while (fcntl (lock, F_SETLKW, &fl) < 0 && errno == EINTR)
+        {
+        }
+      m_output->Output (*collector);
+      fl.l_type = F_UNLCK;
+      fcntl (lock, F_SETLK, &fl);
+    }
+}
+
+void
+SweepRunner::Apply (const Settings &settings)
+{
+  NS_LOG_FUNCTION (this);
+  std::vector<std::string> args;
+  args.push_back ("sweep");
+  for (Settings::const_iterator i = settings.begin (); i != settings.end (); ++i)
+    {
+      if (!i->first.empty () && i->first[0] == '/')
+        {
+          Config::Set (i->first, StringValue (i->second));
+        }
+      else
+        {
+          args.push_back ("--" + i->first + "=" + i->second);
+        }
+    }
+  std::vector<char *> argv;
+  for (std::vector<std::string>::iterator i = args.begin (); i != args.end (); ++i)
+    {
+      argv.push_back (&(*i)[0]);
+    }
+  argv.push_back (0);
+  if (m_cmd != 0)
+    {
+      m_cmd->Parse (args.size (), &argv[0]);
+    }
+  else
+    {
+      CommandLine cmd;
+      cmd.Parse (args.size (), &argv[0]);
+    }
+}
+
+} // namespace ns3
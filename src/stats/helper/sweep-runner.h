@@ -0,0 +1,183 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SWEEP_RUNNER_H
+#define SWEEP_RUNNER_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <utility>
+#include <sys/types.h>
+
+#include "ns3/callback.h"
+#include "ns3/ptr.h"
+
+namespace ns3 {
+
+class CommandLine;
+class DataCollector;
+class DataOutputInterface;
+
+/**
+ * \ingroup dataoutput
+ * \brief Run the points of a parameter sweep in parallel processes.
+ *
+ * The simulation is set up once, in the calling process.  Run then
+ * forks one worker process per point of the sweep, keeping at most
+ * one worker per processor busy.  Each worker:
+ *   - applies the settings of its point,
+ *   - restarts the random variables from the resulting seed and run,
+ *     see RandomVariableStream::ResetStreams,
+ *   - calls the run callback, which typically runs the simulation and
+ *     adds its calculators to the DataCollector,
+ *   - and writes the DataCollector with the DataOutputInterface, if any.
+ *
+ * The outputs of the workers are serialized, so that they can share a
+ * single output such as an SqliteDataOutput database.
+ *
+ * The settings are name=value pairs.  A name starting with '/' is a
+ * Config path set with Config::Set.  Any other name is handled as
+ * the command line argument --name=value: a value added to the
+ * CommandLine given to SetCommandLine, a global value such as RngRun,
+ * or an attribute default.  Attribute defaults only affect the
+ * objects created by the run callback.
+ *
+ * \code
+ *   // build the topology ...
+ *   SweepRunner sweep;
+ *   sweep.SetExperiment ("wifi-load", "rate");
+ *   sweep.SetDataOutput (CreateObject<SqliteDataOutput> ());
+ *   for (uint32_t run = 1; run <= 100; ++run)
+ *     {
+ *       uint32_t point = sweep.AddPoint ();
+ *       sweep.Set (point, "RngRun", run);
+ *       sweep.Set (point, "/NodeList/0/ApplicationList/0/$ns3::OnOffApplication/DataRate", "5Mbps");
+ *     }
+ *   sweep.Run (MakeCallback (&RunOne));
+ * \endcode
+ *
+ * The workers are forked from the calling process, so the sweep runner
+ * is limited to POSIX systems and to single-threaded simulator
+ * implementations.
+ */
+class SweepRunner
+{
+public:
+  /**
+   * The run callback, with the index of the point and the collector
+   * of its results.
+   */
+  typedef Callback<void, uint32_t, Ptr<DataCollector> > RunCallback;
+
+  SweepRunner ();
+  ~SweepRunner ();
+
+  /**
+   * \param workers the maximum number of workers running at once,
+   *        or zero, the default, to run one worker per processor.
+   */
+  void SetMaxWorkers (uint32_t workers);
+  /**
+   * \param cmd the command line holding the program values that the
+   *        settings may change.  It must outlive Run.
+   */
+  void SetCommandLine (CommandLine &cmd);
+  /**
+   * \param experiment the experiment label of the DataCollectors.
+   * \param strategy the strategy label of the DataCollectors.
+   */
+  void SetExperiment (std::string experiment, std::string strategy);
+  /**
+   * \param output the output of the DataCollectors of the workers.
+   */
+  void SetDataOutput (Ptr<DataOutputInterface> output);
+
+  /**
+   * Add a point to the sweep.
+   *
+   * \returns the index of the new point.
+   */
+  uint32_t AddPoint (void);
+  /**
+   * \param point the index of a point.
+   * \param name the name of the setting: a Config path, a CommandLine
+   *        value, a global value or an attribute default.
+   * \param value the value of the setting.
+   */
+  void Set (uint32_t point, std::string name, std::string value);
+  /**
+   * \param point the index of a point.
+   * \param name the name of the setting.
+   * \param value the value of the setting.
+   */
+  void Set (uint32_t point, std::string name, uint64_t value);
+  /** \returns the number of points of the sweep. */
+  uint32_t GetNPoints (void) const;
+
+  /**
+   * Run all the points of the sweep and wait for their workers.
+   *
+   * \param run the callback run by each worker after applying the
+   *        settings of its point.
+   * \returns the number of points whose worker failed.
+   */
+  uint32_t Run (RunCallback run);
+  /**
+   * \param point the index of a point.
+   * \returns the exit status of the worker of the point, or -1 if it
+   *          was terminated by a signal or has not run.
+   */
+  int GetStatus (uint32_t point) const;
+
+private:
+  /** The settings of a point. */
+  typedef std::vector<std::pair<std::string, std::string> > Settings;
+
+  /**
+   * Run a point, in its worker.
+   *
+   * \param point the index of the point.
+   * \param run the run callback.
+   * \param lock the file descriptor to lock around the output.
+   */
+  void RunPoint (uint32_t point, RunCallback run, int lock);
+  /**
+   * Apply the settings of a point, in its worker.
+   *
+   * \param settings the settings of the point.
+   */
+  void Apply (const Settings &settings);
+  /**
+   * Wait for a worker to exit and record its status.
+   *
+   * \param pids the process id of the worker of each point.
+   * \returns the index of the point of the worker.
+   */
+  uint32_t Wait (std::vector<pid_t> &pids);
+
+  uint32_t m_maxWorkers;              //!< The maximum number of workers.
+  CommandLine *m_cmd;                 //!< The command line of the program.
+  std::string m_experiment;           //!< The experiment label.
+  std::string m_strategy;             //!< The strategy label.
+  Ptr<DataOutputInterface> m_output;  //!< The output of the results.
+  std::vector<Settings> m_points;     //!< The settings of each point.
+  std::vector<int> m_status;          //!< The exit status of each point.
+};
+
+} // namespace ns3
+
+#endif /* SWEEP_RUNNER_H */
@@ -0,0 +1,149 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <fstream>
+#include <map>
+
+#include "ns3/test.h"
+#include "ns3/command-line.h"
+#include "ns3/simulator.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/data-collector.h"
+#include "ns3/data-output-interface.h"
+#include "ns3/sweep-runner.h"
+
+using namespace ns3;
+
+// ===========================================================================
+// Writes the run label and the metadata of each DataCollector on a line.
+// ===========================================================================
+
+class LineDataOutput : public DataOutputInterface
+{
+public:
+  LineDataOutput (std::string filename);
+  virtual void Output (DataCollector &dc);
+private:
+  std::string m_filename;
+};
+
+LineDataOutput::LineDataOutput (std::string filename)
+  : m_filename (filename)
+{
+}
+
+void
+LineDataOutput::Output (DataCollector &dc)
+{
+  std::ofstream out (m_filename.c_str (), std::ios::app);
+  out << dc.GetRunLabel ();
+  for (MetadataList::iterator i = dc.MetadataBegin (); i != dc.MetadataEnd (); ++i)
+    {
+      out << " " << i->first << "=" << i->second;
+    }
+  out << std::endl;
+}
+
+// ===========================================================================
+// Test case for the settings and results of the points of a sweep.
+// ===========================================================================
+
+class SweepRunnerTestCase : public TestCase
+{
+public:
+  SweepRunnerTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void RunOne (uint32_t point, Ptr<DataCollector> collector);
+
+  Ptr<UniformRandomVariable> m_rng;
+  uint32_t m_value;
+};
+
+SweepRunnerTestCase::SweepRunnerTestCase ()
+  : TestCase ("Run the points of a sweep in worker processes")
+{
+}
+
+void
+SweepRunnerTestCase::RunOne (uint32_t point, Ptr<DataCollector> collector)
+{
+  collector->AddMetadata ("draw", m_rng->GetInteger (0, 1000000));
+  collector->AddMetadata ("seen", m_value);
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+SweepRunnerTestCase::DoRun (void)
+{
+  uint64_t oldRun = RngSeedManager::GetRun ();
+  // The set up shared by all the points.
+  m_rng = CreateObject<UniformRandomVariable> ();
+  m_value = 0;
+  CommandLine cmd;
+  cmd.AddValue ("value", "A program value", m_value);
+
+  std::string filename = CreateTempDirFilename ("sweep-runner.txt");
+  SweepRunner sweep;
+  sweep.SetMaxWorkers (2);
+  sweep.SetCommandLine (cmd);
+  sweep.SetDataOutput (Create<LineDataOutput> (filename));
+  uint64_t runs[] = { 1, 2, 1, 3 };
+  for (uint32_t i = 0; i < 4; ++i)
+    {
+      uint32_t point = sweep.AddPoint ();
+      sweep.Set (point, "RngRun", runs[i]);
+      sweep.Set (point, "value", 10 + i);
+    }
+  NS_TEST_ASSERT_MSG_EQ (sweep.GetNPoints (), 4, "Wrong number of points");
+  uint32_t failed = sweep.Run (MakeCallback (&SweepRunnerTestCase::RunOne, this));
+  NS_TEST_ASSERT_MSG_EQ (failed, 0, "Some points failed");
+  NS_TEST_EXPECT_MSG_EQ (RngSeedManager::GetRun (), oldRun, "The settings leaked to the caller");
+  NS_TEST_EXPECT_MSG_EQ (m_value, 0, "The settings leaked to the caller");
+
+  std::map<std::string, std::string> draws;
+  std::map<std::string, std::string> seen;
+  std::ifstream in (filename.c_str ());
+  std::string point, rngRun, value, draw, see;
+  while (in >> point >> rngRun >> value >> draw >> see)
+    {
+      draws[point] = draw;
+      seen[point] = see;
+    }
+  NS_TEST_ASSERT_MSG_EQ (draws.size (), 4, "Missing outputs");
+  NS_TEST_EXPECT_MSG_EQ (seen["0"], "seen=10", "Program value not set");
+  NS_TEST_EXPECT_MSG_EQ (seen["3"], "seen=13", "Program value not set");
+  NS_TEST_EXPECT_MSG_EQ (draws["0"], draws["2"], "Same run drew different values");
+  NS_TEST_EXPECT_MSG_NE (draws["0"], draws["1"], "Different runs drew the same values");
+  NS_TEST_EXPECT_MSG_NE (draws["1"], draws["3"], "Different runs drew the same values");
+}
+
+class SweepRunnerTestSuite : public TestSuite
+{
+public:
+  SweepRunnerTestSuite ();
+};
+
+SweepRunnerTestSuite::SweepRunnerTestSuite ()
+  : TestSuite ("sweep-runner", UNIT)
+{
+  AddTestCase (new SweepRunnerTestCase, TestCase::QUICK);
+}
+
+static SweepRunnerTestSuite sweepRunnerTestSuite;
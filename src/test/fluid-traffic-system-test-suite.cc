@@ -0,0 +1,309 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// End-to-end checks of the flow-level (fluid) modes of OnOffApplication
+// and BulkSendApplication, whose traffic shares a point to point
+// bottleneck with packet-level flows.
+
+#include <algorithm>
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/config.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/pointer.h"
+#include "ns3/queue.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/csma-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/on-off-helper.h"
+#include "ns3/bulk-send-helper.h"
+#include "ns3/packet-sink-helper.h"
+#include "ns3/packet-sink.h"
+#include "ns3/v4ping-helper.h"
+
+using namespace ns3;
+
+namespace {
+
+/**
+ * \brief Build a chain of three nodes, whose second link is the
+ * bottleneck: 100 Mb/s and 1 ms, then 10 Mb/s and 5 ms.
+ * \param nodes the nodes, created by this function
+ * \returns the transmit queue of the bottleneck, towards the last node
+ */
+Ptr<Queue>
+BuildChain (NodeContainer &nodes)
+{
+  nodes.Create (3);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("100Mb/s"));
+  p2p.SetChannelAttribute ("Delay", StringValue ("1ms"));
+  NetDeviceContainer access = p2p.Install (nodes.Get (0), nodes.Get (1));
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("10Mb/s"));
+  p2p.SetChannelAttribute ("Delay", StringValue ("5ms"));
+  NetDeviceContainer bottleneck = p2p.Install (nodes.Get (1), nodes.Get (2));
+
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  ipv4.Assign (access);
+  ipv4.SetBase ("10.1.2.0", "255.255.255.0");
+  ipv4.Assign (bottleneck);
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  PointerValue queue;
+  bottleneck.Get (0)->GetAttribute ("TxQueue", queue);
+  return queue.Get<Queue> ();
+}
+
+} // anonymous namespace
+
+/**
+ * Overload the bottleneck with an OnOffApplication in fluid mode, and
+ * check the round trip times of pings which cross the fluid queue.
+ */
+class FluidOnOffTestCase : public TestCase
+{
+public:
+  FluidOnOffTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Record the round trip time of a ping.
+   * \param context the context of the trace
+   * \param rtt the round trip time
+   */
+  void Rtt (std::string context, Time rtt);
+
+  std::vector<std::pair<Time, Time> > m_rtts; //!< The reception times and round trip times.
+};
+
+FluidOnOffTestCase::FluidOnOffTestCase ()
+  : TestCase ("Check the delay and loss of pings crossing the fluid of an OnOffApplication")
+{
+}
+
+void
+FluidOnOffTestCase::Rtt (std::string context, Time rtt)
+{
+  m_rtts.push_back (std::make_pair (Simulator::Now (), rtt));
+}
+
+void
+FluidOnOffTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  Ptr<Queue> queue = BuildChain (nodes);
+
+  // 12 Mb/s of fluid during 5 s fill the 150000 bytes of the bottleneck
+  // in 0.6 s, then one sixth of the traffic is lost.
+  OnOffHelper onoff ("ns3::UdpSocketFactory", InetSocketAddress (Ipv4Address ("10.1.2.2"), 9));
+  onoff.SetConstantRate (DataRate ("12Mb/s"));
+  onoff.SetAttribute ("OnTime", StringValue ("ns3::ConstantRandomVariable[Constant=5]"));
+  onoff.SetAttribute ("OffTime", StringValue ("ns3::ConstantRandomVariable[Constant=0]"));
+  onoff.SetAttribute ("Fluid", BooleanValue (true));
+  ApplicationContainer fluid = onoff.Install (nodes.Get (0));
+  fluid.Start (Seconds (0));
+  fluid.Stop (Seconds (5));
+
+  V4PingHelper ping (Ipv4Address ("10.1.2.2"));
+  ping.SetAttribute ("Interval", TimeValue (MilliSeconds (100)));
+  ApplicationContainer pinger = ping.Install (nodes.Get (0));
+  pinger.Start (Seconds (1));
+  pinger.Stop (Seconds (6));
+  Config::Connect ("/NodeList/0/ApplicationList/1/$ns3::V4Ping/Rtt", MakeCallback (&FluidOnOffTestCase::Rtt, this));
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  // The base round trip time is 12 ms, and the fluid adds 120 ms.
+  uint32_t loaded = 0;
+  uint32_t idle = 0;
+  for (uint32_t i = 0; i < m_rtts.size (); i++)
+    {
+      Time at = m_rtts[i].first;
+      Time rtt = m_rtts[i].second;
+      if (at < Seconds (5))
+        {
+          NS_TEST_ASSERT_MSG_EQ_TOL (rtt.GetSeconds (), 0.132, 0.001, "Wrong round trip time in the fluid at " << at);
+          loaded++;
+        }
+      else if (at > Seconds (5.2))
+        {
+          NS_TEST_ASSERT_MSG_EQ_TOL (rtt.GetSeconds (), 0.012, 0.001, "Wrong round trip time after the fluid at " << at);
+          idle++;
+        }
+    }
+  // 40 pings are sent into the full queue, and lose as much as the fluid.
+  NS_TEST_ASSERT_MSG_EQ_TOL (loaded, 33U, 1, "Wrong number of pings through the fluid");
+  NS_TEST_ASSERT_MSG_GT (idle, 5U, "Pings lost after the fluid");
+  NS_TEST_ASSERT_MSG_EQ (queue->GetFluidRate (), DataRate (0), "Fluid left in the bottleneck");
+  NS_TEST_ASSERT_MSG_GT (queue->GetTotalDroppedPackets (), 0U, "No ping dropped by the fluid");
+}
+
+/**
+ * Share the bottleneck between a BulkSendApplication in fluid mode and
+ * a packet-level TCP transfer, and check that both complete.
+ */
+class FluidBulkSendTestCase : public TestCase
+{
+public:
+  FluidBulkSendTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Sample the fluid at the bottleneck.
+   * \param queue the bottleneck queue
+   */
+  void Sample (Ptr<Queue> queue);
+
+  double m_maxRate;      //!< The maximum fluid rate, in bit/s.
+  double m_maxBacklog;   //!< The maximum fluid work, in bytes.
+};
+
+FluidBulkSendTestCase::FluidBulkSendTestCase ()
+  : TestCase ("Check a packet-level transfer sharing a bottleneck with a fluid BulkSendApplication"),
+    m_maxRate (0),
+    m_maxBacklog (0)
+{
+}
+
+void
+FluidBulkSendTestCase::Sample (Ptr<Queue> queue)
+{
+  m_maxRate = std::max (m_maxRate, static_cast<double> (queue->GetFluidRate ().GetBitRate ()));
+  m_maxBacklog = std::max (m_maxBacklog, queue->GetFluidBacklog ());
+  Simulator::Schedule (MilliSeconds (50), &FluidBulkSendTestCase::Sample, this, queue);
+}
+
+void
+FluidBulkSendTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  Ptr<Queue> queue = BuildChain (nodes);
+
+  // 4 transfers of 2500000 bytes in total, in a few seconds.
+  BulkSendHelper bulk ("ns3::TcpSocketFactory", InetSocketAddress (Ipv4Address ("10.1.2.2"), 9));
+  bulk.SetAttribute ("Fluid", BooleanValue (true));
+  bulk.SetAttribute ("FluidFlows", UintegerValue (4));
+  bulk.SetAttribute ("MaxBytes", UintegerValue (2500000));
+  ApplicationContainer fluid = bulk.Install (nodes.Get (0));
+  fluid.Start (Seconds (0));
+  fluid.Stop (Seconds (20));
+
+  PacketSinkHelper sink ("ns3::TcpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), 10));
+  ApplicationContainer sinks = sink.Install (nodes.Get (2));
+  sinks.Start (Seconds (0));
+  sinks.Stop (Seconds (20));
+
+  BulkSendHelper foreground ("ns3::TcpSocketFactory", InetSocketAddress (Ipv4Address ("10.1.2.2"), 10));
+  foreground.SetAttribute ("MaxBytes", UintegerValue (100000));
+  ApplicationContainer packets = foreground.Install (nodes.Get (0));
+  packets.Start (Seconds (0.5));
+  packets.Stop (Seconds (20));
+
+  Simulator::Schedule (Seconds (0), &FluidBulkSendTestCase::Sample, this, queue);
+  Simulator::Stop (Seconds (20));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  Ptr<PacketSink> received = sinks.Get (0)->GetObject<PacketSink> ();
+  NS_TEST_ASSERT_MSG_EQ (received->GetTotalRx (), 100000U, "Packet-level transfer not completed");
+  NS_TEST_ASSERT_MSG_EQ (queue->GetFluidRate (), DataRate (0), "Fluid transfer not completed");
+  NS_TEST_ASSERT_MSG_GT (m_maxRate, 10e6, "Fluid transfer below the bottleneck rate");
+  NS_TEST_ASSERT_MSG_LT_OR_EQ (m_maxRate, 100e6, "Fluid transfer above the rate of its first link");
+  NS_TEST_ASSERT_MSG_GT (m_maxBacklog, 10000, "Fluid transfer without queueing");
+  NS_TEST_ASSERT_MSG_GT (queue->GetTotalDroppedPackets (), 0U, "No packet dropped by the fluid");
+}
+
+/**
+ * Check that a BulkSendApplication in fluid mode sends packets when no
+ * link of its path models fluid traffic.
+ */
+class FluidBulkSendCsmaTestCase : public TestCase
+{
+public:
+  FluidBulkSendCsmaTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+FluidBulkSendCsmaTestCase::FluidBulkSendCsmaTestCase ()
+  : TestCase ("Check that a fluid BulkSendApplication sends packets without a point to point link")
+{
+}
+
+void
+FluidBulkSendCsmaTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  CsmaHelper csma;
+  csma.SetChannelAttribute ("DataRate", StringValue ("10Mb/s"));
+  NetDeviceContainer devices = csma.Install (nodes);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  ipv4.Assign (devices);
+
+  BulkSendHelper bulk ("ns3::TcpSocketFactory", InetSocketAddress (Ipv4Address ("10.1.1.2"), 9));
+  bulk.SetAttribute ("Fluid", BooleanValue (true));
+  bulk.SetAttribute ("MaxBytes", UintegerValue (100000));
+  ApplicationContainer sender = bulk.Install (nodes.Get (0));
+  sender.Start (Seconds (0));
+  sender.Stop (Seconds (10));
+
+  PacketSinkHelper sink ("ns3::TcpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), 9));
+  ApplicationContainer sinks = sink.Install (nodes.Get (1));
+  sinks.Start (Seconds (0));
+  sinks.Stop (Seconds (10));
+
+  Simulator::Stop (Seconds (10));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  Ptr<PacketSink> received = sinks.Get (0)->GetObject<PacketSink> ();
+  NS_TEST_ASSERT_MSG_EQ (received->GetTotalRx (), 100000U, "Packets not sent without a fluid hop");
+}
+
+/**
+ * Fluid traffic TestSuite
+ */
+static class FluidTrafficSystemTestSuite : public TestSuite
+{
+public:
+  FluidTrafficSystemTestSuite ()
+    : TestSuite ("fluid-traffic-system", SYSTEM)
+  {
+    AddTestCase (new FluidOnOffTestCase, TestCase::QUICK);
+    AddTestCase (new FluidBulkSendTestCase, TestCase::QUICK);
+    AddTestCase (new FluidBulkSendCsmaTestCase, TestCase::QUICK);
+  }
+} g_fluidTrafficSystemTestSuite;
@@ -1076,30 +1076,56 @@ WifiMacHeader::GetSerializedSize (void) const
   return GetSize ();
 }
 void
+WifiMacHeader::WriteLsbU16 (uint8_t *&buffer, uint16_t data)
+{
+  Buffer::WriteLsb (buffer, data, 2);
+  buffer += 2;
+}
+void
+WifiMacHeader::WriteAddress (uint8_t *&buffer, Mac48Address address)
+{
+  address.CopyTo (buffer);
+  buffer += 6;
+}
+uint16_t
+WifiMacHeader::ReadLsbU16 (uint8_t const *&buffer)
+{
+  uint16_t data = Buffer::ReadLsb (buffer, 2);
+  buffer += 2;
+  return data;
+}
+void
+WifiMacHeader::ReadAddress (uint8_t const *&buffer, Mac48Address &address)
+{
+  address.CopyFrom (buffer);
+  buffer += 6;
+}
+void
 WifiMacHeader::Serialize (Buffer::Iterator i) const
 {
-  i.WriteHtolsbU16 (GetFrameControl ());
-  i.WriteHtolsbU16 (m_duration);
-  WriteTo (i, m_addr1);
+  uint8_t *buffer = i.WriteSpan (GetSize ());
+  WriteLsbU16 (buffer, GetFrameControl ());
+  WriteLsbU16 (buffer, m_duration);
+  WriteAddress (buffer, m_addr1);
   switch (m_ctrlType)
     {
     case TYPE_MGT:
-      WriteTo (i, m_addr2);
-      WriteTo (i, m_addr3);
-      i.WriteHtolsbU16 (GetSequenceControl ());
+      WriteAddress (buffer, m_addr2);
+      WriteAddress (buffer, m_addr3);
+      WriteLsbU16 (buffer, GetSequenceControl ());
       break;
     case TYPE_CTL:
       switch (m_ctrlSubtype)
         {
         case SUBTYPE_CTL_RTS:
-          WriteTo (i, m_addr2);
+          WriteAddress (buffer, m_addr2);
           break;
         case SUBTYPE_CTL_CTS:
         case SUBTYPE_CTL_ACK:
           break;
         case SUBTYPE_CTL_BACKREQ:
         case SUBTYPE_CTL_BACKRESP:
-          WriteTo (i, m_addr2);
+          WriteAddress (buffer, m_addr2);
           break;
         default:
           //NOTREACHED
@@ -1109,16 +1135,16 @@ WifiMacHeader::Serialize (Buffer::Iterator i) const
       break;
     case TYPE_DATA:
       {
-        WriteTo (i, m_addr2);
-        WriteTo (i, m_addr3);
-        i.WriteHtolsbU16 (GetSequenceControl ());
+        WriteAddress (buffer, m_addr2);
+        WriteAddress (buffer, m_addr3);
+        WriteLsbU16 (buffer, GetSequenceControl ());
         if (m_ctrlToDs && m_ctrlFromDs)
           {
-            WriteTo (i, m_addr4);
+            WriteAddress (buffer, m_addr4);
           }
         if (m_ctrlSubtype & 0x08)
           {
-            i.WriteHtolsbU16 (GetQosControl ());
+            WriteLsbU16 (buffer, GetQosControl ());
           }
       } break;
     default:
@@ -1133,41 +1159,50 @@ WifiMacHeader::Deserialize (Buffer::Iterator start)
   Buffer::Iterator i = start;
   uint16_t frame_control = i.ReadLsbtohU16 ();
   SetFrameControl (frame_control);
-  m_duration = i.ReadLsbtohU16 ();
-  ReadFrom (i, m_addr1);
+  // The frame control gives the size of the rest of the header; only
+  // the duration and the first address are read for the other frames.
+  uint32_t size = GetSize ();
+  if (size < 10 || (m_ctrlType == TYPE_CTL && m_ctrlSubtype == SUBTYPE_CTL_CTLWRAPPER))
+    {
+      size = 10;
+    }
+  uint8_t scratch[MAX_SIZE];
+  uint8_t const *buffer = i.ReadSpan (scratch, size - 2);
+  m_duration = ReadLsbU16 (buffer);
+  ReadAddress (buffer, m_addr1);
   switch (m_ctrlType)
     {
     case TYPE_MGT:
-      ReadFrom (i, m_addr2);
-      ReadFrom (i, m_addr3);
-      SetSequenceControl (i.ReadLsbtohU16 ());
+      ReadAddress (buffer, m_addr2);
+      ReadAddress (buffer, m_addr3);
+      SetSequenceControl (ReadLsbU16 (buffer));
       break;
     case TYPE_CTL:
       switch (m_ctrlSubtype)
         {
         case SUBTYPE_CTL_RTS:
-          ReadFrom (i, m_addr2);
+          ReadAddress (buffer, m_addr2);
           break;
         case SUBTYPE_CTL_CTS:
         case SUBTYPE_CTL_ACK:
           break;
         case SUBTYPE_CTL_BACKREQ:
         case SUBTYPE_CTL_BACKRESP:
-          ReadFrom (i, m_addr2);
+          ReadAddress (buffer, m_addr2);
           break;
         }
       break;
     case TYPE_DATA:
-      ReadFrom (i, m_addr2);
-      ReadFrom (i, m_addr3);
-      SetSequenceControl (i.ReadLsbtohU16 ());
+      ReadAddress (buffer, m_addr2);
+      ReadAddress (buffer, m_addr3);
+      SetSequenceControl (ReadLsbU16 (buffer));
       if (m_ctrlToDs && m_ctrlFromDs)
         {
-          ReadFrom (i, m_addr4);
+          ReadAddress (buffer, m_addr4);
         }
       if (m_ctrlSubtype & 0x08)
         {
-          SetQosControl (i.ReadLsbtohU16 ());
+          SetQosControl (ReadLsbU16 (buffer));
         }
       break;
     }
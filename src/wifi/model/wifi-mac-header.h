@@ -627,6 +627,38 @@ private:
    * \param os the output stream to print to
    */
   void PrintFrameControl (std::ostream &os) const;
+  /**
+   * Write a 16-bit field in little-endian byte order.
+   *
+   * \param buffer the bytes to write, moved past the field
+   * \param data the value of the field
+   */
+  static void WriteLsbU16 (uint8_t *&buffer, uint16_t data);
+  /**
+   * Write an address field.
+   *
+   * \param buffer the bytes to write, moved past the field
+   * \param address the value of the field
+   */
+  static void WriteAddress (uint8_t *&buffer, Mac48Address address);
+  /**
+   * Read a 16-bit field in little-endian byte order.
+   *
+   * \param buffer the bytes to read, moved past the field
+   * \return the value of the field
+   */
+  static uint16_t ReadLsbU16 (uint8_t const *&buffer);
+  /**
+   * Read an address field.
+   *
+   * \param buffer the bytes to read, moved past the field
+   * \param address the value of the field
+   */
+  static void ReadAddress (uint8_t const *&buffer, Mac48Address &address);
+
+  /// The size of the largest header: frame control, duration, four
+  /// addresses, sequence control and QoS control.
+  static const uint32_t MAX_SIZE = 2 + 2 + 6 + 6 + 6 + 2 + 6 + 2;
 
   uint8_t m_ctrlType;
   uint8_t m_ctrlSubtype;
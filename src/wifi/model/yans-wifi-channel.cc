@@ -81,6 +81,8 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double
 {
   Ptr<MobilityModel> senderMobility = sender->GetMobility ()->GetObject<MobilityModel> ();
   NS_ASSERT (senderMobility != 0);
+  // all receptions are handed to the simulator at once
+  EventBatch receptions;
   uint32_t j = 0;
   for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++, j++)
     {
@@ -114,11 +116,12 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double
           *(atts+1)= packetType;
           *(atts+2)= duration.GetNanoSeconds();
 
-          Simulator::ScheduleWithContext (dstNode,
-                                          delay, &YansWifiChannel::Receive, this,
-                                          j, copy, atts, txVector, preamble);
+          receptions.Add (dstNode, delay,
+                          MakeEvent (&YansWifiChannel::Receive, this,
+                                     j, copy, atts, txVector, preamble));
         }
     }
+  Simulator::ScheduleBatch (receptions);
 }
 
 void
@@ -0,0 +1,702 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Micro- and macro-benchmarks of the simulator core, reported in JSON.
+ *
+ * Every benchmark runs with the same seed and the same workload, so that
+ * the results of two builds can be compared run by run. For each one,
+ * the report gives the number of operations, the wall clock time, the
+ * rate, the time per operation and the peak resident set size of the
+ * process so far (it never decreases, hence benchmarks are run from the
+ * smallest to the largest memory footprint).
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#ifdef NS3_BENCH_INTERNET
+#include "ns3/internet-module.h"
+#endif
+#ifdef NS3_BENCH_WIFI
+#include "ns3/wifi-module.h"
+#include "ns3/mobility-module.h"
+#endif
+
+using namespace ns3;
+
+/**
+ * Collect benchmark results and write them as JSON.
+ */
+class BenchReport
+{
+public:
+  /**
+   * \param filter only run the benchmarks whose name contains this string.
+   * \param scale multiplier applied to the number of operations.
+   */
+  BenchReport (std::string filter, double scale);
+  /**
+   * \param name the name of a benchmark.
+   * \returns true if the benchmark must be run.
+   */
+  bool IsEnabled (std::string name) const;
+  /**
+   * \param n a default number of operations.
+   * \returns the number of operations scaled by the command line.
+   */
+  uint32_t Scale (uint32_t n) const;
+  /** Start timing a benchmark. */
+  void Start (void);
+  /**
+   * Stop timing a benchmark and record its result.
+   * \param name the name of the benchmark.
+   * \param unit what an operation is.
+   * \param ops the number of operations executed.
+   */
+  void Stop (std::string name, std::string unit, uint64_t ops);
+  /**
+   * Write all results.
+   * \param os the output stream.
+   */
+  void Write (std::ostream &os) const;
+
+private:
+  /** The result of a benchmark. */
+  struct Result
+  {
+    std::string name;   //!< Benchmark name.
+    std::string unit;   //!< What an operation is.
+    uint64_t ops;       //!< Number of operations.
+    double seconds;     //!< Elapsed wall clock time.
+    long peakRssKb;     //!< Peak resident set size of the process.
+  };
+  std::string m_filter;
+  double m_scale;
+  SystemWallClockMs m_clock;
+  std::vector<Result> m_results;
+};
+
+BenchReport::BenchReport (std::string filter, double scale)
+  : m_filter (filter),
+    m_scale (scale)
+{
+}
+
+bool
+BenchReport::IsEnabled (std::string name) const
+{
+  return name.find (m_filter) != std::string::npos;
+}
+
+uint32_t
+BenchReport::Scale (uint32_t n) const
+{
+  double scaled = n * m_scale;
+  return scaled < 1 ? 1 : (uint32_t)scaled;
+}
+
+void
+BenchReport::Start (void)
+{
+  m_clock.Start ();
+}
+
+void
+BenchReport::Stop (std::string name, std::string unit, uint64_t ops)
+{
+  int64_t ms = m_clock.End ();
+  struct rusage usage;
+  getrusage (RUSAGE_SELF, &usage);
+
+  Result result;
+  result.name = name;
+  result.unit = unit;
+  result.ops = ops;
+  result.seconds = ms / 1000.0;
+  // ru_maxrss is in kilobytes on Linux, in bytes on OS X
+#ifdef __APPLE__
+  result.peakRssKb = usage.ru_maxrss / 1024;
+#else
+  result.peakRssKb = usage.ru_maxrss;
+#endif
+  m_results.push_back (result);
+  std::clog << name << ": " << ops << " " << unit << " in " << result.seconds << " s" << std::endl;
+}
+
+void
+BenchReport::Write (std::ostream &os) const
+{
+  os << "{" << std::endl;
+  os << "  \"benchmarks\": [" << std::endl;
+  for (uint32_t i = 0; i < m_results.size (); ++i)
+    {
+      const Result &r = m_results[i];
+      // a zero duration only means the clock resolution was too coarse
+      double seconds = r.seconds > 0 ? r.seconds : 0.001;
+      os << "    {" << std::endl
+         << "      \"name\": \"" << r.name << "\"," << std::endl
+         << "      \"unit\": \"" << r.unit << "\"," << std::endl
+         << "      \"ops\": " << r.ops << "," << std::endl
+         << "      \"seconds\": " << r.seconds << "," << std::endl
+         << "      \"ops_per_second\": " << r.ops / seconds << "," << std::endl
+         << "      \"ns_per_op\": " << (r.ops > 0 ? seconds * 1e9 / r.ops : 0) << "," << std::endl
+         << "      \"peak_rss_kb\": " << r.peakRssKb << std::endl
+         << "    }" << (i + 1 < m_results.size () ? "," : "") << std::endl;
+    }
+  os << "  ]" << std::endl;
+  os << "}" << std::endl;
+}
+
+
+/**
+ * Hold model: a constant population of events, each of which schedules
+ * a new event after an exponentially distributed delay.
+ */
+class SchedulerBench
+{
+public:
+  /**
+   * \param population the number of pending events.
+   * \param total the number of events to run.
+   */
+  SchedulerBench (uint32_t population, uint32_t total);
+  /**
+   * \param scheduler the type of scheduler to use.
+   * \returns the number of events run.
+   */
+  uint64_t Run (std::string scheduler);
+private:
+  /** Schedule the next event. */
+  void Cb (void);
+
+  Ptr<ExponentialRandomVariable> m_rand;
+  uint32_t m_population;
+  uint32_t m_total;
+  uint32_t m_count;
+};
+
+SchedulerBench::SchedulerBench (uint32_t population, uint32_t total)
+  : m_population (population),
+    m_total (total),
+    m_count (0)
+{
+  m_rand = CreateObject<ExponentialRandomVariable> ();
+  m_rand->SetAttribute ("Mean", DoubleValue (100));
+}
+
+uint64_t
+SchedulerBench::Run (std::string scheduler)
+{
+  ObjectFactory factory (scheduler);
+  Simulator::SetScheduler (factory);
+  m_count = 0;
+  for (uint32_t i = 0; i < m_population; ++i)
+    {
+      Simulator::Schedule (NanoSeconds (m_rand->GetValue ()), &SchedulerBench::Cb, this);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+  return m_count;
+}
+
+void
+SchedulerBench::Cb (void)
+{
+  ++m_count;
+  if (m_count < m_total)
+    {
+      Simulator::Schedule (NanoSeconds (m_rand->GetValue ()), &SchedulerBench::Cb, this);
+    }
+}
+
+static void
+BenchSchedulers (BenchReport &report)
+{
+  const char *schedulers[] = {
+    "ns3::MapScheduler",
+    "ns3::HeapScheduler",
+    "ns3::CalendarScheduler",
+    "ns3::LadderScheduler",
+    "ns3::ListScheduler"
+  };
+  for (uint32_t i = 0; i < sizeof (schedulers) / sizeof (schedulers[0]); ++i)
+    {
+      std::string name = std::string ("scheduler/") + schedulers[i];
+      if (!report.IsEnabled (name))
+        {
+          continue;
+        }
+      // the list scheduler is linear: keep its population small
+      uint32_t population = i == 4 ? 1000 : 100000;
+      SchedulerBench bench (report.Scale (population), report.Scale (1000000));
+      report.Start ();
+      uint64_t events = bench.Run (schedulers[i]);
+      report.Stop (name, "events", events);
+    }
+}
+
+
+/**
+ * A header of N bytes.
+ */
+template <int N>
+class BenchHeader : public Header
+{
+public:
+  static TypeId GetTypeId (void)
+  {
+    std::ostringstream oss;
+    oss << "ns3::BenchSuiteHeader<" << N << ">";
+    static TypeId tid = TypeId (oss.str ().c_str ())
+      .SetParent<Header> ()
+      .HideFromDocumentation ()
+    ;
+    return tid;
+  }
+  virtual TypeId GetInstanceTypeId (void) const
+  {
+    return GetTypeId ();
+  }
+  virtual void Print (std::ostream &os) const
+  {
+    os << "N=" << N;
+  }
+  virtual uint32_t GetSerializedSize (void) const
+  {
+    return N;
+  }
+  virtual void Serialize (Buffer::Iterator start) const
+  {
+    start.WriteU8 (N, N);
+  }
+  virtual uint32_t Deserialize (Buffer::Iterator start)
+  {
+    start.Next (N);
+    return N;
+  }
+};
+
+static void
+BenchPacketCopy (BenchReport &report)
+{
+  if (!report.IsEnabled ("packet/copy"))
+    {
+      return;
+    }
+  uint32_t n = report.Scale (1000000);
+  BenchHeader<8> udp;
+  BenchHeader<20> ipv4;
+  Ptr<Packet> p = Create<Packet> (1000);
+  p->AddHeader (udp);
+  report.Start ();
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      // copy, then write into the copy, as every hop does
+      Ptr<Packet> copy = p->Copy ();
+      copy->AddHeader (ipv4);
+      copy->RemoveHeader (ipv4);
+    }
+  report.Stop ("packet/copy", "packets", n);
+}
+
+static void
+BenchPacketFragment (BenchReport &report)
+{
+  if (!report.IsEnabled ("packet/fragment"))
+    {
+      return;
+    }
+  uint32_t n = report.Scale (300000);
+  BenchHeader<20> ipv4;
+  Ptr<Packet> p = Create<Packet> (1500);
+  report.Start ();
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      Ptr<Packet> whole = p->CreateFragment (0, 500);
+      for (uint32_t offset = 500; offset < 1500; offset += 500)
+        {
+          Ptr<Packet> fragment = p->CreateFragment (offset, 500);
+          fragment->AddHeader (ipv4);
+          fragment->RemoveHeader (ipv4);
+          whole->AddAtEnd (fragment);
+        }
+    }
+  report.Stop ("packet/fragment", "packets", n);
+}
+
+static void
+BenchBufferGrowth (BenchReport &report)
+{
+  if (!report.IsEnabled ("buffer/growth"))
+    {
+      return;
+    }
+  uint32_t n = report.Scale (100000);
+  report.Start ();
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      Buffer buffer;
+      for (uint32_t j = 0; j < 32; ++j)
+        {
+          buffer.AddAtStart (20);
+          buffer.Begin ().WriteU8 (0, 20);
+          buffer.AddAtEnd (20);
+          Buffer::Iterator end = buffer.End ();
+          end.Prev (20);
+          end.WriteU8 (0, 20);
+        }
+    }
+  report.Stop ("buffer/growth", "buffers", n);
+}
+
+
+/**
+ * Target of the callback benchmark.
+ */
+class CallbackTarget
+{
+public:
+  CallbackTarget () : m_sum (0) {}
+  /** \param v the value to add. */
+  void Add (uint32_t v) { m_sum += v; }
+  uint64_t m_sum;  //!< Sum of all the values added.
+};
+
+static void
+BoundAdd (CallbackTarget *target, uint32_t v)
+{
+  target->Add (v);
+}
+
+static void
+BenchCallbacks (BenchReport &report)
+{
+  uint32_t n = report.Scale (50000000);
+  CallbackTarget target;
+  if (report.IsEnabled ("callback/member"))
+    {
+      Callback<void, uint32_t> cb = MakeCallback (&CallbackTarget::Add, &target);
+      report.Start ();
+      for (uint32_t i = 0; i < n; ++i)
+        {
+          cb (i);
+        }
+      report.Stop ("callback/member", "calls", n);
+    }
+  if (report.IsEnabled ("callback/bound"))
+    {
+      Callback<void, uint32_t> cb = MakeBoundCallback (&BoundAdd, &target);
+      report.Start ();
+      for (uint32_t i = 0; i < n; ++i)
+        {
+          cb (i);
+        }
+      report.Stop ("callback/bound", "calls", n);
+    }
+  if (target.m_sum == 0 && n > 1)
+    {
+      std::cerr << "callback benchmark did not run" << std::endl;
+    }
+}
+
+
+static void
+PhyRxDrop (Ptr<const Packet> packet)
+{
+}
+
+static void
+BenchConfig (BenchReport &report)
+{
+  if (!report.IsEnabled ("config/connect"))
+    {
+      return;
+    }
+  uint32_t n = report.Scale (2000);
+  NodeContainer nodes;
+  nodes.Create (100);
+  SimpleNetDeviceHelper helper;
+  helper.Install (nodes);
+
+  std::string path = "/NodeList/*/DeviceList/*/$ns3::SimpleNetDevice/PhyRxDrop";
+  report.Start ();
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      Config::ConnectWithoutContext (path, MakeCallback (&PhyRxDrop));
+      Config::DisconnectWithoutContext (path, MakeCallback (&PhyRxDrop));
+    }
+  report.Stop ("config/connect", "paths", 2 * (uint64_t)n);
+  Simulator::Destroy ();
+}
+
+
+#ifdef NS3_BENCH_INTERNET
+/**
+ * Send UDP packets from the first to the last node of a line of three
+ * nodes, and count the packets forwarded by the node in the middle.
+ */
+class ForwardingBench
+{
+public:
+  /** \param n the number of packets to send. */
+  ForwardingBench (uint32_t n);
+  /** \returns the number of packets forwarded. */
+  uint64_t Run (void);
+private:
+  /** Send the next packet. */
+  void Send (void);
+  /**
+   * Count a forwarded packet.
+   * \param header the IPv4 header.
+   * \param packet the packet.
+   * \param interface the outgoing interface.
+   */
+  void Forward (const Ipv4Header &header, Ptr<const Packet> packet, uint32_t interface);
+
+  Ptr<Socket> m_socket;
+  uint32_t m_n;
+  uint32_t m_sent;
+  uint64_t m_forwarded;
+};
+
+ForwardingBench::ForwardingBench (uint32_t n)
+  : m_n (n),
+    m_sent (0),
+    m_forwarded (0)
+{
+}
+
+uint64_t
+ForwardingBench::Run (void)
+{
+  NodeContainer nodes;
+  nodes.Create (3);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  SimpleNetDeviceHelper helper;
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  ipv4.Assign (helper.Install (NodeContainer (nodes.Get (0), nodes.Get (1))));
+  ipv4.SetBase ("10.1.2.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = ipv4.Assign (helper.Install (NodeContainer (nodes.Get (1), nodes.Get (2))));
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  nodes.Get (1)->GetObject<Ipv4L3Protocol> ()->TraceConnectWithoutContext
+    ("UnicastForward", MakeCallback (&ForwardingBench::Forward, this));
+
+  TypeId tid = TypeId::LookupByName ("ns3::UdpSocketFactory");
+  Ptr<Socket> sink = Socket::CreateSocket (nodes.Get (2), tid);
+  sink->Bind (InetSocketAddress (Ipv4Address::GetAny (), 9));
+  m_socket = Socket::CreateSocket (nodes.Get (0), tid);
+  m_socket->Connect (InetSocketAddress (interfaces.GetAddress (1), 9));
+
+  Simulator::Schedule (Seconds (1), &ForwardingBench::Send, this);
+  Simulator::Run ();
+  m_socket = 0;
+  Simulator::Destroy ();
+  return m_forwarded;
+}
+
+void
+ForwardingBench::Send (void)
+{
+  m_socket->Send (Create<Packet> (512));
+  m_sent++;
+  if (m_sent < m_n)
+    {
+      Simulator::Schedule (MicroSeconds (10), &ForwardingBench::Send, this);
+    }
+}
+
+void
+ForwardingBench::Forward (const Ipv4Header &header, Ptr<const Packet> packet, uint32_t interface)
+{
+  m_forwarded++;
+}
+
+static void
+BenchForwarding (BenchReport &report)
+{
+  if (!report.IsEnabled ("ipv4/forward"))
+    {
+      return;
+    }
+  ForwardingBench bench (report.Scale (200000));
+  report.Start ();
+  uint64_t forwarded = bench.Run ();
+  report.Stop ("ipv4/forward", "packets", forwarded);
+}
+#endif /* NS3_BENCH_INTERNET */
+
+
+#ifdef NS3_BENCH_WIFI
+/**
+ * Broadcast packets from one node to an ad hoc network where every node
+ * is in range of the sender, and count the receptions.
+ */
+class WifiFanOutBench
+{
+public:
+  /**
+   * \param nodes the number of nodes.
+   * \param n the number of packets to send.
+   */
+  WifiFanOutBench (uint32_t nodes, uint32_t n);
+  /** \returns the number of packets received. */
+  uint64_t Run (void);
+private:
+  /** Send the next packet. */
+  void Send (void);
+  /**
+   * Count a received packet.
+   * \param packet the packet.
+   */
+  void Receive (Ptr<const Packet> packet);
+
+  Ptr<NetDevice> m_device;
+  uint32_t m_nodes;
+  uint32_t m_n;
+  uint32_t m_sent;
+  uint64_t m_received;
+};
+
+WifiFanOutBench::WifiFanOutBench (uint32_t nodes, uint32_t n)
+  : m_nodes (nodes),
+    m_n (n),
+    m_sent (0),
+    m_received (0)
+{
+}
+
+uint64_t
+WifiFanOutBench::Run (void)
+{
+  NodeContainer nodes;
+  nodes.Create (m_nodes);
+
+  YansWifiChannelHelper channel = YansWifiChannelHelper::Default ();
+  YansWifiPhyHelper phy = YansWifiPhyHelper::Default ();
+  phy.SetChannel (channel.Create ());
+  WifiHelper wifi = WifiHelper::Default ();
+  NqosWifiMacHelper mac = NqosWifiMacHelper::Default ();
+  mac.SetType ("ns3::AdhocWifiMac");
+  NetDeviceContainer devices = wifi.Install (phy, mac, nodes);
+
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator ("ns3::GridPositionAllocator",
+                                 "DeltaX", DoubleValue (1.0),
+                                 "DeltaY", DoubleValue (1.0),
+                                 "GridWidth", UintegerValue (10));
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (nodes);
+
+  Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/PhyRxEnd",
+                                 MakeCallback (&WifiFanOutBench::Receive, this));
+
+  m_device = devices.Get (0);
+  Simulator::Schedule (Seconds (1), &WifiFanOutBench::Send, this);
+  Simulator::Run ();
+  m_device = 0;
+  Simulator::Destroy ();
+  return m_received;
+}
+
+void
+WifiFanOutBench::Send (void)
+{
+  m_device->Send (Create<Packet> (100), m_device->GetBroadcast (), 0x0800);
+  m_sent++;
+  if (m_sent < m_n)
+    {
+      Simulator::Schedule (MilliSeconds (1), &WifiFanOutBench::Send, this);
+    }
+}
+
+void
+WifiFanOutBench::Receive (Ptr<const Packet> packet)
+{
+  m_received++;
+}
+
+static void
+BenchWifi (BenchReport &report)
+{
+  if (!report.IsEnabled ("wifi/fan-out"))
+    {
+      return;
+    }
+  WifiFanOutBench bench (50, report.Scale (20000));
+  report.Start ();
+  uint64_t received = bench.Run ();
+  report.Stop ("wifi/fan-out", "receptions", received);
+}
+#endif /* NS3_BENCH_WIFI */
+
+
+int main (int argc, char *argv[])
+{
+  std::string filter = "";
+  std::string output = "";
+  double scale = 1.0;
+
+  CommandLine cmd;
+  cmd.Usage ("Run the simulator core benchmarks and report the results in JSON.\n"
+             "\n"
+             "Benchmarks are named <group>/<case>: scheduler/<type>, packet/copy,\n"
+             "packet/fragment, buffer/growth, callback/member, callback/bound,\n"
+             "config/connect, ipv4/forward and wifi/fan-out. The last two are\n"
+             "only available when the internet, and the wifi and mobility modules\n"
+             "are enabled.");
+  cmd.AddValue ("filter", "only run the benchmarks whose name contains this string", filter);
+  cmd.AddValue ("scale",  "multiply the number of operations by this factor", scale);
+  cmd.AddValue ("output", "write the JSON report to this file instead of stdout", output);
+  cmd.Parse (argc, argv);
+
+  RngSeedManager::SetSeed (1);
+  RngSeedManager::SetRun (1);
+
+  BenchReport report (filter, scale);
+  BenchCallbacks (report);
+  BenchBufferGrowth (report);
+  BenchPacketCopy (report);
+  BenchPacketFragment (report);
+  BenchConfig (report);
+  BenchSchedulers (report);
+#ifdef NS3_BENCH_INTERNET
+  BenchForwarding (report);
+#endif
+#ifdef NS3_BENCH_WIFI
+  BenchWifi (report);
+#endif
+
+  if (output == "")
+    {
+      report.Write (std::cout);
+    }
+  else
+    {
+      std::ofstream os (output.c_str ());
+      report.Write (os);
+    }
+  return 0;
+}